@@ -0,0 +1,59 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+#ifndef MAESTRO_AHW_BUFFER_LEVEL_HPP_
+#define MAESTRO_AHW_BUFFER_LEVEL_HPP_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace maestro {
+
+    namespace AHW {
+
+        // One level of the on-chip buffer hierarchy (e.g., L3 scratchpad, shared L2, L1, register file)
+        class BufferLevelConfig {
+        public:
+            std::string name_;
+            long size_ = 0; // Bytes per buffer instance; 0: unbounded
+            int bw_ = 0; // Elements per cycle in each direction; 0: unbounded
+            // Dynamic energy per element access, in the unit of the SRAM energy table; negative: looked up by size
+            double read_energy_ = -1;
+            double write_energy_ = -1;
+        }; // End of class BufferLevelConfig
+
+        /*
+         * Buffer level (index into the hierarchy, outermost first) that holds the data at a cluster boundary.
+         * Boundary b < num_cluster_lvs is the buffer each level-b cluster reads from (0: the top cluster),
+         * and boundary num_cluster_lvs is the buffer of the base cluster's units. The innermost level always
+         * serves the units; outer cluster levels take the levels from the top, and cluster levels beyond the
+         * hierarchy share its second innermost level.
+         */
+        inline int GetBufferLevelIdx(int boundary, int num_cluster_lvs, int num_buffer_levels) {
+            if(boundary >= num_cluster_lvs) {
+                return num_buffer_levels - 1;
+            }
+            return std::max(std::min(boundary, num_buffer_levels - 2), 0);
+        }
+    }; // End of namespace AHW
+}; // End of namespace maestro
+#endif
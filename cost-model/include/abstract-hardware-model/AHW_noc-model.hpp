@@ -22,16 +22,28 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #ifndef MAESTRO_AHW_NOC_MODEL_HPP_
 #define MAESTRO_AHW_NOC_MODEL_HPP_
 
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
 namespace maestro {
 
     namespace AHW {
 
+        /*
+         * Default: the original model, which only counts the data leaving (or arriving at) the upstream buffer
+         * Bus, Mesh, FatTree, MulticastTree: see the classes below
+         */
+        enum class NoCTopology {Default, Bus, Mesh, FatTree, MulticastTree};
+
         class NetworkOnChipModel {
         public:
             NetworkOnChipModel(int bw, int hops, int hop_latency ,bool mc) :
                     bandwidth_(bw), num_average_hops_(hops), latency_per_hops_(hop_latency), multicast_support_(mc) {
             }
 
+            virtual ~NetworkOnChipModel() {}
+
             int GetBandwidth() {
                 return bandwidth_;
             }
@@ -63,13 +75,188 @@ namespace maestro {
                 return delay;
             } // End of GetOutStandingDelay
 
+            /*
+             * Delay of one iteration's transfer from the upstream buffer to num_endpoints sub-clusters:
+             * unique_volume elements leave the buffer, delivered_volume elements arrive at the sub-clusters
+             * in total (the difference is spatial multicast)
+             */
+            virtual long GetIngressDelay(long unique_volume, long /* delivered_volume */, long /* num_endpoints */) {
+                return GetOutStandingDelay(unique_volume);
+            }
+
+            /*
+             * Delay of one iteration's transfer from the sub-clusters to the upstream buffer: the sub-clusters
+             * send sent_volume elements in total, which spatial reduction reduces to unique_volume
+             */
+            virtual long GetEgressDelay(long unique_volume, long /* sent_volume */, long /* num_endpoints */) {
+                return GetOutStandingDelay(unique_volume);
+            }
+
+            /*
+             * Fill latency of a pipelined binary reduction tree over the NoC that combines fan_in partial sums
+             * into one output; every tree level takes one hop and one addition
+             */
+            long GetReductionTreeLatency(long fan_in) {
+                long num_levels = static_cast<long>(std::ceil(std::log2(static_cast<double>(std::max(fan_in, 1L)))));
+                return num_levels * (latency_per_hops_ + 1);
+            }
+
+            // Cycles for the reduction tree to emit num_outputs reduced elements, bw per cycle
+            long GetReductionIssueDelay(long num_outputs) {
+                return (num_outputs + bandwidth_ - 1) / std::max(bandwidth_, 1);
+            }
+
+            // Whether the delays depend on the delivered and sent volumes; callers skip computing them otherwise
+            virtual bool IsTopologyAware() {
+                return false;
+            }
+
         protected:
             int bandwidth_;
             int num_average_hops_;
             int latency_per_hops_;
             bool multicast_support_;
 
+
+            // Head delay plus pipelined serialization of the given load on the bottleneck link
+            long GetPipelinedDelay(long num_hops, double bottleneck_load, double link_bw) {
+                long num_sends = std::max(static_cast<long>(std::ceil(bottleneck_load / link_bw)), 1L);
+                return num_hops * latency_per_hops_ + (num_sends - 1);
+            }
+
+            // Average number of sub-clusters that need each element
+            static double GetFanout(long unique_volume, long delivered_volume) {
+                return (unique_volume > 0) ? std::max(static_cast<double>(delivered_volume) / unique_volume, 1.0) : 1.0;
+            }
         }; // End of class NetworkOnChipModel
+
+        /*
+         * Shared bus of bw elements per cycle. A multicast-capable bus delivers each element to all its
+         * destinations at once; otherwise every copy takes its own bus cycle.
+         */
+        class BusNoCModel : public NetworkOnChipModel {
+        public:
+            BusNoCModel(int bw, int hops, int hop_latency, bool mc) :
+                    NetworkOnChipModel(bw, hops, hop_latency, mc) {
+            }
+
+            virtual long GetIngressDelay(long unique_volume, long delivered_volume, long /* num_endpoints */) {
+                long load = multicast_support_ ? unique_volume : std::max(delivered_volume, unique_volume);
+                return GetPipelinedDelay(num_average_hops_, load, bandwidth_);
+            }
+
+            virtual long GetEgressDelay(long unique_volume, long sent_volume, long num_endpoints) {
+                return GetIngressDelay(unique_volume, sent_volume, num_endpoints);
+            }
+
+            virtual bool IsTopologyAware() {
+                return true;
+            }
+        }; // End of class BusNoCModel
+
+        /*
+         * 2D mesh of the sub-clusters (k x k, k = ceil(sqrt(num_endpoints))) whose upstream buffer is banked
+         * along one edge, one injection link of bw per column; traffic enters at the column of its
+         * destination (XY routing). Destinations are assumed to be spread uniformly, so every column link
+         * carries 1/k of the traffic. Multicast replicates along columns only: an element with fanout f is
+         * injected into min(f, k) columns. Egress reductions mirror this.
+         */
+        class MeshNoCModel : public NetworkOnChipModel {
+        public:
+            MeshNoCModel(int bw, int hops, int hop_latency, bool mc) :
+                    NetworkOnChipModel(bw, hops, hop_latency, mc) {
+            }
+
+            virtual long GetIngressDelay(long unique_volume, long delivered_volume, long num_endpoints) {
+                long k = std::max(static_cast<long>(std::ceil(std::sqrt(static_cast<double>(num_endpoints)))), 1L);
+                double fanout = GetFanout(unique_volume, delivered_volume);
+
+                double total_load = multicast_support_ ?
+                                    unique_volume * std::min(fanout, static_cast<double>(k))
+                                    : static_cast<double>(std::max(delivered_volume, unique_volume));
+                long num_hops = (k + 1) / 2 + 1;
+                return GetPipelinedDelay(num_hops, total_load / k, bandwidth_);
+            }
+
+            virtual long GetEgressDelay(long unique_volume, long sent_volume, long num_endpoints) {
+                return GetIngressDelay(unique_volume, sent_volume, num_endpoints);
+            }
+
+            virtual bool IsTopologyAware() {
+                return true;
+            }
+        }; // End of class MeshNoCModel
+
+        /*
+         * Binary tree with links of bw at every level, rooted at the upstream buffer. Switches replicate
+         * multicast data (and reduce partial sums on the way up), so the root link carries every unique
+         * element once; without multicast it carries every copy.
+         */
+        class MulticastTreeNoCModel : public NetworkOnChipModel {
+        public:
+            MulticastTreeNoCModel(int bw, int hops, int hop_latency, bool mc) :
+                    NetworkOnChipModel(bw, hops, hop_latency, mc) {
+            }
+
+            virtual long GetIngressDelay(long unique_volume, long delivered_volume, long num_endpoints) {
+                long num_levels = GetNumLevels(num_endpoints);
+                long root_load = multicast_support_ ? unique_volume : std::max(delivered_volume, unique_volume);
+                return GetPipelinedDelay(num_levels, root_load, bandwidth_);
+            }
+
+            virtual long GetEgressDelay(long unique_volume, long sent_volume, long num_endpoints) {
+                return GetIngressDelay(unique_volume, sent_volume, num_endpoints);
+            }
+
+            virtual bool IsTopologyAware() {
+                return true;
+            }
+
+        protected:
+            static long GetNumLevels(long num_endpoints) {
+                return std::max(static_cast<long>(std::ceil(std::log2(static_cast<double>(std::max(num_endpoints, 1L))))), 1L);
+            }
+        }; // End of class MulticastTreeNoCModel
+
+        /*
+         * Binary fat tree with full bisection bandwidth: leaf links carry bw and links double their bandwidth
+         * at every level toward the root, so every level offers num_endpoints * bw in total and the root
+         * connects to the upstream buffer with num_endpoints / 2 * bw. The slower of the root port and the
+         * leaf links (each leaf receives its own copies) bounds the transfer.
+         */
+        class FatTreeNoCModel : public MulticastTreeNoCModel {
+        public:
+            FatTreeNoCModel(int bw, int hops, int hop_latency, bool mc) :
+                    MulticastTreeNoCModel(bw, hops, hop_latency, mc) {
+            }
+
+            virtual long GetIngressDelay(long unique_volume, long delivered_volume, long num_endpoints) {
+                long num_leaves = std::max(num_endpoints, 1L);
+                long num_levels = GetNumLevels(num_leaves);
+                double root_bw = static_cast<double>(bandwidth_) * std::max(num_leaves / 2, 1L);
+
+                long delivered = std::max(delivered_volume, unique_volume);
+                double root_time = (multicast_support_ ? unique_volume : delivered) / root_bw;
+                double leaf_time = static_cast<double>(delivered) / num_leaves / bandwidth_;
+                return GetPipelinedDelay(num_levels, std::max(root_time, leaf_time), 1.0);
+            }
+        }; // End of class FatTreeNoCModel
+
+        inline std::shared_ptr<NetworkOnChipModel> CreateNoCModel(NoCTopology topology, int bw, int hops, int hop_latency, bool mc) {
+            switch(topology) {
+                case NoCTopology::Bus:
+                    return std::make_shared<BusNoCModel>(bw, hops, hop_latency, mc);
+                case NoCTopology::Mesh:
+                    return std::make_shared<MeshNoCModel>(bw, hops, hop_latency, mc);
+                case NoCTopology::FatTree:
+                    return std::make_shared<FatTreeNoCModel>(bw, hops, hop_latency, mc);
+                case NoCTopology::MulticastTree:
+                    return std::make_shared<MulticastTreeNoCModel>(bw, hops, hop_latency, mc);
+                case NoCTopology::Default:
+                default:
+                    return std::make_shared<NetworkOnChipModel>(bw, hops, hop_latency, mc);
+            }
+        }
     }; // End of namespace abstract_hw
 }; // End of namespace maestro
 #endif
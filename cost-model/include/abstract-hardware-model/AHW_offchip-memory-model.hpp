@@ -0,0 +1,147 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+#ifndef MAESTRO_AHW_OFFCHIP_MEMORY_MODEL_HPP_
+#define MAESTRO_AHW_OFFCHIP_MEMORY_MODEL_HPP_
+
+#include <vector>
+#include <algorithm>
+
+namespace maestro {
+
+    namespace AHW {
+
+        // Transfer of one tile of a tensor between the off-chip memory and the uppermost buffer
+        class OffchipAccessStream {
+        public:
+            long num_elements_ = 0;
+            // Number of elements stored contiguously in the off-chip memory
+            long run_length_ = 1;
+            int element_bit_size_ = 32;
+            bool is_write_ = false;
+        }; // End of class OffchipAccessStream
+
+        // DRAM timing; latencies are in accelerator cycles
+        class DRAMTimingConfig {
+        public:
+            int bus_bw_ = 16; // Bytes per cycle
+            int burst_size_ = 64; // Bytes
+            int row_size_ = 2048; // Bytes
+            int num_banks_ = 8;
+            int t_rcd_ = 14; // Row activation
+            int t_rp_ = 14; // Precharge
+            int t_cas_ = 14; // Column access
+            int t_turnaround_ = 8; // Read to write switch of the data bus
+        }; // End of class DRAMTimingConfig
+
+        class OffchipMemoryModel {
+        public:
+            virtual ~OffchipMemoryModel() {}
+
+            // Cycles to move all the given streams
+            virtual long GetTransferDelay(const std::vector<OffchipAccessStream>& streams) = 0;
+
+            // Reads and writes share one channel, so ingress and egress transfers do not overlap
+            virtual bool IsHalfDuplex() {
+                return false;
+            }
+        }; // End of class OffchipMemoryModel
+
+        // Fixed number of elements per cycle in each direction
+        class ConstantBandwidthModel : public OffchipMemoryModel {
+        public:
+            ConstantBandwidthModel(int bw) :
+                    bandwidth_(bw) {
+            }
+
+            virtual long GetTransferDelay(const std::vector<OffchipAccessStream>& streams) {
+                long num_elements = 0;
+                for(auto& stream : streams) {
+                    num_elements += stream.num_elements_;
+                }
+                return num_elements / std::max(bandwidth_, 1);
+            }
+
+        protected:
+            int bandwidth_;
+        }; // End of class ConstantBandwidthModel
+
+        /*
+         * Burst-granular DRAM channel. Every contiguous run of a stream is fetched in whole bursts and opens
+         * its own rows (a tile is a strided pattern, so consecutive runs rarely share a row); row activations
+         * of different runs overlap across banks and with the data transfers. A transfer pays one
+         * activation and column access latency, and one bus turnaround if it mixes reads and writes.
+         */
+        class DRAMModel : public OffchipMemoryModel {
+        public:
+            DRAMModel(DRAMTimingConfig timing) :
+                    timing_(timing) {
+            }
+
+            virtual long GetTransferDelay(const std::vector<OffchipAccessStream>& streams) {
+                long num_data_bytes = 0;
+                long num_activations = 0;
+                bool has_read = false;
+                bool has_write = false;
+
+                for(auto& stream : streams) {
+                    if(stream.num_elements_ <= 0) {
+                        continue;
+                    }
+
+                    long num_bytes = CeilDiv(stream.num_elements_ * stream.element_bit_size_, 8);
+                    long run_bytes = std::min(CeilDiv(std::max(stream.run_length_, 1L) * stream.element_bit_size_, 8), num_bytes);
+                    long num_runs = CeilDiv(num_bytes, run_bytes);
+
+                    num_data_bytes += num_runs * CeilDiv(run_bytes, timing_.burst_size_) * timing_.burst_size_;
+                    num_activations += num_runs * CeilDiv(run_bytes, timing_.row_size_);
+                    has_read = has_read || !stream.is_write_;
+                    has_write = has_write || stream.is_write_;
+                }
+
+                if(num_data_bytes == 0) {
+                    return 0;
+                }
+
+                long data_cycles = CeilDiv(num_data_bytes, timing_.bus_bw_);
+                long activation_cycles = CeilDiv(num_activations * (timing_.t_rp_ + timing_.t_rcd_), timing_.num_banks_);
+                long turnaround_cycles = (has_read && has_write) ? timing_.t_turnaround_ : 0;
+
+                return timing_.t_rp_ + timing_.t_rcd_ + timing_.t_cas_
+                       + std::max(data_cycles, activation_cycles) + turnaround_cycles;
+            }
+
+            virtual bool IsHalfDuplex() {
+                return true;
+            }
+
+        protected:
+            DRAMTimingConfig timing_;
+
+        private:
+            static long CeilDiv(long a, long b) {
+                b = std::max(b, 1L);
+                return (a + b - 1) / b;
+            }
+        }; // End of class DRAMModel
+    }; // End of namespace AHW
+}; // End of namespace maestro
+#endif
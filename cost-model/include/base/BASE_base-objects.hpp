@@ -34,6 +34,29 @@ namespace maestro {
 
     void InitializeBaseObjects(int print_lv = 256);
 
+    // Objects of the session running on the calling thread, or the process-wide defaults
+    std::shared_ptr<TL::ErrorHandler> GetErrorHandler();
+    std::shared_ptr<TL::MessagePrinter> GetMessagePrinter();
+
+    /*
+     * Installs session-specific objects on the calling thread for the lifetime of the scope.
+     * MAESTRO objects constructed within the scope use them instead of the process-wide defaults,
+     * which lets an embedding host run independent analyses side by side (e.g., one per thread).
+     */
+    class BaseObjectScope {
+    public:
+        BaseObjectScope(std::shared_ptr<TL::ErrorHandler> session_error_handler_in,
+                        std::shared_ptr<TL::MessagePrinter> session_message_printer_in);
+        ~BaseObjectScope();
+
+        BaseObjectScope(const BaseObjectScope&) = delete;
+        BaseObjectScope& operator=(const BaseObjectScope&) = delete;
+
+    protected:
+        std::shared_ptr<TL::ErrorHandler> prev_error_handler_;
+        std::shared_ptr<TL::MessagePrinter> prev_message_printer_;
+    };
+
 };
 
 #endif
@@ -25,6 +25,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 
 #include <string>
+#include <stdexcept>
 #include "DFA_layer.hpp"
 
 namespace maestro{
@@ -87,11 +88,25 @@ namespace maestro{
             case LayerQuantizationType::INT2:
                 return 2;
             default:
-                std::cerr << "Unsupported quantization type" << std::endl;
-                exit(EXIT_FAILURE);
+                throw std::invalid_argument("Unsupported quantization type");
         }
     }
 
+    // Hardware parameters as seen by a layer; the number of PEs and buffer entries scales with the layer precision
+    class LayerHardwareView {
+    public:
+        LayerHardwareView(long num_pes, long l1_byte_size, long l2_byte_size, LayerQuantizationType quantization_type) :
+                num_pes_(num_pes * (32 / static_cast<long>(getBitSize(quantization_type)))),
+                l1_size_(l1_byte_size * 8 / static_cast<long>(getBitSize(quantization_type))),
+                l2_size_(l2_byte_size * 8 / static_cast<long>(getBitSize(quantization_type))) {
+        }
+
+        const long num_pes_;
+        // In elements of the layer precision
+        const long l1_size_;
+        const long l2_size_;
+    }; // End of class LayerHardwareView
+
 // Function to find the appropriate memory size
     size_t getMemorySize(size_t byteSize) {
         for (const auto& [size, params] : memory_data) {
@@ -114,8 +129,7 @@ namespace maestro{
             case LayerQuantizationType::INT2:
                 return 2;
             default:
-                std::cerr << "Unsupported quantization type" << std::endl;
-                exit(EXIT_FAILURE);
+                throw std::invalid_argument("Unsupported quantization type");
         }
     }
 
@@ -139,8 +153,7 @@ namespace maestro{
         } else if (operation == Operation::Write) {
             return params.wr_dyn_energy;
         } else {
-            std::cerr << "Unsupported operation type" << std::endl;
-            exit(EXIT_FAILURE);
+            throw std::invalid_argument("Unsupported operation type");
         }
     }
 
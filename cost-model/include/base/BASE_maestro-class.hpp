@@ -34,14 +34,14 @@ namespace maestro {
 
         MAESTROClass() :
                 instance_name_("class"),
-                error_handler_(error_handler),
-                message_printer_(message_printer) {
+                error_handler_(GetErrorHandler()),
+                message_printer_(GetMessagePrinter()) {
         }
 
         MAESTROClass(std::string instance_name) :
                 instance_name_(instance_name),
-                error_handler_(error_handler),
-                message_printer_(message_printer) {
+                error_handler_(GetErrorHandler()),
+                message_printer_(GetMessagePrinter()) {
         }
 
         std::string GetName() {
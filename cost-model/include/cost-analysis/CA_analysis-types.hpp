@@ -1,12 +1,64 @@
 #ifndef MAESTRO_CA_ANALYSIS_TYPES_HPP_
 #define MAESTRO_CA_ANALYSIS_TYPES_HPP_
 
+#include <string>
+#include <algorithm>
+
+#include "BASE_constants.hpp"
 
 namespace maestro {
     namespace CA {
 
         enum class IterationStatus {Init, Edge, Unroll};
         enum class EstimationType {Min, Max, Exact, NumEstimationTypes};
+        enum class AnalysisFidelity {Exact, Roofline};
+
+        /*
+         * How the partial sums that several sub-clusters produce for the same output are combined.
+         * Implicit: PEs reduce them as they are generated, at no extra cost
+         * CoarseGrainedSync: an explicit reduction tree starts once every sub-cluster finished the iteration
+         * FineGrainedSync: an explicit reduction tree reduces each output as soon as its partial sums are ready
+         */
+        enum class ReductionMode {Implicit, CoarseGrainedSync, FineGrainedSync};
+
+        const int max_buffering_depth = 3;
+
+        /*
+         * Number of tiles of each tensor class every buffer holds (1: single, 2: double, 3: triple buffering).
+         * With a single tile, the transfers of the tensor stall the computation. With two, the transfer of the
+         * next (or previous) tile overlaps the computation of the current one. Each further tile lets the
+         * transfers run one more tile ahead (or behind), so the slack of compute-bound iterations hides the
+         * overrun of transfer-bound ones.
+         */
+        class TensorBuffering {
+        public:
+            TensorBuffering(int depth = 2) {
+                for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                    depth_[i] = depth;
+                }
+            }
+
+            void SetDepth(DataClass data_class, int depth) {
+                depth_[static_cast<int>(data_class)] = std::max(std::min(depth, max_buffering_depth), 1);
+            }
+
+            int GetDepth(DataClass data_class) const {
+                return depth_[static_cast<int>(data_class)];
+            }
+
+            bool IsOverlapped(DataClass data_class) const {
+                return GetDepth(data_class) >= 2;
+            }
+
+            std::string ToString() const {
+                return "Input x" + std::to_string(GetDepth(DataClass::Input))
+                       + ", Weight x" + std::to_string(GetDepth(DataClass::Weight))
+                       + ", Output x" + std::to_string(GetDepth(DataClass::Output));
+            }
+
+        protected:
+            int depth_[static_cast<int>(DataClass::NumDataClasses)];
+        }; // End of class TensorBuffering
 
     };
 };
@@ -22,24 +22,87 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <iostream>
 #include <memory>
 #include <cmath>
+#include <vector>
+#include <fstream>
+#include <limits>
 
 #include "BASE_constants.hpp"
 
 #include "BASE_maestro-class.hpp"
 #include "TL_error-handler.hpp"
+#include "TL_task-scheduler.hpp"
 
 #include "DFA_cluster-unit.hpp"
 #include "DFA_cluster-table.hpp"
 #include "DFA_iteration-status.hpp"
 #include "DFA_iteration-analysis.hpp"
+#include "DFA_sparsity.hpp"
 
 #include "CA_analysis-types.hpp"
 #include "CA_reuse-analysis.hpp"
 #include "CA_cost-analysis-results.hpp"
+#include "CA_offchip-access.hpp"
+
+#include "AHW_offchip-memory-model.hpp"
 
 namespace maestro {
     namespace CA {
 
+        // Per-case intermediate results; produced independently for each iteration case and accumulated in order
+        class IterationCaseResults {
+        public:
+            class TensorTraffic {
+            public:
+                DataClass data_class_;
+                long spatial_traffic_;
+                long spatial_mapping_size_;
+            };
+
+            long num_case_occurrences_ = 0;
+            bool is_valid_ = false;
+
+            std::vector<TensorTraffic> output_traffic_;
+            std::vector<TensorTraffic> input_traffic_;
+
+            long num_partial_sums_ = 0;
+            double arithmetic_intensity_ = 0;
+            long ingress_spatial_traffic_ = 0;
+            long egress_spatial_traffic_ = 0;
+
+            long computation_delay_ = 0;
+            long ingress_comm_delay_ = 0;
+            long egress_comm_delay_ = 0;
+            long reduction_delay_ = 0;
+            long outstanding_delay_ = 0;
+            long reduction_traffic_ = 0;
+            // Breakdown of outstanding_delay_ outside the initialization case: the part that stalls the
+            // computation and the transfers overlapped with it
+            bool is_init_ = false;
+            long stalled_delay_ = 0;
+            long overlapped_ingress_delay_ = 0;
+            long overlapped_egress_delay_ = 0;
+            // Split of outstanding_delay_ and of stalled_delay_ over the bound types, and the bound types of
+            // the overlapped transfers (the NoC or the off-chip memory, whichever is slower)
+            long bound_delay_[static_cast<int>(BoundType::NumBoundTypes)] = {};
+            long stalled_bound_delay_[static_cast<int>(BoundType::NumBoundTypes)] = {};
+            BoundType ingress_bound_ = BoundType::Ingress;
+            BoundType egress_bound_ = BoundType::Egress;
+            // Accesses below the sub-clusters' buffers; see CostAnalysisResults::GetHierarchyAccessCount
+            long hierarchy_access_count_[max_hierarchy_depth + 1][static_cast<int>(BufferAccessType::NumBufferAccessTypes)] = {};
+
+            long off_chip_ingress_bw_req_ = 0;
+            long off_chip_egress_bw_req_ = 0;
+            long offchip_ingress_delay_ = 0;
+            long offchip_egress_delay_ = 0;
+
+            long double num_active_unit_clusters_ = 0;
+            std::shared_ptr<CostAnalysisResults> critical_sub_results_ = nullptr;
+
+            // Results of the sub-cluster analyses of this case, in the order they were produced
+            std::shared_ptr<std::vector<std::shared_ptr<CostAnalysisResults>>> nested_results_ =
+                    std::make_shared<std::vector<std::shared_ptr<CostAnalysisResults>>>();
+        }; // End of class IterationCaseResults
+
         class CostAnalysisEngine : public MAESTROClass {
         public:
 
@@ -52,8 +115,56 @@ namespace maestro {
                     tensors_(tensors),
                     clusters_(clusters),
                     num_simd_lanes_(configs->target_accelerator_->GetVectorWidth()),
+                    offchip_memory_(configs->GetOffchipMemoryModel()),
                     MAESTROClass("PerformanceAnalysis") {}
 
+            // Analyzes the iteration cases of non-base cluster levels in parallel; nullptr keeps the analysis serial
+            void SetTaskScheduler(std::shared_ptr<TL::TaskScheduler> task_scheduler) {
+                task_scheduler_ = task_scheduler;
+            }
+
+            // A tensor class kept in L2 across layers (fused with the adjacent layer) is not moved off-chip
+            void SetL2Resident(DataClass data_class, bool is_resident) {
+                l2_resident_[static_cast<int>(data_class)] = is_resident;
+            }
+
+            void SetReductionMode(ReductionMode reduction_mode) {
+                reduction_mode_ = reduction_mode;
+            }
+
+            // Tile buffers per tensor class when the analysis double-buffers; otherwise every tensor has one
+            void SetTensorBuffering(TensorBuffering buffering) {
+                buffering_ = buffering;
+            }
+
+            // Keeps the iteration cases of every cluster level (see CostAnalysisResults::GetCaseRecords)
+            void SetTimelineRecording(bool record_timeline) {
+                record_timeline_ = record_timeline;
+            }
+
+            // Bit width of the elements of the analyzed layer, used for the off-chip transfer sizes
+            void SetElementBitSize(int element_bit_size) {
+                element_bit_size_ = element_bit_size;
+            }
+
+            /*
+             * Sparsity of the analyzed layer (nullptr for a dense layer). Input and weight tensors are held and
+             * moved in their compressed formats, outputs are compressed when drained off-chip, and only the
+             * effectual MACs are computed; the base clusters wait for the slowest one.
+             */
+            void SetSparsity(std::shared_ptr<DFA::LayerSparsity> sparsity, int element_bit_size) {
+                sparsity_ = sparsity;
+                for (int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                    footprint_factor_[i] = (sparsity == nullptr) ? 1.0 :
+                                           sparsity->GetFootprintFactor(static_cast<DataClass>(i), element_bit_size);
+                }
+
+                num_base_clusters_ = 1;
+                for (int cluster_idx = 0; cluster_idx < clusters_->size() - 1; cluster_idx++) {
+                    num_base_clusters_ *= clusters_->GetCluster(cluster_idx)->GetNumClusters();
+                }
+            }
+
             std::shared_ptr<std::vector<std::shared_ptr<CostAnalysisResults>>>
             AnalyzeEntireCluster(bool write_log_file = false) {
 
@@ -77,8 +188,6 @@ namespace maestro {
                 /* Base information */
                 std::shared_ptr<DFA::ClusterUnit> target_cluster = clusters_->GetCluster(cluster_idx);
                 int num_sub_clusters = target_cluster->GetNumClusters(false);
-                int num_edge_clusters = target_cluster->GetNumClusters(true);
-                int num_active_clusters = num_sub_clusters;
                 auto dataflow = target_cluster->GetDataflow();
                 auto noc = target_cluster->GetNoCModel();
 
@@ -107,17 +216,8 @@ namespace maestro {
                 auto results = std::make_shared<CostAnalysisResults>(clusters_->GetLayerType(), cluster_idx);
                 results->UpdateNumSubClusters(target_cluster->GetNumClusters());
 
-                /* Cost stats */
-                long peak_noc_bw_req = 0;
-                long double avg_noc_bw_req = 0;
-                long off_chip_bw_req = 0;
-
-                long double delays[static_cast<int>(DelayType::NumDelayTypes)][static_cast<int>(ValueType::NumValTypes)];
-                for (int i = 0; i < static_cast<int>(DelayType::NumDelayTypes); i++) {
-                    delays[i][static_cast<int>(ValueType::Min)] = std::numeric_limits<long double>::max();
-                    delays[i][static_cast<int>(ValueType::Max)] = std::numeric_limits<long double>::min();
-                    delays[i][static_cast<int>(ValueType::Avg)] = 0;
-                }
+                /* Cost stats; committed to results once all the iteration cases are accumulated */
+                CostAccumulator accumulator;
 
                 auto iteration_analysis = std::make_unique<DFA::IterationAnalysis>(dimensions, target_cluster);
                 std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationStatus>>> all_iteration_cases = iteration_analysis->GetAllIterationsStatus();
@@ -126,413 +226,779 @@ namespace maestro {
                 // TODO: Apply case-based analysis
 //          UpdateBufferSizeReq(results, dimensions, reuse_analysis, do_double_buffering);
 
-                long num_total_cases = 0;
-                int case_id = 0;
+                // updated done only for the first iteration. The { Init, Init, Init, ....} case
+                // (cases without partial sums are skipped, so it is repeated until the first valid case)
                 for (auto &iteration_case: *all_iteration_cases) {
-                    // updated done only for the first iteration. The { Init, Init, Init, ....} case
-                    if (case_id == 0) {
-                        UpdateBufferSizeReq(results, dimensions, reuse_analysis, iteration_case, cluster_idx,
-                                            num_cluster_lvs, do_double_buffering);
+                    UpdateBufferSizeReq(results, accumulator, dimensions, reuse_analysis, iteration_case, cluster_idx,
+                                        num_cluster_lvs, do_double_buffering);
+                    if (GetNumPartialSums(reuse_analysis, iteration_case) > 0) {
+                        break;
                     }
+                }
 
-                    long num_case_occurrences = iteration_case->GetNumOccurrences();
-                    assert(num_case_occurrences > 0);
+                int case_id = 0;
+                std::ofstream* case_log_file = (write_log_file && cluster_idx <= print_cluster_lv) ? &log_file : nullptr;
+                bool analyze_in_parallel = task_scheduler_ != nullptr && !write_log_file
+                                           && cluster_idx < num_cluster_lvs - 1 && all_iteration_cases->size() > 1;
+
+                if (analyze_in_parallel) {
+                    /*
+                     * Cases are analyzed in chunks, each with its own ReuseAnalysis (its lookup tables are not
+                     * thread-safe), and accumulated in case order afterwards
+                     */
+                    int num_cases = all_iteration_cases->size();
+                    int num_chunks = std::min(num_cases, 4 * task_scheduler_->GetNumThreads());
+                    std::vector<IterationCaseResults> case_results(num_cases);
+
+                    task_scheduler_->ParallelFor(num_chunks, [&](int chunk_id) {
+                        BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                        auto chunk_reuse_analysis = std::make_shared<CA::ReuseAnalysis>(target_cluster, write_log_file);
+                        int first_case = static_cast<long>(chunk_id) * num_cases / num_chunks;
+                        int last_case = static_cast<long>(chunk_id + 1) * num_cases / num_chunks;
+                        for (int case_idx = first_case; case_idx < last_case; case_idx++) {
+                            AnalyzeIterationCase(cluster_idx, num_cluster_lvs, all_iteration_cases->at(case_idx), 0,
+                                                 chunk_reuse_analysis, results, case_results[case_idx], nullptr,
+                                                 print_cluster_lv, do_double_buffering, write_log_file);
+                        }
+                    });
 
-                    if (write_log_file && cluster_idx <= print_cluster_lv) {
-                        log_file << "======================= CASE " << case_id << " ======================="
-                                 << std::endl;
-                        log_file << "@ cluster level " << cluster_idx << std::endl;
-                        log_file << iteration_case->ToString() << std::endl;
+                    for (auto &case_res: case_results) {
+                        AccumulateIterationCase(cluster_idx, case_res, accumulator, results, ret, do_double_buffering, case_id);
                     }
+                } else {
+                    for (auto &iteration_case: *all_iteration_cases) {
+                        IterationCaseResults case_res;
+                        AnalyzeIterationCase(cluster_idx, num_cluster_lvs, iteration_case, case_id, reuse_analysis,
+                                             results, case_res, case_log_file, print_cluster_lv, do_double_buffering,
+                                             write_log_file);
+                        AccumulateIterationCase(cluster_idx, case_res, accumulator, results, ret, do_double_buffering, case_id);
+                    } // End of for_each (iteration_case) in (all_iteration_cases)
+                }
+                // Outputs still held in spare buffers drain after the last iteration
+                accumulator.runtime_ += accumulator.drain_backlog_;
+                accumulator.bound_cycles_[static_cast<int>(accumulator.drain_bound_)] += accumulator.drain_backlog_;
+                results->CommitAccumulator(accumulator);
 
-                    long ingress_spatial_traffic = 0;
-                    long egress_spatial_traffic = 0;
-
-                    long num_partial_sums = 0;
+                ret->push_back(results);
+            }
 
-                    for (auto &tensor: *output_tensors) {
-                        long tensor_egress_traffic = reuse_analysis->GetSpatialEgressTraffic(tensor, iteration_case);
-                        long tensor_spatial_mapping_size = reuse_analysis->GetOutputTensorSpatialMappingSize(tensor,
-                                                                                                             iteration_case);
-                        num_partial_sums +=  reuse_analysis->GetOutputTensorSpatialMappingSize(
-                                tensor, iteration_case, true);
-                        auto data_class = tensor->GetDataClass();
-
-                        if (write_log_file && cluster_idx <= print_cluster_lv) {
-                            log_file << "Output Tensor " << tensor->GetTensorName() << std::endl;
-                            log_file << "\tegress_traffic " << tensor_egress_traffic << std::endl;
-                            log_file << "\tspatial_mapping_size " << tensor_spatial_mapping_size << std::endl;
-                            log_file << "\tnum_partial_sums "
-                                     << num_partial_sums << std::endl;
-                        }
 
+        protected:
+            std::shared_ptr<ConfigurationV2> configs_;
+            std::shared_ptr<DFA::TensorTable> tensors_;
+            std::shared_ptr<DFA::ClusterTable> clusters_;
+            int num_simd_lanes_;
+            std::shared_ptr<AHW::OffchipMemoryModel> offchip_memory_;
+            int element_bit_size_ = 32;
 
-                        egress_spatial_traffic += tensor_egress_traffic;
+            std::shared_ptr<TL::TaskScheduler> task_scheduler_ = nullptr;
+            bool l2_resident_[static_cast<int>(DataClass::NumDataClasses)] = {false};
 
-                        long upstream_write_this_tensor = tensor_egress_traffic;
+            std::shared_ptr<DFA::LayerSparsity> sparsity_ = nullptr;
+            double footprint_factor_[static_cast<int>(DataClass::NumDataClasses)] = {1.0, 1.0, 1.0};
+            long num_base_clusters_ = 1;
 
-                        long prev_upstream_wr_count = results->GetBufferAccessCount(BufferType::Upstream,
-                                                                                    BufferAccessType::Write,
-                                                                                    data_class);
-                        results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Write,
-                                                         prev_upstream_wr_count +
-                                                         num_case_occurrences * upstream_write_this_tensor, data_class);
+            ReductionMode reduction_mode_ = ReductionMode::Implicit;
+            TensorBuffering buffering_;
+            bool record_timeline_ = false;
 
-                        long prev_downstream_wr_count = results->GetBufferAccessCount(BufferType::Downstream,
-                                                                                      BufferAccessType::Write,
-                                                                                      data_class);
-                        results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write,
-                                                         prev_downstream_wr_count +
-                                                         num_case_occurrences * tensor_spatial_mapping_size,
-                                                         data_class);
+        private:
 
-                        long prev_downstream_rd_count = results->GetBufferAccessCount(BufferType::Downstream,
-                                                                                      BufferAccessType::Read,
-                                                                                      data_class);
-                        results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read,
-                                                         prev_downstream_rd_count +
-                                                         num_case_occurrences * tensor_spatial_mapping_size,
-                                                         data_class);
-                        //num_partial_sums += reuse_analysis->GetNumCriticalPathPartialSums(tensor, iteration_case);
+            int GetBufferingDepth(DataClass data_class, bool do_double_buffering) {
+                return do_double_buffering ? buffering_.GetDepth(data_class) : 1;
+            }
 
+            // Tiles the transfers of the given classes can run ahead of double buffering; 0 if none overlaps
+            int GetRunAhead(std::vector<DataClass> data_classes, bool do_double_buffering) {
+                int run_ahead = max_buffering_depth;
+                bool has_overlapped = false;
+                for (auto data_class: data_classes) {
+                    int depth = GetBufferingDepth(data_class, do_double_buffering);
+                    if (depth >= 2) {
+                        run_ahead = std::min(run_ahead, depth - 2);
+                        has_overlapped = true;
                     }
+                }
+                return has_overlapped ? run_ahead : 0;
+            }
 
+            /*
+             * Splits the delay of a transfer into the part of the overlapped (multi-buffered) tensors and the
+             * part of the single-buffered ones; delay_func(traffic, volume) gives the delay of a transfer
+             */
+            template<typename DelayFunc>
+            void SplitCommDelay(long total_traffic, long total_volume, long serial_traffic, long serial_volume,
+                                bool has_serial, bool has_overlapped, DelayFunc delay_func,
+                                long& overlapped_delay, long& serial_delay) {
+                overlapped_delay = 0;
+                serial_delay = 0;
+                if (!has_serial) {
+                    overlapped_delay = delay_func(total_traffic, total_volume);
+                } else if (!has_overlapped) {
+                    serial_delay = delay_func(total_traffic, total_volume);
+                } else {
+                    long overlapped_traffic = total_traffic - serial_traffic;
+                    overlapped_delay = (overlapped_traffic > 0) ? delay_func(overlapped_traffic, total_volume - serial_volume) : 0;
+                    serial_delay = (serial_traffic > 0) ? delay_func(serial_traffic, serial_volume) : 0;
+                }
+            }
 
-                    if (num_partial_sums <= 0) {
-//              std::cout << "Num partial sums is less than 0!" << std::endl;
-                        if (write_log_file && cluster_idx <= print_cluster_lv) {
-                            log_file << "Skipping Invalid case" << std::endl;
+            // Off-chip delays of one iteration; a half-duplex channel serves both directions in turn
+            void GetOffchipDelays(std::vector<AHW::OffchipAccessStream> ingress_streams,
+                                  std::vector<AHW::OffchipAccessStream> egress_streams,
+                                  long& ingress_delay, long& egress_delay) {
+                ingress_delay = offchip_memory_->GetTransferDelay(ingress_streams);
+                egress_delay = offchip_memory_->GetTransferDelay(egress_streams);
+                if (offchip_memory_->IsHalfDuplex()) {
+                    ingress_streams.insert(ingress_streams.end(), egress_streams.begin(), egress_streams.end());
+                    ingress_delay = offchip_memory_->GetTransferDelay(ingress_streams);
+                    egress_delay = 0;
+                }
+            }
+
+            // Off-chip transfer volume of a tensor class at the top cluster level
+            long GetOffchipTransferSize(std::shared_ptr<CostAnalysisResults> results, DataClass data_class) {
+                if(l2_resident_[static_cast<int>(data_class)]) {
+                    return 0;
+                }
+                // Input and weight buffers already hold compressed tensors; outputs are compressed on the way out
+                long size = results->GetBufferSizeReq(CA::BufferType::Upstream, data_class);
+                return (data_class == DataClass::Output) ? GetCompressedSize(size, data_class) : size;
+            }
+
+            // Off-chip transfers of one tile of each of the given tensor classes at the top cluster level
+            std::vector<AHW::OffchipAccessStream> GetOffchipStreams(
+                    std::shared_ptr<CostAnalysisResults> results,
+                    std::vector<DataClass> data_classes,
+                    bool do_double_buffering) {
+                std::shared_ptr<DFA::ClusterUnit> target_cluster = clusters_->GetCluster(0);
+
+                std::vector<AHW::OffchipAccessStream> ret;
+                for (auto data_class: data_classes) {
+                    int buffer_size_mult = GetBufferingDepth(data_class, do_double_buffering);
+                    AHW::OffchipAccessStream stream;
+                    stream.num_elements_ = GetOffchipTransferSize(results, data_class) / buffer_size_mult;
+                    stream.element_bit_size_ = element_bit_size_;
+                    stream.is_write_ = (data_class == DataClass::Output);
+                    for (auto &tensor: *tensors_) {
+                        if (tensor->GetDataClass() == data_class) {
+                            stream.run_length_ = GetOffchipRunLength(tensor, target_cluster->GetDimensions(),
+                                                                     target_cluster->GetDataflow(),
+                                                                     target_cluster->GetNumClusters());
+                            break;
                         }
-                        continue;
                     }
+                    ret.push_back(stream);
+                }
+                return ret;
+            }
 
+            // Number of elements a tensor class occupies in its compressed format
+            long GetCompressedSize(long num_elements, DataClass data_class) {
+                double factor = footprint_factor_[static_cast<int>(data_class)];
+                if (factor >= 1.0) {
+                    return num_elements;
+                }
+                return static_cast<long>(std::ceil(static_cast<double>(num_elements) * factor));
+            }
 
-                    for (auto &tensor: *input_tensors) {
-                        long tensor_ingress_traffic = reuse_analysis->GetSpatialIngressTraffic(tensor, iteration_case);
-                        long tensor_spatial_mapping_size = reuse_analysis->GetInputTensorSpatialMappingSize(tensor,
-                                                                                                            iteration_case);
-                        auto data_class = tensor->GetDataClass();
-
-                        if (write_log_file && cluster_idx <= print_cluster_lv) {
-                            log_file << "Input Tensor " << tensor->GetTensorName() << std::endl;
-                            log_file << "\tingress_traffic " << tensor_ingress_traffic << std::endl;
-                            log_file << "\tspatial_mapping_size " << tensor_spatial_mapping_size << std::endl;
-                        }
+            long GetNumPartialSums(std::shared_ptr<CA::ReuseAnalysis> reuse_analysis,
+                                   std::shared_ptr<DFA::IterationStatus> iteration_case) {
+                auto output_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::OutputTensor);
+                long num_partial_sums = 0;
+                for (auto &tensor: *output_tensors) {
+                    num_partial_sums += reuse_analysis->GetOutputTensorSpatialMappingSize(tensor, iteration_case, true);
+                }
+                return num_partial_sums;
+            }
 
-                        ingress_spatial_traffic += tensor_ingress_traffic;
-
-                        long upstream_read_this_tensor = tensor_ingress_traffic;
-
-                        long prev_rd_count = results->GetBufferAccessCount(BufferType::Upstream, BufferAccessType::Read,
-                                                                           data_class);
-                        results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, prev_rd_count +
-                                                                                                       num_case_occurrences *
-                                                                                                       upstream_read_this_tensor,
-                                                         data_class);
-
-                        long prev_downstream_wr_count = results->GetBufferAccessCount(BufferType::Downstream,
-                                                                                      BufferAccessType::Write,
-                                                                                      data_class);
-                        results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write,
-                                                         prev_rd_count +
-                                                         num_case_occurrences * upstream_read_this_tensor, data_class);
-
-                        long prev_downstream_rd_count = results->GetBufferAccessCount(BufferType::Downstream,
-                                                                                      BufferAccessType::Read,
-                                                                                      data_class);
-                        results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read,
-                                                         prev_downstream_rd_count +
-                                                         num_case_occurrences * tensor_spatial_mapping_size,
-                                                         data_class);
-                    }
+            /*
+             * Analyzes one iteration case, including the sub-cluster analyses it requires. Only reads the
+             * shared state (results is used for the buffer size requirements), so different cases can be
+             * analyzed concurrently with separate ReuseAnalysis instances.
+             */
+            void AnalyzeIterationCase(
+                    int cluster_idx,
+                    int num_cluster_lvs,
+                    std::shared_ptr<DFA::IterationStatus> iteration_case,
+                    int case_id,
+                    std::shared_ptr<CA::ReuseAnalysis> reuse_analysis,
+                    std::shared_ptr<CostAnalysisResults> results,
+                    IterationCaseResults& case_res,
+                    std::ofstream* log_file,
+                    int print_cluster_lv,
+                    bool do_double_buffering,
+                    bool write_log_file) {
+                std::shared_ptr<DFA::ClusterUnit> target_cluster = clusters_->GetCluster(cluster_idx);
+                int num_sub_clusters = target_cluster->GetNumClusters(false);
+                int num_edge_clusters = target_cluster->GetNumClusters(true);
+                int num_active_clusters = num_sub_clusters;
+                auto dataflow = target_cluster->GetDataflow();
+                auto noc = target_cluster->GetNoCModel();
+
+                auto output_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::OutputTensor);
+                auto input_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::InputTensor);
 
-                    double arithmetic_intensity = static_cast<double>(num_partial_sums) /
-                                                  static_cast<double>(ingress_spatial_traffic);
+                long num_case_occurrences = iteration_case->GetNumOccurrences();
+                assert(num_case_occurrences > 0);
+                case_res.num_case_occurrences_ = num_case_occurrences;
 
-                    results->SetArithmeticIntensity(arithmetic_intensity);
+                if (log_file != nullptr) {
+                    *log_file << "======================= CASE " << case_id << " ======================="
+                              << std::endl;
+                    *log_file << "@ cluster level " << cluster_idx << std::endl;
+                    *log_file << iteration_case->ToString() << std::endl;
+                }
 
+                long ingress_spatial_traffic = 0;
+                long egress_spatial_traffic = 0;
+                // Traffic of the single-buffered input tensors, which stalls the computation
+                long serial_ingress_traffic = 0;
+                bool has_serial_input = false;
+                bool has_overlapped_input = false;
 
-                    //TODO: Exactly model cross-PE accumulation
+                long num_partial_sums = 0;
 
-                    if (write_log_file && cluster_idx <= print_cluster_lv) {
-                        log_file << "Overall ingress_spatial_traffic: " << ingress_spatial_traffic << std::endl;
-                        log_file << "Overall egress_spatial_traffic: " << egress_spatial_traffic << std::endl;
-                        log_file << "Number of MACs over sub cluster array: " << num_partial_sums
-                                 << std::endl;
+                for (auto &tensor: *output_tensors) {
+                    long tensor_egress_traffic = reuse_analysis->GetSpatialEgressTraffic(tensor, iteration_case);
+                    long tensor_spatial_mapping_size = reuse_analysis->GetOutputTensorSpatialMappingSize(tensor,
+                                                                                                         iteration_case);
+                    num_partial_sums +=  reuse_analysis->GetOutputTensorSpatialMappingSize(
+                            tensor, iteration_case, true);
+
+                    if (log_file != nullptr) {
+                        *log_file << "Output Tensor " << tensor->GetTensorName() << std::endl;
+                        *log_file << "\tegress_traffic " << tensor_egress_traffic << std::endl;
+                        *log_file << "\tspatial_mapping_size " << tensor_spatial_mapping_size << std::endl;
+                        *log_file << "\tnum_partial_sums "
+                                  << num_partial_sums << std::endl;
                     }
 
-                    ////////////////////////////
+                    egress_spatial_traffic += tensor_egress_traffic;
+                    case_res.output_traffic_.push_back({tensor->GetDataClass(), tensor_egress_traffic, tensor_spatial_mapping_size});
+                    //num_partial_sums += reuse_analysis->GetNumCriticalPathPartialSums(tensor, iteration_case);
+                }
 
-                    long computation_delay = 0;
-                    std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> sub_cluster_results = std::make_shared<std::vector<std::shared_ptr<CA::CostAnalysisResults>>>();
+                case_res.num_partial_sums_ = num_partial_sums;
+                case_res.is_valid_ = (num_partial_sums > 0);
+                if (!case_res.is_valid_) {
+//              std::cout << "Num partial sums is less than 0!" << std::endl;
+                    if (log_file != nullptr) {
+                        *log_file << "Skipping Invalid case" << std::endl;
+                    }
+                    return;
+                }
 
-                    std::shared_ptr<DFA::directive::Directive> spmap_directive = nullptr;
-                    for (auto &directive: *dataflow) {
-                        if (directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
-                            spmap_directive = directive;
-                            break;
-                        }
+                // Only the MACs with nonzero operands are computed
+                long num_dense_partial_sums = num_partial_sums;
+                if (sparsity_ != nullptr) {
+                    num_partial_sums = static_cast<long>(std::ceil(static_cast<double>(num_partial_sums)
+                                                                   * sparsity_->GetEffectualMACFraction()));
+                    case_res.num_partial_sums_ = num_partial_sums;
+                }
+
+
+                for (auto &tensor: *input_tensors) {
+                    long tensor_ingress_traffic = GetCompressedSize(
+                            reuse_analysis->GetSpatialIngressTraffic(tensor, iteration_case), tensor->GetDataClass());
+                    long tensor_spatial_mapping_size = GetCompressedSize(
+                            reuse_analysis->GetInputTensorSpatialMappingSize(tensor, iteration_case), tensor->GetDataClass());
+
+                    if (log_file != nullptr) {
+                        *log_file << "Input Tensor " << tensor->GetTensorName() << std::endl;
+                        *log_file << "\tingress_traffic " << tensor_ingress_traffic << std::endl;
+                        *log_file << "\tspatial_mapping_size " << tensor_spatial_mapping_size << std::endl;
                     }
 
-                    if (spmap_directive == nullptr) {
-                        error_handler_->PrintErrorMsg(TL::ErrorCode::NoSpatialMap, std::to_string(cluster_idx),
-                                                      this->GetName());
-                        error_handler_->TerminateProgram();
+                    ingress_spatial_traffic += tensor_ingress_traffic;
+                    if (GetBufferingDepth(tensor->GetDataClass(), do_double_buffering) == 1) {
+                        serial_ingress_traffic += tensor_ingress_traffic;
+                        has_serial_input = true;
+                    } else {
+                        has_overlapped_input = true;
                     }
+                    case_res.input_traffic_.push_back({tensor->GetDataClass(), tensor_ingress_traffic, tensor_spatial_mapping_size});
+                }
 
-                    auto spmap_dim_iter_state = iteration_case->GetIterState(spmap_directive->GetVariable());
+                case_res.arithmetic_intensity_ = static_cast<double>(num_partial_sums) /
+                                                 static_cast<double>(ingress_spatial_traffic);
+                case_res.ingress_spatial_traffic_ = ingress_spatial_traffic;
+                case_res.egress_spatial_traffic_ = egress_spatial_traffic;
 
-                    if (spmap_dim_iter_state->IsEdge()) {
-                        num_active_clusters = num_edge_clusters;
-                    } else {
-                        num_active_clusters = num_sub_clusters;
+                if (log_file != nullptr) {
+                    *log_file << "Overall ingress_spatial_traffic: " << ingress_spatial_traffic << std::endl;
+                    *log_file << "Overall egress_spatial_traffic: " << egress_spatial_traffic << std::endl;
+                    *log_file << "Number of MACs over sub cluster array: " << num_partial_sums
+                              << std::endl;
+                }
+
+                ////////////////////////////
+
+                long computation_delay = 0;
+                std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> sub_cluster_results = std::make_shared<std::vector<std::shared_ptr<CA::CostAnalysisResults>>>();
+                auto nested_results = case_res.nested_results_;
+
+                std::shared_ptr<DFA::directive::Directive> spmap_directive = nullptr;
+                for (auto &directive: *dataflow) {
+                    if (directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
+                        spmap_directive = directive;
+                        break;
                     }
+                }
 
-                    // Recursively process subclusters
-                    if (cluster_idx < num_cluster_lvs - 1) {
-                        if (spmap_dim_iter_state->IsEdge()) {
-                            if (spmap_dim_iter_state->HasSpEdgeEdge()) {
-                                auto subclsuter_dim_under_sp_edge_edge = reuse_analysis->ConstructSubClusterDimension(
-                                        iteration_case, true);
-                                AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs,
-                                                       subclsuter_dim_under_sp_edge_edge, ret, print_cluster_lv,
-                                                       do_double_buffering, write_log_file);
-                                auto sp_edge_edge_subcluster_res = ret->at(ret->size() - 1);
-                                sub_cluster_results->push_back(sp_edge_edge_subcluster_res);
-
-                                int num_rem_clusters = num_edge_clusters - 1;
-                                if (num_rem_clusters > 0) {
-                                    auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(
-                                            iteration_case, false);
-                                    AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs, this_subclsuter_dim, ret,
-                                                           print_cluster_lv, do_double_buffering, write_log_file);
-                                    auto this_subcluster_res = ret->at(ret->size() - 1);
-                                    this_subcluster_res->SetNumSpatialOccurrences(num_rem_clusters);
-                                    sub_cluster_results->push_back(this_subcluster_res);
-                                }
-                            } // End of if(spmap_dim_iter_state->HasSpEdgeEdge())
-                            else {
-                                auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(iteration_case,
-                                                                                                        false);
-                                AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs, this_subclsuter_dim, ret,
+                if (spmap_directive == nullptr) {
+                    error_handler_->PrintErrorMsg(TL::ErrorCode::NoSpatialMap, std::to_string(cluster_idx),
+                                                  this->GetName());
+                    error_handler_->TerminateProgram();
+                }
+
+                auto spmap_dim_iter_state = iteration_case->GetIterState(spmap_directive->GetVariable());
+
+                if (spmap_dim_iter_state->IsEdge()) {
+                    num_active_clusters = num_edge_clusters;
+                } else {
+                    num_active_clusters = num_sub_clusters;
+                }
+
+                // Recursively process subclusters
+                if (cluster_idx < num_cluster_lvs - 1) {
+                    if (spmap_dim_iter_state->IsEdge()) {
+                        if (spmap_dim_iter_state->HasSpEdgeEdge()) {
+                            auto subclsuter_dim_under_sp_edge_edge = reuse_analysis->ConstructSubClusterDimension(
+                                    iteration_case, true);
+                            AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs,
+                                                   subclsuter_dim_under_sp_edge_edge, nested_results, print_cluster_lv,
+                                                   do_double_buffering, write_log_file);
+                            auto sp_edge_edge_subcluster_res = nested_results->at(nested_results->size() - 1);
+                            sub_cluster_results->push_back(sp_edge_edge_subcluster_res);
+
+                            int num_rem_clusters = num_edge_clusters - 1;
+                            if (num_rem_clusters > 0) {
+                                auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(
+                                        iteration_case, false);
+                                AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs, this_subclsuter_dim, nested_results,
                                                        print_cluster_lv, do_double_buffering, write_log_file);
-                                auto this_subcluster_res = ret->at(ret->size() - 1);
-                                this_subcluster_res->SetNumSpatialOccurrences(num_edge_clusters);
+                                auto this_subcluster_res = nested_results->at(nested_results->size() - 1);
+                                this_subcluster_res->SetNumSpatialOccurrences(num_rem_clusters);
                                 sub_cluster_results->push_back(this_subcluster_res);
-                            } // End of else of if(spmap_dim_iter_state->HasSpEdgeEdge())
-                        } // End of if(spmap_dim_iter_state->IsEdge())
+                            }
+                        } // End of if(spmap_dim_iter_state->HasSpEdgeEdge())
                         else {
                             auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(iteration_case,
                                                                                                     false);
-                            AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs, this_subclsuter_dim, ret,
+                            AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs, this_subclsuter_dim, nested_results,
                                                    print_cluster_lv, do_double_buffering, write_log_file);
-                            auto this_subcluster_res = ret->at(ret->size() - 1);
-                            this_subcluster_res->SetNumSpatialOccurrences(num_sub_clusters);
+                            auto this_subcluster_res = nested_results->at(nested_results->size() - 1);
+                            this_subcluster_res->SetNumSpatialOccurrences(num_edge_clusters);
                             sub_cluster_results->push_back(this_subcluster_res);
-                        }
+                        } // End of else of if(spmap_dim_iter_state->HasSpEdgeEdge())
+                    } // End of if(spmap_dim_iter_state->IsEdge())
+                    else {
+                        auto this_subclsuter_dim = reuse_analysis->ConstructSubClusterDimension(iteration_case,
+                                                                                                false);
+                        AnalyzeClusterLevel_V2(cluster_idx + 1, num_cluster_lvs, this_subclsuter_dim, nested_results,
+                                               print_cluster_lv, do_double_buffering, write_log_file);
+                        auto this_subcluster_res = nested_results->at(nested_results->size() - 1);
+                        this_subcluster_res->SetNumSpatialOccurrences(num_sub_clusters);
+                        sub_cluster_results->push_back(this_subcluster_res);
+                    }
 
-                        // Take the worst-case delay as the computation delay
-                        for (auto &sub_res: *sub_cluster_results) {
-                            computation_delay = std::max(computation_delay, sub_res->GetRuntime());
+                    // Take the worst-case delay as the computation delay
+                    for (auto &sub_res: *sub_cluster_results) {
+                        if (case_res.critical_sub_results_ == nullptr || sub_res->GetRuntime() > computation_delay) {
+                            case_res.critical_sub_results_ = sub_res;
                         }
+                        computation_delay = std::max(computation_delay, sub_res->GetRuntime());
+                    }
 
-                    } // End of if(cluster_idx < num_cluster_lvs-1)
-                    else { // Base cluster
-                        computation_delay = static_cast<long>(
-                                std::ceil(
-                                        static_cast<double>(num_partial_sums) / static_cast<double>(num_simd_lanes_)));
+                } // End of if(cluster_idx < num_cluster_lvs-1)
+                else if (sparsity_ != nullptr) { // Base cluster of a sparse layer; the slowest base cluster sets the pace
+                    double mac_fraction = sparsity_->GetImbalancedMACFraction(num_dense_partial_sums, num_base_clusters_);
+                    computation_delay = static_cast<long>(
+                            std::ceil(static_cast<double>(num_dense_partial_sums) * mac_fraction
+                                      / static_cast<double>(num_simd_lanes_)));
+                }
+                else { // Base cluster
+                    computation_delay = static_cast<long>(
+                            std::ceil(
+                                    static_cast<double>(num_partial_sums) / static_cast<double>(num_simd_lanes_)));
+                }
+
+                if (cluster_idx == num_cluster_lvs - 1) {
+                    // The operands of each unit are read from its own buffer level
+                    long unit_operand_size = 0;
+                    for (auto &tensor_traffic: case_res.input_traffic_) {
+                        unit_operand_size += tensor_traffic.spatial_mapping_size_;
+                    }
+                    for (auto &tensor_traffic: case_res.output_traffic_) {
+                        unit_operand_size += tensor_traffic.spatial_mapping_size_;
                     }
-                    ////////////////////////////
+                    unit_operand_size = (unit_operand_size + num_active_clusters - 1) / std::max(num_active_clusters, 1);
+                    computation_delay = std::max(computation_delay,
+                                                 configs_->GetBufferPortDelay(num_cluster_lvs, num_cluster_lvs, unit_operand_size));
+                }
+                ////////////////////////////
 
-                    long ingress_comm_delay = noc->GetOutStandingDelay(ingress_spatial_traffic);
-                    long egress_comm_delay = noc->GetOutStandingDelay(egress_spatial_traffic);
+                bool is_explicit_reduction = reduction_mode_ != ReductionMode::Implicit;
+                long sent_traffic = 0;
+                if (noc->IsTopologyAware() || is_explicit_reduction) {
+                    for (auto &tensor: *output_tensors) {
+                        sent_traffic += reuse_analysis->GetSpatialSentTraffic(tensor, iteration_case);
+                    }
+                }
 
-                    long outstanding_delay;
-                    if (iteration_case->isAllInit()) {
-                        outstanding_delay = (do_double_buffering) ? computation_delay + ingress_comm_delay :
-                                            ingress_comm_delay + computation_delay + egress_comm_delay;
+                // Partial sums of several sub-clusters for the same outputs go through a reduction tree
+                long reduction_delay = 0;
+                long reduction_traffic = 0;
+                if (is_explicit_reduction && sent_traffic > egress_spatial_traffic && egress_spatial_traffic > 0) {
+                    reduction_traffic = sent_traffic - egress_spatial_traffic;
+                    long fan_in = (sent_traffic + egress_spatial_traffic - 1) / egress_spatial_traffic;
+                    long tree_latency = noc->GetReductionTreeLatency(fan_in);
+                    long issue_delay = noc->GetReductionIssueDelay(egress_spatial_traffic);
+                    if (reduction_mode_ == ReductionMode::CoarseGrainedSync) {
+                        reduction_delay = tree_latency + issue_delay;
+                    } else {
+                        // Outputs enter the tree as the sub-clusters complete them; only the tail is exposed
+                        reduction_delay = tree_latency + std::max(issue_delay - computation_delay, 0L);
+                    }
+                }
+                case_res.reduction_traffic_ = reduction_traffic;
+
+                // Multicast copies and partial sums before reduction load the links of a topology-aware NoC
+                long delivered_traffic = 0;
+                long serial_delivered_traffic = 0;
+                if (noc->IsTopologyAware()) {
+                    for (auto &tensor: *input_tensors) {
+                        long tensor_delivered_traffic = GetCompressedSize(
+                                reuse_analysis->GetSpatialDeliveredTraffic(tensor, iteration_case), tensor->GetDataClass());
+                        delivered_traffic += tensor_delivered_traffic;
+                        if (GetBufferingDepth(tensor->GetDataClass(), do_double_buffering) == 1) {
+                            serial_delivered_traffic += tensor_delivered_traffic;
+                        }
+                    }
+                }
+
+                // The upstream buffer of this level cannot serve or absorb traffic faster than its bandwidth
+                auto ingress_delay_func = [&](long traffic, long delivered) {
+                    long delay = noc->IsTopologyAware() ? noc->GetIngressDelay(traffic, delivered, num_sub_clusters)
+                                                        : noc->GetOutStandingDelay(traffic);
+                    return std::max(delay, configs_->GetBufferPortDelay(cluster_idx, num_cluster_lvs, traffic));
+                };
+                auto egress_delay_func = [&](long traffic, long sent) {
+                    long delay = noc->IsTopologyAware() ? noc->GetEgressDelay(traffic, sent, num_sub_clusters)
+                                                        : noc->GetOutStandingDelay(traffic);
+                    return std::max(delay, configs_->GetBufferPortDelay(cluster_idx, num_cluster_lvs, traffic));
+                };
+
+                // Transfers of single-buffered tensors stall the computation; the others overlap it
+                long ingress_comm_delay;
+                long egress_comm_delay;
+                long serial_ingress_comm_delay;
+                long serial_egress_comm_delay;
+                bool is_serial_output = GetBufferingDepth(DataClass::Output, do_double_buffering) == 1;
+                SplitCommDelay(ingress_spatial_traffic, delivered_traffic, serial_ingress_traffic, serial_delivered_traffic,
+                               has_serial_input, has_overlapped_input, ingress_delay_func,
+                               ingress_comm_delay, serial_ingress_comm_delay);
+                SplitCommDelay(egress_spatial_traffic, sent_traffic, egress_spatial_traffic, sent_traffic,
+                               is_serial_output, !is_serial_output, egress_delay_func,
+                               egress_comm_delay, serial_egress_comm_delay);
+
+                long reduced_computation_delay = computation_delay + reduction_delay;
+                long stalled_delay = reduced_computation_delay + serial_ingress_comm_delay + serial_egress_comm_delay;
+                long outstanding_delay;
+                if (iteration_case->isAllInit()) {
+                    outstanding_delay = stalled_delay + ingress_comm_delay;
+                } else {
+                    outstanding_delay = std::max(egress_comm_delay, std::max(stalled_delay, ingress_comm_delay));
+                }
+
+                long* stalled_bound_delay = case_res.stalled_bound_delay_;
+                long* bound_delay = case_res.bound_delay_;
+                stalled_bound_delay[static_cast<int>(BoundType::Computation)] = computation_delay;
+                stalled_bound_delay[static_cast<int>(BoundType::Reduction)] = reduction_delay;
+                stalled_bound_delay[static_cast<int>(BoundType::Ingress)] = serial_ingress_comm_delay;
+                stalled_bound_delay[static_cast<int>(BoundType::Egress)] = serial_egress_comm_delay;
+                if (outstanding_delay == stalled_delay || iteration_case->isAllInit()) {
+                    std::copy(stalled_bound_delay, stalled_bound_delay + static_cast<int>(BoundType::NumBoundTypes), bound_delay);
+                    bound_delay[static_cast<int>(BoundType::Ingress)] += outstanding_delay - stalled_delay;
+                } else {
+                    bound_delay[static_cast<int>(ingress_comm_delay >= egress_comm_delay ? BoundType::Ingress : BoundType::Egress)]
+                            = outstanding_delay;
+                }
+                long overlapped_ingress_delay = ingress_comm_delay;
+                long overlapped_egress_delay = egress_comm_delay;
+                //felix
+                if (cluster_idx == 0) {
+                    // A multi-buffered top-level buffer moves one of its tiles per iteration
+                    std::vector<DataClass> overlapped_input_classes;
+                    std::vector<DataClass> serial_input_classes;
+                    for (auto data_class: {DataClass::Input, DataClass::Weight}) {
+                        (GetBufferingDepth(data_class, do_double_buffering) == 1 ? serial_input_classes
+                                                                                 : overlapped_input_classes).push_back(data_class);
+                    }
+                    std::vector<DataClass> output_classes = {DataClass::Output};
+                    std::vector<DataClass> no_classes;
+
+                    long ingress_offchip_delay;
+                    long egress_offchip_delay;
+                    long serial_ingress_offchip_delay;
+                    long serial_egress_offchip_delay;
+                    GetOffchipDelays(GetOffchipStreams(results, overlapped_input_classes, do_double_buffering),
+                                     GetOffchipStreams(results, is_serial_output ? no_classes : output_classes, do_double_buffering),
+                                     ingress_offchip_delay, egress_offchip_delay);
+                    GetOffchipDelays(GetOffchipStreams(results, serial_input_classes, do_double_buffering),
+                                     GetOffchipStreams(results, is_serial_output ? output_classes : no_classes, do_double_buffering),
+                                     serial_ingress_offchip_delay, serial_egress_offchip_delay);
+
+                    long serial_offchip_delay = serial_ingress_offchip_delay + serial_egress_offchip_delay;
+                    long onchip_delay = outstanding_delay + serial_offchip_delay;
+                    stalled_delay += serial_offchip_delay;
+                    outstanding_delay = std::max(ingress_offchip_delay,
+                                                 std::max(onchip_delay, egress_offchip_delay));
+
+                    stalled_bound_delay[static_cast<int>(BoundType::Offchip)] = serial_offchip_delay;
+                    if (outstanding_delay > onchip_delay) {
+                        std::fill(bound_delay, bound_delay + static_cast<int>(BoundType::NumBoundTypes), 0L);
+                        bound_delay[static_cast<int>(BoundType::Offchip)] = outstanding_delay;
                     } else {
-                        outstanding_delay = (do_double_buffering) ? std::max(egress_comm_delay,
-                                                                             std::max(computation_delay,
-                                                                                      ingress_comm_delay)) :
-                                            ingress_comm_delay + computation_delay + egress_comm_delay;
+                        bound_delay[static_cast<int>(BoundType::Offchip)] = serial_offchip_delay;
+                    }
+                    if (ingress_offchip_delay > overlapped_ingress_delay) {
+                        case_res.ingress_bound_ = BoundType::Offchip;
                     }
+                    if (egress_offchip_delay > overlapped_egress_delay) {
+                        case_res.egress_bound_ = BoundType::Offchip;
+                    }
+                    overlapped_ingress_delay = std::max(overlapped_ingress_delay, ingress_offchip_delay);
+                    overlapped_egress_delay = std::max(overlapped_egress_delay, egress_offchip_delay);
+                    case_res.offchip_ingress_delay_ = ingress_offchip_delay + serial_ingress_offchip_delay;
+                    case_res.offchip_egress_delay_ = egress_offchip_delay + serial_egress_offchip_delay;
                     //felix
-                    if (cluster_idx == 0) {
-                        auto out_buffer_delay =
-                                (results->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Output)) /
-                                configs_->offchip_bw_;
-                        auto in_buffer_delay = (results->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Input) +
-                                                results->GetBufferSizeReq(CA::BufferType::Upstream,
-                                                                          DataClass::Weight)) / configs_->offchip_bw_;
-                        auto ingress_offchip_delay = (do_double_buffering) ? in_buffer_delay / 2 : in_buffer_delay;
-                        auto egress_offchip_delay = (do_double_buffering) ? out_buffer_delay / 2 : out_buffer_delay;
-                        outstanding_delay = (do_double_buffering) ? std::max(ingress_offchip_delay,
-                                                                             std::max(outstanding_delay,
-                                                                                      egress_offchip_delay)) :
-                                            outstanding_delay + ingress_offchip_delay + egress_offchip_delay;
-                        //felix
-                        off_chip_bw_req = std::max(off_chip_bw_req, results->GetBufferSizeReq(CA::BufferType::Upstream,
-                                                                                              DataClass::Output) /
-                                                                    computation_delay);
-                        off_chip_bw_req = std::max(off_chip_bw_req, (results->GetBufferSizeReq(CA::BufferType::Upstream,
-                                                                                               DataClass::Input) +
-                                                                     results->GetBufferSizeReq(CA::BufferType::Upstream,
-                                                                                               DataClass::Weight)) /
-                                                                    computation_delay);
-                        off_chip_bw_req = (do_double_buffering) ? off_chip_bw_req / 2 : off_chip_bw_req;
-                        //
-                        //felix
-                        results->UpdateOffchipBWReq(off_chip_bw_req);
+                    case_res.off_chip_egress_bw_req_ = GetOffchipTransferSize(results, DataClass::Output) /
+                                                       computation_delay;
+                    case_res.off_chip_ingress_bw_req_ = (GetOffchipTransferSize(results, DataClass::Input) +
+                                                         GetOffchipTransferSize(results, DataClass::Weight)) /
+                                                        computation_delay;
+                }
+
+                long double num_active_unit_clusters = 0;
+                for (auto &sub_res: *sub_cluster_results) {
+                    num_active_unit_clusters +=
+                            sub_res->GetNumAvgActiveClusters() * sub_res->GetNumSpatialOccurrences();
+                    case_res.reduction_traffic_ += sub_res->GetReductionTraffic() * sub_res->GetNumSpatialOccurrences();
+                    for (int depth = 1; depth < max_hierarchy_depth; depth++) {
+                        for (auto access_type : {BufferAccessType::Read, BufferAccessType::Write}) {
+                            case_res.hierarchy_access_count_[depth + 1][static_cast<int>(access_type)] +=
+                                    sub_res->GetHierarchyAccessCount(depth, access_type) * sub_res->GetNumSpatialOccurrences();
+                        }
                     }
-                    //
-                    results->UpdateRuntime(
-                            results->GetRuntime(CA::EstimationType::Exact) + num_case_occurrences * outstanding_delay,
-                            CA::EstimationType::Exact);
-                    results->UpdateNumComputations(results->GetNumComputations() +
-                                                   num_case_occurrences * num_partial_sums);
+                }
 
+                num_active_unit_clusters = (num_active_unit_clusters == 0) ? num_active_clusters
+                                                                           : num_active_unit_clusters;
+                case_res.num_active_unit_clusters_ = num_active_unit_clusters;
+
+                //TODO: Doble check
+                if (computation_delay == 0)
+                    computation_delay = 1;
+
+                case_res.computation_delay_ = computation_delay;
+                case_res.ingress_comm_delay_ = ingress_comm_delay + serial_ingress_comm_delay;
+                case_res.egress_comm_delay_ = egress_comm_delay + serial_egress_comm_delay;
+                case_res.is_init_ = iteration_case->isAllInit();
+                case_res.stalled_delay_ = stalled_delay;
+                case_res.overlapped_ingress_delay_ = overlapped_ingress_delay;
+                case_res.overlapped_egress_delay_ = overlapped_egress_delay;
+                case_res.reduction_delay_ = reduction_delay;
+                case_res.outstanding_delay_ = outstanding_delay;
+
+                if (log_file != nullptr) {
+                    if (iteration_case->isAllInit()) {
+                        *log_file << "Note: Initialization case; cannot exploit latency hiding in this case"
+                                  << std::endl;
+                    }
 
-                    long double num_active_unit_clusters = 0;
-                    for (auto &sub_res: *sub_cluster_results) {
-                        num_active_unit_clusters +=
-                                sub_res->GetNumAvgActiveClusters() * sub_res->GetNumSpatialOccurrences();
+                    *log_file << "num computations (per iteration): " << num_partial_sums
+                              << std::endl;
+                    *log_file << "ingress_spatial_traffic (per iteration): " << ingress_spatial_traffic << std::endl;
+                    *log_file << "egress_spatial_traffic (per iteration): " << egress_spatial_traffic << std::endl;
+                    *log_file << std::endl;
+
+                    *log_file << "ingress_comm_delay (per iteration): " << case_res.ingress_comm_delay_ << std::endl;
+                    *log_file << "egress_comm_delay (per iteration): " << case_res.egress_comm_delay_ << std::endl;
+                    *log_file << "computation_delay (per iteration): " << computation_delay << std::endl;
+                    if (is_explicit_reduction) {
+                        *log_file << "reduction_delay (per iteration): " << reduction_delay << std::endl;
+                        *log_file << "reduction_traffic (per iteration): " << reduction_traffic << std::endl;
                     }
+                    *log_file << std::endl;
 
-                    num_active_unit_clusters = (num_active_unit_clusters == 0) ? num_active_clusters
-                                                                               : num_active_unit_clusters;
-                    results->SetNumAvgActiveClusters(
-                            results->GetNumAvgActiveClusters() + num_active_unit_clusters * num_case_occurrences);
-
-                    //TODO: Doble check
-                    if (computation_delay == 0)
-                        computation_delay = 1;
-
-                    peak_noc_bw_req = std::max(peak_noc_bw_req,
-                                               std::max(ingress_spatial_traffic, egress_spatial_traffic) /
-                                               computation_delay);
-                    avg_noc_bw_req +=
-                            (num_case_occurrences * std::max(ingress_spatial_traffic, egress_spatial_traffic)) /
-                            computation_delay;
-
-
-                    delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Avg)] +=
-                            num_case_occurrences * ingress_comm_delay;
-                    delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Avg)] +=
-                            num_case_occurrences * egress_comm_delay;
-                    delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Avg)] +=
-                            num_case_occurrences * computation_delay;
-
-                    delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Min)]
-                            = std::min(delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Min)],
-                                       static_cast<long double>(ingress_comm_delay));
-                    delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Min)]
-                            = std::min(delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Min)],
-                                       static_cast<long double>(egress_comm_delay));
-                    delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Min)]
-                            = std::min(
-                            delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Min)],
-                            static_cast<long double>(computation_delay));
-
-                    delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Max)]
-                            = std::max(delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Max)],
-                                       static_cast<long double>(ingress_comm_delay));
-                    delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Max)]
-                            = std::max(delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Max)],
-                                       static_cast<long double>(egress_comm_delay));
-                    delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Max)]
-                            = std::max(
-                            delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Max)],
-                            static_cast<long double>(computation_delay));
-
-                    num_total_cases += num_case_occurrences;
-                    case_id++;
-
-                    if (write_log_file && cluster_idx <= print_cluster_lv) {
+                    if (do_double_buffering) {
                         if (iteration_case->isAllInit()) {
-                            log_file << "Note: Initialization case; cannot exploit latency hiding in this case"
-                                     << std::endl;
+                            *log_file
+                                    << "This case is <<Ingress communication + computation>> bound (Initialization case)"
+                                    << std::endl;
+                        } else if (outstanding_delay == stalled_delay) {
+                            *log_file << "This case is <<Computation>> bound" << std::endl;
+                        } else if (outstanding_delay == ingress_comm_delay) {
+                            *log_file << "This case is <<Ingress communication>> bound" << std::endl;
+                        } else if (outstanding_delay == egress_comm_delay) {
+                            *log_file << "This case is <<Egress communication>> bound" << std::endl;
                         }
+                    }
 
-                        log_file << "num computations (per iteration): " << num_partial_sums
-                                 << std::endl;
-                        log_file << "ingress_spatial_traffic (per iteration): " << ingress_spatial_traffic << std::endl;
-                        log_file << "egress_spatial_traffic (per iteration): " << egress_spatial_traffic << std::endl;
-                        log_file << std::endl;
-
-                        log_file << "ingress_comm_delay (per iteration): " << ingress_comm_delay << std::endl;
-                        log_file << "egress_comm_delay (per iteration): " << egress_comm_delay << std::endl;
-                        log_file << "computation_delay (per iteration): " << computation_delay << std::endl;
-                        log_file << std::endl;
-
-                        if (do_double_buffering) {
-                            if (iteration_case->isAllInit()) {
-                                log_file
-                                        << "This case is <<Ingress communication + computation>> bound (Initialization case)"
-                                        << std::endl;
-                            } else if (outstanding_delay == computation_delay) {
-                                log_file << "This case is <<Computation>> bound" << std::endl;
-                            } else if (outstanding_delay == ingress_comm_delay) {
-                                log_file << "This case is <<Ingress communication>> bound" << std::endl;
-                            } else if (outstanding_delay == egress_comm_delay) {
-                                log_file << "This case is <<Egress communication>> bound" << std::endl;
-                            }
-                        }
+                    *log_file << "outstanding_delay (per iteration): " << outstanding_delay << std::endl;
+                    *log_file << "outstanding_delay (for all iterations in this case): "
+                              << num_case_occurrences * outstanding_delay << std::endl;
+                    *log_file << "======================= END CASE " << case_id + 1 << " =======================\n\n"
+                              << std::endl;
+                }
+            }
+
+            // Adds the contribution of one iteration case to the cluster-level counters; cases must be accumulated in order
+            void AccumulateIterationCase(
+                    int cluster_idx,
+                    IterationCaseResults& case_res,
+                    CostAccumulator& accumulator,
+                    std::shared_ptr<CostAnalysisResults> results,
+                    std::shared_ptr<std::vector<std::shared_ptr<CostAnalysisResults>>> ret,
+                    bool do_double_buffering,
+                    int& case_id) {
+                long num_case_occurrences = case_res.num_case_occurrences_;
+                ret->insert(ret->end(), case_res.nested_results_->begin(), case_res.nested_results_->end());
+
+                for (auto &tensor_traffic: case_res.output_traffic_) {
+                    auto data_class = tensor_traffic.data_class_;
+
+                    accumulator.BufferAccessCount(BufferType::Upstream, BufferAccessType::Write, data_class)
+                            += num_case_occurrences * tensor_traffic.spatial_traffic_;
+                    accumulator.BufferAccessCount(BufferType::Downstream, BufferAccessType::Write, data_class)
+                            += num_case_occurrences * tensor_traffic.spatial_mapping_size_;
+                    accumulator.BufferAccessCount(BufferType::Downstream, BufferAccessType::Read, data_class)
+                            += num_case_occurrences * tensor_traffic.spatial_mapping_size_;
+                }
+
+                if (!case_res.is_valid_) {
+                    return;
+                }
+
+                for (auto &tensor_traffic: case_res.input_traffic_) {
+                    auto data_class = tensor_traffic.data_class_;
+
+                    // Everything read from the upstream buffer is written to the downstream buffers
+                    long& upstream_rd_count = accumulator.BufferAccessCount(BufferType::Upstream, BufferAccessType::Read, data_class);
+                    upstream_rd_count += num_case_occurrences * tensor_traffic.spatial_traffic_;
+                    accumulator.BufferAccessCount(BufferType::Downstream, BufferAccessType::Write, data_class) = upstream_rd_count;
+                    accumulator.BufferAccessCount(BufferType::Downstream, BufferAccessType::Read, data_class)
+                            += num_case_occurrences * tensor_traffic.spatial_mapping_size_;
+                }
 
-                        log_file << "outstanding_delay (per iteration): " << outstanding_delay << std::endl;
-                        log_file << "outstanding_delay (for all iterations in this case): "
-                                 << num_case_occurrences * outstanding_delay << std::endl;
-                        log_file << "======================= END CASE " << case_id << " =======================\n\n"
-                                 << std::endl;
+                accumulator.arithmetic_intensity_ = case_res.arithmetic_intensity_;
+
+                //felix
+                if (cluster_idx == 0) {
+                    long& off_chip_bw_req = accumulator.off_chip_bw_req_;
+                    off_chip_bw_req = std::max(off_chip_bw_req, case_res.off_chip_egress_bw_req_);
+                    off_chip_bw_req = std::max(off_chip_bw_req, case_res.off_chip_ingress_bw_req_);
+                    off_chip_bw_req = (do_double_buffering) ? off_chip_bw_req / 2 : off_chip_bw_req;
+                }
+
+                long start_cycle = accumulator.runtime_;
+                int ingress_run_ahead = GetRunAhead({DataClass::Input, DataClass::Weight}, do_double_buffering);
+                int egress_run_ahead = GetRunAhead({DataClass::Output}, do_double_buffering);
+                if (case_res.is_init_ || (ingress_run_ahead == 0 && egress_run_ahead == 0)) {
+                    accumulator.runtime_ += num_case_occurrences * case_res.outstanding_delay_;
+                    AttributeBoundCycles(num_case_occurrences * case_res.outstanding_delay_, case_res.bound_delay_,
+                                         case_res.critical_sub_results_, accumulator.bound_cycles_);
+                } else {
+                    /*
+                     * Spare tile buffers carry transfer time across iterations: ingress runs ahead during
+                     * compute-bound iterations and egress falls behind during transfer-bound ones
+                     */
+                    long stalled_delay = case_res.stalled_delay_;
+                    long ingress_delay = case_res.overlapped_ingress_delay_;
+                    long egress_delay = case_res.overlapped_egress_delay_;
+
+                    long ingress_overrun = num_case_occurrences * std::max(ingress_delay - stalled_delay, 0L);
+                    long ingress_slack = num_case_occurrences * std::max(stalled_delay - ingress_delay, 0L);
+                    long prefetched = std::min(accumulator.prefetch_credit_, ingress_overrun);
+                    accumulator.prefetch_credit_ = std::min(accumulator.prefetch_credit_ - prefetched + ingress_slack,
+                                                            ingress_run_ahead * ingress_delay);
+
+                    long egress_overrun = num_case_occurrences * std::max(egress_delay - stalled_delay, 0L);
+                    long egress_slack = num_case_occurrences * std::max(stalled_delay - egress_delay, 0L);
+                    long deferred = std::min(egress_overrun,
+                                             std::max(egress_run_ahead * egress_delay - accumulator.drain_backlog_, 0L));
+                    accumulator.drain_backlog_ = std::max(accumulator.drain_backlog_ + deferred - egress_slack, 0L);
+                    if (deferred > 0) {
+                        accumulator.drain_bound_ = case_res.egress_bound_;
                     }
-                } // End of for_each (iteration_case) in (all_iteration_cases)
-                avg_noc_bw_req = avg_noc_bw_req / num_total_cases;
-
-                if (num_total_cases != 0) {
-                    results->SetNumAvgActiveClusters(results->GetNumAvgActiveClusters() / num_total_cases);
-                }
-                results->UpdatePeakBWReq(peak_noc_bw_req);
-                results->UpdateAvgBWReq(avg_noc_bw_req);
-
-                delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Avg)] /= num_total_cases;
-                delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Avg)] /= num_total_cases;
-                delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Avg)] /= num_total_cases;
-
-                results->UpdateDelay(DelayType::Ingress, ValueType::Avg,
-                                     delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Avg)]);
-                results->UpdateDelay(DelayType::Egress, ValueType::Avg,
-                                     delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Avg)]);
-                results->UpdateDelay(DelayType::Computation, ValueType::Avg,
-                                     delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Avg)]);
-
-                results->UpdateDelay(DelayType::Ingress, ValueType::Min,
-                                     delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Min)]);
-                results->UpdateDelay(DelayType::Egress, ValueType::Min,
-                                     delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Min)]);
-                results->UpdateDelay(DelayType::Computation, ValueType::Min,
-                                     delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Min)]);
-
-                results->UpdateDelay(DelayType::Ingress, ValueType::Max,
-                                     delays[static_cast<int>(DelayType::Ingress)][static_cast<int>(ValueType::Max)]);
-                results->UpdateDelay(DelayType::Egress, ValueType::Max,
-                                     delays[static_cast<int>(DelayType::Egress)][static_cast<int>(ValueType::Max)]);
-                results->UpdateDelay(DelayType::Computation, ValueType::Max,
-                                     delays[static_cast<int>(DelayType::Computation)][static_cast<int>(ValueType::Max)]);
 
-                ret->push_back(results);
-            }
+                    long exposed_ingress = ingress_overrun - prefetched;
+                    long exposed_egress = egress_overrun - deferred;
+                    accumulator.runtime_ += num_case_occurrences * stalled_delay + std::max(exposed_ingress, exposed_egress);
+                    AttributeBoundCycles(num_case_occurrences * stalled_delay, case_res.stalled_bound_delay_,
+                                         case_res.critical_sub_results_, accumulator.bound_cycles_);
+                    if (std::max(exposed_ingress, exposed_egress) > 0) {
+                        auto bound_type = (exposed_ingress >= exposed_egress) ? case_res.ingress_bound_ : case_res.egress_bound_;
+                        accumulator.bound_cycles_[static_cast<int>(bound_type)] += std::max(exposed_ingress, exposed_egress);
+                    }
+                }
+                if (record_timeline_) {
+                    IterationCaseRecord case_record;
+                    case_record.case_id_ = case_id;
+                    case_record.is_init_ = case_res.is_init_;
+                    case_record.num_occurrences_ = num_case_occurrences;
+                    case_record.start_cycle_ = start_cycle;
+                    case_record.duration_ = accumulator.runtime_ - start_cycle;
+                    case_record.computation_delay_ = case_res.computation_delay_;
+                    case_record.reduction_delay_ = case_res.reduction_delay_;
+                    case_record.ingress_delay_ = case_res.ingress_comm_delay_;
+                    case_record.egress_delay_ = case_res.egress_comm_delay_;
+                    case_record.stalled_delay_ = case_res.stalled_delay_;
+                    case_record.offchip_ingress_delay_ = case_res.offchip_ingress_delay_;
+                    case_record.offchip_egress_delay_ = case_res.offchip_egress_delay_;
+                    case_record.critical_sub_results_ = case_res.critical_sub_results_;
+                    results->AddCaseRecord(case_record);
+                }
+                accumulator.num_computations_ += num_case_occurrences * case_res.num_partial_sums_;
+                accumulator.num_active_unit_clusters_ += case_res.num_active_unit_clusters_ * num_case_occurrences;
+                accumulator.reduction_traffic_ += num_case_occurrences * case_res.reduction_traffic_;
+                for (int depth = 2; depth <= max_hierarchy_depth; depth++) {
+                    for (auto access_type : {BufferAccessType::Read, BufferAccessType::Write}) {
+                        accumulator.hierarchy_access_count_[depth][static_cast<int>(access_type)] +=
+                                num_case_occurrences * case_res.hierarchy_access_count_[depth][static_cast<int>(access_type)];
+                    }
+                }
 
+                long computation_delay = case_res.computation_delay_;
+                long spatial_traffic = std::max(case_res.ingress_spatial_traffic_, case_res.egress_spatial_traffic_);
 
-        protected:
-            std::shared_ptr<ConfigurationV2> configs_;
-            std::shared_ptr<DFA::TensorTable> tensors_;
-            std::shared_ptr<DFA::ClusterTable> clusters_;
-            int num_simd_lanes_;
+                accumulator.peak_noc_bw_req_ = std::max(accumulator.peak_noc_bw_req_, spatial_traffic / computation_delay);
+                accumulator.avg_noc_bw_req_ += (num_case_occurrences * spatial_traffic) / computation_delay;
 
-        private:
+                long case_delays[static_cast<int>(DelayType::NumDelayTypes)];
+                case_delays[static_cast<int>(DelayType::Ingress)] = case_res.ingress_comm_delay_;
+                case_delays[static_cast<int>(DelayType::Egress)] = case_res.egress_comm_delay_;
+                case_delays[static_cast<int>(DelayType::Computation)] = computation_delay;
+                case_delays[static_cast<int>(DelayType::Reduction)] = case_res.reduction_delay_;
+
+                for (int i = 0; i < static_cast<int>(DelayType::NumDelayTypes); i++) {
+                    auto& delays = accumulator.delays_[i];
+                    delays[static_cast<int>(ValueType::Avg)] += num_case_occurrences * case_delays[i];
+                    delays[static_cast<int>(ValueType::Min)] = std::min(delays[static_cast<int>(ValueType::Min)],
+                                                                        static_cast<long double>(case_delays[i]));
+                    delays[static_cast<int>(ValueType::Max)] = std::max(delays[static_cast<int>(ValueType::Max)],
+                                                                        static_cast<long double>(case_delays[i]));
+                }
+
+                accumulator.num_total_cases_ += num_case_occurrences;
+                case_id++;
+            }
 
             void UpdateBufferSizeReq(
                     std::shared_ptr<CostAnalysisResults> results,
+                    CostAccumulator& accumulator,
                     std::shared_ptr<DFA::DimensionTable> dimensions,
                     std::shared_ptr<CA::ReuseAnalysis> reuse_analysis,
                     std::shared_ptr<DFA::IterationStatus> iter_status,
@@ -542,9 +1008,9 @@ namespace maestro {
                 auto output_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::OutputTensor);
                 auto input_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::InputTensor);
 
-                int buffer_size_mult = do_double_buffering ? 2 : 1;
                 for (auto &tensor: *input_tensors) {
                     auto dataclass = tensor->GetDataClass();
+                    int buffer_size_mult = GetBufferingDepth(dataclass, do_double_buffering);
                     auto coupled_vars = tensor->GetCoupledVariables();
                     long size = 1;
 
@@ -552,7 +1018,7 @@ namespace maestro {
                         size *= dimensions->GetSize(dim);
                     }
 
-                    auto upstream_buffer_req = reuse_analysis->GetSpatialIngressTraffic(tensor, iter_status);
+                    auto upstream_buffer_req = GetCompressedSize(reuse_analysis->GetSpatialIngressTraffic(tensor, iter_status), dataclass);
                     auto prev_upstream_buffer_req = results->GetBufferSizeReq(BufferType::Upstream,
                                                                               tensor->GetDataClass());
 
@@ -560,9 +1026,11 @@ namespace maestro {
                                                  prev_upstream_buffer_req + upstream_buffer_req * buffer_size_mult,
                                                  dataclass);
 
-                    results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, size, dataclass);
+                    // Filling the top-level buffer; a resident tensor is already there
+                    bool is_resident = cluster_idx == 0 && l2_resident_[static_cast<int>(dataclass)];
+                    accumulator.BufferAccessCount(BufferType::Upstream, BufferAccessType::Write, dataclass) = is_resident ? 0 : GetCompressedSize(size, dataclass);
 
-                    auto downstream_buffer_req = reuse_analysis->GetMappedVolume(tensor);
+                    auto downstream_buffer_req = GetCompressedSize(reuse_analysis->GetMappedVolume(tensor), dataclass);
                     auto prev_downstream_buffer_req = results->GetBufferSizeReq(BufferType::Downstream,
                                                                                 tensor->GetDataClass());
                     results->UpdateBufferSizeReq(BufferType::Downstream,
@@ -572,6 +1040,7 @@ namespace maestro {
 
                 for (auto &tensor: *output_tensors) {
                     auto dataclass = tensor->GetDataClass();
+                    int buffer_size_mult = GetBufferingDepth(dataclass, do_double_buffering);
                     auto coupled_vars = tensor->GetCoupledVariables();
                     long size = 1;
 
@@ -591,7 +1060,9 @@ namespace maestro {
                     results->UpdateBufferSizeReq(BufferType::Upstream, buffer_size_mult * upstream_buffer_req,
                                                  dataclass);
 
-                    results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, size, dataclass);
+                    // Draining the top-level buffer; a resident tensor stays for the next layer
+                    bool is_resident = cluster_idx == 0 && l2_resident_[static_cast<int>(dataclass)];
+                    accumulator.BufferAccessCount(BufferType::Upstream, BufferAccessType::Read, dataclass) = is_resident ? 0 : GetCompressedSize(size, dataclass);
 
                     auto downstream_buffer_req = reuse_analysis->GetMappedVolume(tensor);
                     results->UpdateBufferSizeReq(BufferType::Downstream, buffer_size_mult * downstream_buffer_req,
@@ -22,6 +22,13 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #ifndef CA_COST_ANALYSIS_OUTPUT_HPP_
 #define CA_COST_ANALYSIS_OUTPUT_HPP_
 
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <type_traits>
+
 #include "BASE_maestro-class.hpp"
 #include "BASE_constants.hpp"
 
@@ -32,10 +39,111 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 namespace maestro {
     namespace CA {
 
-        enum class BufferType {Upstream, Downstream};
-        enum class BufferAccessType {Read, Write};
-        enum class DelayType {Ingress, Egress, Computation, NumDelayTypes};
+        enum class BufferType {Upstream, Downstream, NumBufferTypes};
+        enum class BufferAccessType {Read, Write, NumBufferAccessTypes};
+        enum class DelayType {Ingress, Egress, Computation, Reduction, NumDelayTypes};
         enum class ValueType {Min, Max, Avg, NumValTypes};
+        // Term that set the length of an iteration: the stalled part or an overlapped transfer that outran it.
+        // Ingress and Egress are on-chip transfers, limited by the NoC or the buffer ports
+        enum class BoundType {Computation, Reduction, Ingress, Egress, Offchip, NumBoundTypes};
+
+        inline std::string BoundTypeToString(BoundType bound_type) {
+            switch(bound_type) {
+                case BoundType::Computation:
+                    return "Computation";
+                case BoundType::Reduction:
+                    return "Reduction";
+                case BoundType::Ingress:
+                    return "Ingress";
+                case BoundType::Egress:
+                    return "Egress";
+                case BoundType::Offchip:
+                    return "Off-chip";
+                default:
+                    return "Unknown";
+            }
+        }
+
+        // Deepest buffer hierarchy whose accesses are tracked below a cluster level
+        const int max_hierarchy_depth = 8;
+
+        /*
+         * Flat counters of one cluster-level analysis. The cost analysis engine updates a local copy for every
+         * iteration case and commits it to CostAnalysisResults once, at the end of the cluster level.
+         */
+        class CostAccumulator {
+        public:
+            CostAccumulator() {
+                for(int i = 0; i < static_cast<int>(DelayType::NumDelayTypes); i++) {
+                    delays_[i][static_cast<int>(ValueType::Min)] = std::numeric_limits<long double>::max();
+                    delays_[i][static_cast<int>(ValueType::Max)] = std::numeric_limits<long double>::min();
+                    delays_[i][static_cast<int>(ValueType::Avg)] = 0;
+                }
+            }
+
+            long& BufferAccessCount(BufferType target_buffer, BufferAccessType access_type, DataClass data_class) {
+                return buffer_access_count_[static_cast<int>(target_buffer)][static_cast<int>(access_type)][static_cast<int>(data_class)];
+            }
+
+            long double& Delay(DelayType delay_type, ValueType val_type) {
+                return delays_[static_cast<int>(delay_type)][static_cast<int>(val_type)];
+            }
+
+            long buffer_access_count_[static_cast<int>(BufferType::NumBufferTypes)]
+                                     [static_cast<int>(BufferAccessType::NumBufferAccessTypes)]
+                                     [static_cast<int>(DataClass::NumDataClasses)] = {};
+            long double delays_[static_cast<int>(DelayType::NumDelayTypes)][static_cast<int>(ValueType::NumValTypes)];
+
+            long runtime_ = 0;
+            long num_computations_ = 0;
+            double num_active_unit_clusters_ = 0;
+            double arithmetic_intensity_ = 0;
+
+            long peak_noc_bw_req_ = 0;
+            long double avg_noc_bw_req_ = 0;
+            long off_chip_bw_req_ = 0;
+            long num_total_cases_ = 0;
+            long reduction_traffic_ = 0;
+            // See CostAnalysisResults::GetHierarchyAccessCount; depth 1 comes from the downstream counts
+            long hierarchy_access_count_[max_hierarchy_depth + 1][static_cast<int>(BufferAccessType::NumBufferAccessTypes)] = {};
+            // Ingress cycles already done for upcoming tiles, and egress cycles still pending (see TensorBuffering)
+            long prefetch_credit_ = 0;
+            long drain_backlog_ = 0;
+            // Bound type of the transfers in drain_backlog_
+            BoundType drain_bound_ = BoundType::Egress;
+            // Runtime cycles per bound type; see CostAnalysisResults::GetBoundCycles
+            double bound_cycles_[static_cast<int>(BoundType::NumBoundTypes)] = {};
+        }; // End of class CostAccumulator
+
+        static_assert(std::is_trivially_copyable<CostAccumulator>::value, "CostAccumulator must stay a flat record");
+
+        class CostAnalysisResults;
+
+        /*
+         * One iteration case of a cluster level on the modeled timeline, kept when the engine records the
+         * timeline (see CostAnalysisEngine::SetTimelineRecording). Delays are per iteration of the case.
+         */
+        class IterationCaseRecord {
+        public:
+            int case_id_ = 0;
+            bool is_init_ = false;
+            long num_occurrences_ = 0;
+            // Cycles from the start of the cluster level, and spent on all the occurrences
+            long start_cycle_ = 0;
+            long duration_ = 0;
+
+            long computation_delay_ = 0;
+            long reduction_delay_ = 0;
+            long ingress_delay_ = 0;
+            long egress_delay_ = 0;
+            long stalled_delay_ = 0;
+            // Top cluster level only
+            long offchip_ingress_delay_ = 0;
+            long offchip_egress_delay_ = 0;
+
+            // Slowest sub-cluster of one iteration; nullptr at the base cluster level
+            std::shared_ptr<CostAnalysisResults> critical_sub_results_ = nullptr;
+        }; // End of class IterationCaseRecord
 
         class CostAnalysisResults : public MAESTROClass {
         public:
@@ -75,17 +183,7 @@ namespace maestro {
 
 
             long GetBufferAccessCount(BufferType target_buffer, BufferAccessType access_type, DataClass data_class) {
-                long ret;
-                int data_class_id = static_cast<int>(data_class);
-                if(target_buffer == BufferType::Upstream) {
-                    ret = (access_type == BufferAccessType::Read)?
-                          upstream_buffer_read_[data_class_id] : upstream_buffer_write_estimate_[data_class_id];
-                }
-                else {
-                    ret = (access_type == BufferAccessType::Read)?
-                          downstream_buffer_read_estimate[data_class_id] : downstream_buffer_write_[data_class_id];
-                }
-                return ret;
+                return buffer_access_count_[static_cast<int>(target_buffer)][static_cast<int>(access_type)][static_cast<int>(data_class)];
             }
 
             long GetDelay(DelayType delay_type, ValueType val_type) {
@@ -95,26 +193,53 @@ namespace maestro {
                 else if(delay_type == DelayType::Egress) {
                     return egress_delay_[static_cast<int>(val_type)];
                 }
+                else if(delay_type == DelayType::Reduction) {
+                    return reduction_delay_[static_cast<int>(val_type)];
+                }
                 else {
                     return compute_delay_[static_cast<int>(val_type)];
                 }
             }
 
             void UpdateBufferAccessCount(BufferType target_buffer, BufferAccessType access_type, long counts, DataClass data_class) {
+                buffer_access_count_[static_cast<int>(target_buffer)][static_cast<int>(access_type)][static_cast<int>(data_class)] = counts;
+            }
 
-                int data_class_id = static_cast<int>(data_class);
-
-                if((target_buffer == BufferType::Upstream) && (access_type == BufferAccessType::Read)) {
-                    upstream_buffer_read_[data_class_id] = counts;
-                }
-                else if((target_buffer == BufferType::Upstream) && (access_type == BufferAccessType::Write)) {
-                    upstream_buffer_write_estimate_[data_class_id] = counts;
+            // Overwrites the counters covered by the accumulator; averages are taken over its number of cases
+            void CommitAccumulator(const CostAccumulator& accumulator) {
+                std::copy(&accumulator.buffer_access_count_[0][0][0],
+                          &accumulator.buffer_access_count_[0][0][0] + sizeof(buffer_access_count_) / sizeof(long),
+                          &buffer_access_count_[0][0][0]);
+
+                runtime_[static_cast<int>(CA::EstimationType::Exact)] = accumulator.runtime_;
+                num_computations_ = accumulator.num_computations_;
+                arithmetic_intensity_ = accumulator.arithmetic_intensity_;
+                offchip_bw_req_ = accumulator.off_chip_bw_req_;
+                peak_bw_req_ = accumulator.peak_noc_bw_req_;
+                reduction_traffic_ = accumulator.reduction_traffic_;
+                UpdateBoundCycles(accumulator.bound_cycles_);
+
+                std::copy(&accumulator.hierarchy_access_count_[0][0],
+                          &accumulator.hierarchy_access_count_[0][0] + sizeof(hierarchy_access_count_) / sizeof(long),
+                          &hierarchy_access_count_[0][0]);
+                for(auto access_type : {BufferAccessType::Read, BufferAccessType::Write}) {
+                    long num_accesses = 0;
+                    for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                        num_accesses += GetBufferAccessCount(BufferType::Downstream, access_type, static_cast<DataClass>(i));
+                    }
+                    UpdateHierarchyAccessCount(1, access_type, num_accesses);
                 }
-                else if((target_buffer == BufferType::Downstream) && (access_type == BufferAccessType::Read)) {
-                    downstream_buffer_read_estimate[data_class_id] = counts;
-                }
-                else if ((target_buffer == BufferType::Downstream) && (access_type == BufferAccessType::Write)) {
-                    downstream_buffer_write_[data_class_id] = counts;
+
+                long num_total_cases = accumulator.num_total_cases_;
+                avg_bw_req_ = accumulator.avg_noc_bw_req_ / num_total_cases;
+                avg_num_active_unit_clusters_ = (num_total_cases != 0) ?
+                        accumulator.num_active_unit_clusters_ / num_total_cases : accumulator.num_active_unit_clusters_;
+
+                long* delays[static_cast<int>(DelayType::NumDelayTypes)] = {ingress_delay_, egress_delay_, compute_delay_, reduction_delay_};
+                for(int i = 0; i < static_cast<int>(DelayType::NumDelayTypes); i++) {
+                    delays[i][static_cast<int>(ValueType::Avg)] = accumulator.delays_[i][static_cast<int>(ValueType::Avg)] / num_total_cases;
+                    delays[i][static_cast<int>(ValueType::Min)] = accumulator.delays_[i][static_cast<int>(ValueType::Min)];
+                    delays[i][static_cast<int>(ValueType::Max)] = accumulator.delays_[i][static_cast<int>(ValueType::Max)];
                 }
             }
 
@@ -137,6 +262,9 @@ namespace maestro {
                 else if(delay_type == DelayType::Egress) {
                     egress_delay_[static_cast<int>(val_type)] = delay;
                 }
+                else if(delay_type == DelayType::Reduction) {
+                    reduction_delay_[static_cast<int>(val_type)] = delay;
+                }
                 else {
                     compute_delay_[static_cast<int>(val_type)] = delay;
                 }
@@ -191,6 +319,36 @@ namespace maestro {
                 avg_bw_req_ = avg_bw_req;
             }
 
+            long GetClusterLevel() {
+                return cluster_level_;
+            }
+
+            /*
+             * Accesses (all data classes) to the buffers depth levels below this cluster's upstream buffer
+             * (1: the buffers of its sub-clusters), summed over every instance under one instance of this cluster
+             */
+            long GetHierarchyAccessCount(int depth, BufferAccessType access_type) {
+                if(depth < 1 || depth > max_hierarchy_depth) {
+                    return 0;
+                }
+                return hierarchy_access_count_[depth][static_cast<int>(access_type)];
+            }
+
+            void UpdateHierarchyAccessCount(int depth, BufferAccessType access_type, long count) {
+                if(depth >= 1 && depth <= max_hierarchy_depth) {
+                    hierarchy_access_count_[depth][static_cast<int>(access_type)] = count;
+                }
+            }
+
+            // Partial sums moved through explicit reduction trees, over all iterations
+            long GetReductionTraffic() {
+                return reduction_traffic_;
+            }
+
+            void UpdateReductionTraffic(long reduction_traffic) {
+                reduction_traffic_ = reduction_traffic;
+            }
+
             void UpdateNumSubClusters(long num_clusters) {
                 num_sub_clusters_ = num_clusters;
             }
@@ -223,6 +381,38 @@ namespace maestro {
                 return arithmetic_intensity_;
             }
 
+            void AddCaseRecord(const IterationCaseRecord& case_record) {
+                case_records_.push_back(case_record);
+            }
+
+            // Iteration cases in execution order; empty unless the timeline was recorded
+            const std::vector<IterationCaseRecord>& GetCaseRecords() {
+                return case_records_;
+            }
+
+            /*
+             * Runtime cycles of this cluster level attributed to the term that bounded them, including the
+             * levels below it (the computation of a level is the runtime of its slowest sub-cluster). The
+             * bound cycles of all the types add up to the runtime.
+             */
+            double GetBoundCycles(BoundType bound_type) {
+                return bound_cycles_[static_cast<int>(bound_type)];
+            }
+
+            void UpdateBoundCycles(const double* bound_cycles) {
+                std::copy(bound_cycles, bound_cycles + static_cast<int>(BoundType::NumBoundTypes), bound_cycles_);
+            }
+
+            BoundType GetDominantBound() {
+                int ret = 0;
+                for(int i = 1; i < static_cast<int>(BoundType::NumBoundTypes); i++) {
+                    if(bound_cycles_[i] > bound_cycles_[ret]) {
+                        ret = i;
+                    }
+                }
+                return static_cast<BoundType>(ret);
+            }
+
         protected:
             LayerType layer_type_;
             std::shared_ptr<std::vector<std::shared_ptr<DFA::IterationStatus>>> iter_status_info_;
@@ -235,10 +425,9 @@ namespace maestro {
 
             long runtime_[static_cast<int>(CA::EstimationType::NumEstimationTypes)]= {0, };
 
-            long upstream_buffer_write_estimate_[static_cast<int>(DataClass::NumDataClasses)] = {0};
-            long upstream_buffer_read_[static_cast<int>(DataClass::NumDataClasses)] = {0};
-            long downstream_buffer_write_[static_cast<int>(DataClass::NumDataClasses)] = {0};
-            long downstream_buffer_read_estimate[static_cast<int>(DataClass::NumDataClasses)] = {0};
+            long buffer_access_count_[static_cast<int>(BufferType::NumBufferTypes)]
+                                     [static_cast<int>(BufferAccessType::NumBufferAccessTypes)]
+                                     [static_cast<int>(DataClass::NumDataClasses)] = {};
 
             long upstream_buffer_size_req_[static_cast<int>(DataClass::NumDataClasses)] = {0};
             long downstream_buffer_size_req_[static_cast<int>(DataClass::NumDataClasses)] = {0};
@@ -246,15 +435,60 @@ namespace maestro {
             long ingress_delay_[static_cast<int>(ValueType::NumValTypes)] = {0};
             long egress_delay_[static_cast<int>(ValueType::NumValTypes)] = {0};
             long compute_delay_[static_cast<int>(ValueType::NumValTypes)] = {0};
+            long reduction_delay_[static_cast<int>(ValueType::NumValTypes)] = {0};
 
             long peak_bw_req_ = 0;
             double avg_bw_req_ = 0;
             long offchip_bw_req_ = 0;
             long num_computations_ = 0;
             long top_level_num_computations_ = 0;
+            long reduction_traffic_ = 0;
+            long hierarchy_access_count_[max_hierarchy_depth + 1][static_cast<int>(BufferAccessType::NumBufferAccessTypes)] = {};
+            std::vector<IterationCaseRecord> case_records_;
+            double bound_cycles_[static_cast<int>(BoundType::NumBoundTypes)] = {};
         private:
 
         }; // End of class CostAnalysisResults
+
+        /*
+         * Adds num_cycles to bound_cycles, split over the bound types in proportion to bound_delay (one
+         * iteration's split of its delay). The computation share follows the bound cycles of the slowest
+         * sub-cluster, if any, so that the attribution reaches down to the base cluster.
+         */
+        inline void AttributeBoundCycles(double num_cycles, const long* bound_delay,
+                                         std::shared_ptr<CostAnalysisResults> sub_results, double* bound_cycles) {
+            const int num_bound_types = static_cast<int>(BoundType::NumBoundTypes);
+            double total_delay = 0;
+            for(int i = 0; i < num_bound_types; i++) {
+                total_delay += bound_delay[i];
+            }
+            if(num_cycles <= 0) {
+                return;
+            }
+            if(total_delay <= 0) {
+                bound_cycles[static_cast<int>(BoundType::Computation)] += num_cycles;
+                return;
+            }
+
+            double sub_runtime = 0;
+            if(sub_results != nullptr) {
+                for(int i = 0; i < num_bound_types; i++) {
+                    sub_runtime += sub_results->GetBoundCycles(static_cast<BoundType>(i));
+                }
+            }
+
+            for(int i = 0; i < num_bound_types; i++) {
+                double cycles = num_cycles * bound_delay[i] / total_delay;
+                if(i == static_cast<int>(BoundType::Computation) && sub_runtime > 0) {
+                    for(int j = 0; j < num_bound_types; j++) {
+                        bound_cycles[j] += cycles * sub_results->GetBoundCycles(static_cast<BoundType>(j)) / sub_runtime;
+                    }
+                }
+                else {
+                    bound_cycles[i] += cycles;
+                }
+            }
+        }
     } // End of namespace CA
 } // End of namespace maestro
 
@@ -0,0 +1,423 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_CA_LOWER_BOUNDS_HPP_
+#define MAESTRO_CA_LOWER_BOUNDS_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <cmath>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_constants.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_tensor.hpp"
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_sparsity.hpp"
+#include "DFSL_syntax_tokens.hpp"
+#include "DFSL_hw-parser.hpp"
+
+#include "CA_analysis-types.hpp"
+
+#include "DSE_config.hpp"
+#include "DSE_cost-database.hpp"
+
+namespace maestro {
+    namespace CA {
+
+        /*
+         * Optimistic estimates of a (layer, mapping) pair; the cost analysis engine never reports
+         * a smaller runtime, energy, or buffer requirement than these values.
+         */
+        class PerformanceBounds {
+        public:
+            long num_macs_ = 0;      // effectual MACs
+            long runtime_ = 0;       // cycles; MACs over the usable parallel MAC units, or compulsory off-chip traffic
+            double energy_ = 0;      // nJ; MAC energy only (buffer and NoC energy are non-negative)
+            long min_l1_size_ = 0;   // elements; buffered innermost tiles
+            long min_l2_size_ = 0;   // elements; buffered outermost tiles
+            bool fits_buffers_ = true;
+
+            double GetCost(DSE::OptimizationTarget target) {
+                switch (target) {
+                    case DSE::OptimizationTarget::Energy:
+                        return energy_;
+                    case DSE::OptimizationTarget::EnergyDelayProduct:
+                        return static_cast<double>(runtime_) * energy_;
+                    case DSE::OptimizationTarget::PerformancePerWatt:
+                        // MACs per energy is bounded from above, so its negation is bounded from below
+                        return (energy_ > 0) ? -static_cast<double>(num_macs_) / energy_ : 0;
+                    case DSE::OptimizationTarget::Runtime:
+                    default:
+                        return static_cast<double>(runtime_);
+                }
+            }
+
+            std::string ToString() {
+                return "runtime >= " + std::to_string(runtime_) + " cycles, energy >= " + std::to_string(energy_)
+                       + " nJ, L1 >= " + std::to_string(min_l1_size_) + ", L2 >= " + std::to_string(min_l2_size_);
+            }
+        }; // End of class PerformanceBounds
+
+        class PruningStats {
+        public:
+            long num_candidates_ = 0;
+            long num_pruned_ = 0;
+
+            void Accumulate(const PruningStats& other) {
+                num_candidates_ += other.num_candidates_;
+                num_pruned_ += other.num_pruned_;
+            }
+
+            double GetPruningRatio() const {
+                return (num_candidates_ == 0) ? 0.0 : static_cast<double>(num_pruned_) / num_candidates_;
+            }
+
+            std::string ToString() const {
+                return std::to_string(num_pruned_) + " of " + std::to_string(num_candidates_) + " candidates pruned ("
+                       + std::to_string(100.0 * GetPruningRatio()) + "%)";
+            }
+        }; // End of class PruningStats
+
+        /*
+         * Closed-form bounds used to discard candidates before running the cluster/iteration analysis.
+         *  - Runtime: every effectual MAC takes a SIMD lane of a PE for a cycle, and no more PEs can be busy
+         *    than the spatial maps have positions.
+         *  - Energy: the MAC energy of the effectual MACs of the layer.
+         *  - Buffers: the (compressed) tiles the innermost (L1) and outermost (L2) levels hold, as many of
+         *    each as the tensor buffering of the cost analysis engine keeps (see SetTensorBuffering).
+         *  - Off-chip: every element of the dense tensors crosses the off-chip interface at least once. The
+         *    engine moves a whole tile per outermost iteration and rounds each transfer down, which may lose
+         *    up to a cycle per iteration.
+         * NoC delays are not bounded.
+         */
+        class LowerBoundAnalysis : public MAESTROClass {
+        public:
+            LowerBoundAnalysis(std::shared_ptr<DFSL::HWConfig> hw_config, int simd_width = 1) :
+                    MAESTROClass("LowerBoundAnalysis"),
+                    hw_config_(hw_config),
+                    simd_width_(std::max(simd_width, 1)) {
+            }
+
+            // Must match the buffering of the analysis the bounds are compared with (double buffering by default)
+            void SetTensorBuffering(TensorBuffering buffering) {
+                buffering_ = buffering;
+            }
+
+            std::shared_ptr<PerformanceBounds> AnalyzeLayer(std::shared_ptr<DFA::Layer> layer,
+                                                            std::shared_ptr<DFA::DirectiveTable> dataflow = nullptr) {
+                auto ret = std::make_shared<PerformanceBounds>();
+                if(dataflow == nullptr) {
+                    dataflow = layer->GetDataflow();
+                }
+
+                auto quantization = layer->getQuantization();
+                auto layer_hw = hw_config_->GetLayerHardwareView(quantization);
+                long num_pes = layer_hw.num_pes_;
+
+                std::map<std::string, int> dim_sizes;
+                for(auto& dim : *layer->GetDimensions()) {
+                    dim_sizes[dim->GetName()] = dim->GetSize();
+                }
+
+                // Sparse layers only compute the MACs whose operands are both nonzero
+                auto sparsity = layer->GetSparsity();
+                ret->num_macs_ = GetNumMACs(layer, dim_sizes);
+                if(sparsity != nullptr && !sparsity->IsDense()) {
+                    ret->num_macs_ = static_cast<long>(std::floor(static_cast<double>(ret->num_macs_)
+                                                                  * sparsity->GetEffectualMACFraction()));
+                }
+                ret->energy_ = ret->num_macs_ * DSE::cost::mac_energy_func(quantization);
+
+                // Only evenly tiled mappings get the mapping-specific bounds (see IsEvenlyTiled)
+                bool is_regular = dataflow != nullptr && IsEvenlyTiled(layer, dataflow, dim_sizes, num_pes);
+
+                long num_parallel_units = is_regular ? GetNumParallelUnits(dataflow, dim_sizes, num_pes) : num_pes;
+                num_parallel_units = std::max(std::min(num_parallel_units, num_pes), 1L);
+                ret->runtime_ = static_cast<long>(std::ceil(static_cast<double>(ret->num_macs_)
+                                                            / (num_parallel_units * simd_width_)));
+
+                if(is_regular) {
+                    auto outermost_tiles = GetLevelTiles(dataflow, dim_sizes, false);
+                    auto innermost_tiles = GetLevelTiles(dataflow, dim_sizes, true);
+                    ret->min_l2_size_ = GetFootprint(layer, outermost_tiles);
+                    ret->min_l1_size_ = GetFootprint(layer, innermost_tiles);
+
+                    ret->fits_buffers_ = ret->min_l1_size_ <= layer_hw.l1_size_ && ret->min_l2_size_ <= layer_hw.l2_size_;
+
+                    // Compressed tensors are rounded per tile; only dense layers get the off-chip bound
+                    if(sparsity == nullptr || sparsity->IsDense()) {
+                        ret->runtime_ = std::max(ret->runtime_, GetOffchipBound(layer, dataflow, dim_sizes));
+                    }
+                }
+
+                return ret;
+            }
+
+            // A candidate cannot beat the incumbent if even its optimistic estimate does not
+            bool CanPrune(std::shared_ptr<PerformanceBounds> bounds, DSE::OptimizationTarget target,
+                          double incumbent_cost, bool incumbent_fits_buffers) {
+                if(incumbent_fits_buffers && !bounds->fits_buffers_) {
+                    return true;
+                }
+                if(!incumbent_fits_buffers && bounds->fits_buffers_) {
+                    return false;
+                }
+                return bounds->GetCost(target) >= incumbent_cost;
+            }
+
+        protected:
+            std::shared_ptr<DFSL::HWConfig> hw_config_;
+            int simd_width_;
+            TensorBuffering buffering_;
+
+        private:
+            // Number of output positions along a sliding dimension covered by an input extent
+            int GetNumOutputPositions(std::shared_ptr<DFA::Layer> layer, std::map<std::string, int>& dim_sizes,
+                                      std::string dim, int extent) {
+                auto sliding_windows = DFA::GetSlidingWindows(layer);
+                auto window = sliding_windows.find(dim);
+                if(window == sliding_windows.end() || dim_sizes.count(window->second) == 0) {
+                    return extent;
+                }
+                std::string window_dim = window->second;
+
+                int window_size = dim_sizes[window_dim];
+                int stride = std::max(layer->GetOuterStride(dim), 1);
+                if(extent < window_size) {
+                    return 1;
+                }
+                return (extent - window_size) / stride + 1;
+            }
+
+            long GetNumMACs(std::shared_ptr<DFA::Layer> layer, std::map<std::string, int>& dim_sizes) {
+                long ret = 1;
+                for(auto& it : dim_sizes) {
+                    // Depth-wise layers have no output channel in their tensors
+                    if(layer->GetLayerType() == LayerType::DSCONV && it.first == DFSL::layer_dim_output_channel_) {
+                        continue;
+                    }
+                    ret *= GetNumOutputPositions(layer, dim_sizes, it.first, it.second);
+                }
+                return ret;
+            }
+
+            /*
+             * The engine approximates edge iterations (partial tiles, partially occupied clusters), strided
+             * windows, and grouped convolutions, and can report less than the ideal work for them.
+             * Mappings with any of those only get the mapping-independent bounds.
+             */
+            bool IsEvenlyTiled(std::shared_ptr<DFA::Layer> layer, std::shared_ptr<DFA::DirectiveTable> dataflow,
+                               std::map<std::string, int>& dim_sizes, long num_pes) {
+                if(layer->GetLayerType() == LayerType::NGCONV) {
+                    return false;
+                }
+                for(auto& dim : *layer->GetDimensions()) {
+                    if(dim->GetOuterStride() > 1) {
+                        return false;
+                    }
+                }
+
+                long num_inner_pes = 1;
+                for(auto& directive : *dataflow) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        num_inner_pes *= std::max(directive->GetSize(), 1);
+                    }
+                }
+
+                std::vector<long> num_units = {std::max(num_pes / num_inner_pes, 1L)};
+                for(auto& directive : *dataflow) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        num_units.push_back(std::max(directive->GetSize(), 1));
+                    }
+                }
+
+                std::map<std::string, int> extents = dim_sizes;
+                std::map<std::string, int> level_tiles;
+                int cluster_lv = 0;
+                for(auto& directive : *dataflow) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        for(auto& it : level_tiles) {
+                            extents[it.first] = it.second;
+                        }
+                        level_tiles.clear();
+                        cluster_lv++;
+                        continue;
+                    }
+
+                    auto dim = directive->GetVariable();
+                    if(extents.count(dim) == 0) {
+                        return false;
+                    }
+                    int extent = extents[dim];
+                    int map_size = std::max(directive->GetSize(), 1);
+                    int map_ofs = std::max(directive->GetOfs(), 1);
+                    if(map_size < extent && (extent - map_size) % map_ofs != 0) {
+                        return false;
+                    }
+
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
+                        long num_positions = (extent <= map_size) ? 1 : (extent - map_size) / map_ofs + 1;
+                        long level_units = num_units.at(cluster_lv);
+                        if(num_positions > level_units && num_positions % level_units != 0) {
+                            return false;
+                        }
+                    }
+                    level_tiles[dim] = std::min(map_size, extent);
+                }
+
+                return true;
+            }
+
+            // Spatial maps can occupy at most as many PEs as the product of their positions over all cluster levels
+            long GetNumParallelUnits(std::shared_ptr<DFA::DirectiveTable> dataflow, std::map<std::string, int>& dim_sizes,
+                                     long num_pes) {
+                if(dataflow == nullptr) {
+                    return num_pes;
+                }
+
+                long ret = 1;
+                for(auto& directive : *dataflow) {
+                    if(directive->GetClass() != DFA::directive::DirectiveClass::SpatialMap) {
+                        continue;
+                    }
+                    auto dim = directive->GetVariable();
+                    if(dim_sizes.count(dim) == 0) {
+                        return num_pes;
+                    }
+                    long extent = dim_sizes[dim];
+                    long map_size = std::max(directive->GetSize(), 1);
+                    long map_ofs = std::max(directive->GetOfs(), 1);
+                    long num_positions = (extent <= map_size) ? 1 : (extent - map_size + map_ofs - 1) / map_ofs + 1;
+                    ret = std::min(ret * num_positions, num_pes);
+                }
+                return ret;
+            }
+
+            // Map sizes of the outermost or innermost level; dimensions not mapped there inherit the enclosing tile
+            std::map<std::string, int> GetLevelTiles(std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                                     std::map<std::string, int>& dim_sizes, bool innermost) {
+                std::map<std::string, int> ret = dim_sizes;
+                std::map<std::string, int> level_tiles;
+
+                for(auto& directive : *dataflow) {
+                    auto directive_class = directive->GetClass();
+                    if(directive_class == DFA::directive::DirectiveClass::Cluster) {
+                        if(!innermost) {
+                            break;
+                        }
+                        for(auto& it : level_tiles) {
+                            ret[it.first] = it.second;
+                        }
+                        level_tiles.clear();
+                    }
+                    else {
+                        auto dim = directive->GetVariable();
+                        if(ret.count(dim) != 0) {
+                            level_tiles[dim] = std::min(std::max(directive->GetSize(), 1), ret[dim]);
+                        }
+                    }
+                }
+                for(auto& it : level_tiles) {
+                    ret[it.first] = it.second;
+                }
+
+                return ret;
+            }
+
+            // Elements of a tensor within the given tiles (the whole tensor for the layer dimensions)
+            long GetTensorSize(std::shared_ptr<DFA::Layer> layer, DataClass data_class, std::map<std::string, int>& tiles) {
+                std::map<std::string, int> dim_sizes;
+                for(auto& dim : *layer->GetDimensions()) {
+                    dim_sizes[dim->GetName()] = dim->GetSize();
+                }
+
+                long ret = 1;
+                for(auto& dim : DFA::GetCoupledVariables(layer, data_class)) {
+                    if(tiles.count(dim) == 0) {
+                        continue;
+                    }
+                    int tile = tiles[dim];
+                    if(data_class == DataClass::Output) {
+                        tile = GetNumOutputPositions(layer, dim_sizes, dim, tile);
+                    }
+                    ret *= std::max(tile, 1);
+                }
+                return ret;
+            }
+
+            long GetFootprint(std::shared_ptr<DFA::Layer> layer, std::map<std::string, int>& tiles) {
+                int bit_size = maestro::getBitSize(layer->getQuantization());
+                auto sparsity = layer->GetSparsity();
+
+                long ret = 0;
+                for(auto data_class : {DataClass::Input, DataClass::Weight, DataClass::Output}) {
+                    double tensor_size = static_cast<double>(GetTensorSize(layer, data_class, tiles));
+                    if(sparsity != nullptr) {
+                        tensor_size *= sparsity->GetFootprintFactor(data_class, bit_size);
+                    }
+                    ret += buffering_.GetDepth(data_class) * static_cast<long>(std::floor(tensor_size));
+                }
+                return ret;
+            }
+
+            /*
+             * Cycles to move the unique input, weight, and output elements over the off-chip interface: over
+             * offchip_bw_ elements per cycle in each direction, or over the DRAM bus shared by both directions
+             */
+            long GetOffchipBound(std::shared_ptr<DFA::Layer> layer, std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                 std::map<std::string, int>& dim_sizes) {
+                long ingress_volume = GetTensorSize(layer, DataClass::Input, dim_sizes)
+                                      + GetTensorSize(layer, DataClass::Weight, dim_sizes);
+                long egress_volume = GetTensorSize(layer, DataClass::Output, dim_sizes);
+
+                if(hw_config_->dram_config_ != nullptr) {
+                    long num_bytes = (ingress_volume + egress_volume) * maestro::getBitSize(layer->getQuantization()) / 8;
+                    return num_bytes / std::max(hw_config_->dram_config_->bus_bw_, 1);
+                }
+
+                // Upper bound on the number of outermost iterations, each of which may round a cycle away
+                long num_iterations = 1;
+                for(auto& directive : *dataflow) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        break;
+                    }
+                    long extent = dim_sizes[directive->GetVariable()];
+                    long map_size = std::max(directive->GetSize(), 1);
+                    long map_ofs = std::max(directive->GetOfs(), 1);
+                    num_iterations *= (extent <= map_size) ? 1 : (extent - map_size) / map_ofs + 1;
+                }
+
+                long offchip_bw = std::max(hw_config_->off_chip_bw_, 1);
+                return std::max(std::max(ingress_volume, egress_volume) / offchip_bw - num_iterations, 0L);
+            }
+        }; // End of class LowerBoundAnalysis
+    }; // End of namespace CA
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,78 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_CA_OFFCHIP_ACCESS_HPP_
+#define MAESTRO_CA_OFFCHIP_ACCESS_HPP_
+
+#include <memory>
+#include <string>
+#include <map>
+#include <algorithm>
+
+#include "DFA_tensor.hpp"
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_dimension-table.hpp"
+
+namespace maestro {
+    namespace CA {
+        /*
+         * Number of elements of a tensor that the uppermost tile reads (or writes) contiguously from the
+         * off-chip memory. Tensors are laid out row-major in the order of their coupled dimensions; a run
+         * extends over the innermost dimensions as long as the tile covers them entirely.
+         */
+        inline long GetOffchipRunLength(std::shared_ptr<DFA::Tensor> tensor,
+                                        std::shared_ptr<DFA::DimensionTable> dimensions,
+                                        std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                        long num_sub_clusters) {
+            std::map<std::string, long> tile_extents;
+            for(auto& directive : *dataflow) {
+                auto directive_class = directive->GetClass();
+                if(directive_class != DFA::directive::DirectiveClass::TemporalMap
+                   && directive_class != DFA::directive::DirectiveClass::SpatialMap) {
+                    continue;
+                }
+
+                long extent = directive->GetSize();
+                if(directive_class == DFA::directive::DirectiveClass::SpatialMap) {
+                    extent += (num_sub_clusters - 1) * directive->GetOfs();
+                }
+                tile_extents[directive->GetVariable()] = extent;
+            }
+
+            auto coupled_vars = tensor->GetCoupledVariables();
+            long run_length = 1;
+            for(auto it = coupled_vars->rbegin(); it != coupled_vars->rend(); ++it) {
+                long dim_size = std::max(dimensions->GetSize(*it), 1);
+                long extent = (tile_extents.find(*it) == tile_extents.end()) ? dim_size : std::min(tile_extents[*it], dim_size);
+                run_length *= std::max(extent, 1L);
+                if(extent < dim_size) {
+                    break;
+                }
+            }
+
+            return run_length;
+        }
+    }; // End of namespace CA
+}; // End of namespace maestro
+
+#endif
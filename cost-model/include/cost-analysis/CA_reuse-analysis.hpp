@@ -208,6 +208,10 @@ namespace  maestro {
 
                 long ret = 1;
 
+                if(dataflow->HasRecords()) {
+                    return GetPEMappedVolumeFromRecords(dataflow, coupled_dims, iter_status, is_first_pe, is_sp_edge_edge_pe);
+                }
+
                 int directive_idx = 0;
                 for(auto& directive : *dataflow) {
                     auto directive_class = directive->GetClass();
@@ -853,6 +857,32 @@ namespace  maestro {
                 return ret;
             }
 
+            /*
+             * Sum of the per-sub-cluster ingress volumes of an input tensor: data multicast to several
+             * sub-clusters counts once per receiver (GetSpatialIngressTraffic counts it once)
+             */
+            long GetSpatialDeliveredTraffic(
+                    std::shared_ptr<DFA::Tensor> input_tensor,
+                    std::shared_ptr<DFA::IterationStatus> iter_status
+            ) {
+                return SumOverActiveSubClusters(iter_status, [&](bool is_sp_edge_edge_pe) {
+                    return GetPEIngressVolume(input_tensor, iter_status, true, is_sp_edge_edge_pe);
+                });
+            }
+
+            /*
+             * Sum of the per-sub-cluster egress volumes of an output tensor: partial sums spatially reduced
+             * into one element count once per sender (GetSpatialEgressTraffic counts them once)
+             */
+            long GetSpatialSentTraffic(
+                    std::shared_ptr<DFA::Tensor> output_tensor,
+                    std::shared_ptr<DFA::IterationStatus> iter_status
+            ) {
+                return SumOverActiveSubClusters(iter_status, [&](bool is_sp_edge_edge_pe) {
+                    return GetPEEgressVolume(output_tensor, iter_status, false, true, is_sp_edge_edge_pe);
+                });
+            }
+
             long GetNumCriticalPathPartialSums(
                     std::shared_ptr<DFA::Tensor> output_tensor,
                     std::shared_ptr<DFA::IterationStatus> iter_status
@@ -1016,6 +1046,19 @@ namespace  maestro {
 
                 int prime_change_dim_directive_idx = -1;
 
+                if(dataflow->HasRecords()) {
+                    for(int idx = 0; idx < dataflow->size(); idx++) {
+                        auto& record = dataflow->GetRecord(idx);
+                        if(record.class_ == DFA::directive::DirectiveClass::TemporalMap || record.class_ == DFA::directive::DirectiveClass::SpatialMap) {
+                            auto iter_state = iter_status->GetIterState(DFA::GetDimensionName(record.dim_id_));
+                            if(iter_state->GetIterPosition() != DFA::IterationPosition::Init) {
+                                prime_change_dim_directive_idx = idx;
+                            }
+                        }
+                    }
+                    return prime_change_dim_directive_idx;
+                }
+
                 int idx = 0;
                 for(auto& directive : *dataflow) {
                     auto directive_class = directive->GetClass();
@@ -1052,6 +1095,25 @@ namespace  maestro {
 
                 bool tensor_inited = false;
 
+                if(dataflow->HasRecords()) {
+                    for(int directive_idx = changing_dim_idx + 1; directive_idx < dataflow->size(); directive_idx++) {
+                        auto& record = dataflow->GetRecord(directive_idx);
+                        if(record.class_ == DFA::directive::DirectiveClass::TemporalMap || record.class_ == DFA::directive::DirectiveClass::SpatialMap) {
+                            auto& dim = DFA::GetDimensionName(record.dim_id_);
+                            auto iter_state = iter_status->GetIterState(dim);
+                            bool is_coupled = std::find(coupled_dims->begin(), coupled_dims->end(), dim) != coupled_dims->end();
+
+                            if(iter_state->GetIterPosition() == DFA::IterationPosition::Init
+                               && is_coupled
+                               && !iter_state->IsUnrolled()) {
+                                tensor_inited = true;
+                                break;
+                            }
+                        }
+                    }
+                    return tensor_inited;
+                }
+
                 int directive_idx = 0;
                 for(auto& directive : *dataflow) {
                     auto directive_class = directive->GetClass();
@@ -1077,6 +1139,78 @@ namespace  maestro {
 
         private:
 
+            // Sum of a per-sub-cluster volume over the sub-clusters active in this iteration
+            template<typename VolumeFunc>
+            long SumOverActiveSubClusters(std::shared_ptr<DFA::IterationStatus> iter_status, VolumeFunc sub_cluster_volume) {
+                std::shared_ptr<DFA::IterationState> sp_iter_state = nullptr;
+                for(auto& directive : *target_cluster_->GetDataflow()) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap) {
+                        sp_iter_state = iter_status->GetIterState(directive->GetVariable());
+                        break;
+                    }
+                }
+
+                if(sp_iter_state == nullptr) {
+                    return sub_cluster_volume(false);
+                }
+                if(!sp_iter_state->IsEdge()) {
+                    return target_cluster_->GetNumClusters(false) * sub_cluster_volume(false);
+                }
+
+                long num_edge_clusters = target_cluster_->GetNumClusters(true);
+                if(sp_iter_state->HasSpEdgeEdge()) {
+                    return (num_edge_clusters - 1) * sub_cluster_volume(false) + sub_cluster_volume(true);
+                }
+                return num_edge_clusters * sub_cluster_volume(false);
+            }
+
+            // GetPEMappedVolume over the flat directive records; avoids copying dimension names per directive
+            long GetPEMappedVolumeFromRecords(
+                    std::shared_ptr<DFA::DirectiveTable> dataflow,
+                    std::shared_ptr<std::list<std::string>> coupled_dims,
+                    std::shared_ptr<DFA::IterationStatus> iter_status,
+                    bool is_first_pe,
+                    bool is_sp_edge_edge_pe) {
+                long ret = 1;
+
+                for(int directive_idx = 0; directive_idx < dataflow->size(); directive_idx++) {
+                    auto& record = dataflow->GetRecord(directive_idx);
+                    if(record.class_ != DFA::directive::DirectiveClass::TemporalMap && record.class_ != DFA::directive::DirectiveClass::SpatialMap) {
+                        continue;
+                    }
+
+                    auto& dim = DFA::GetDimensionName(record.dim_id_);
+                    if(std::find(coupled_dims->begin(), coupled_dims->end(), dim) == coupled_dims->end()) {
+                        continue;
+                    }
+
+                    auto iter_state = iter_status->GetIterState(dim);
+                    if(!iter_state->IsEdge()) {
+                        ret *= (*num_mapped_elements_)[dim];
+                    }
+                    else if(record.class_ == DFA::directive::DirectiveClass::TemporalMap) {
+                        ret *= (*num_mapped_elements_edge_)[dim];
+                    }
+                    else {
+                        int num_active_clusters = target_cluster_->GetNumClusters(true);
+
+                        if(num_active_clusters == 1 && (is_first_pe  || is_sp_edge_edge_pe)) {
+                            ret *= (*num_mapped_elements_edge_)[dim];
+                        }
+                        else if (num_active_clusters > 1) {
+                            if(is_sp_edge_edge_pe) {
+                                ret *= (*num_mapped_elements_edge_)[dim];
+                            }
+                            else {
+                                ret *= (*num_mapped_elements_)[dim];
+                            }
+                        }
+                    }
+                }
+
+                return ret;
+            }
+
             void AnalyzeInputMappingSizes(std::shared_ptr<DFA::ClusterUnit> target_cluster) {
                 auto dataflow = target_cluster->GetDataflow();
                 auto dimensions = target_cluster->GetDimensions();
@@ -0,0 +1,635 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_CA_ROOFLINE_ANALYSIS_HPP_
+#define MAESTRO_CA_ROOFLINE_ANALYSIS_HPP_
+
+#include <memory>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "BASE_constants.hpp"
+#include "BASE_maestro-class.hpp"
+
+#include "AHW_noc-model.hpp"
+#include "AHW_offchip-memory-model.hpp"
+
+#include "DFA_tensor.hpp"
+#include "DFA_tensor-table.hpp"
+#include "DFA_dimension-table.hpp"
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_cluster-unit.hpp"
+#include "DFA_cluster-table.hpp"
+#include "DFA_sparsity.hpp"
+
+#include "CA_analysis-types.hpp"
+#include "CA_cost-analysis-results.hpp"
+#include "CA_offchip-access.hpp"
+
+#include "API_configuration.hpp"
+
+namespace maestro {
+    namespace CA {
+
+        /*
+         * Fast approximate counterpart of CostAnalysisEngine with the same result interface
+         * (one CostAnalysisResults per cluster level, innermost level first).
+         *
+         * Instead of enumerating every iteration case, each cluster level is analyzed with its
+         * steady-state tile only: a tensor is re-fetched whenever one of its coupled loops advances
+         * (sliding windows only fetch the new rows/columns), and the level runtime is the roofline of
+         * the sub-cluster compute, the NoC transfers (NetworkOnChipModel) and, at the uppermost level,
+         * the off-chip transfers. Edge tiles are treated as full tiles.
+         */
+        class RooflineAnalysisEngine : public MAESTROClass {
+        public:
+            RooflineAnalysisEngine(
+                    std::shared_ptr<ConfigurationV2> configs,
+                    std::shared_ptr<DFA::TensorTable> tensors,
+                    std::shared_ptr<DFA::ClusterTable> clusters) :
+                    MAESTROClass("RooflineAnalysis"),
+                    configs_(configs),
+                    tensors_(tensors),
+                    clusters_(clusters),
+                    num_simd_lanes_(configs->target_accelerator_->GetVectorWidth()),
+                    offchip_memory_(configs->GetOffchipMemoryModel()) {
+            }
+
+            std::shared_ptr<std::vector<std::shared_ptr<CostAnalysisResults>>>
+            AnalyzeEntireCluster(bool write_log_file = false) {
+                auto ret = std::make_shared<std::vector<std::shared_ptr<CostAnalysisResults>>>();
+
+                // Innermost level first, as the sub-cluster results feed the upper level
+                std::shared_ptr<CostAnalysisResults> sub_cluster_results = nullptr;
+                for(int cluster_idx = clusters_->size() - 1; cluster_idx >= 0; cluster_idx--) {
+                    auto results = AnalyzeClusterLevel(cluster_idx, sub_cluster_results);
+                    sub_cluster_results = results;
+                    ret->push_back(results);
+                }
+
+                if(write_log_file) {
+                    WriteLog(ret);
+                }
+
+                return ret;
+            }
+
+            // A tensor class kept in L2 across layers (fused with the adjacent layer) is not moved off-chip
+            void SetL2Resident(DataClass data_class, bool is_resident) {
+                l2_resident_[static_cast<int>(data_class)] = is_resident;
+            }
+
+            void SetElementBitSize(int element_bit_size) {
+                element_bit_size_ = element_bit_size;
+            }
+
+            // See CostAnalysisEngine::SetReductionMode
+            void SetReductionMode(ReductionMode reduction_mode) {
+                reduction_mode_ = reduction_mode;
+            }
+
+            /*
+             * See CostAnalysisEngine::SetTensorBuffering. All iterations of a level are alike here, so buffers
+             * beyond double buffering only add footprint.
+             */
+            void SetTensorBuffering(TensorBuffering buffering) {
+                buffering_ = buffering;
+            }
+
+            // Sparsity of the analyzed layer (nullptr for a dense layer); see CostAnalysisEngine::SetSparsity
+            void SetSparsity(std::shared_ptr<DFA::LayerSparsity> sparsity, int element_bit_size) {
+                sparsity_ = sparsity;
+                for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                    footprint_factor_[i] = (sparsity == nullptr) ? 1.0 :
+                                           sparsity->GetFootprintFactor(static_cast<DataClass>(i), element_bit_size);
+                }
+
+                num_base_clusters_ = 1;
+                for(int cluster_idx = 0; cluster_idx < clusters_->size() - 1; cluster_idx++) {
+                    num_base_clusters_ *= std::max(clusters_->GetCluster(cluster_idx)->GetNumClusters(), 1L);
+                }
+            }
+
+        protected:
+            std::shared_ptr<ConfigurationV2> configs_;
+            std::shared_ptr<DFA::TensorTable> tensors_;
+            std::shared_ptr<DFA::ClusterTable> clusters_;
+            int num_simd_lanes_;
+            std::shared_ptr<AHW::OffchipMemoryModel> offchip_memory_;
+            int element_bit_size_ = 32;
+            bool l2_resident_[static_cast<int>(DataClass::NumDataClasses)] = {false};
+
+            std::shared_ptr<DFA::LayerSparsity> sparsity_ = nullptr;
+            double footprint_factor_[static_cast<int>(DataClass::NumDataClasses)] = {1.0, 1.0, 1.0};
+            long num_base_clusters_ = 1;
+
+            ReductionMode reduction_mode_ = ReductionMode::Implicit;
+            TensorBuffering buffering_;
+
+        private:
+            // Appends the steady-state estimate of every level to log.txt, like CostAnalysisEngine
+            void WriteLog(std::shared_ptr<std::vector<std::shared_ptr<CostAnalysisResults>>> results) {
+                std::ofstream log_file("log.txt", std::fstream::out | std::fstream::app);
+                for(int cluster_idx = 0; cluster_idx < clusters_->size(); cluster_idx++) {
+                    auto target_cluster = clusters_->GetCluster(cluster_idx);
+                    auto& level_results = results->at(clusters_->size() - 1 - cluster_idx);
+
+                    log_file << "=======================" << std::endl;
+                    log_file << "Roofline log for cluster level " << cluster_idx << std::endl;
+                    log_file << "=======================" << std::endl;
+                    log_file << "Num sub clusters: " << target_cluster->GetNumClusters() << std::endl;
+                    log_file << "Cluster tile size" << std::endl;
+                    log_file << target_cluster->GetDimensions()->ToString() << std::endl;
+                    log_file << "Cluster Dataflow" << std::endl;
+                    log_file << target_cluster->GetDataflow()->ToString() << std::endl;
+                    log_file << "Runtime: " << level_results->GetRuntime() << std::endl;
+                    log_file << "Number of MACs: " << level_results->GetNumComputations() << std::endl;
+                }
+            }
+
+            class LoopInfo {
+            public:
+                std::string dim_;
+                bool is_spatial_ = false;
+                long map_size_ = 1;
+                long map_ofs_ = 1;
+                long num_trips_ = 1;
+            };
+
+            // sub_cluster_results: results of the level below (nullptr for the base cluster)
+            std::shared_ptr<CostAnalysisResults> AnalyzeClusterLevel(int cluster_idx, std::shared_ptr<CostAnalysisResults> sub_cluster_results) {
+                long sub_cluster_runtime = (sub_cluster_results == nullptr) ? 0 : sub_cluster_results->GetRuntime();
+                long sub_cluster_reduction_traffic = (sub_cluster_results == nullptr) ? 0 : sub_cluster_results->GetReductionTraffic();
+                auto target_cluster = clusters_->GetCluster(cluster_idx);
+                auto dimensions = target_cluster->GetDimensions();
+                auto dataflow = target_cluster->GetDataflow();
+                auto noc = target_cluster->GetNoCModel();
+                bool is_base_cluster = (cluster_idx == clusters_->size() - 1);
+                long num_sub_clusters = std::max(target_cluster->GetNumClusters(), 1L);
+
+                auto results = std::make_shared<CostAnalysisResults>(clusters_->GetLayerType(), cluster_idx);
+                results->UpdateNumSubClusters(num_sub_clusters);
+
+                /* Loop nest of this level (outermost first) and the tile of one sub-cluster */
+                std::vector<LoopInfo> loops;
+                std::map<std::string, long> tile_sizes;
+                long num_active_sub_clusters = 1;
+                for(auto& directive : *dataflow) {
+                    auto directive_class = directive->GetClass();
+                    if(directive_class != DFA::directive::DirectiveClass::TemporalMap
+                       && directive_class != DFA::directive::DirectiveClass::SpatialMap) {
+                        continue;
+                    }
+
+                    LoopInfo loop;
+                    loop.dim_ = directive->GetVariable();
+                    loop.is_spatial_ = (directive_class == DFA::directive::DirectiveClass::SpatialMap);
+
+                    long dim_size = dimensions->GetSize(loop.dim_);
+                    loop.map_size_ = std::max(std::min(static_cast<long>(directive->GetSize()), dim_size), 1L);
+                    loop.map_ofs_ = std::max(static_cast<long>(directive->GetOfs()), 1L);
+
+                    long num_positions = (dim_size <= loop.map_size_) ?
+                                         1 : (dim_size - loop.map_size_ + loop.map_ofs_ - 1) / loop.map_ofs_ + 1;
+                    if(loop.is_spatial_) {
+                        loop.num_trips_ = (num_positions + num_sub_clusters - 1) / num_sub_clusters;
+                        num_active_sub_clusters = std::max(num_active_sub_clusters,
+                                                           (num_positions + loop.num_trips_ - 1) / loop.num_trips_);
+                    }
+                    else {
+                        loop.num_trips_ = num_positions;
+                    }
+
+                    tile_sizes[loop.dim_] = loop.map_size_;
+                    loops.push_back(loop);
+                }
+
+                long num_iterations = 1;
+                for(auto& loop : loops) {
+                    num_iterations *= loop.num_trips_;
+                }
+
+                auto input_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::InputTensor);
+                auto output_tensors = tensors_->GetTensorsInClass(DFA::TensorClass::OutputTensor);
+
+                /* Computation */
+                // As in CostAnalysisEngine, the base cluster processes the partial sums of all its units on the SIMD lanes
+                long num_tile_macs = GetNumMACs(dimensions, tile_sizes);
+                long computation_delay = is_base_cluster ?
+                                         static_cast<long>(std::ceil(static_cast<double>(num_active_sub_clusters * num_tile_macs) / num_simd_lanes_))
+                                         : sub_cluster_runtime;
+                long num_computations = num_iterations * num_active_sub_clusters * num_tile_macs;
+                if(sparsity_ != nullptr) {
+                    // Only the effectual MACs are computed, and the slowest base cluster sets the pace
+                    if(is_base_cluster) {
+                        double mac_fraction = sparsity_->GetImbalancedMACFraction(num_active_sub_clusters * num_tile_macs, num_base_clusters_);
+                        computation_delay = static_cast<long>(std::ceil(static_cast<double>(num_active_sub_clusters * num_tile_macs)
+                                                                        * mac_fraction / num_simd_lanes_));
+                    }
+                    num_computations = static_cast<long>(std::ceil(static_cast<double>(num_computations) * sparsity_->GetEffectualMACFraction()));
+                }
+                results->UpdateNumComputations(num_computations);
+
+                /* Data movement between this level's buffer and its sub-clusters */
+                long first_ingress_traffic = 0;
+                long total_ingress_traffic = 0;
+                long first_offchip_ingress_traffic = 0;
+                // Volumes arriving at the sub-clusters, counting every multicast copy
+                long first_delivered_traffic = 0;
+                long total_delivered_traffic = 0;
+                // Part of the above of the single-buffered tensors, whose transfers stall the computation
+                long serial_first_ingress_traffic = 0;
+                long serial_ingress_traffic = 0;
+                long serial_first_delivered_traffic = 0;
+                long serial_delivered_traffic = 0;
+                std::vector<AHW::OffchipAccessStream> serial_offchip_ingress_streams;
+                // Operands one unit reads from its own buffer per iteration (base cluster)
+                long unit_operand_size = 0;
+                std::vector<AHW::OffchipAccessStream> offchip_ingress_streams;
+                for(auto& tensor : *input_tensors) {
+                    auto data_class = tensor->GetDataClass();
+                    bool is_resident = cluster_idx == 0 && l2_resident_[static_cast<int>(data_class)];
+                    int buffer_size_mult = buffering_.GetDepth(data_class);
+                    bool is_serial = !buffering_.IsOverlapped(data_class);
+                    // Inputs and weights are held and moved in their compressed formats
+                    long tile_volume = GetCompressedSize(GetTileVolume(tensor, dimensions, tile_sizes, false), data_class);
+                    long first_traffic = GetSpatialTraffic(tensor, loops, tile_volume, num_active_sub_clusters,
+                                                           noc->IsMulticastSupported(), false);
+                    double num_fetched_tiles = GetNumFetchedTiles(tensor, loops, false);
+
+                    long traffic = static_cast<long>(static_cast<double>(first_traffic) * num_fetched_tiles);
+                    first_ingress_traffic += first_traffic;
+                    total_ingress_traffic += traffic;
+                    first_offchip_ingress_traffic += is_resident ? 0 : first_traffic;
+                    if(cluster_idx == 0) {
+                        (is_serial ? serial_offchip_ingress_streams : offchip_ingress_streams).push_back(
+                                GetOffchipStream(tensor, is_resident ? 0 : first_traffic, dimensions, dataflow, num_sub_clusters));
+                    }
+
+                    results->UpdateBufferSizeReq(BufferType::Upstream, buffer_size_mult * first_traffic, data_class);
+                    results->UpdateBufferSizeReq(BufferType::Downstream, buffer_size_mult * tile_volume, data_class);
+                    results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, traffic, data_class);
+                    results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, is_resident ? 0 :
+                                                     GetCompressedSize(GetTileVolume(tensor, dimensions, GetDimSizes(dimensions), false), data_class), data_class);
+                    results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write, traffic, data_class);
+                    // Multicast data reaches every sub-cluster, including the ones idle in edge iterations
+                    long num_reading_sub_clusters = IsSpatiallyCoupled(tensor, loops) ? num_active_sub_clusters : num_sub_clusters;
+                    results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read,
+                                                     num_iterations * num_reading_sub_clusters * tile_volume, data_class);
+
+                    long first_delivered = std::max(num_reading_sub_clusters * tile_volume, first_traffic);
+                    first_delivered_traffic += first_delivered;
+                    total_delivered_traffic += static_cast<long>(static_cast<double>(first_delivered) * num_fetched_tiles);
+                    unit_operand_size += tile_volume;
+                    if(is_serial) {
+                        serial_first_ingress_traffic += first_traffic;
+                        serial_ingress_traffic += traffic;
+                        serial_first_delivered_traffic += first_delivered;
+                        serial_delivered_traffic += static_cast<long>(static_cast<double>(first_delivered) * num_fetched_tiles);
+                    }
+                }
+
+                long first_egress_traffic = 0;
+                long total_egress_traffic = 0;
+                long first_offchip_egress_traffic = 0;
+                // Volume leaving the sub-clusters, before spatial reduction
+                long total_sent_traffic = 0;
+                std::vector<AHW::OffchipAccessStream> offchip_egress_streams;
+                std::vector<AHW::OffchipAccessStream> serial_offchip_egress_streams;
+                bool is_serial_output = !buffering_.IsOverlapped(DataClass::Output);
+                for(auto& tensor : *output_tensors) {
+                    auto data_class = tensor->GetDataClass();
+                    bool is_resident = cluster_idx == 0 && l2_resident_[static_cast<int>(data_class)];
+                    int buffer_size_mult = buffering_.GetDepth(data_class);
+                    long tile_volume = GetTileVolume(tensor, dimensions, tile_sizes, true);
+                    // Partial sums of sub-clusters that only differ in reduction dimensions are reduced on the way out
+                    long first_traffic = GetSpatialTraffic(tensor, loops, tile_volume, num_active_sub_clusters, true, true);
+                    double num_fetched_tiles = GetNumFetchedTiles(tensor, loops, true);
+
+                    long traffic = static_cast<long>(static_cast<double>(first_traffic) * num_fetched_tiles);
+                    first_egress_traffic += first_traffic;
+                    total_egress_traffic += traffic;
+                    // Outputs are compressed on the way off-chip
+                    first_offchip_egress_traffic += is_resident ? 0 : GetCompressedSize(first_traffic, data_class);
+                    if(cluster_idx == 0) {
+                        (is_serial_output ? serial_offchip_egress_streams : offchip_egress_streams).push_back(
+                                GetOffchipStream(tensor, is_resident ? 0 : GetCompressedSize(first_traffic, data_class),
+                                                 dimensions, dataflow, num_sub_clusters));
+                    }
+
+                    results->UpdateBufferSizeReq(BufferType::Upstream, buffer_size_mult * first_traffic, data_class);
+                    results->UpdateBufferSizeReq(BufferType::Downstream, buffer_size_mult * tile_volume, data_class);
+                    results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Write, traffic, data_class);
+                    results->UpdateBufferAccessCount(BufferType::Upstream, BufferAccessType::Read, is_resident ? 0 :
+                                                     GetCompressedSize(GetTileVolume(tensor, dimensions, GetDimSizes(dimensions), true), data_class), data_class);
+                    results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Write,
+                                                     num_iterations * num_active_sub_clusters * tile_volume, data_class);
+                    results->UpdateBufferAccessCount(BufferType::Downstream, BufferAccessType::Read,
+                                                     num_iterations * num_active_sub_clusters * tile_volume, data_class);
+
+                    total_sent_traffic += static_cast<long>(static_cast<double>(num_active_sub_clusters * tile_volume) * num_fetched_tiles);
+                    unit_operand_size += tile_volume;
+                }
+
+                // Accesses below this level's sub-clusters; see CostAnalysisResults::GetHierarchyAccessCount
+                for(auto access_type : {BufferAccessType::Read, BufferAccessType::Write}) {
+                    long num_accesses = 0;
+                    for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                        num_accesses += results->GetBufferAccessCount(BufferType::Downstream, access_type, static_cast<DataClass>(i));
+                    }
+                    results->UpdateHierarchyAccessCount(1, access_type, num_accesses);
+                    for(int depth = 2; sub_cluster_results != nullptr && depth <= max_hierarchy_depth; depth++) {
+                        results->UpdateHierarchyAccessCount(depth, access_type, num_iterations * num_active_sub_clusters
+                                                            * sub_cluster_results->GetHierarchyAccessCount(depth - 1, access_type));
+                    }
+                }
+                if(is_base_cluster) {
+                    computation_delay = std::max(computation_delay,
+                                                 configs_->GetBufferPortDelay(clusters_->size(), clusters_->size(), unit_operand_size));
+                }
+
+                /* Roofline over compute, NoC, and off-chip transfers */
+                long avg_ingress_traffic = total_ingress_traffic / num_iterations;
+                long avg_egress_traffic = total_egress_traffic / num_iterations;
+                // Both bounded by the bandwidth of this level's upstream buffer
+                auto ingress_delay_func = [&](long traffic, long delivered) {
+                    long delay = (traffic > 0) ? noc->GetIngressDelay(traffic, delivered, num_sub_clusters) : 0;
+                    return std::max(delay, configs_->GetBufferPortDelay(cluster_idx, clusters_->size(), traffic));
+                };
+                auto egress_delay_func = [&](long traffic, long sent) {
+                    long delay = (traffic > 0) ? noc->GetEgressDelay(traffic, sent, num_sub_clusters) : 0;
+                    return std::max(delay, configs_->GetBufferPortDelay(cluster_idx, clusters_->size(), traffic));
+                };
+                long ingress_comm_delay = ingress_delay_func((total_ingress_traffic - serial_ingress_traffic) / num_iterations,
+                                                             (total_delivered_traffic - serial_delivered_traffic) / num_iterations);
+                long serial_ingress_comm_delay = ingress_delay_func(serial_ingress_traffic / num_iterations,
+                                                                    serial_delivered_traffic / num_iterations);
+                long egress_comm_delay = egress_delay_func(avg_egress_traffic, total_sent_traffic / num_iterations);
+                long serial_egress_comm_delay = 0;
+                if(is_serial_output) {
+                    std::swap(egress_comm_delay, serial_egress_comm_delay);
+                }
+
+                // Explicit reduction of the partial sums the sub-clusters produce for the same outputs
+                long reduction_delay = 0;
+                long avg_sent_traffic = total_sent_traffic / num_iterations;
+                long reduction_traffic = num_iterations * num_active_sub_clusters * sub_cluster_reduction_traffic;
+                if(reduction_mode_ != ReductionMode::Implicit && avg_sent_traffic > avg_egress_traffic && avg_egress_traffic > 0) {
+                    long fan_in = (avg_sent_traffic + avg_egress_traffic - 1) / avg_egress_traffic;
+                    long tree_latency = noc->GetReductionTreeLatency(fan_in);
+                    long issue_delay = noc->GetReductionIssueDelay(avg_egress_traffic);
+                    reduction_delay = (reduction_mode_ == ReductionMode::CoarseGrainedSync) ?
+                                      tree_latency + issue_delay : tree_latency + std::max(issue_delay - computation_delay, 0L);
+                    reduction_traffic += std::max(total_sent_traffic - total_egress_traffic, 0L);
+                }
+                results->UpdateReductionTraffic(reduction_traffic);
+
+                // Transfers of single-buffered tensors stall the computation; the others overlap it
+                long stalled_delay = computation_delay + reduction_delay + serial_ingress_comm_delay + serial_egress_comm_delay;
+                long ingress_offchip_delay = 0;
+                long egress_offchip_delay = 0;
+                long bound_delay[static_cast<int>(BoundType::NumBoundTypes)] = {};
+                bound_delay[static_cast<int>(BoundType::Computation)] = computation_delay;
+                bound_delay[static_cast<int>(BoundType::Reduction)] = reduction_delay;
+                bound_delay[static_cast<int>(BoundType::Ingress)] = serial_ingress_comm_delay;
+                bound_delay[static_cast<int>(BoundType::Egress)] = serial_egress_comm_delay;
+                if(cluster_idx == 0) {
+                    // Per-iteration refill of the multi-buffered uppermost buffer from off-chip memory
+                    long serial_ingress_offchip_delay = 0;
+                    long serial_egress_offchip_delay = 0;
+                    GetOffchipDelays(offchip_ingress_streams, offchip_egress_streams, ingress_offchip_delay, egress_offchip_delay);
+                    GetOffchipDelays(serial_offchip_ingress_streams, serial_offchip_egress_streams,
+                                     serial_ingress_offchip_delay, serial_egress_offchip_delay);
+                    stalled_delay += serial_ingress_offchip_delay + serial_egress_offchip_delay;
+                    bound_delay[static_cast<int>(BoundType::Offchip)] = serial_ingress_offchip_delay + serial_egress_offchip_delay;
+
+                    long offchip_bw_req = std::max(first_offchip_ingress_traffic, first_offchip_egress_traffic)
+                                          / std::max(computation_delay, 1L);
+                    results->UpdateOffchipBWReq(offchip_bw_req);
+                }
+                long steady_delay = std::max(stalled_delay, std::max(ingress_comm_delay, egress_comm_delay));
+                steady_delay = std::max(steady_delay, std::max(ingress_offchip_delay, egress_offchip_delay));
+
+                // The first iteration cannot hide the ingress transfers of the multi-buffered tensors
+                long overlapped_first_ingress_traffic = first_ingress_traffic - serial_first_ingress_traffic;
+                long first_ingress_delay = (overlapped_first_ingress_traffic > 0) ?
+                        noc->GetIngressDelay(overlapped_first_ingress_traffic, first_delivered_traffic - serial_first_delivered_traffic, num_sub_clusters) : 0;
+                long runtime = first_ingress_delay + num_iterations * steady_delay;
+                results->UpdateRuntime(runtime, EstimationType::Exact);
+
+                // An overlapped transfer that outruns the stalled part bounds the whole iteration
+                if(steady_delay > stalled_delay) {
+                    std::fill(bound_delay, bound_delay + static_cast<int>(BoundType::NumBoundTypes), 0L);
+                    long overlapped_delays[] = {ingress_comm_delay, egress_comm_delay, ingress_offchip_delay, egress_offchip_delay};
+                    BoundType overlapped_bounds[] = {BoundType::Ingress, BoundType::Egress, BoundType::Offchip, BoundType::Offchip};
+                    int max_idx = std::max_element(overlapped_delays, overlapped_delays + 4) - overlapped_delays;
+                    bound_delay[static_cast<int>(overlapped_bounds[max_idx])] = steady_delay;
+                }
+                double bound_cycles[static_cast<int>(BoundType::NumBoundTypes)] = {};
+                bound_cycles[static_cast<int>(BoundType::Ingress)] = first_ingress_delay;
+                AttributeBoundCycles(static_cast<double>(num_iterations) * steady_delay, bound_delay, sub_cluster_results, bound_cycles);
+                results->UpdateBoundCycles(bound_cycles);
+                results->UpdateRuntime(runtime, EstimationType::Min);
+                results->UpdateRuntime(runtime, EstimationType::Max);
+
+                long safe_computation_delay = std::max(computation_delay, 1L);
+                results->UpdatePeakBWReq(std::max(first_ingress_traffic, first_egress_traffic) / safe_computation_delay);
+                results->UpdateAvgBWReq(static_cast<double>(std::max(avg_ingress_traffic, avg_egress_traffic)) / safe_computation_delay);
+                results->SetNumAvgActiveClusters(num_active_sub_clusters);
+                if(first_ingress_traffic > 0) {
+                    results->SetArithmeticIntensity(static_cast<double>(num_active_sub_clusters * num_tile_macs) / first_ingress_traffic);
+                }
+
+                for(auto val_type : {ValueType::Min, ValueType::Max, ValueType::Avg}) {
+                    results->UpdateDelay(DelayType::Ingress, val_type, ingress_comm_delay + serial_ingress_comm_delay);
+                    results->UpdateDelay(DelayType::Egress, val_type, egress_comm_delay + serial_egress_comm_delay);
+                    results->UpdateDelay(DelayType::Computation, val_type, computation_delay);
+                    results->UpdateDelay(DelayType::Reduction, val_type, reduction_delay);
+                }
+
+                return results;
+            }
+
+            std::map<std::string, long> GetDimSizes(std::shared_ptr<DFA::DimensionTable> dimensions) {
+                std::map<std::string, long> ret;
+                for(auto& dim : *dimensions) {
+                    ret[dim->GetName()] = dim->GetSize();
+                }
+                return ret;
+            }
+
+            long GetTileSize(std::shared_ptr<DFA::DimensionTable> dimensions, std::map<std::string, long>& tile_sizes,
+                             std::string dim) {
+                if(tile_sizes.find(dim) != tile_sizes.end()) {
+                    return tile_sizes[dim];
+                }
+                return dimensions->GetSize(dim);
+            }
+
+            // Output tensors are indexed by output positions along sliding (overlapped) dimensions
+            long GetOutputExtent(std::shared_ptr<DFA::DimensionTable> dimensions, std::map<std::string, long>& tile_sizes,
+                                 std::string dim) {
+                long extent = GetTileSize(dimensions, tile_sizes, dim);
+                if(dimensions->IsOverlapped(dim) && !dimensions->IsSlidingDim(dim)) {
+                    long window_size = GetTileSize(dimensions, tile_sizes, dimensions->GetOverlappingDim(dim));
+                    long outer_stride = std::max(dimensions->GetOuterStride(dim), 1);
+                    extent = std::max((extent - window_size + outer_stride) / outer_stride, 1L);
+                }
+                return extent;
+            }
+
+            long GetTileVolume(std::shared_ptr<DFA::Tensor> tensor, std::shared_ptr<DFA::DimensionTable> dimensions,
+                               std::map<std::string, long> tile_sizes, bool is_output) {
+                long ret = 1;
+                for(auto& dim : *tensor->GetCoupledVariables()) {
+                    if(!dimensions->HasVar(dim)) {
+                        continue;
+                    }
+                    ret *= is_output ? GetOutputExtent(dimensions, tile_sizes, dim) : GetTileSize(dimensions, tile_sizes, dim);
+                }
+                return ret;
+            }
+
+            // MACs of one tile; sliding dimensions contribute their output positions
+            AHW::OffchipAccessStream GetOffchipStream(std::shared_ptr<DFA::Tensor> tensor, long num_elements,
+                                                      std::shared_ptr<DFA::DimensionTable> dimensions,
+                                                      std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                                      long num_sub_clusters) {
+                AHW::OffchipAccessStream stream;
+                stream.num_elements_ = num_elements;
+                stream.run_length_ = GetOffchipRunLength(tensor, dimensions, dataflow, num_sub_clusters);
+                stream.element_bit_size_ = element_bit_size_;
+                stream.is_write_ = (tensor->GetDataClass() == DataClass::Output);
+                return stream;
+            }
+
+            long GetCompressedSize(long num_elements, DataClass data_class) {
+                double factor = footprint_factor_[static_cast<int>(data_class)];
+                if(factor >= 1.0) {
+                    return num_elements;
+                }
+                return static_cast<long>(std::ceil(static_cast<double>(num_elements) * factor));
+            }
+
+            long GetNumMACs(std::shared_ptr<DFA::DimensionTable> dimensions, std::map<std::string, long>& tile_sizes) {
+                std::set<std::string> dims;
+                for(auto& tensor : *tensors_) {
+                    for(auto& dim : *tensor->GetCoupledVariables()) {
+                        if(dimensions->HasVar(dim)) {
+                            dims.insert(dim);
+                        }
+                    }
+                }
+
+                long ret = 1;
+                for(auto& dim : dims) {
+                    ret *= GetOutputExtent(dimensions, tile_sizes, dim);
+                }
+                return ret;
+            }
+
+            bool IsCoupled(std::shared_ptr<DFA::Tensor> tensor, std::string dim) {
+                auto coupled_vars = tensor->GetCoupledVariables();
+                return std::find(coupled_vars->begin(), coupled_vars->end(), dim) != coupled_vars->end();
+            }
+
+            bool IsSpatiallyCoupled(std::shared_ptr<DFA::Tensor> tensor, std::vector<LoopInfo>& loops) {
+                for(auto& loop : loops) {
+                    if(loop.is_spatial_ && IsCoupled(tensor, loop.dim_)) {
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            /*
+             * Data sent to (or received from) all active sub-clusters in one iteration. Sub-clusters share
+             * the data of uncoupled spatial dimensions if the NoC multicasts, and the overlapped part of
+             * sliding windows mapped across them. Output tiles (in output positions) never overlap.
+             */
+            long GetSpatialTraffic(std::shared_ptr<DFA::Tensor> tensor, std::vector<LoopInfo>& loops, long tile_volume,
+                                   long num_active_sub_clusters, bool is_multicast_supported, bool is_output) {
+                for(auto& loop : loops) {
+                    if(loop.is_spatial_ && IsCoupled(tensor, loop.dim_)) {
+                        if(is_output) {
+                            return tile_volume * num_active_sub_clusters;
+                        }
+                        long spatial_extent = (num_active_sub_clusters - 1) * std::min(loop.map_ofs_, loop.map_size_) + loop.map_size_;
+                        return tile_volume / loop.map_size_ * spatial_extent;
+                    }
+                }
+                return is_multicast_supported ? tile_volume : tile_volume * num_active_sub_clusters;
+            }
+
+            /*
+             * Number of (full-tile equivalent) fetches over the loop nest: a tile is re-fetched every time
+             * a loop at or above its innermost advancing coupled loop advances. If that loop slides over an
+             * overlapping dimension, only the non-overlapped part of an input tile is fetched on its advances.
+             */
+            double GetNumFetchedTiles(std::shared_ptr<DFA::Tensor> tensor, std::vector<LoopInfo>& loops, bool is_output) {
+                int innermost_coupled_idx = -1;
+                for(int idx = 0; idx < loops.size(); idx++) {
+                    if(loops[idx].num_trips_ > 1 && IsCoupled(tensor, loops[idx].dim_)) {
+                        innermost_coupled_idx = idx;
+                    }
+                }
+                if(innermost_coupled_idx < 0) {
+                    return 1;
+                }
+
+                double num_outer_trips = 1;
+                for(int idx = 0; idx < innermost_coupled_idx; idx++) {
+                    num_outer_trips *= loops[idx].num_trips_;
+                }
+
+                auto& innermost_loop = loops[innermost_coupled_idx];
+                double new_data_ratio = 1.0;
+                if(!is_output && innermost_loop.map_ofs_ < innermost_loop.map_size_) {
+                    new_data_ratio = static_cast<double>(innermost_loop.map_ofs_) / innermost_loop.map_size_;
+                }
+
+                return num_outer_trips * (1 + (innermost_loop.num_trips_ - 1) * new_data_ratio);
+            }
+
+            // Off-chip delays of one iteration; see CostAnalysisEngine::GetOffchipDelays
+            void GetOffchipDelays(std::vector<AHW::OffchipAccessStream> ingress_streams,
+                                  std::vector<AHW::OffchipAccessStream> egress_streams,
+                                  long& ingress_delay, long& egress_delay) {
+                ingress_delay = offchip_memory_->GetTransferDelay(ingress_streams);
+                egress_delay = offchip_memory_->GetTransferDelay(egress_streams);
+                if(offchip_memory_->IsHalfDuplex()) {
+                    ingress_streams.insert(ingress_streams.end(), egress_streams.begin(), egress_streams.end());
+                    ingress_delay = offchip_memory_->GetTransferDelay(ingress_streams);
+                    egress_delay = 0;
+                }
+            }
+        }; // End of class RooflineAnalysisEngine
+    }; // End of namespace CA
+}; // End of namespace maestro
+
+#endif
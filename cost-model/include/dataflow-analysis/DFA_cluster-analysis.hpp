@@ -136,8 +136,8 @@ namespace maestro {
                         case directive::DirectiveClass::Cluster: {
                             // Get NoC setting for this cluster
                             if(nocs_->size() < current_cluster_level) {
-                                error_handler->PrintErrorMsg(TL::ErrorCode::MissingNoCForCluster, std::to_string(current_cluster_level) ,this->GetName());
-                                error_handler->TerminateProgram();
+                                error_handler_->PrintErrorMsg(TL::ErrorCode::MissingNoCForCluster, std::to_string(current_cluster_level) ,this->GetName());
+                                error_handler_->TerminateProgram();
                             }
                             std::shared_ptr<AHW::NetworkOnChipModel> noc = nocs_->at(current_cluster_level);
 
@@ -200,7 +200,7 @@ namespace maestro {
                         } // End of case Cluster
                             break;
                         default: {
-                            error_handler->PrintErrorMsg(TL::ErrorCode::InvalidDirective,"", instance_name_);
+                            error_handler_->PrintErrorMsg(TL::ErrorCode::InvalidDirective,"", instance_name_);
                         }
                     }// End of switch(directive->GetClass)
                 } // End of for-each directive in full_dataflow
@@ -66,6 +66,7 @@ namespace maestro {
                 num_mapped_elements_ = std::make_unique<std::map<std::string, int>>();
                 dataflow->ConvertToInputCentric();
                 Preprocess();
+                dataflow->BuildRecords();
             }
 
             int GetClusterLevel() {
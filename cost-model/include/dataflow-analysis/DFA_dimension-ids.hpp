@@ -0,0 +1,71 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_DFA_DIMENSION_IDS_HPP_
+#define MAESTRO_DFA_DIMENSION_IDS_HPP_
+
+#include <string>
+
+#include "DFSL_syntax_tokens.hpp"
+
+namespace maestro {
+    namespace DFA {
+        /*
+         * Dense ids of the DFSL dimension names, used to index the flat directive and dimension
+         * records of the analysis hot path instead of searching by name
+         */
+        const int num_dimension_ids = 10;
+        const int invalid_dimension_id = -1;
+
+        inline const std::string& GetDimensionName(int dim_id) {
+            static const std::string* const dimension_names[num_dimension_ids] = {
+                    &DFSL::layer_dim_input_batch_,
+                    &DFSL::layer_dim_group_,
+                    &DFSL::layer_dim_output_channel_,
+                    &DFSL::layer_dim_input_channel_,
+                    &DFSL::layer_dim_weight_height_,
+                    &DFSL::layer_dim_weight_width_,
+                    &DFSL::layer_dim_input_height_,
+                    &DFSL::layer_dim_input_width_,
+                    &DFSL::layer_dim_output_height_,
+                    &DFSL::layer_dim_output_width_
+            };
+            return *dimension_names[dim_id];
+        }
+
+        // Returns invalid_dimension_id for names that are not DFSL dimensions
+        inline int GetDimensionId(const std::string& dim) {
+            if(dim.empty()) {
+                return invalid_dimension_id;
+            }
+            for(int dim_id = 0; dim_id < num_dimension_ids; dim_id++) {
+                auto& name = GetDimensionName(dim_id);
+                if(name[0] == dim[0] && name == dim) {
+                    return dim_id;
+                }
+            }
+            return invalid_dimension_id;
+        }
+    }; // End of namespace DFA
+}; // End of namespace maestro
+
+#endif
@@ -26,11 +26,13 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <vector>
 #include <memory>
 #include <string>
+#include <array>
 
 #include "BASE_maestro-class.hpp"
 #include "TL_error-handler.hpp"
 
 #include "DFA_layer.hpp"
+#include "DFA_dimension-ids.hpp"
 #include "DFA_dimension-overlap-info-table.hpp"
 
 namespace maestro {
@@ -86,6 +88,7 @@ namespace maestro {
             DimensionTable() :
                     MAESTROClass("Dimension Table") {
                 dim_overlap_table_ = std::make_shared<DimensionOverlapInfoTable>();
+                dim_records_.fill({false, 0, 1, 1});
             }
 
             // Not a good way to use std::map; will remove after update deprecated code
@@ -106,44 +109,54 @@ namespace maestro {
             }
 
             bool HasVar(std::string targ) {
+                int dim_id = GetDimensionId(targ);
+                if(dim_id != invalid_dimension_id) {
+                    return dim_records_[dim_id].is_valid_;
+                }
                 return (dim_table_.find(targ) != dim_table_.end());
             }
 
             int GetSize(std::string targ) {
-
-                if(!this->HasVar(targ)) {
-                    error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
-                    error_handler_->TerminateProgram();
-                }
-
-                return dim_table_[targ]->GetSize();
+                return GetDimensionRecord(targ).size_;
             }
 
             int GetOuterStride(std::string targ) {
+                return GetDimensionRecord(targ).outer_stride_;
+            }
 
-                if(!this->HasVar(targ)) {
-                    error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
-                    error_handler_->TerminateProgram();
-                }
-
-                return dim_table_[targ]->GetOuterStride();
+            int GetInnerStride(std::string targ) {
+                return GetDimensionRecord(targ).inner_stride_;
+            }
 
+            const DimensionRecord& GetDimensionRecord(int dim_id) {
+                return dim_records_[dim_id];
             }
 
-            int GetInnerStride(std::string targ) {
+            DimensionRecord GetDimensionRecord(std::string targ) {
 
                 if(!this->HasVar(targ)) {
                     error_handler_->PrintErrorMsg(TL::ErrorCode::MissingDimension, targ);
                     error_handler_->TerminateProgram();
                 }
 
-                return dim_table_[targ]->GetInnerStride();
+                int dim_id = GetDimensionId(targ);
+                if(dim_id != invalid_dimension_id) {
+                    return dim_records_[dim_id];
+                }
 
+                auto& dim = dim_table_[targ];
+                return {true, dim->GetSize(), dim->GetOuterStride(), dim->GetInnerStride()};
             }
 
 
             void AddDimension(std::shared_ptr<LayerDimension> new_dimension) {
-                dim_table_.insert(std::make_pair(new_dimension->GetName(), new_dimension));
+                bool is_new = dim_table_.insert(std::make_pair(new_dimension->GetName(), new_dimension)).second;
+
+                int dim_id = GetDimensionId(new_dimension->GetName());
+                if(is_new && dim_id != invalid_dimension_id) {
+                    dim_records_[dim_id] = {true, new_dimension->GetSize(), new_dimension->GetOuterStride(),
+                                            new_dimension->GetInnerStride()};
+                }
             }
 
             void AddOverlapDimension(std::string reference_dim, std::string sliding_dim) {
@@ -190,6 +203,8 @@ namespace maestro {
         protected:
             std::map<std::string, std::shared_ptr<LayerDimension>> dim_table_;
             std::shared_ptr<DimensionOverlapInfoTable> dim_overlap_table_;
+            // Flat copy of dim_table_ for the DFSL dimensions, indexed by dimension id
+            std::array<DimensionRecord, num_dimension_ids> dim_records_;
         };
     }
 }
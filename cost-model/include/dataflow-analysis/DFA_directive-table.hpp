@@ -27,14 +27,18 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <string>
 #include <vector>
 #include <list>
+#include <array>
 
 
 #include "DFA_directives.hpp"
+#include "DFA_dimension-ids.hpp"
 #include "DFSL_syntax_tokens.hpp"
 
 namespace maestro {
     namespace DFA {
 
+        const int max_num_directive_records = 32;
+
         class DirectiveTable {
         public:
 
@@ -99,6 +103,7 @@ namespace maestro {
             }
 
             void ConvertToInputCentric() {
+                has_records_ = false;
 
                 int size_S, size_R = 0;
 
@@ -126,7 +131,13 @@ namespace maestro {
             std::shared_ptr<directive::Directive> FindDirective (std::string var) {
                 std::shared_ptr<directive::Directive> ret = nullptr;
 
-                for(auto directive : *directives_) {
+                int dim_id = has_records_ ? GetDimensionId(var) : invalid_dimension_id;
+                if(dim_id != invalid_dimension_id) {
+                    int directive_idx = directive_idx_of_dim_[dim_id];
+                    return (directive_idx == invalid_dimension_id) ? ret : directives_->at(directive_idx);
+                }
+
+                for(auto& directive : *directives_) {
                     if(directive->GetVariable() == var) {
                         return directive;
                     }
@@ -136,8 +147,14 @@ namespace maestro {
             }
 
             int GetDirectiveIdx (std::string var) {
+                int dim_id = has_records_ ? GetDimensionId(var) : invalid_dimension_id;
+                if(dim_id != invalid_dimension_id) {
+                    int directive_idx = directive_idx_of_dim_[dim_id];
+                    return (directive_idx == invalid_dimension_id) ? directives_->size() : directive_idx;
+                }
+
                 int idx = 0;
-                for(auto directive : *directives_) {
+                for(auto& directive : *directives_) {
                     if(directive->GetVariable() == var) {
                         return idx;
                     }
@@ -148,7 +165,7 @@ namespace maestro {
 
             int GetTemporalMapIdx (std::string var) {
                 int idx = 0;
-                for(auto directive : *directives_) {
+                for(auto& directive : *directives_) {
                     if(directive->GetVariable() == var) {
                         return idx;
                     }
@@ -160,27 +177,101 @@ namespace maestro {
             }
 
             void AddDirectiveFront(std::shared_ptr<directive::Directive> new_directive) {
+                has_records_ = false;
                 directives_->insert(directives_->begin(), new_directive);
             }
 
 
             void AddDirective(std::shared_ptr<directive::Directive> new_directive) {
+                has_records_ = false;
                 directives_->push_back(new_directive);
             }
 
             void DeleteDirectives(){
+                has_records_ = false;
                 directives_->erase(directives_->begin(),
                                    directives_->begin() + directives_->size());
             }
 
             void ReverseDirectives() {
+                has_records_ = false;
                 std::reverse(std::begin(*directives_), std::end(*directives_));
             }
 
+            /*
+             * Takes a flat snapshot of the directives and indexes them by dimension id; called once the
+             * dataflow is final (e.g., when a ClusterUnit is constructed). Changing the table drops the
+             * snapshot, but changes made directly on the directive objects are not tracked.
+             * Tables with non-DFSL dimensions or too many directives keep using the name search.
+             */
+            void BuildRecords() {
+                has_records_ = false;
+                if(directives_->size() > max_num_directive_records) {
+                    return;
+                }
+
+                directive_idx_of_dim_.fill(invalid_dimension_id);
+                num_records_ = 0;
+                for(auto& directive : *directives_) {
+                    int dim_id = invalid_dimension_id;
+                    if(directive->GetClass() != directive::DirectiveClass::Cluster) {
+                        dim_id = GetDimensionId(directive->GetVariable());
+                        if(dim_id == invalid_dimension_id) {
+                            return;
+                        }
+                        if(directive_idx_of_dim_[dim_id] == invalid_dimension_id) {
+                            directive_idx_of_dim_[dim_id] = num_records_;
+                        }
+                    }
+                    records_[num_records_] = {directive->GetClass(), dim_id, directive->GetSize(), directive->GetOfs()};
+                    num_records_++;
+                }
+                has_records_ = true;
+            }
+
+            bool HasRecords() {
+                return has_records_;
+            }
+
+            const directive::DirectiveRecord& GetRecord(int idx) {
+                return records_[idx];
+            }
+
+            // The first record on the dimension, or nullptr if none (requires HasRecords())
+            const directive::DirectiveRecord* FindRecord(int dim_id) {
+                int directive_idx = directive_idx_of_dim_[dim_id];
+                return (directive_idx == invalid_dimension_id) ? nullptr : &records_[directive_idx];
+            }
+
             int size() {
                 return directives_->size();
             }
 
+            // Deep copy; the copy constructor shares the directive objects
+            std::shared_ptr<DirectiveTable> Clone() {
+                auto ret = std::make_shared<DirectiveTable>();
+                for(auto& directive : *directives_) {
+                    switch(directive->GetClass()) {
+                        case directive::DirectiveClass::TemporalMap: {
+                            ret->AddDirective(std::make_shared<directive::TemporalMap>(directive->GetSize(), directive->GetOfs(), directive->GetVariable()));
+                            break;
+                        }
+                        case directive::DirectiveClass::SpatialMap: {
+                            ret->AddDirective(std::make_shared<directive::SpatialMap>(directive->GetSize(), directive->GetOfs(), directive->GetVariable()));
+                            break;
+                        }
+                        case directive::DirectiveClass::Cluster: {
+                            ret->AddDirective(std::make_shared<directive::Cluster>(directive->GetSize(), directive->GetAllocType()));
+                            break;
+                        }
+                        default: {
+                            ret->AddDirective(directive);
+                        }
+                    }
+                }
+                return ret;
+            }
+
             std::string ToString() {
                 std::string ret = "";
                 for(auto& it : *directives_) {
@@ -194,6 +285,11 @@ namespace maestro {
         protected:
             std::shared_ptr<std::vector<std::shared_ptr<directive::Directive>>> directives_;
 
+            bool has_records_ = false;
+            int num_records_ = 0;
+            std::array<directive::DirectiveRecord, max_num_directive_records> records_;
+            std::array<int, num_dimension_ids> directive_idx_of_dim_;
+
         }; // End of class DirectiveTable
     } // End of namespace DFA
 } // End of namesapce maestro
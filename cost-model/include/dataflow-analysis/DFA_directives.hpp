@@ -24,6 +24,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #define MAESTRO_DFA_DIRECTIVES_HPP_
 
 #include <string>
+#include <type_traits>
 
 #include "DFSL_syntax_tokens.hpp"
 
@@ -269,6 +270,17 @@ namespace maestro {
                 int size_;
                 ClusterType type_ = ClusterType::Logical;
             };// End of class Cluster
+
+            // Flat copy of a directive for the analysis hot path (see DirectiveTable::BuildRecords)
+            class DirectiveRecord {
+            public:
+                DirectiveClass class_;
+                int dim_id_;
+                int size_;
+                int offset_;
+            }; // End of class DirectiveRecord
+
+            static_assert(std::is_trivially_copyable<DirectiveRecord>::value, "DirectiveRecord must stay trivially copyable");
         } // End of namespace directive
     } // End of namespace DFA
 } // End of namespace maestro
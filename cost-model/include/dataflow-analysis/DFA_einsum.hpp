@@ -0,0 +1,159 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DFA_EINSUM_HPP_
+#define MAESTRO_DFA_EINSUM_HPP_
+
+#include <memory>
+#include <string>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+#include "BASE_constants.hpp"
+#include "DFA_layer.hpp"
+
+namespace maestro {
+    namespace DFA {
+        /*
+         * Tensor coupling of a generic layer written as an einsum, Output[...] += Input[...] * Weight[...],
+         * e.g., "HMD, HND -> HMN" for the batched Q x K^T of attention. Every index is one character and
+         * names a layer dimension; indices missing from the output are reduced.
+         * A sliding window pair (Y: R) makes Y a position of the input along which the window R slides, as
+         * in convolutions: like CONV layers, the input and the output are both indexed by the input
+         * position Y, and the output has Sz(Y) - Sz(R) + 1 positions along it.
+         */
+        class EinsumSpec {
+        public:
+            void SetIndices(DataClass data_class, std::list<std::string> indices) {
+                indices_[static_cast<int>(data_class)] = indices;
+            }
+
+            const std::list<std::string>& GetIndices(DataClass data_class) const {
+                return indices_[static_cast<int>(data_class)];
+            }
+
+            void AddSlidingWindow(std::string position_dim, std::string window_dim) {
+                sliding_windows_[position_dim] = window_dim;
+            }
+
+            // Window dimension of each position dimension
+            const std::map<std::string, std::string>& GetSlidingWindows() const {
+                return sliding_windows_;
+            }
+
+            // Error message, or an empty string if the expression is consistent with the layer dimensions
+            std::string Validate(std::shared_ptr<std::vector<std::shared_ptr<LayerDimension>>> dimensions) const {
+                std::set<std::string> dim_names;
+                for(auto& dim : *dimensions) {
+                    dim_names.insert(dim->GetName());
+                }
+
+                std::set<std::string> input_indices;
+                std::set<std::string> used_indices;
+                for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                    if(indices_[i].empty()) {
+                        return "every tensor needs at least one index";
+                    }
+                    std::set<std::string> tensor_indices;
+                    for(auto& index : indices_[i]) {
+                        if(dim_names.count(index) == 0) {
+                            return "index " + index + " has no dimension";
+                        }
+                        if(!tensor_indices.insert(index).second) {
+                            return "index " + index + " appears twice in one tensor";
+                        }
+                        if(static_cast<DataClass>(i) != DataClass::Output) {
+                            input_indices.insert(index);
+                        }
+                        used_indices.insert(index);
+                    }
+                }
+
+                for(auto& index : GetIndices(DataClass::Output)) {
+                    if(input_indices.count(index) == 0) {
+                        return "output index " + index + " appears in neither the input nor the weight";
+                    }
+                }
+                for(auto& dim : dim_names) {
+                    if(used_indices.count(dim) == 0) {
+                        return "dimension " + dim + " is not an index of the expression";
+                    }
+                }
+
+                // As Y: R of convolutions, a position indexes the input and the output, and a window only the weight
+                for(auto& it : sliding_windows_) {
+                    bool is_position = HasIndex(DataClass::Input, it.first) && HasIndex(DataClass::Output, it.first)
+                                       && !HasIndex(DataClass::Weight, it.first);
+                    bool is_window = HasIndex(DataClass::Weight, it.second) && !HasIndex(DataClass::Input, it.second)
+                                     && !HasIndex(DataClass::Output, it.second);
+                    if(!is_position || !is_window) {
+                        return "sliding window " + it.first + ": " + it.second
+                               + " needs a position index of the input and the output, and a window index of the weight";
+                    }
+                }
+
+                return "";
+            }
+
+            // Einsum notation, e.g., "CYX, KCRS -> KYX"
+            std::string ToString() const {
+                std::string ret;
+                for(auto data_class : {DataClass::Input, DataClass::Weight, DataClass::Output}) {
+                    if(data_class == DataClass::Weight) {
+                        ret += ", ";
+                    }
+                    else if(data_class == DataClass::Output) {
+                        ret += " -> ";
+                    }
+                    for(auto& index : GetIndices(data_class)) {
+                        ret += index;
+                    }
+                }
+                return ret;
+            }
+
+            // One index per character of an operand, e.g., "KCRS"
+            static std::list<std::string> ParseIndices(const std::string& operand) {
+                std::list<std::string> ret;
+                for(auto index : operand) {
+                    ret.push_back(std::string(1, index));
+                }
+                return ret;
+            }
+
+            bool HasIndex(DataClass data_class, const std::string& index) const {
+                auto& indices = GetIndices(data_class);
+                return std::find(indices.begin(), indices.end(), index) != indices.end();
+            }
+
+        protected:
+            std::list<std::string> indices_[static_cast<int>(DataClass::NumDataClasses)];
+            std::map<std::string, std::string> sliding_windows_;
+        }; // End of class EinsumSpec
+    }; // End of namespace DFA
+}; // End of namespace maestro
+
+#endif
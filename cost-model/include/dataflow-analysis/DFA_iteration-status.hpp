@@ -229,7 +229,7 @@ namespace maestro {
                 (*iter_states_)[iter_state->GetDimVariable()] = iter_state;
             }
 
-            std::shared_ptr<IterationState> GetIterState(std::string dim_var) {
+            std::shared_ptr<IterationState> GetIterState(const std::string& dim_var) {
                 return (*iter_states_)[dim_var];
             }
 
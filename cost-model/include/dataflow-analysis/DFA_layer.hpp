@@ -31,10 +31,12 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 namespace maestro{
 
 //    enum class ConvLayerDimensionIdentifier {K, C, R, S ,Y, X};
-    enum class LayerType {CONV, DSCONV, FC, POOL, TRCONV, NGCONV, LSTM, GEMM, NumLayerTypes};
+    enum class LayerType {CONV, DSCONV, FC, POOL, TRCONV, NGCONV, LSTM, GEMM, EINSUM, NumLayerTypes};
     enum class LayerQuantizationType { FP32, FP16, FP8, FP4, FP2, INT32, INT16, INT8, INT4, INT2};
     
     namespace DFA {
+        class LayerSparsity; // DFA_sparsity.hpp
+        class EinsumSpec; // DFA_einsum.hpp
 
         class LayerDimension {
         protected:
@@ -69,6 +71,15 @@ namespace maestro{
             }
         }; // End of class LayerDimension
 
+        // Flat copy of a LayerDimension, indexed by dimension id in DimensionTable
+        class DimensionRecord {
+        public:
+            bool is_valid_;
+            int size_;
+            int outer_stride_;
+            int inner_stride_;
+        }; // End of class DimensionRecord
+
         class Layer {
         public:
 
@@ -121,6 +132,24 @@ namespace maestro{
                 return quantization_;
             }
 
+            // nullptr for dense layers
+            void SetSparsity(std::shared_ptr<LayerSparsity> sparsity) {
+                sparsity_ = sparsity;
+            }
+
+            std::shared_ptr<LayerSparsity> GetSparsity() {
+                return sparsity_;
+            }
+
+            // Tensor coupling of EINSUM layers; nullptr for the other layer types
+            void SetEinsum(std::shared_ptr<EinsumSpec> einsum) {
+                einsum_ = einsum;
+            }
+
+            std::shared_ptr<EinsumSpec> GetEinsum() {
+                return einsum_;
+            }
+
             int GetSize(std::string id) {
                 for (auto &it : *dimensions_) {
                     if(it->GetName() == id) {
@@ -156,9 +185,11 @@ namespace maestro{
         protected:
             LayerType type_;
             std::string name_;
-            LayerQuantizationType quantization_;
+            LayerQuantizationType quantization_ = LayerQuantizationType::FP32;
             std::shared_ptr<std::vector<std::shared_ptr<LayerDimension>>> dimensions_;
             std::shared_ptr<DFA::DirectiveTable> dataflow_directives_;
+            std::shared_ptr<LayerSparsity> sparsity_;
+            std::shared_ptr<EinsumSpec> einsum_;
 
         }; // End of class Layer
 
@@ -402,6 +433,36 @@ namespace maestro{
 
         }; // End of class NGConvLayer
 
+        class EinsumLayer : public Layer {
+        public:
+            EinsumLayer (std::string name) : Layer(name) {
+            }
+
+            EinsumLayer (std::string name, std::shared_ptr<std::vector<std::shared_ptr<LayerDimension>>> dimensions) :
+                    Layer(name, LayerType::EINSUM, dimensions) {
+            }
+
+            virtual ~EinsumLayer() {}
+
+            virtual std::string ToString() {
+                std::string ret = "Layer " + name_ + "{\nType: EINSUM\n Dimension {\n";
+                for (auto &it : *dimensions_) {
+                    ret += it->ToString();
+                    ret += "\n";
+                }
+                ret += "}\n";
+
+                ret += "Dataflow {\n";
+                for (auto &it : *dataflow_directives_) {
+                    ret += it->ToString();
+                    ret += "\n";
+                }
+                ret += "}\n";
+
+                return ret;
+            }
+        }; // End of class EinsumLayer
+
         class FCLayer : public Layer {
         protected:
 
@@ -442,6 +503,51 @@ namespace maestro{
                 return ret;
             }
         }; // End of class LSTM Layer
+
+        /*
+         * Deep copy of a layer (dimensions and dataflow). Cluster analysis rewrites the dataflow of the layer
+         * it analyzes, so every analysis of the same layer needs its own copy.
+         */
+        inline std::shared_ptr<Layer> CloneLayer(std::shared_ptr<Layer> layer) {
+            auto dimensions = std::make_shared<std::vector<std::shared_ptr<LayerDimension>>>();
+            for(auto& dim : *layer->GetDimensions()) {
+                dimensions->push_back(std::make_shared<LayerDimension>(dim->GetName(), dim->GetSize(), dim->GetOuterStride(), dim->GetInnerStride()));
+            }
+
+            std::shared_ptr<Layer> ret;
+            switch(layer->GetLayerType()) {
+                case LayerType::GEMM: {
+                    ret = std::make_shared<GEMMLayer>(layer->GetName(), dimensions);
+                    break;
+                }
+                case LayerType::DSCONV: {
+                    ret = std::make_shared<DSConvLayer>(layer->GetName(), dimensions);
+                    break;
+                }
+                case LayerType::NGCONV: {
+                    ret = std::make_shared<NGConvLayer>(layer->GetName(), dimensions);
+                    break;
+                }
+                case LayerType::EINSUM: {
+                    ret = std::make_shared<EinsumLayer>(layer->GetName(), dimensions);
+                    break;
+                }
+                case LayerType::CONV:
+                default: {
+                    ret = std::make_shared<ConvLayer>(layer->GetName(), dimensions);
+                }
+            }
+
+            ret->SetLayerType(layer->GetLayerType());
+            ret->setQuantization(layer->getQuantization());
+            ret->SetSparsity(layer->GetSparsity());
+            ret->SetEinsum(layer->GetEinsum());
+            if(layer->GetDataflow() != nullptr) {
+                ret->SetDataflow(layer->GetDataflow()->Clone());
+            }
+
+            return ret;
+        }
     }; // End of namespace DFA
 }; // End of namespace maestro
 
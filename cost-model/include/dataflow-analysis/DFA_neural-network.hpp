@@ -85,6 +85,10 @@ namespace maestro{
                 return GetLayer(idx);
             }
 
+            int GetNumLayers() {
+                return layers_->size();
+            }
+
             NeuralNetwork() {
                 layers_ = std::make_shared<std::vector<std::shared_ptr<Layer>>>();
             }
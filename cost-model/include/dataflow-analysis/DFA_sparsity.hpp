@@ -0,0 +1,134 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_DFA_SPARSITY_HPP_
+#define MAESTRO_DFA_SPARSITY_HPP_
+
+#include <string>
+#include <cmath>
+#include <algorithm>
+
+#include "BASE_constants.hpp"
+
+namespace maestro {
+    namespace DFA {
+        /*
+         * Storage format of a sparse tensor.
+         * Dense: zeros are stored and moved; only the computation skips them
+         * Bitmask: nonzero values and one presence bit per element
+         * CSR: nonzero values and one coordinate (sparse_index_bit_size bits) per nonzero value
+         */
+        enum class SparseFormat {Dense, Bitmask, CSR};
+
+        const int sparse_index_bit_size = 16;
+
+        /*
+         * Expected fraction of nonzero elements of the tensors of a layer and their storage formats.
+         * Nonzeros are assumed to be uniformly distributed over each tensor.
+         */
+        class LayerSparsity {
+        public:
+            LayerSparsity() {
+                for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                    density_[i] = 1.0;
+                    format_[i] = SparseFormat::Bitmask;
+                }
+            }
+
+            void SetDensity(DataClass data_class, double density) {
+                density_[static_cast<int>(data_class)] = density;
+            }
+
+            double GetDensity(DataClass data_class) const {
+                return density_[static_cast<int>(data_class)];
+            }
+
+            void SetFormat(DataClass data_class, SparseFormat format) {
+                format_[static_cast<int>(data_class)] = format;
+            }
+
+            SparseFormat GetFormat(DataClass data_class) const {
+                return format_[static_cast<int>(data_class)];
+            }
+
+            bool IsDense() const {
+                for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                    if(density_[i] < 1.0) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // Fraction of the MACs whose operands are both nonzero; the others are skipped
+            double GetEffectualMACFraction() const {
+                return GetDensity(DataClass::Input) * GetDensity(DataClass::Weight);
+            }
+
+            /*
+             * Size of the stored (and transferred) tensor relative to its dense size, including the
+             * metadata of the format. A tensor is kept dense when compression does not pay off.
+             */
+            double GetFootprintFactor(DataClass data_class, int element_bit_size) const {
+                double density = GetDensity(data_class);
+                double factor = 1.0;
+                switch(GetFormat(data_class)) {
+                    case SparseFormat::Bitmask: {
+                        factor = density + 1.0 / element_bit_size;
+                        break;
+                    }
+                    case SparseFormat::CSR: {
+                        factor = density * (1.0 + static_cast<double>(sparse_index_bit_size) / element_bit_size);
+                        break;
+                    }
+                    case SparseFormat::Dense:
+                    default: {
+                        factor = 1.0;
+                    }
+                }
+                return std::min(factor, 1.0);
+            }
+
+            /*
+             * Expected effectual MAC fraction of the slowest of num_units units that each get num_macs
+             * dense MACs: the maximum of num_units binomial counts, approximated by
+             * mean + sqrt(2 ln(num_units)) * standard deviation
+             */
+            double GetImbalancedMACFraction(long num_macs, long num_units) const {
+                double fraction = GetEffectualMACFraction();
+                if(num_units <= 1 || num_macs <= 0 || fraction >= 1.0) {
+                    return fraction;
+                }
+
+                double deviation = std::sqrt(2.0 * std::log(static_cast<double>(num_units))
+                                             * fraction * (1.0 - fraction) / num_macs);
+                return std::min(fraction + deviation, 1.0);
+            }
+
+        protected:
+            double density_[static_cast<int>(DataClass::NumDataClasses)];
+            SparseFormat format_[static_cast<int>(DataClass::NumDataClasses)];
+        }; // End of class LayerSparsity
+    }; // End of namespace DFA
+}; // End of namespace maestro
+
+#endif
@@ -25,8 +25,13 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include <string>
 #include <list>
+#include <map>
+#include <memory>
 
 #include "BASE_constants.hpp"
+#include "DFSL_syntax_tokens.hpp"
+#include "DFA_layer.hpp"
+#include "DFA_einsum.hpp"
 
 namespace maestro {
     namespace DFA {
@@ -79,6 +84,92 @@ namespace maestro {
             std::shared_ptr<std::list<std::string>> coupled_variables_;
         }; // End of class Tensor
 
+        // Dimensions each tensor of a layer type depends on
+        inline std::list<std::string> GetCoupledVariables(LayerType layer_type, DataClass data_class, bool batch_processing = false) {
+            switch(layer_type) {
+                case (LayerType::DSCONV): {
+                    if(data_class == DataClass::Weight) {
+                        return {"C", "R", "S"};
+                    }
+                    if(batch_processing) {
+                        return {"N", "C", "Y", "X"};
+                    }
+                    return {"C", "Y", "X"};
+                }
+                case (LayerType::NGCONV): {
+                    if(data_class == DataClass::Weight) {
+                        return {"G", "K", "C", "R", "S"};
+                    }
+                    std::list<std::string> ret;
+                    if(data_class == DataClass::Input) {
+                        ret = {"G", "C", "Y", "X"};
+                    }
+                    else {
+                        ret = {"G", "K", "C", "Y", "X"};
+                    }
+                    if(batch_processing) {
+                        ret.push_front("N");
+                    }
+                    return ret;
+                }
+                case (LayerType::GEMM): {
+                    if(data_class == DataClass::Input) {
+                        return {"M", "K"};
+                    }
+                    if(data_class == DataClass::Weight) {
+                        return {"K", "N"};
+                    }
+                    return {"M", "N"};
+                }
+                case (LayerType::CONV):
+                default : {
+                    if(data_class == DataClass::Weight) {
+                        return {"K", "C", "R", "S"};
+                    }
+                    std::list<std::string> ret;
+                    if(data_class == DataClass::Input) {
+                        ret = {"C", "Y", "X"};
+                    }
+                    else {
+                        ret = {"K", "Y", "X"};
+                    }
+                    if(batch_processing) {
+                        ret.push_front("N");
+                    }
+                    return ret;
+                }
+            }
+        }
+
+        // Dimensions each tensor of the layer depends on; batch_processing applies to the built-in layer types
+        inline std::list<std::string> GetCoupledVariables(std::shared_ptr<Layer> layer, DataClass data_class, bool batch_processing = false) {
+            if(layer->GetLayerType() == LayerType::EINSUM && layer->GetEinsum() != nullptr) {
+                return layer->GetEinsum()->GetIndices(data_class);
+            }
+            return GetCoupledVariables(layer->GetLayerType(), data_class, batch_processing);
+        }
+
+        // Window dimension of each sliding (input position) dimension of the layer
+        inline std::map<std::string, std::string> GetSlidingWindows(std::shared_ptr<Layer> layer) {
+            switch(layer->GetLayerType()) {
+                case LayerType::EINSUM: {
+                    if(layer->GetEinsum() == nullptr) {
+                        return {};
+                    }
+                    return layer->GetEinsum()->GetSlidingWindows();
+                }
+                case LayerType::CONV:
+                case LayerType::DSCONV:
+                case LayerType::NGCONV: {
+                    return {{DFSL::layer_dim_input_height_, DFSL::layer_dim_weight_height_},
+                            {DFSL::layer_dim_input_width_, DFSL::layer_dim_weight_width_}};
+                }
+                default: {
+                    return {};
+                }
+            }
+        }
+
     }; // End of namespace DFA
 }; // End of namespace maestro
 
@@ -35,6 +35,10 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include<boost/format.hpp>
 
 #include "BASE_maestro-class.hpp"
+#include "BASE_constants.hpp"
+#include "AHW_offchip-memory-model.hpp"
+#include "AHW_noc-model.hpp"
+#include "AHW_buffer-level.hpp"
 #include "DFSL_syntax_tokens.hpp"
 #include "DFSL_parser.hpp"
 
@@ -50,6 +54,12 @@ namespace maestro {
             NoCBWIdentifier,
             NoCNumHopsIdentifier,
             OffChipBWIdentifier,
+            OffChipMemoryIdentifier,
+            DRAMParamIdentifier,
+            NoCTopologyIdentifier,
+            BufferLevelIdentifier,
+              BufferLevelParamIdentifier,
+                BufferLevelParamValue,
         };
 
         class HWConfig : public MAESTROClass {
@@ -58,8 +68,23 @@ namespace maestro {
             int l1_size_ = INT_MAX;
             int l2_size_ = INT_MAX;
             int noc_bw_ = INT_MAX;
+            // Per cluster level, innermost level first; outer levels beyond the list use its last entry. Empty: noc_bw_
+            std::vector<int> noc_bws_;
             int noc_hops_ = 1;
+            // Whether the NoCs of all cluster levels support multicast (--noc_mc_support)
+            bool noc_multicast_ = true;
             int off_chip_bw_ = INT_MAX;
+            // nullptr: constant off-chip bandwidth of off_chip_bw_
+            std::shared_ptr<AHW::DRAMTimingConfig> dram_config_ = nullptr;
+            // Per cluster level, innermost level first; outer levels beyond the list use its last entry. Empty: Default
+            std::vector<AHW::NoCTopology> noc_topologies_;
+            // Outermost level first; empty: the L2 (l2_size_cstr) and L1 (l1_size_cstr) pair
+            std::vector<AHW::BufferLevelConfig> buffer_levels_;
+
+            // l1_size_ and l2_size_ are in bytes; the view gives PEs and buffer entries at the layer precision
+            LayerHardwareView GetLayerHardwareView(LayerQuantizationType quantization_type) const {
+                return LayerHardwareView(num_pes_, l1_size_, l2_size_, quantization_type);
+            }
         };
 
         class HWParser : public InputParser {
@@ -72,6 +97,10 @@ namespace maestro {
                 boost::char_separator<char> sep(" ,->():\t;");
                 int line_number = 1;
                 auto ret = std::make_shared<DFSL::HWConfig>();
+                auto dram_config = std::make_shared<AHW::DRAMTimingConfig>();
+                bool use_dram = false;
+                int* dram_param = nullptr;
+                std::string buffer_level_param;
                 while(std::getline(in_file_, line)) {
                     boost::tokenizer<boost::char_separator<char>> tokn(line, sep);
 
@@ -103,6 +132,19 @@ namespace maestro {
                                 else if(tkn == DFSL::tmp_offchip_bw_decl_) {
                                     state_ = HWParserState::OffChipBWIdentifier;
                                 }
+                                else if(tkn == DFSL::tmp_offchip_memory_decl_) {
+                                    state_ = HWParserState::OffChipMemoryIdentifier;
+                                }
+                                else if((dram_param = GetDRAMParam(tkn, dram_config)) != nullptr) {
+                                    state_ = HWParserState::DRAMParamIdentifier;
+                                }
+                                else if(tkn == DFSL::tmp_noc_topology_decl_) {
+                                    ret->noc_topologies_.clear();
+                                    state_ = HWParserState::NoCTopologyIdentifier;
+                                }
+                                else if(tkn == DFSL::tmp_buffer_level_decl_) {
+                                    state_ = HWParserState::BufferLevelIdentifier;
+                                }
                                 else {
                                     ParseError(line_number);
                                 }
@@ -146,6 +188,79 @@ namespace maestro {
                                 break;
                             }
 
+                            case HWParserState::OffChipMemoryIdentifier: {
+                                if(tkn == DFSL::offchip_memory_dram_) {
+                                    use_dram = true;
+                                }
+                                else if(tkn == DFSL::offchip_memory_constant_) {
+                                    use_dram = false;
+                                }
+                                else {
+                                    std::cout << "[Error] Unknown off-chip memory model " << tkn << "; use constant or dram" << std::endl;
+                                    ParseError(line_number);
+                                }
+                                state_ = HWParserState::Idle;
+                                break;
+                            }
+
+                            case HWParserState::DRAMParamIdentifier: {
+                                *dram_param = std::atoi(tkn.c_str());
+                                if(*dram_param < 0) {
+                                    ParseError(line_number);
+                                }
+                                state_ = HWParserState::Idle;
+                                break;
+                            }
+
+                            // The topology list runs to the end of the line
+                            case HWParserState::NoCTopologyIdentifier: {
+                                AHW::NoCTopology topology = AHW::NoCTopology::Default;
+                                if(!GetNoCTopology(tkn, topology)) {
+                                    std::cout << "[Error] Unknown NoC topology " << tkn << "; use default, bus, mesh, fat_tree, or multicast_tree" << std::endl;
+                                    ParseError(line_number);
+                                }
+                                ret->noc_topologies_.push_back(topology);
+                                break;
+                            }
+
+                            // buffer_level: <name> [size <bytes>] [bw <elements/cycle>] [read_energy <e>] [write_energy <e>]
+                            case HWParserState::BufferLevelIdentifier: {
+                                AHW::BufferLevelConfig buffer_level;
+                                buffer_level.name_ = tkn;
+                                ret->buffer_levels_.push_back(buffer_level);
+                                state_ = HWParserState::BufferLevelParamIdentifier;
+                                break;
+                            }
+
+                            case HWParserState::BufferLevelParamIdentifier: {
+                                if(tkn != DFSL::buffer_level_size_ && tkn != DFSL::buffer_level_bw_
+                                   && tkn != DFSL::buffer_level_read_energy_ && tkn != DFSL::buffer_level_write_energy_) {
+                                    std::cout << "[Error] Unknown buffer level parameter " << tkn << "; use size, bw, read_energy, or write_energy" << std::endl;
+                                    ParseError(line_number);
+                                }
+                                buffer_level_param = tkn;
+                                state_ = HWParserState::BufferLevelParamValue;
+                                break;
+                            }
+
+                            case HWParserState::BufferLevelParamValue: {
+                                auto& buffer_level = ret->buffer_levels_.back();
+                                if(buffer_level_param == DFSL::buffer_level_size_) {
+                                    buffer_level.size_ = std::atol(tkn.c_str());
+                                }
+                                else if(buffer_level_param == DFSL::buffer_level_bw_) {
+                                    buffer_level.bw_ = std::atoi(tkn.c_str());
+                                }
+                                else if(buffer_level_param == DFSL::buffer_level_read_energy_) {
+                                    buffer_level.read_energy_ = std::atof(tkn.c_str());
+                                }
+                                else {
+                                    buffer_level.write_energy_ = std::atof(tkn.c_str());
+                                }
+                                state_ = HWParserState::BufferLevelParamIdentifier;
+                                break;
+                            }
+
                             default: {
                                 ParseError(line_number);
                                 break;
@@ -153,6 +268,15 @@ namespace maestro {
                         } // End of switch(state_)
                     } // End of for(tkn)
 
+                    // A buffer level declaration ends with its line
+                    if(state_ == HWParserState::BufferLevelParamIdentifier) {
+                        state_ = HWParserState::Idle;
+                    }
+
+                    if(state_ == HWParserState::NoCTopologyIdentifier && !ret->noc_topologies_.empty()) {
+                        state_ = HWParserState::Idle;
+                    }
+
                     line_number++;
 
                 } // End of while(getline(...))
@@ -161,6 +285,10 @@ namespace maestro {
                     ParseError(line_number);
                 }
 
+                if(use_dram) {
+                    ret->dram_config_ = dram_config;
+                }
+
                 return ret;
 
             } // End of ParseHW
@@ -168,6 +296,57 @@ namespace maestro {
         protected:
             HWParserState state_ = HWParserState::Idle;
 
+            bool GetNoCTopology(const std::string& tkn, AHW::NoCTopology& topology) {
+                if(tkn == DFSL::noc_topology_default_) {
+                    topology = AHW::NoCTopology::Default;
+                }
+                else if(tkn == DFSL::noc_topology_bus_) {
+                    topology = AHW::NoCTopology::Bus;
+                }
+                else if(tkn == DFSL::noc_topology_mesh_) {
+                    topology = AHW::NoCTopology::Mesh;
+                }
+                else if(tkn == DFSL::noc_topology_fat_tree_) {
+                    topology = AHW::NoCTopology::FatTree;
+                }
+                else if(tkn == DFSL::noc_topology_multicast_tree_) {
+                    topology = AHW::NoCTopology::MulticastTree;
+                }
+                else {
+                    return false;
+                }
+                return true;
+            }
+
+            // DRAM timing parameter the token declares, or nullptr
+            int* GetDRAMParam(const std::string& tkn, std::shared_ptr<AHW::DRAMTimingConfig> dram_config) {
+                if(tkn == DFSL::tmp_dram_bus_bw_decl_) {
+                    return &dram_config->bus_bw_;
+                }
+                else if(tkn == DFSL::tmp_dram_burst_size_decl_) {
+                    return &dram_config->burst_size_;
+                }
+                else if(tkn == DFSL::tmp_dram_row_size_decl_) {
+                    return &dram_config->row_size_;
+                }
+                else if(tkn == DFSL::tmp_dram_num_banks_decl_) {
+                    return &dram_config->num_banks_;
+                }
+                else if(tkn == DFSL::tmp_dram_t_rcd_decl_) {
+                    return &dram_config->t_rcd_;
+                }
+                else if(tkn == DFSL::tmp_dram_t_rp_decl_) {
+                    return &dram_config->t_rp_;
+                }
+                else if(tkn == DFSL::tmp_dram_t_cas_decl_) {
+                    return &dram_config->t_cas_;
+                }
+                else if(tkn == DFSL::tmp_dram_t_turnaround_decl_) {
+                    return &dram_config->t_turnaround_;
+                }
+                return nullptr;
+            }
+
         };
     }; // End of namespace DFSL
 }; // End of namespace maestro
@@ -29,6 +29,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <cstdlib>
 #include <memory>
 #include <map>
+#include <vector>
 
 #include<boost/tokenizer.hpp>
 #include<boost/format.hpp>
@@ -40,6 +41,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include "DFA_layer.hpp"
 #include "DFA_neural-network.hpp"
 #include "DFA_tensor.hpp"
+#include "DFA_sparsity.hpp"
+#include "DFA_einsum.hpp"
 #include "DFSL_syntax_tokens.hpp"
 
 
@@ -51,6 +54,8 @@ namespace maestro {
             Network_Identifier, Network_Body,
             Layer_Identifier, Layer_Body, Layer_Type,
             Stride_Decl, Stride_Body, Stride_Size,
+            Density_Decl, Density_Body, Density_Value, SparseFormat_Decl, SparseFormat_Body, SparseFormat_Value,
+            Einsum_Decl, Einsum_Body, SlidingWindow_Decl, SlidingWindow_Body, SlidingWindow_Size,
             Dimension_Decl, Dimension_Body, Dimension_Size,
             Dataflow_Decl, Dataflow_Body, Dataflow_MapSize, Dataflow_MapOffset, Dataflow_MapVar, Dataflow_ClusterSize, Dataflow_ClusterType,
             Accelerator_Identifier, Acclerator_Body,
@@ -76,8 +81,9 @@ namespace maestro {
             std::ifstream in_file_;
 
             void ParseError(int line_num) {
-                std::cout << "[MAESTRO Parser] Parse error at line number " + std::to_string(line_num) + " in target file " +  file_name_  << std::endl;
-                exit(-1);
+                std::string msg = "[MAESTRO Parser] Parse error at line number " + std::to_string(line_num) + " in target file " +  file_name_;
+                std::cout << msg << std::endl;
+                error_handler_->TerminateProgram(TL::ErrorCode::ParseError, msg);
             }
         }; // End of class InputParser
 
@@ -100,6 +106,11 @@ namespace maestro {
                 std::shared_ptr<std::vector<std::shared_ptr<DFA::LayerDimension>>> dim_vector = nullptr;
 
                 std::shared_ptr<std::map<std::string, int>> stride_info = nullptr;
+                std::shared_ptr<DFA::LayerSparsity> layer_sparsity = nullptr;
+                DataClass sparse_data_class = DataClass::Input;
+                std::shared_ptr<DFA::EinsumSpec> einsum = nullptr;
+                std::vector<std::string> einsum_operands;
+                std::string window_position_dim;
 
                 DFA::directive::DirectiveClass curr_directive_class = DFA::directive::DirectiveClass::Invalid;
                 std::shared_ptr<DFA::directive::Directive> curr_directive = nullptr;
@@ -215,6 +226,17 @@ namespace maestro {
                                         prev_directive_table = std::make_shared<DFA::DirectiveTable>(*directive_table);
                                     }
                                     curr_layer->SetLayerType(layer_type);
+                                    if(layer_sparsity != nullptr && !layer_sparsity->IsDense()) {
+                                        curr_layer->SetSparsity(layer_sparsity);
+                                    }
+                                    if(layer_type == LayerType::EINSUM) {
+                                        CheckEinsum(einsum, dim_vector, curr_layer->GetDataflow(), line_number);
+                                        curr_layer->SetEinsum(einsum);
+                                    }
+                                    else if(einsum != nullptr) {
+                                        std::cout << "[Error] Einsum and SlidingWindow descriptions are only valid for " << DFSL::layer_type_einsum_ << " layers" << std::endl;
+                                        ParseError(line_number);
+                                    }
 
                                     network->AddLayer(curr_layer);
 
@@ -225,6 +247,8 @@ namespace maestro {
                                     directive_table = nullptr;
                                     curr_layer = nullptr;
                                     stride_info = nullptr;
+                                    layer_sparsity = nullptr;
+                                    einsum = nullptr;
                                     had_dim_def = false;
                                     state_ = ParserState::Network_Body;
                                 }
@@ -245,6 +269,14 @@ namespace maestro {
                                     state_ = ParserState::Dimension_Decl;
                                 }else if (tkn == DFSL::layer_precision_decl_){
                                     state_ = ParserState :: Precision_Decl;
+                                }else if(tkn == DFSL::layer_density_decl_) {
+                                    state_ = ParserState::Density_Decl;
+                                }else if(tkn == DFSL::layer_sparse_format_decl_) {
+                                    state_ = ParserState::SparseFormat_Decl;
+                                }else if(tkn == DFSL::layer_einsum_decl_) {
+                                    state_ = ParserState::Einsum_Decl;
+                                }else if(tkn == DFSL::layer_sliding_window_decl_) {
+                                    state_ = ParserState::SlidingWindow_Decl;
                                 }else if(tkn == DFSL::layer_dataflow_decl_) {
                                     state_ = ParserState::Dataflow_Decl;
                                 }else {
@@ -336,6 +368,164 @@ namespace maestro {
                                 }
                                 break;
                             }
+                            case ParserState::Density_Decl: {
+                                if(tkn == DFSL::brace_open_) {
+                                    if(layer_sparsity == nullptr) {
+                                        layer_sparsity = std::make_shared<DFA::LayerSparsity>();
+                                    }
+                                    state_ = ParserState::Density_Body;
+                                }
+                                else {
+                                    std::cout << "[Error] Syntax error; density description: Density {Input: density, Weight: density, Output: density}. " << std::endl;
+                                    ParseError(line_number);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::Density_Body: {
+                                if(tkn == DFSL::brace_close_) {
+                                    state_ = ParserState::Layer_Body;
+                                }
+                                else if(ParseDataClass(tkn, sparse_data_class)) {
+                                    state_ = ParserState::Density_Value;
+                                }
+                                else {
+                                    std::cout << "[Error] Unknown tensor class " << tkn << "; use Input, Weight, or Output" << std::endl;
+                                    ParseError(line_number);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::Density_Value: {
+                                double density = std::atof(tkn.c_str());
+                                if(density <= 0 || density > 1) {
+                                    std::cout << "[Error] Density must be in (0, 1]" << std::endl;
+                                    ParseError(line_number);
+                                }
+                                else {
+                                    layer_sparsity->SetDensity(sparse_data_class, density);
+                                    state_ = ParserState::Density_Body;
+                                }
+                                break;
+                            }
+
+                            case ParserState::SparseFormat_Decl: {
+                                if(tkn == DFSL::brace_open_) {
+                                    if(layer_sparsity == nullptr) {
+                                        layer_sparsity = std::make_shared<DFA::LayerSparsity>();
+                                    }
+                                    state_ = ParserState::SparseFormat_Body;
+                                }
+                                else {
+                                    std::cout << "[Error] Syntax error; sparse format description: SparseFormat {Input: format, Weight: format, Output: format}. " << std::endl;
+                                    ParseError(line_number);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::SparseFormat_Body: {
+                                if(tkn == DFSL::brace_close_) {
+                                    state_ = ParserState::Layer_Body;
+                                }
+                                else if(ParseDataClass(tkn, sparse_data_class)) {
+                                    state_ = ParserState::SparseFormat_Value;
+                                }
+                                else {
+                                    std::cout << "[Error] Unknown tensor class " << tkn << "; use Input, Weight, or Output" << std::endl;
+                                    ParseError(line_number);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::SparseFormat_Value: {
+                                if(tkn == DFSL::sparse_format_dense_) {
+                                    layer_sparsity->SetFormat(sparse_data_class, DFA::SparseFormat::Dense);
+                                }
+                                else if(tkn == DFSL::sparse_format_bitmask_) {
+                                    layer_sparsity->SetFormat(sparse_data_class, DFA::SparseFormat::Bitmask);
+                                }
+                                else if(tkn == DFSL::sparse_format_csr_) {
+                                    layer_sparsity->SetFormat(sparse_data_class, DFA::SparseFormat::CSR);
+                                }
+                                else {
+                                    std::cout << "[Error] Unknown sparse format " << tkn << "; use Dense, Bitmask, or CSR" << std::endl;
+                                    ParseError(line_number);
+                                }
+                                state_ = ParserState::SparseFormat_Body;
+                                break;
+                            }
+
+                            case ParserState::Einsum_Decl: {
+                                if(tkn == DFSL::brace_open_) {
+                                    if(einsum == nullptr) {
+                                        einsum = std::make_shared<DFA::EinsumSpec>();
+                                    }
+                                    einsum_operands.clear();
+                                    state_ = ParserState::Einsum_Body;
+                                }
+                                else {
+                                    std::cout << "[Error] Syntax error; einsum description: Einsum { input indices, weight indices -> output indices }. " << std::endl;
+                                    ParseError(line_number);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::Einsum_Body: {
+                                if(tkn == DFSL::brace_close_) {
+                                    if(einsum_operands.size() != 3) {
+                                        std::cout << "[Error] An einsum needs two operands and a result, e.g., Einsum { MK, KN -> MN }" << std::endl;
+                                        ParseError(line_number);
+                                    }
+                                    einsum->SetIndices(DataClass::Input, DFA::EinsumSpec::ParseIndices(einsum_operands[0]));
+                                    einsum->SetIndices(DataClass::Weight, DFA::EinsumSpec::ParseIndices(einsum_operands[1]));
+                                    einsum->SetIndices(DataClass::Output, DFA::EinsumSpec::ParseIndices(einsum_operands[2]));
+                                    state_ = ParserState::Layer_Body;
+                                }
+                                else {
+                                    einsum_operands.push_back(tkn);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::SlidingWindow_Decl: {
+                                if(tkn == DFSL::brace_open_) {
+                                    if(einsum == nullptr) {
+                                        einsum = std::make_shared<DFA::EinsumSpec>();
+                                    }
+                                    state_ = ParserState::SlidingWindow_Body;
+                                }
+                                else {
+                                    std::cout << "[Error] Syntax error; sliding window description: SlidingWindow {position dim: window dim, ...}. " << std::endl;
+                                    ParseError(line_number);
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::SlidingWindow_Body: {
+                                if(tkn == DFSL::brace_close_) {
+                                    state_ = ParserState::Layer_Body;
+                                }
+                                else {
+                                    window_position_dim = tkn;
+                                    state_ = ParserState::SlidingWindow_Size;
+                                }
+
+                                break;
+                            }
+
+                            case ParserState::SlidingWindow_Size: {
+                                einsum->AddSlidingWindow(window_position_dim, tkn);
+                                state_ = ParserState::SlidingWindow_Body;
+                                break;
+                            }
+
                             case ParserState::Layer_Type: {
                                 if(tkn == DFSL::layer_type_conv_) {
                                     if(!tmp_name.empty()) {
@@ -357,6 +547,16 @@ namespace maestro {
                                     }
                                     layer_type = LayerType::GEMM;
                                 }
+                                else if(tkn == DFSL::layer_type_einsum_) {
+                                    if(!tmp_name.empty()) {
+                                        curr_layer = std::make_shared<DFA::EinsumLayer>(tmp_name);
+                                        tmp_name.clear();
+                                    }
+                                    else {
+                                        curr_layer = std::make_shared<DFA::EinsumLayer>(DFSL::layer_decl_);
+                                    }
+                                    layer_type = LayerType::EINSUM;
+                                }
                                 else if(tkn == DFSL::layer_type_fc_) {
                                     //TODO
                                 }
@@ -578,10 +778,11 @@ namespace maestro {
                                     case DFA::directive::DirectiveClass::TemporalMap: {
                                         curr_directive = std::make_shared<DFA::directive::TemporalMap> (map_size, map_offset, tkn);
                                         //felix20210528
-                                        if (tkn=="R" or tkn=="S"){
+                                        // Windows of EINSUM layers are checked with the whole layer (CheckEinsum)
+                                        if (layer_type != LayerType::EINSUM && (tkn=="R" or tkn=="S")){
                                             if (map_size != map_offset){
                                                 std::cout<<"[Error] Invalid mapping at line number: "<< line_number<<" in " <<file_name_<< ". Tile size of "<<tkn<<"("<<map_size<<") should be equal to tile offset of "<<tkn<<"("<<map_offset<<")."<<std::endl;
-                                                exit(-1);
+                                                error_handler_->TerminateProgram(TL::ErrorCode::InvalidDirective);
 //                        std::cout<<"[Warning] Invalid mapping: Line_number: " << line_number << ":"<< line<<std::endl;
                                             }
                                             for (auto d: *dim_vector){
@@ -589,7 +790,7 @@ namespace maestro {
                                                     if(d->GetSize() != map_size){
 //                            std::cout<<"[Error] Invalid mapping: ";
                                                         std::cout<<"[Error] Invalid mapping at line number: "<< line_number<<" in " <<file_name_<<". Tile size of "<<tkn<<"("<<map_size<<") should be equal to dimension size of "<<tkn<<"("<<d->GetSize()<<")."<<std::endl;
-                                                        exit(-1);
+                                                        error_handler_->TerminateProgram(TL::ErrorCode::InvalidDirective);
 //                            std::cout<<"[Warning] Invalid mapping: Line_number: " << line_number << ":"<< line<<std::endl;
                                                     }
                                                 }
@@ -977,6 +1178,60 @@ namespace maestro {
 
         protected:
             ParserState state_ = ParserState::Idle;
+
+            /*
+             * EINSUM layers need a consistent expression, and, like R/S of convolutions, their window
+             * dimensions must be mapped entirely by every temporal map
+             */
+            void CheckEinsum(std::shared_ptr<DFA::EinsumSpec> einsum,
+                             std::shared_ptr<std::vector<std::shared_ptr<DFA::LayerDimension>>> dimensions,
+                             std::shared_ptr<DFA::DirectiveTable> dataflow,
+                             int line_number) {
+                if(einsum == nullptr) {
+                    std::cout << "[Error] " << DFSL::layer_type_einsum_ << " layers need an einsum description: Einsum { input indices, weight indices -> output indices }" << std::endl;
+                    ParseError(line_number);
+                }
+
+                auto error_msg = einsum->Validate(dimensions);
+                if(!error_msg.empty()) {
+                    std::cout << "[Error] Invalid einsum " << einsum->ToString() << ": " << error_msg << std::endl;
+                    ParseError(line_number);
+                }
+
+                for(auto& it : einsum->GetSlidingWindows()) {
+                    int window_size = 0;
+                    for(auto& dim : *dimensions) {
+                        if(dim->GetName() == it.second) {
+                            window_size = dim->GetSize();
+                        }
+                    }
+                    for(auto& directive : *dataflow) {
+                        if(directive->GetClass() == DFA::directive::DirectiveClass::TemporalMap && directive->GetVariable() == it.second
+                           && (directive->GetSize() != window_size || directive->GetOfs() != window_size)) {
+                            std::cout << "[Error] Invalid mapping in " << file_name_ << ": tile size and offset of the window dimension "
+                                      << it.second << " should be equal to its dimension size (" << window_size << ")" << std::endl;
+                            error_handler_->TerminateProgram(TL::ErrorCode::InvalidDirective);
+                        }
+                    }
+                }
+            }
+
+            bool ParseDataClass(const std::string& tkn, DataClass& data_class) {
+                if(tkn == DFSL::tensor_class_input_) {
+                    data_class = DataClass::Input;
+                }
+                else if(tkn == DFSL::tensor_class_weight_) {
+                    data_class = DataClass::Weight;
+                }
+                else if(tkn == DFSL::tensor_class_output_) {
+                    data_class = DataClass::Output;
+                }
+                else {
+                    return false;
+                }
+                return true;
+            }
+
             int num_pes_;
             int pe_vector_width_;
             DSE::OpType mult_op_type_;
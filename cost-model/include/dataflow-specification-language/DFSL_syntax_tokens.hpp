@@ -55,6 +55,9 @@ namespace maestro {
         const std::string layer_type_ngconv_ = "NGCONV"; // Nested grouped convolution (ResNeXt)
         const std::string layer_type_lstm_ = "LSTM";
         const std::string layer_type_gemm_ = "GEMM";
+        const std::string layer_type_einsum_ = "EINSUM"; // Generic operator; Einsum { CYX, KCRS -> KYX } SlidingWindow { Y: R, X: S }
+        const std::string layer_einsum_decl_ = "Einsum";
+        const std::string layer_sliding_window_decl_ = "SlidingWindow";
         const std::string layer_stride_decl_ = "Stride";
 
         const std::string layer_precision_decl_ = "Precision";
@@ -69,6 +72,15 @@ namespace maestro {
         const std::string layer_quant_int4 = "INT4";
         const std::string layer_quant_int2 = "INT2";
 
+        const std::string layer_density_decl_ = "Density";
+        const std::string layer_sparse_format_decl_ = "SparseFormat";
+        const std::string tensor_class_input_ = "Input";
+        const std::string tensor_class_weight_ = "Weight";
+        const std::string tensor_class_output_ = "Output";
+        const std::string sparse_format_dense_ = "Dense";
+        const std::string sparse_format_bitmask_ = "Bitmask";
+        const std::string sparse_format_csr_ = "CSR";
+
         const std::string layer_dim_decl_ = "Dimensions";
         const std::string layer_dim_input_batch_    = "N";
         const std::string layer_dim_group_          = "G";
@@ -104,6 +116,28 @@ namespace maestro {
         const std::string tmp_noc_hops_decl_ = "NoC_NumHops";
         //felix
         const std::string tmp_offchip_bw_decl_ = "offchip_bw_cstr";
+        const std::string tmp_offchip_memory_decl_ = "offchip_memory";
+        const std::string offchip_memory_constant_ = "constant";
+        const std::string offchip_memory_dram_ = "dram";
+        const std::string tmp_dram_bus_bw_decl_ = "dram_bus_bw";
+        const std::string tmp_dram_burst_size_decl_ = "dram_burst_size";
+        const std::string tmp_dram_row_size_decl_ = "dram_row_size";
+        const std::string tmp_dram_num_banks_decl_ = "dram_num_banks";
+        const std::string tmp_dram_t_rcd_decl_ = "dram_t_rcd";
+        const std::string tmp_dram_t_rp_decl_ = "dram_t_rp";
+        const std::string tmp_dram_t_cas_decl_ = "dram_t_cas";
+        const std::string tmp_dram_t_turnaround_decl_ = "dram_t_turnaround";
+        const std::string tmp_noc_topology_decl_ = "noc_topology";
+        const std::string noc_topology_default_ = "default";
+        const std::string noc_topology_bus_ = "bus";
+        const std::string noc_topology_mesh_ = "mesh";
+        const std::string noc_topology_fat_tree_ = "fat_tree";
+        const std::string noc_topology_multicast_tree_ = "multicast_tree";
+        const std::string tmp_buffer_level_decl_ = "buffer_level";
+        const std::string buffer_level_size_ = "size";
+        const std::string buffer_level_bw_ = "bw";
+        const std::string buffer_level_read_energy_ = "read_energy";
+        const std::string buffer_level_write_energy_ = "write_energy";
         //====
 
         /* Hardware Resource Description */
@@ -0,0 +1,206 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DFSL_WRITER_HPP_
+#define MAESTRO_DFSL_WRITER_HPP_
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+#include "BASE_maestro-class.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_layer.hpp"
+#include "DFA_neural-network.hpp"
+#include "DFA_sparsity.hpp"
+#include "DFA_einsum.hpp"
+#include "DFSL_syntax_tokens.hpp"
+
+
+namespace maestro {
+    namespace DFSL {
+
+        /*
+         * Emits a network in the DFSL mapping format accepted by DFSLParser,
+         * e.g., to store the mappings found by the mapping search tools.
+         */
+        class DFSLWriter : public MAESTROClass {
+        public:
+            DFSLWriter(std::string file_name) :
+                    MAESTROClass("DFSL Writer"),
+                    file_name_(file_name) {
+            }
+
+            bool WriteDFSL(std::shared_ptr<DFA::NeuralNetwork> network) {
+                std::ofstream out_file(file_name_);
+                if(!out_file) {
+                    std::cout << "[MAESTRO DFSL Writer] Failed to open the output file " << file_name_ << std::endl;
+                    return false;
+                }
+
+                out_file << NetworkToString(network);
+                return true;
+            }
+
+            static std::string NetworkToString(std::shared_ptr<DFA::NeuralNetwork> network) {
+                std::string ret = network_decl_ + " " + network->GetName() + " " + brace_open_ + "\n";
+                bool is_first = true;
+                for(auto& layer : *network) {
+                    if(!is_first) {
+                        ret += "\n";
+                    }
+                    ret += LayerToString(layer);
+                    is_first = false;
+                }
+                ret += brace_close_ + "\n";
+
+                return ret;
+            }
+
+            static std::string LayerToString(std::shared_ptr<DFA::Layer> layer) {
+                std::string ret = "\t" + layer_decl_ + " " + layer->GetName() + " " + brace_open_ + "\n";
+                ret += "\t\t" + layer_type_decl_ + ": " + LayerTypeToString(layer->GetLayerType()) + "\n";
+
+                auto dimensions = layer->GetDimensions();
+
+                std::string stride_str;
+                for(auto& dim : *dimensions) {
+                    if(dim->GetOuterStride() != 1) {
+                        stride_str += (stride_str.empty()? " " : ", ") + dim->GetName() + ": " + std::to_string(dim->GetOuterStride());
+                    }
+                }
+                if(!stride_str.empty()) {
+                    ret += "\t\t" + layer_stride_decl_ + " " + brace_open_ + stride_str + " " + brace_close_ + "\n";
+                }
+
+                ret += "\t\t" + layer_precision_decl_ + " " + brace_open_ + " " + QuantizationToString(layer->getQuantization()) + " " + brace_close_ + "\n";
+
+                auto sparsity = layer->GetSparsity();
+                if(sparsity != nullptr) {
+                    const std::string* tensor_class_names[] = {&tensor_class_input_, &tensor_class_weight_, &tensor_class_output_};
+                    std::string density_str;
+                    std::string format_str;
+                    for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                        auto data_class = static_cast<DataClass>(i);
+                        density_str += (i == 0 ? " " : ", ") + *tensor_class_names[i] + ": " + std::to_string(sparsity->GetDensity(data_class));
+                        format_str += (i == 0 ? " " : ", ") + *tensor_class_names[i] + ": " + SparseFormatToString(sparsity->GetFormat(data_class));
+                    }
+                    ret += "\t\t" + layer_density_decl_ + " " + brace_open_ + density_str + " " + brace_close_ + "\n";
+                    ret += "\t\t" + layer_sparse_format_decl_ + " " + brace_open_ + format_str + " " + brace_close_ + "\n";
+                }
+
+                auto einsum = layer->GetEinsum();
+                if(layer->GetLayerType() == LayerType::EINSUM && einsum != nullptr) {
+                    ret += "\t\t" + layer_einsum_decl_ + " " + brace_open_ + " " + einsum->ToString() + " " + brace_close_ + "\n";
+                    std::string window_str;
+                    for(auto& it : einsum->GetSlidingWindows()) {
+                        window_str += (window_str.empty()? " " : ", ") + it.first + ": " + it.second;
+                    }
+                    if(!window_str.empty()) {
+                        ret += "\t\t" + layer_sliding_window_decl_ + " " + brace_open_ + window_str + " " + brace_close_ + "\n";
+                    }
+                }
+
+                ret += "\t\t" + layer_dim_decl_ + " " + brace_open_;
+                bool is_first = true;
+                for(auto& dim : *dimensions) {
+                    ret += (is_first? " " : ", ") + dim->GetName() + ": " + std::to_string(dim->GetSize());
+                    is_first = false;
+                }
+                ret += " " + brace_close_ + "\n";
+
+                auto dataflow = layer->GetDataflow();
+                if(dataflow != nullptr) {
+                    ret += "\t\t" + layer_dataflow_decl_ + " " + brace_open_ + "\n";
+                    for(auto& directive : *dataflow) {
+                        ret += "\t\t\t" + directive->ToString() + separator_ + "\n";
+                    }
+                    ret += "\t\t" + brace_close_ + "\n";
+                }
+                ret += "\t" + brace_close_ + "\n";
+
+                return ret;
+            }
+
+            static std::string LayerTypeToString(LayerType layer_type) {
+                switch(layer_type) {
+                    case LayerType::GEMM:
+                        return layer_type_gemm_;
+                    case LayerType::DSCONV:
+                        return layer_type_dsconv_;
+                    case LayerType::NGCONV:
+                        return layer_type_ngconv_;
+                    case LayerType::EINSUM:
+                        return layer_type_einsum_;
+                    case LayerType::CONV:
+                    default:
+                        return layer_type_conv_;
+                }
+            }
+
+            static std::string QuantizationToString(LayerQuantizationType quantization) {
+                switch(quantization) {
+                    case LayerQuantizationType::FP16:
+                        return layer_quant_fp16;
+                    case LayerQuantizationType::FP8:
+                        return layer_quant_fp8;
+                    case LayerQuantizationType::FP4:
+                        return layer_quant_fp4;
+                    case LayerQuantizationType::FP2:
+                        return layer_quant_fp2;
+                    case LayerQuantizationType::INT32:
+                        return layer_quant_int32;
+                    case LayerQuantizationType::INT16:
+                        return layer_quant_int16;
+                    case LayerQuantizationType::INT8:
+                        return layer_quant_int8;
+                    case LayerQuantizationType::INT4:
+                        return layer_quant_int4;
+                    case LayerQuantizationType::INT2:
+                        return layer_quant_int2;
+                    case LayerQuantizationType::FP32:
+                    default:
+                        return layer_quant_fp32;
+                }
+            }
+
+            static std::string SparseFormatToString(DFA::SparseFormat format) {
+                switch(format) {
+                    case DFA::SparseFormat::Dense:
+                        return sparse_format_dense_;
+                    case DFA::SparseFormat::CSR:
+                        return sparse_format_csr_;
+                    case DFA::SparseFormat::Bitmask:
+                    default:
+                        return sparse_format_bitmask_;
+                }
+            }
+
+        protected:
+            std::string file_name_;
+        }; // End of class DFSLWriter
+    }; // End of namespace DFSL
+}; // End of namespace maestro
+
+#endif
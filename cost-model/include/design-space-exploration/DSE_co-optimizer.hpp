@@ -0,0 +1,463 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DSE_CO_OPTIMIZER_HPP_
+#define MAESTRO_DSE_CO_OPTIMIZER_HPP_
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <map>
+#include <utility>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+
+#include "DFA_directive-table.hpp"
+#include "DFA_layer.hpp"
+#include "DFA_neural-network.hpp"
+#include "DFA_tensor.hpp"
+
+#include "DFSL_hw-parser.hpp"
+#include "DFSL_writer.hpp"
+
+#include "DSE_config.hpp"
+#include "DSE_hardware_modules.hpp"
+#include "DSE_genetic-mapper.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+    namespace DSE {
+
+        // One hardware point of the co-optimization with the best mapping of every layer on it
+        class CoDesignPoint {
+        public:
+            int num_pes_ = 1;
+            int noc_bw_ = 1;
+            int l1_size_ = 0;
+            int l2_size_ = 0;
+            double area_ = 0;
+            double power_ = 0;
+
+            // Within the area and power constraints; the other points are not searched
+            bool is_searched_ = false;
+            long runtime_ = 0;
+            double energy_ = 0;
+            bool fits_buffers_ = false;
+            bool is_pareto_optimal_ = false;
+
+            std::shared_ptr<DFA::NeuralNetwork> network_ = nullptr;
+            std::string mapping_file_name_ = "";
+
+            double GetEDP() {
+                return static_cast<double>(runtime_) * energy_;
+            }
+
+            // Not worse in runtime, energy, and area, and better in one of them
+            bool Dominates(const CoDesignPoint& other) const {
+                bool not_worse = runtime_ <= other.runtime_ && energy_ <= other.energy_ && area_ <= other.area_;
+                bool better = runtime_ < other.runtime_ || energy_ < other.energy_ || area_ < other.area_;
+                return not_worse && better;
+            }
+        }; // End of class CoDesignPoint
+
+        /*
+         * Searches the hardware (PEs, top-level NoC bandwidth, L1 and L2 sizes) and the mapping of every
+         * layer jointly. Every point of the hardware grid whose DSE::Accelerator area and power meet the
+         * constraints gets a genetic mapping search for each distinct layer shape of the network (repeated
+         * layers are searched once). Points are visited in grid order, and each search reuses the parsed
+         * layers, seeds its populations with the best mappings of the previously searched points, and
+         * shares exact analyses with the points that have the same PEs and NoC bandwidth (the analysis
+         * does not depend on the buffer capacities, only the buffer fit does). The result is the set of
+         * (hardware, mapping) pairs that are Pareto-optimal in end-to-end runtime, energy, and area among
+         * the points whose mappings fit the buffers (all the searched points if none does).
+         */
+        class CoOptimizer : public MAESTROClass {
+        public:
+            // Number of previously searched hardware points whose best mappings seed a search
+            const int max_seed_points_ = 4;
+
+            CoOptimizer(std::shared_ptr<DFA::NeuralNetwork> network,
+                        std::shared_ptr<DFSL::HWConfig> hw_config,
+                        int simd_width,
+                        OptimizationTarget objective,
+                        double area_cap,
+                        double power_cap,
+                        int population_size,
+                        int num_generations,
+                        double mutation_rate,
+                        int num_elites,
+                        unsigned int seed,
+                        int num_threads) :
+                    MAESTROClass("CoOptimizer"),
+                    network_(network),
+                    hw_config_(hw_config),
+                    simd_width_(simd_width),
+                    objective_(objective),
+                    area_cap_(area_cap),
+                    power_cap_(power_cap),
+                    population_size_(population_size),
+                    num_generations_(num_generations),
+                    mutation_rate_(mutation_rate),
+                    num_elites_(num_elites),
+                    seed_(seed),
+                    num_threads_(num_threads) {
+            }
+
+            // Candidate values of each hardware parameter; an empty list keeps the value of the given hardware
+            void SetHardwareCandidates(std::vector<int> num_pes, std::vector<int> noc_bws,
+                                       std::vector<int> l1_sizes, std::vector<int> l2_sizes) {
+                pe_candidates_ = num_pes;
+                noc_bw_candidates_ = noc_bws;
+                l1_size_candidates_ = l1_sizes;
+                l2_size_candidates_ = l2_sizes;
+            }
+
+            void SetPruning(bool use_pruning) {
+                use_pruning_ = use_pruning;
+            }
+
+            std::vector<CoDesignPoint>& GetDesignPoints() {
+                return design_points_;
+            }
+
+            int GetNumSearchedPoints() {
+                int ret = 0;
+                for(auto& design_point : design_points_) {
+                    ret += design_point.is_searched_ ? 1 : 0;
+                }
+                return ret;
+            }
+
+            int GetNumUniqueLayers() {
+                return unique_layers_.size();
+            }
+
+            long GetNumEvaluations() {
+                return num_evaluations_;
+            }
+
+            long GetNumCacheHits() {
+                return num_cache_hits_;
+            }
+
+            // Analyses taken from another hardware point with the same PEs and NoC bandwidth
+            long GetNumSharedHits() {
+                long ret = 0;
+                for(auto& it : shared_caches_) {
+                    ret += it.second->GetNumHits();
+                }
+                return ret;
+            }
+
+            bool Run() {
+                ConstructUniqueLayers();
+                ConstructDesignPoints();
+                if(GetNumSearchedPoints() == 0) {
+                    double min_area = design_points_.front().area_;
+                    double min_power = design_points_.front().power_;
+                    for(auto& design_point : design_points_) {
+                        min_area = std::min(min_area, design_point.area_);
+                        min_power = std::min(min_power, design_point.power_);
+                    }
+                    std::cout << "[CoOptimizer] No hardware point meets the area (" << area_cap_ << ") and power ("
+                              << power_cap_ << ") constraints; the smallest area is " << min_area
+                              << " and the lowest power " << min_power << std::endl;
+                    return false;
+                }
+
+                int num_searched = 0;
+                for(auto& design_point : design_points_) {
+                    if(!design_point.is_searched_) {
+                        continue;
+                    }
+                    SearchDesignPoint(design_point);
+                    num_searched++;
+                    std::cout << "[CoOptimizer] Hardware point " << num_searched << "/" << GetNumSearchedPoints()
+                              << " (" << design_point.num_pes_ << " PEs, NoC bandwidth " << design_point.noc_bw_
+                              << ", L1 " << design_point.l1_size_ << ", L2 " << design_point.l2_size_ << "): runtime "
+                              << design_point.runtime_ << " cycles, energy " << design_point.energy_ << " nJ"
+                              << (design_point.fits_buffers_ ? "" : " [exceeds buffer capacity]") << std::endl;
+                }
+
+                MarkParetoOptimal();
+                return true;
+            }
+
+            // Writes every hardware point to <output_prefix>.csv and the mappings of the Pareto-optimal ones to <output_prefix>_<idx>.m
+            bool WriteResults(std::string output_prefix) {
+                int pareto_idx = 0;
+                for(auto& design_point : design_points_) {
+                    if(!design_point.is_pareto_optimal_) {
+                        continue;
+                    }
+                    design_point.mapping_file_name_ = output_prefix + "_" + std::to_string(pareto_idx) + ".m";
+                    DFSL::DFSLWriter dfsl_writer(design_point.mapping_file_name_);
+                    if(!dfsl_writer.WriteDFSL(design_point.network_)) {
+                        return false;
+                    }
+                    pareto_idx++;
+                }
+
+                std::string csv_file_name = output_prefix + ".csv";
+                std::ofstream out_file(csv_file_name);
+                if(!out_file.is_open()) {
+                    std::cout << "[CoOptimizer] Failed to open " << csv_file_name << std::endl;
+                    return false;
+                }
+
+                out_file << "NumPEs, NoC BW, L1 Size, L2 Size, Vector Width, Area, Power, Within Constraints, "
+                         << "Runtime (Cycles), Energy (nJ), EDP, Fits Buffers, Pareto Optimal, Mapping File" << std::endl;
+                for(auto& design_point : design_points_) {
+                    out_file << design_point.num_pes_ << ", " << design_point.noc_bw_ << ", " << design_point.l1_size_ << ", "
+                             << design_point.l2_size_ << ", " << simd_width_ << ", " << design_point.area_ << ", "
+                             << design_point.power_ << ", " << (design_point.is_searched_ ? "yes" : "no") << ", ";
+                    if(design_point.is_searched_) {
+                        out_file << design_point.runtime_ << ", " << design_point.energy_ << ", " << design_point.GetEDP() << ", "
+                                 << (design_point.fits_buffers_ ? "yes" : "no") << ", ";
+                    }
+                    else {
+                        out_file << ", , , , ";
+                    }
+                    out_file << (design_point.is_pareto_optimal_ ? "yes" : "no") << ", " << design_point.mapping_file_name_ << std::endl;
+                }
+                return true;
+            }
+
+            void PrintParetoFront() {
+                std::cout << "NumPEs, NoC BW, L1 Size, L2 Size, Area, Power, Runtime (Cycles), Energy (nJ), EDP, Fits Buffers, Mapping File" << std::endl;
+                for(auto& design_point : design_points_) {
+                    if(!design_point.is_pareto_optimal_) {
+                        continue;
+                    }
+                    std::cout << design_point.num_pes_ << ", " << design_point.noc_bw_ << ", " << design_point.l1_size_ << ", "
+                              << design_point.l2_size_ << ", " << design_point.area_ << ", " << design_point.power_ << ", "
+                              << design_point.runtime_ << ", " << design_point.energy_ << ", " << design_point.GetEDP() << ", "
+                              << (design_point.fits_buffers_ ? "yes" : "no") << ", " << design_point.mapping_file_name_ << std::endl;
+                }
+            }
+
+        protected:
+            std::shared_ptr<DFA::NeuralNetwork> network_;
+            std::shared_ptr<DFSL::HWConfig> hw_config_;
+            int simd_width_;
+            OptimizationTarget objective_;
+            double area_cap_;
+            double power_cap_;
+
+            int population_size_;
+            int num_generations_;
+            double mutation_rate_;
+            int num_elites_;
+            unsigned int seed_;
+            int num_threads_;
+            bool use_pruning_ = true;
+
+            std::vector<int> pe_candidates_;
+            std::vector<int> noc_bw_candidates_;
+            std::vector<int> l1_size_candidates_;
+            std::vector<int> l2_size_candidates_;
+
+            std::vector<CoDesignPoint> design_points_;
+            long num_evaluations_ = 0;
+            long num_cache_hits_ = 0;
+
+            // First layer of each distinct shape, and the index of its shape for every layer of the network
+            std::vector<std::shared_ptr<DFA::Layer>> unique_layers_;
+            std::vector<int> unique_layer_idx_;
+
+            // Keyed by (PEs, NoC bandwidth)
+            std::map<std::pair<int, int>, std::shared_ptr<SharedResultCache>> shared_caches_;
+            // Best mappings of the most recently searched hardware points, oldest first
+            std::deque<std::map<std::string, MappingGenome>> recent_genomes_;
+
+        private:
+            // Everything but the name and the mapping of a layer
+            static std::string GetLayerShapeKey(std::shared_ptr<DFA::Layer> layer) {
+                std::string ret = std::to_string(static_cast<int>(layer->GetLayerType())) + ";"
+                                  + std::to_string(static_cast<int>(layer->getQuantization())) + ";";
+                for(auto& dim : *layer->GetDimensions()) {
+                    ret += dim->GetName() + ":" + std::to_string(dim->GetSize()) + "/" + std::to_string(dim->GetOuterStride())
+                           + "/" + std::to_string(dim->GetInnerStride()) + ",";
+                }
+
+                auto sparsity = layer->GetSparsity();
+                if(sparsity != nullptr) {
+                    for(auto data_class : {DataClass::Input, DataClass::Weight, DataClass::Output}) {
+                        ret += ";" + std::to_string(sparsity->GetDensity(data_class))
+                               + "/" + std::to_string(static_cast<int>(sparsity->GetFormat(data_class)));
+                    }
+                }
+
+                if(layer->GetEinsum() != nullptr) {
+                    ret += ";" + layer->GetEinsum()->ToString();
+                    for(auto& it : DFA::GetSlidingWindows(layer)) {
+                        ret += "," + it.first + ":" + it.second;
+                    }
+                }
+                return ret;
+            }
+
+            void ConstructUniqueLayers() {
+                unique_layers_.clear();
+                unique_layer_idx_.clear();
+
+                std::map<std::string, int> shape_ids;
+                for(auto layer : *network_) {
+                    auto key = GetLayerShapeKey(layer);
+                    if(shape_ids.find(key) == shape_ids.end()) {
+                        shape_ids[key] = unique_layers_.size();
+                        unique_layers_.push_back(layer);
+                    }
+                    unique_layer_idx_.push_back(shape_ids[key]);
+                }
+            }
+
+            // The grid over the candidate lists, the last parameter varying fastest
+            void ConstructDesignPoints() {
+                design_points_.clear();
+                auto num_pes_list = pe_candidates_.empty() ? std::vector<int>{hw_config_->num_pes_} : pe_candidates_;
+                auto noc_bw_list = noc_bw_candidates_.empty() ? std::vector<int>{GetTopNoCBandwidth()} : noc_bw_candidates_;
+                auto l1_size_list = l1_size_candidates_.empty() ? std::vector<int>{hw_config_->l1_size_} : l1_size_candidates_;
+                auto l2_size_list = l2_size_candidates_.empty() ? std::vector<int>{hw_config_->l2_size_} : l2_size_candidates_;
+
+                for(auto num_pes : num_pes_list) {
+                    for(auto noc_bw : noc_bw_list) {
+                        for(auto l1_size : l1_size_list) {
+                            for(auto l2_size : l2_size_list) {
+                                CoDesignPoint design_point;
+                                design_point.num_pes_ = num_pes;
+                                design_point.noc_bw_ = noc_bw;
+                                design_point.l1_size_ = l1_size;
+                                design_point.l2_size_ = l2_size;
+
+                                Accelerator accelerator(num_pes, simd_width_, noc_bw, l1_size, l2_size);
+                                design_point.area_ = accelerator.GetArea();
+                                design_point.power_ = accelerator.GetPower();
+                                design_point.is_searched_ = design_point.area_ <= area_cap_ && design_point.power_ <= power_cap_;
+                                design_points_.push_back(design_point);
+                            }
+                        }
+                    }
+                }
+            }
+
+            // NoC bandwidth of the top cluster level (the last per-level entry covers the levels beyond the list)
+            int GetTopNoCBandwidth() {
+                return hw_config_->noc_bws_.empty() ? hw_config_->noc_bw_ : hw_config_->noc_bws_.back();
+            }
+
+            std::shared_ptr<DFSL::HWConfig> ConstructHWConfig(const CoDesignPoint& design_point) {
+                auto ret = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                ret->num_pes_ = design_point.num_pes_;
+                ret->noc_bw_ = design_point.noc_bw_;
+                if(!ret->noc_bws_.empty()) {
+                    ret->noc_bws_.back() = design_point.noc_bw_;
+                }
+                ret->l1_size_ = design_point.l1_size_;
+                ret->l2_size_ = design_point.l2_size_;
+                return ret;
+            }
+
+            void SearchDesignPoint(CoDesignPoint& design_point) {
+                auto& shared_cache = shared_caches_[std::make_pair(design_point.num_pes_, design_point.noc_bw_)];
+                if(shared_cache == nullptr) {
+                    shared_cache = std::make_shared<SharedResultCache>();
+                }
+
+                auto evaluator = std::make_shared<LayerEvaluator>(ConstructHWConfig(design_point), simd_width_);
+                GeneticMapper mapper(evaluator, objective_, population_size_, num_generations_, mutation_rate_,
+                                     num_elites_, seed_, num_threads_);
+                mapper.SetPruning(use_pruning_);
+                mapper.SetSharedCache(shared_cache);
+                mapper.SetReporting(false);
+                for(auto it = recent_genomes_.rbegin(); it != recent_genomes_.rend(); ++it) {
+                    for(auto& genome : *it) {
+                        mapper.AddSeedGenome(genome.first, genome.second);
+                    }
+                }
+
+                std::vector<std::shared_ptr<DFA::DirectiveTable>> best_dataflows;
+                for(auto& layer : unique_layers_) {
+                    best_dataflows.push_back(mapper.SearchLayer(layer));
+                }
+
+                design_point.network_ = std::make_shared<DFA::NeuralNetwork>(network_->GetName());
+                design_point.runtime_ = 0;
+                design_point.energy_ = 0;
+                design_point.fits_buffers_ = true;
+                auto& best_fitnesses = mapper.GetBestFitnesses();
+                for(int layer_id = 0; layer_id < network_->GetNumLayers(); layer_id++) {
+                    int unique_idx = unique_layer_idx_[layer_id];
+                    auto best_layer = DFA::CloneLayer(network_->at(layer_id));
+                    best_layer->SetDataflow(best_dataflows[unique_idx]->Clone());
+                    design_point.network_->AddLayer(best_layer);
+
+                    auto& fitness = best_fitnesses[unique_layers_[unique_idx]->GetName()];
+                    design_point.runtime_ += fitness.design_point_->runtime_;
+                    design_point.energy_ += fitness.design_point_->energy_;
+                    design_point.fits_buffers_ = design_point.fits_buffers_ && fitness.fits_buffers_;
+                }
+
+                recent_genomes_.push_back(mapper.GetBestGenomes());
+                if(recent_genomes_.size() > max_seed_points_) {
+                    recent_genomes_.pop_front();
+                }
+                num_evaluations_ += mapper.GetNumEvaluations();
+                num_cache_hits_ += mapper.GetNumCacheHits();
+            }
+
+            void MarkParetoOptimal() {
+                bool has_fitting_point = false;
+                for(auto& design_point : design_points_) {
+                    has_fitting_point = has_fitting_point || (design_point.is_searched_ && design_point.fits_buffers_);
+                }
+
+                std::vector<int> candidates;
+                for(int idx = 0; idx < design_points_.size(); idx++) {
+                    auto& design_point = design_points_[idx];
+                    if(design_point.is_searched_ && (design_point.fits_buffers_ || !has_fitting_point)) {
+                        candidates.push_back(idx);
+                    }
+                }
+
+                for(auto idx : candidates) {
+                    bool is_dominated = false;
+                    for(auto other_idx : candidates) {
+                        if(design_points_[other_idx].Dominates(design_points_[idx])) {
+                            is_dominated = true;
+                            break;
+                        }
+                    }
+                    design_points_[idx].is_pareto_optimal_ = !is_dominated;
+                }
+            }
+        }; // End of class CoOptimizer
+    }; // End of namespace DSE
+}; // End of namespace maestro
+
+#endif
@@ -27,7 +27,7 @@ namespace maestro {
 
     namespace DSE {
 
-        enum class OptimizationTarget {Runtime, Energy, PerformancePerWatt};
+        enum class OptimizationTarget {Runtime, Energy, PerformancePerWatt, EnergyDelayProduct};
 
     }; // End of namespace DSE
 }; // End of namesapce maestro
@@ -27,6 +27,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <stdexcept>
 
 #include "DSE_design_point.hpp"
 #include "API_configuration.hpp"
@@ -151,8 +152,7 @@ namespace maestro {
                     case LayerQuantizationType::INT2:
                         return 16;
                     default:
-                        std::cerr << "Unsupported quantization type" << std::endl;
-                        exit(EXIT_FAILURE);
+                        throw std::invalid_argument("Unsupported quantization type");
                 }
 
             }
@@ -26,6 +26,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <iostream>
 #include <memory>
 #include <list>
+#include <vector>
 
 #include "DSE_config.hpp"
 
@@ -46,6 +47,18 @@ namespace maestro {
             int vector_width_ = 1;
             int l2_sram_sz = 1;
             int l1_sram_sz = 1;
+
+            // Per-layer energy breakdown (nJ)
+            long num_macs_ = 0;
+            double mac_energy_ = 0;
+            double l1_energy_ = 0;
+            double l2_energy_ = 0;
+            double noc_energy_ = 0;
+
+            // Per buffer level declared in the HW description (outermost first); empty otherwise
+            std::vector<double> buffer_energy_;
+            std::vector<long> buffer_size_req_; // Bytes
+            bool fits_buffers_ = true;
             std::shared_ptr<std::list<std::pair<std::string, double>>> multicasting_factors_;
 
             DesignPoint(OptimizationTarget optimization_target, long runtime,
@@ -73,11 +86,29 @@ namespace maestro {
                         case OptimizationTarget::PerformancePerWatt:
                             ret = performance_per_energy_ > dp->performance_per_energy_;
                             break;
+                        case OptimizationTarget::EnergyDelayProduct:
+                            ret = GetCost(target_) < dp->GetCost(target_);
+                            break;
                     }
                 }
                 return ret;
             }
 
+            // Scalar cost of this design point under the given target; lower is better
+            double GetCost(OptimizationTarget target) {
+                switch (target) {
+                    case OptimizationTarget::Energy:
+                        return energy_;
+                    case OptimizationTarget::PerformancePerWatt:
+                        return -static_cast<double>(performance_per_energy_);
+                    case OptimizationTarget::EnergyDelayProduct:
+                        return static_cast<double>(runtime_) * energy_;
+                    case OptimizationTarget::Runtime:
+                    default:
+                        return static_cast<double>(runtime_);
+                }
+            }
+
             void PutMulticastingFactor(std::string dataclass, double factor) {
                 multicasting_factors_->push_back(std::make_pair(dataclass, factor));
             }
@@ -0,0 +1,701 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DSE_GENETIC_MAPPER_HPP_
+#define MAESTRO_DSE_GENETIC_MAPPER_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <random>
+#include <limits>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_constants.hpp"
+#include "TL_thread-pool.hpp"
+
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_layer.hpp"
+#include "DFA_tensor.hpp"
+#include "DFA_neural-network.hpp"
+#include "DFSL_syntax_tokens.hpp"
+
+#include "CA_lower-bounds.hpp"
+
+#include "DSE_config.hpp"
+#include "DSE_design_point.hpp"
+#include "DSE_surrogate-model.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+    namespace DSE {
+
+        /*
+         * Two-level mapping (outer cluster level, Cluster(cluster_size_, P), inner PE level).
+         * Tile sizes of sliding dimensions (Y/X, or those of EINSUM sliding windows) are in output positions;
+         * window dimensions (R/S) are always mapped entirely.
+         */
+        class MappingGenome {
+        public:
+            std::vector<std::string> outer_order_;
+            std::vector<std::string> inner_order_;
+            std::string outer_spatial_dim_;
+            std::string inner_spatial_dim_;
+            std::map<std::string, int> outer_tile_;
+            std::map<std::string, int> inner_tile_;
+            int cluster_size_ = 1;
+        }; // End of class MappingGenome
+
+        class MappingFitness {
+        public:
+            double cost_ = std::numeric_limits<double>::max();
+            bool fits_buffers_ = false;
+            bool pruned_ = false; // cost_ and fits_buffers_ are lower-bound estimates; design_point_ is not set
+            bool predicted_ = false; // cost_ is a surrogate model estimate; design_point_ is not set
+            std::shared_ptr<DesignPoint> design_point_ = nullptr;
+
+            // Pruned mappings cannot beat the incumbent, so they rank behind every analyzed one
+            bool IsBetterThan(const MappingFitness& other) const {
+                if(pruned_ != other.pruned_) {
+                    return other.pruned_;
+                }
+                if(fits_buffers_ != other.fits_buffers_) {
+                    return fits_buffers_;
+                }
+                return cost_ < other.cost_;
+            }
+        }; // End of class MappingFitness
+
+        /*
+         * Analysis results (keyed by layer name and mapping) shared by the mappers of hardware points that
+         * only differ in their L1/L2 capacities; the analysis does not depend on them, only the buffer fit does.
+         */
+        class SharedResultCache {
+        public:
+            std::shared_ptr<DesignPoint> Find(const std::string& key) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = results_.find(key);
+                if(it == results_.end()) {
+                    return nullptr;
+                }
+                num_hits_++;
+                return it->second;
+            }
+
+            void Insert(const std::string& key, std::shared_ptr<DesignPoint> design_point) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                results_[key] = design_point;
+            }
+
+            long GetNumHits() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return num_hits_;
+            }
+
+        protected:
+            std::mutex mutex_;
+            std::map<std::string, std::shared_ptr<DesignPoint>> results_;
+            long num_hits_ = 0;
+        }; // End of class SharedResultCache
+
+        /*
+         * GAMMA-style genetic search over the DFSL directive space (loop order, spatial dimension,
+         * tile sizes and cluster size) of each layer. Fitness is evaluated in-process on a thread pool,
+         * and every evaluated mapping is cached so re-generated individuals are not re-analyzed.
+         * Candidates whose analytical lower bound cannot beat the best mapping of earlier generations
+         * are pruned without running the cost analysis. With a surrogate model, the remaining candidates
+         * of a generation are ranked by their predicted cost and only the best ones are analyzed exactly;
+         * the others keep their predictions (uncached, so they are screened again if they reappear).
+         * Searches over related hardware points can share exact results (SharedResultCache) and seed
+         * each other's first populations with their best mappings.
+         */
+        class GeneticMapper : public MAESTROClass {
+        public:
+            GeneticMapper(std::shared_ptr<LayerEvaluator> evaluator,
+                          OptimizationTarget objective,
+                          int population_size,
+                          int num_generations,
+                          double mutation_rate,
+                          int num_elites,
+                          unsigned int seed,
+                          int num_threads) :
+                    MAESTROClass("GeneticMapper"),
+                    evaluator_(evaluator),
+                    objective_(objective),
+                    population_size_(std::max(population_size, 2)),
+                    num_generations_(std::max(num_generations, 1)),
+                    mutation_rate_(mutation_rate),
+                    num_elites_(std::max(std::min(num_elites, population_size - 1), 0)),
+                    rng_(seed),
+                    thread_pool_(num_threads) {
+                lower_bound_analysis_ = std::make_shared<CA::LowerBoundAnalysis>(evaluator->GetHWConfig(), evaluator->GetSIMDWidth());
+            }
+
+            void SetPruning(bool use_pruning) {
+                use_pruning_ = use_pruning;
+            }
+
+            // Analyze only the num_exact best-predicted new mappings of each generation exactly (nullptr: all)
+            void SetSurrogate(std::shared_ptr<SurrogateModel> surrogate, int num_exact) {
+                surrogate_ = surrogate;
+                num_exact_ = std::max(num_exact, 1);
+            }
+
+            void SetSharedCache(std::shared_ptr<SharedResultCache> shared_cache) {
+                shared_cache_ = shared_cache;
+            }
+
+            // Prints one summary line per searched layer
+            void SetReporting(bool do_report) {
+                do_report_ = do_report;
+            }
+
+            /*
+             * Mappings placed in the first population of the layer with the given name (e.g., the best ones
+             * on similar hardware); their cluster sizes are adapted to the PEs of this mapper's hardware.
+             */
+            void AddSeedGenome(std::string layer_name, const MappingGenome& genome) {
+                seed_genomes_[layer_name].push_back(genome);
+            }
+
+            // Best mapping (and its fitness) of every layer searched so far, by layer name
+            std::map<std::string, MappingGenome>& GetBestGenomes() {
+                return best_genomes_;
+            }
+
+            std::map<std::string, MappingFitness>& GetBestFitnesses() {
+                return best_fitnesses_;
+            }
+
+            // Returns a copy of the network in which every layer carries the best mapping found
+            std::shared_ptr<DFA::NeuralNetwork> SearchNetwork(std::shared_ptr<DFA::NeuralNetwork> network) {
+                auto ret = std::make_shared<DFA::NeuralNetwork>(network->GetName());
+                for(auto& layer : *network) {
+                    auto best_layer = DFA::CloneLayer(layer);
+                    best_layer->SetDataflow(SearchLayer(layer));
+                    ret->AddLayer(best_layer);
+                }
+                return ret;
+            }
+
+            // Searches the mapping of a single layer; the mapping given in the DFSL file is only used for its dimensions
+            std::shared_ptr<DFA::DirectiveTable> SearchLayer(std::shared_ptr<DFA::Layer> layer) {
+                ConstructSearchSpace(layer);
+
+                std::vector<MappingGenome> population;
+                for(int idx = 0; idx < population_size_; idx++) {
+                    population.push_back(RandomGenome());
+                }
+                auto seeds = seed_genomes_.find(layer->GetName());
+                if(seeds != seed_genomes_.end()) {
+                    int num_seeds = std::min(static_cast<int>(seeds->second.size()), population_size_ / 2);
+                    for(int idx = 0; idx < num_seeds; idx++) {
+                        population[idx] = AdaptGenome(seeds->second[idx]);
+                    }
+                }
+
+                MappingGenome best_genome = population.front();
+                MappingFitness best_fitness;
+                long num_cache_hits_before = num_cache_hits_;
+                long num_evaluations_before = num_evaluations_;
+                long num_predictions_before = num_predictions_;
+                CA::PruningStats layer_pruning_stats;
+
+                for(int generation = 0; generation <= num_generations_; generation++) {
+                    auto fitness = EvaluatePopulation(layer, population, best_fitness, layer_pruning_stats);
+
+                    std::vector<int> rank(population.size());
+                    for(int idx = 0; idx < rank.size(); idx++) {
+                        rank[idx] = idx;
+                    }
+                    std::stable_sort(rank.begin(), rank.end(), [&fitness](int lhs, int rhs) {
+                        return fitness[lhs].IsBetterThan(fitness[rhs]);
+                    });
+
+                    // The best mapping is always an exactly analyzed one
+                    for(auto idx : rank) {
+                        if(fitness[idx].design_point_ == nullptr) {
+                            continue;
+                        }
+                        if(fitness[idx].IsBetterThan(best_fitness)) {
+                            best_fitness = fitness[idx];
+                            best_genome = population[idx];
+                        }
+                        break;
+                    }
+
+                    message_printer_->PrintMsg(1, "[GeneticMapper] Layer " + layer->GetName() + ", generation " + std::to_string(generation)
+                                                  + ", best cost " + std::to_string(best_fitness.cost_));
+
+                    if(generation == num_generations_) {
+                        break;
+                    }
+
+                    std::vector<MappingGenome> next_population;
+                    for(int idx = 0; idx < num_elites_; idx++) {
+                        next_population.push_back(population[rank[idx]]);
+                    }
+                    while(next_population.size() < population_size_) {
+                        auto& parent_a = population[SelectParent(rank)];
+                        auto& parent_b = population[SelectParent(rank)];
+                        auto child = Crossover(parent_a, parent_b);
+                        Mutate(child);
+                        Repair(child);
+                        next_population.push_back(child);
+                    }
+                    population = next_population;
+                }
+
+                auto best_dataflow = ConstructDataflow(best_genome);
+                best_genomes_[layer->GetName()] = best_genome;
+                best_fitnesses_[layer->GetName()] = best_fitness;
+                pruning_stats_.Accumulate(layer_pruning_stats);
+                if(!do_report_) {
+                    return best_dataflow;
+                }
+
+                std::cout << "[GeneticMapper] Layer " << layer->GetName() << ": best cost " << best_fitness.cost_
+                          << " (runtime " << best_fitness.design_point_->runtime_ << " cycles, energy "
+                          << best_fitness.design_point_->energy_ << " nJ)"
+                          << (best_fitness.fits_buffers_ ? "" : " [exceeds buffer capacity]")
+                          << ", " << (num_evaluations_ - num_evaluations_before) << " evaluations, "
+                          << (num_cache_hits_ - num_cache_hits_before) << " cache hits";
+                if(use_pruning_) {
+                    std::cout << ", " << layer_pruning_stats.ToString();
+                }
+                if(surrogate_ != nullptr) {
+                    std::cout << ", " << (num_predictions_ - num_predictions_before) << " surrogate predictions";
+                }
+                std::cout << std::endl;
+
+                return best_dataflow;
+            }
+
+            // Random mappings from the search space of the layer (e.g., to train a surrogate model)
+            std::vector<std::shared_ptr<DFA::DirectiveTable>> SampleDataflows(std::shared_ptr<DFA::Layer> layer, int num_dataflows) {
+                ConstructSearchSpace(layer);
+                std::vector<std::shared_ptr<DFA::DirectiveTable>> ret;
+                for(int idx = 0; idx < num_dataflows; idx++) {
+                    ret.push_back(ConstructDataflow(RandomGenome()));
+                }
+                return ret;
+            }
+
+            std::shared_ptr<DFA::DirectiveTable> ConstructDataflow(const MappingGenome& genome) {
+                auto ret = std::make_shared<DFA::DirectiveTable>();
+                AddLevelDirectives(ret, genome.outer_order_, genome.outer_spatial_dim_, genome.outer_tile_);
+                ret->AddDirective(std::make_shared<DFA::directive::Cluster>(genome.cluster_size_, DFA::directive::ClusterType::Physical));
+                AddLevelDirectives(ret, genome.inner_order_, genome.inner_spatial_dim_, genome.inner_tile_);
+                return ret;
+            }
+
+            long GetNumEvaluations() {
+                return num_evaluations_;
+            }
+
+            long GetNumCacheHits() {
+                return num_cache_hits_;
+            }
+
+            long GetNumPredictions() {
+                return num_predictions_;
+            }
+
+            CA::PruningStats GetPruningStats() {
+                return pruning_stats_;
+            }
+
+        protected:
+            std::shared_ptr<LayerEvaluator> evaluator_;
+            OptimizationTarget objective_;
+            int population_size_;
+            int num_generations_;
+            double mutation_rate_;
+            int num_elites_;
+            std::mt19937 rng_;
+            TL::ThreadPool thread_pool_;
+
+            std::mutex cache_mutex_;
+            std::map<std::string, MappingFitness> fitness_cache_;
+            long num_evaluations_ = 0;
+            long num_cache_hits_ = 0;
+
+            bool use_pruning_ = true;
+            std::shared_ptr<CA::LowerBoundAnalysis> lower_bound_analysis_;
+            CA::PruningStats pruning_stats_;
+
+            std::shared_ptr<SurrogateModel> surrogate_ = nullptr;
+            int num_exact_ = 1;
+            long num_predictions_ = 0;
+
+            std::shared_ptr<SharedResultCache> shared_cache_ = nullptr;
+            bool do_report_ = true;
+            std::map<std::string, std::vector<MappingGenome>> seed_genomes_;
+            std::map<std::string, MappingGenome> best_genomes_;
+            std::map<std::string, MappingFitness> best_fitnesses_;
+
+            // Search space of the current layer
+            std::vector<std::string> dims_;
+            std::vector<std::string> spatial_dims_;
+            std::map<std::string, std::vector<int>> tile_candidates_;
+            std::map<std::string, int> window_size_; // R for Y, S for X, and itself for R/S (see DFA::GetSlidingWindows)
+            std::vector<int> cluster_size_candidates_;
+            long l1_capacity_ = 0;
+            long l2_capacity_ = 0;
+
+        private:
+            void ConstructSearchSpace(std::shared_ptr<DFA::Layer> layer) {
+                dims_.clear();
+                spatial_dims_.clear();
+                tile_candidates_.clear();
+                window_size_.clear();
+                cluster_size_candidates_.clear();
+                fitness_cache_.clear();
+
+                auto layer_type = layer->GetLayerType();
+                auto sliding_windows = DFA::GetSlidingWindows(layer);
+                std::set<std::string> window_dims;
+                for(auto& it : sliding_windows) {
+                    window_dims.insert(it.second);
+                }
+
+                std::map<std::string, int> dim_sizes;
+                for(auto& dim : *layer->GetDimensions()) {
+                    // Depth-wise layers have no output channel in their tensors
+                    if(layer_type == LayerType::DSCONV && dim->GetName() == DFSL::layer_dim_output_channel_) {
+                        continue;
+                    }
+                    dim_sizes[dim->GetName()] = dim->GetSize();
+                    dims_.push_back(dim->GetName());
+                }
+
+                for(auto& dim : dims_) {
+                    int num_positions = dim_sizes[dim];
+                    if(window_dims.count(dim)) {
+                        window_size_[dim] = dim_sizes[dim];
+                        tile_candidates_[dim] = {1};
+                        continue;
+                    }
+
+                    auto window = sliding_windows.find(dim);
+                    if(window != sliding_windows.end() && dim_sizes.count(window->second)) {
+                        window_size_[dim] = dim_sizes[window->second];
+                    }
+                    else {
+                        window_size_[dim] = 1;
+                    }
+                    num_positions = std::max(dim_sizes[dim] - window_size_[dim] + 1, 1);
+
+                    tile_candidates_[dim] = GetTileCandidates(num_positions);
+                    spatial_dims_.push_back(dim);
+                }
+
+                // Quantized layers pack more operations per PE (see APIV2)
+                auto layer_hw = evaluator_->GetHWConfig()->GetLayerHardwareView(layer->getQuantization());
+                int num_pes = layer_hw.num_pes_;
+                for(int size = 1; size <= num_pes; size++) {
+                    if(num_pes % size == 0) {
+                        cluster_size_candidates_.push_back(size);
+                    }
+                }
+
+                l1_capacity_ = layer_hw.l1_size_;
+                l2_capacity_ = layer_hw.l2_size_;
+            }
+
+            // Divisors and powers of two up to the number of positions
+            std::vector<int> GetTileCandidates(int num_positions) {
+                std::vector<int> ret;
+                for(int size = 1; size <= num_positions; size++) {
+                    bool is_pow2 = (size & (size - 1)) == 0;
+                    if(num_positions % size == 0 || is_pow2) {
+                        ret.push_back(size);
+                    }
+                }
+                return ret;
+            }
+
+            int RandomInt(int max_exclusive) {
+                std::uniform_int_distribution<int> dist(0, max_exclusive - 1);
+                return dist(rng_);
+            }
+
+            bool RandomEvent(double probability) {
+                std::uniform_real_distribution<double> dist(0.0, 1.0);
+                return dist(rng_) < probability;
+            }
+
+            template <typename T>
+            T RandomPick(const std::vector<T>& candidates) {
+                return candidates.at(RandomInt(candidates.size()));
+            }
+
+            MappingGenome RandomGenome() {
+                MappingGenome ret;
+                ret.outer_order_ = dims_;
+                ret.inner_order_ = dims_;
+                std::shuffle(ret.outer_order_.begin(), ret.outer_order_.end(), rng_);
+                std::shuffle(ret.inner_order_.begin(), ret.inner_order_.end(), rng_);
+                ret.outer_spatial_dim_ = RandomPick(spatial_dims_);
+                ret.inner_spatial_dim_ = RandomPick(spatial_dims_);
+                for(auto& dim : dims_) {
+                    ret.outer_tile_[dim] = RandomPick(tile_candidates_[dim]);
+                    ret.inner_tile_[dim] = RandomPick(tile_candidates_[dim]);
+                }
+                ret.cluster_size_ = RandomPick(cluster_size_candidates_);
+                Repair(ret);
+                return ret;
+            }
+
+            // Seed genome of the same layer with the largest cluster size this hardware allows
+            MappingGenome AdaptGenome(const MappingGenome& genome) {
+                MappingGenome ret = genome;
+                int cluster_size = cluster_size_candidates_.front();
+                for(auto candidate : cluster_size_candidates_) {
+                    if(candidate <= genome.cluster_size_) {
+                        cluster_size = candidate;
+                    }
+                }
+                ret.cluster_size_ = cluster_size;
+                Repair(ret);
+                return ret;
+            }
+
+            // Tournament selection over the ranked population
+            int SelectParent(const std::vector<int>& rank) {
+                const int tournament_size = 3;
+                int best_pos = RandomInt(rank.size());
+                for(int round = 1; round < tournament_size; round++) {
+                    best_pos = std::min(best_pos, RandomInt(rank.size()));
+                }
+                return rank[best_pos];
+            }
+
+            MappingGenome Crossover(const MappingGenome& parent_a, const MappingGenome& parent_b) {
+                MappingGenome ret = parent_a;
+                if(RandomEvent(0.5)) {
+                    ret.outer_order_ = parent_b.outer_order_;
+                }
+                if(RandomEvent(0.5)) {
+                    ret.inner_order_ = parent_b.inner_order_;
+                }
+                if(RandomEvent(0.5)) {
+                    ret.outer_spatial_dim_ = parent_b.outer_spatial_dim_;
+                }
+                if(RandomEvent(0.5)) {
+                    ret.inner_spatial_dim_ = parent_b.inner_spatial_dim_;
+                }
+                for(auto& dim : dims_) {
+                    if(RandomEvent(0.5)) {
+                        ret.outer_tile_[dim] = parent_b.outer_tile_.at(dim);
+                        ret.inner_tile_[dim] = parent_b.inner_tile_.at(dim);
+                    }
+                }
+                if(RandomEvent(0.5)) {
+                    ret.cluster_size_ = parent_b.cluster_size_;
+                }
+                return ret;
+            }
+
+            void Mutate(MappingGenome& genome) {
+                if(RandomEvent(mutation_rate_)) {
+                    std::swap(genome.outer_order_[RandomInt(dims_.size())], genome.outer_order_[RandomInt(dims_.size())]);
+                }
+                if(RandomEvent(mutation_rate_)) {
+                    std::swap(genome.inner_order_[RandomInt(dims_.size())], genome.inner_order_[RandomInt(dims_.size())]);
+                }
+                if(RandomEvent(mutation_rate_)) {
+                    genome.outer_spatial_dim_ = RandomPick(spatial_dims_);
+                }
+                if(RandomEvent(mutation_rate_)) {
+                    genome.inner_spatial_dim_ = RandomPick(spatial_dims_);
+                }
+                for(auto& dim : dims_) {
+                    if(RandomEvent(mutation_rate_)) {
+                        genome.outer_tile_[dim] = RandomPick(tile_candidates_[dim]);
+                    }
+                    if(RandomEvent(mutation_rate_)) {
+                        genome.inner_tile_[dim] = RandomPick(tile_candidates_[dim]);
+                    }
+                }
+                if(RandomEvent(mutation_rate_)) {
+                    genome.cluster_size_ = RandomPick(cluster_size_candidates_);
+                }
+            }
+
+            // Inner tiles cannot exceed the outer tiles they are carved from
+            void Repair(MappingGenome& genome) {
+                for(auto& dim : dims_) {
+                    genome.inner_tile_[dim] = std::min(genome.inner_tile_[dim], genome.outer_tile_[dim]);
+                }
+            }
+
+            void AddLevelDirectives(std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                    const std::vector<std::string>& order,
+                                    const std::string& spatial_dim,
+                                    const std::map<std::string, int>& tiles) {
+                for(auto& dim : order) {
+                    int tile = tiles.at(dim);
+                    int window_size = window_size_.at(dim);
+                    int map_size = tile + window_size - 1;
+                    int map_ofs = tile;
+
+                    // Filter dimensions (the only ones never mapped spatially) are always mapped entirely
+                    if(std::find(spatial_dims_.begin(), spatial_dims_.end(), dim) == spatial_dims_.end()) {
+                        map_size = window_size;
+                        map_ofs = window_size;
+                    }
+
+                    if(dim == spatial_dim) {
+                        dataflow->AddDirective(std::make_shared<DFA::directive::SpatialMap>(map_size, map_ofs, dim));
+                    }
+                    else {
+                        dataflow->AddDirective(std::make_shared<DFA::directive::TemporalMap>(map_size, map_ofs, dim));
+                    }
+                }
+            }
+
+            MappingFitness EvaluateDataflow(std::shared_ptr<DFA::Layer> layer, std::shared_ptr<DFA::DirectiveTable> dataflow) {
+                MappingFitness ret;
+                std::string shared_key = layer->GetName() + "\n" + dataflow->ToString();
+                ret.design_point_ = (shared_cache_ != nullptr) ? shared_cache_->Find(shared_key) : nullptr;
+                if(ret.design_point_ == nullptr) {
+                    ret.design_point_ = evaluator_->Evaluate(layer, dataflow);
+                    if(shared_cache_ != nullptr) {
+                        shared_cache_->Insert(shared_key, ret.design_point_);
+                    }
+                }
+                ret.cost_ = ret.design_point_->GetCost(objective_);
+                ret.fits_buffers_ = ret.design_point_->l1_sram_sz <= l1_capacity_ && ret.design_point_->l2_sram_sz <= l2_capacity_;
+                return ret;
+            }
+
+            /*
+             * The incumbent is the best mapping of the previous generations; a mapping is only analyzed
+             * if its lower bound could still improve on it.
+             */
+            std::vector<MappingFitness> EvaluatePopulation(std::shared_ptr<DFA::Layer> layer,
+                                                           const std::vector<MappingGenome>& population,
+                                                           const MappingFitness& incumbent,
+                                                           CA::PruningStats& pruning_stats) {
+                std::vector<std::string> keys;
+                std::vector<std::shared_ptr<DFA::DirectiveTable>> dataflows;
+                std::vector<int> pending; // indices of the first occurrence of each unseen mapping
+                std::map<std::string, int> pending_keys;
+
+                for(int idx = 0; idx < population.size(); idx++) {
+                    auto dataflow = ConstructDataflow(population[idx]);
+                    auto key = dataflow->ToString();
+                    keys.push_back(key);
+                    dataflows.push_back(dataflow);
+
+                    std::lock_guard<std::mutex> lock(cache_mutex_);
+                    if(fitness_cache_.find(key) != fitness_cache_.end() || pending_keys.find(key) != pending_keys.end()) {
+                        num_cache_hits_++;
+                    }
+                    else {
+                        pending_keys[key] = idx;
+                        pending.push_back(idx);
+                    }
+                }
+
+                if(use_pruning_) {
+                    std::vector<int> unpruned;
+                    for(auto idx : pending) {
+                        pruning_stats.num_candidates_++;
+
+                        auto bounds = lower_bound_analysis_->AnalyzeLayer(layer, dataflows[idx]);
+                        bool has_incumbent = incumbent.design_point_ != nullptr;
+                        if(has_incumbent && lower_bound_analysis_->CanPrune(bounds, objective_, incumbent.cost_, incumbent.fits_buffers_)) {
+                            MappingFitness fitness;
+                            fitness.cost_ = bounds->GetCost(objective_);
+                            fitness.fits_buffers_ = bounds->fits_buffers_;
+                            fitness.pruned_ = true;
+                            fitness_cache_[keys[idx]] = fitness;
+                            pruning_stats.num_pruned_++;
+                        }
+                        else {
+                            unpruned.push_back(idx);
+                        }
+                    }
+                    pending = unpruned;
+                }
+
+                std::map<std::string, MappingFitness> predicted_fitness;
+                if(surrogate_ != nullptr && static_cast<int>(pending.size()) > num_exact_) {
+                    auto hw_config = evaluator_->GetHWConfig();
+                    std::vector<std::pair<double, int>> predicted_costs;
+                    for(auto idx : pending) {
+                        auto prediction = surrogate_->Predict(layer, dataflows[idx], hw_config, evaluator_->GetSIMDWidth());
+                        auto bounds = lower_bound_analysis_->AnalyzeLayer(layer, dataflows[idx]);
+
+                        MappingFitness fitness;
+                        fitness.cost_ = prediction.GetCost(objective_);
+                        fitness.fits_buffers_ = bounds->fits_buffers_;
+                        fitness.predicted_ = true;
+                        predicted_fitness[keys[idx]] = fitness;
+                        // Mappings that cannot fit the buffers go last, as in MappingFitness::IsBetterThan
+                        predicted_costs.push_back(std::make_pair(bounds->fits_buffers_ ? fitness.cost_ : std::numeric_limits<double>::max(), idx));
+                    }
+                    num_predictions_ += pending.size();
+
+                    std::stable_sort(predicted_costs.begin(), predicted_costs.end(),
+                                     [](const std::pair<double, int>& lhs, const std::pair<double, int>& rhs) {
+                        return lhs.first < rhs.first;
+                    });
+                    pending.clear();
+                    for(int pos = 0; pos < num_exact_; pos++) {
+                        pending.push_back(predicted_costs[pos].second);
+                        predicted_fitness.erase(keys[predicted_costs[pos].second]);
+                    }
+                }
+
+                thread_pool_.ParallelFor(pending.size(), [&](int task_id) {
+                    BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                    int idx = pending[task_id];
+                    auto fitness = EvaluateDataflow(layer, dataflows[idx]);
+
+                    std::lock_guard<std::mutex> lock(cache_mutex_);
+                    fitness_cache_[keys[idx]] = fitness;
+                });
+                num_evaluations_ += pending.size();
+
+                std::vector<MappingFitness> ret;
+                for(auto& key : keys) {
+                    auto cached = fitness_cache_.find(key);
+                    ret.push_back((cached != fitness_cache_.end()) ? cached->second : predicted_fitness.at(key));
+                }
+                return ret;
+            }
+        }; // End of class GeneticMapper
+    }; // End of namespace DSE
+}; // End of namespace maestro
+
+#endif
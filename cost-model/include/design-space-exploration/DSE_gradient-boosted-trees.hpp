@@ -0,0 +1,298 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DSE_GRADIENT_BOOSTED_TREES_HPP_
+#define MAESTRO_DSE_GRADIENT_BOOSTED_TREES_HPP_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+
+namespace maestro {
+    namespace DSE {
+
+        // Node of a regression tree; a leaf if feature_ < 0
+        class RegressionTreeNode {
+        public:
+            int feature_ = -1;
+            double threshold_ = 0; // Samples with a feature value <= threshold_ go left
+            int left_ = -1;
+            int right_ = -1;
+            double value_ = 0;
+        }; // End of class RegressionTreeNode
+
+        class GradientBoostingParams {
+        public:
+            int num_trees_ = 300;
+            int max_depth_ = 6;
+            double learning_rate_ = 0.1;
+            int min_samples_leaf_ = 4;
+            double subsample_ = 0.8;
+            int max_bins_ = 64;
+            unsigned int seed_ = 1;
+        }; // End of class GradientBoostingParams
+
+        /*
+         * Least-squares gradient boosting of regression trees. Feature values are bucketed into at most
+         * max_bins_ quantile bins before training, so finding the best split of a node is one histogram pass
+         * per feature. Prediction walks max_depth_ comparisons per tree.
+         */
+        class GradientBoostedTrees {
+        public:
+            GradientBoostedTrees(GradientBoostingParams params = GradientBoostingParams()) :
+                    params_(params) {
+            }
+
+            void Fit(const std::vector<std::vector<double>>& features, const std::vector<double>& targets) {
+                trees_.clear();
+                int num_samples = targets.size();
+                if(num_samples == 0) {
+                    base_value_ = 0;
+                    return;
+                }
+                int num_features = features.front().size();
+
+                ConstructBins(features, num_features);
+                std::vector<std::vector<unsigned char>> binned(num_samples, std::vector<unsigned char>(num_features));
+                for(int sample = 0; sample < num_samples; sample++) {
+                    for(int feature = 0; feature < num_features; feature++) {
+                        binned[sample][feature] = GetBin(feature, features[sample][feature]);
+                    }
+                }
+
+                base_value_ = std::accumulate(targets.begin(), targets.end(), 0.0) / num_samples;
+                std::vector<double> predictions(num_samples, base_value_);
+                std::vector<double> residuals(num_samples);
+                std::mt19937 rng(params_.seed_);
+                std::vector<int> all_samples(num_samples);
+                std::iota(all_samples.begin(), all_samples.end(), 0);
+
+                for(int tree_idx = 0; tree_idx < params_.num_trees_; tree_idx++) {
+                    for(int sample = 0; sample < num_samples; sample++) {
+                        residuals[sample] = targets[sample] - predictions[sample];
+                    }
+
+                    std::vector<int> samples = all_samples;
+                    if(params_.subsample_ < 1.0) {
+                        std::shuffle(samples.begin(), samples.end(), rng);
+                        int num_kept = std::max(static_cast<int>(params_.subsample_ * num_samples), std::min(num_samples, 2 * params_.min_samples_leaf_));
+                        samples.resize(num_kept);
+                    }
+
+                    std::vector<RegressionTreeNode> tree;
+                    GrowNode(tree, binned, residuals, samples, 0, num_features);
+                    for(int sample = 0; sample < num_samples; sample++) {
+                        predictions[sample] += PredictTree(tree, features[sample]);
+                    }
+                    trees_.push_back(tree);
+                }
+            }
+
+            double Predict(const std::vector<double>& features) const {
+                double ret = base_value_;
+                for(auto& tree : trees_) {
+                    ret += PredictTree(tree, features);
+                }
+                return ret;
+            }
+
+            int GetNumTrees() const {
+                return trees_.size();
+            }
+
+            // "<base value> <number of trees>", then per tree its number of nodes and one node per line
+            void Write(std::ostream& out) const {
+                out.precision(17);
+                out << base_value_ << " " << trees_.size() << std::endl;
+                for(auto& tree : trees_) {
+                    out << tree.size() << std::endl;
+                    for(auto& node : tree) {
+                        out << node.feature_ << " " << node.threshold_ << " " << node.left_ << " " << node.right_
+                            << " " << node.value_ << std::endl;
+                    }
+                }
+            }
+
+            // Fails on malformed trees, including splits on features beyond num_features
+            bool Read(std::istream& in, int num_features) {
+                trees_.clear();
+                int num_trees = 0;
+                if(!(in >> base_value_ >> num_trees) || num_trees < 0) {
+                    return false;
+                }
+                for(int tree_idx = 0; tree_idx < num_trees; tree_idx++) {
+                    int num_nodes = 0;
+                    if(!(in >> num_nodes) || num_nodes <= 0) {
+                        return false;
+                    }
+                    std::vector<RegressionTreeNode> tree(num_nodes);
+                    for(auto& node : tree) {
+                        if(!(in >> node.feature_ >> node.threshold_ >> node.left_ >> node.right_ >> node.value_)) {
+                            return false;
+                        }
+                        if(node.feature_ >= num_features) {
+                            return false;
+                        }
+                        if(node.feature_ >= 0 && (node.left_ < 0 || node.left_ >= num_nodes || node.right_ < 0 || node.right_ >= num_nodes)) {
+                            return false;
+                        }
+                    }
+                    trees_.push_back(tree);
+                }
+                return true;
+            }
+
+        protected:
+            GradientBoostingParams params_;
+            double base_value_ = 0;
+            std::vector<std::vector<RegressionTreeNode>> trees_;
+            // Per feature, the upper edge of every bin but the last
+            std::vector<std::vector<double>> bin_edges_;
+
+        private:
+            void ConstructBins(const std::vector<std::vector<double>>& features, int num_features) {
+                int max_bins = std::max(std::min(params_.max_bins_, 256), 2);
+                bin_edges_.assign(num_features, std::vector<double>());
+                for(int feature = 0; feature < num_features; feature++) {
+                    std::vector<double> values;
+                    for(auto& sample : features) {
+                        values.push_back(sample[feature]);
+                    }
+                    std::sort(values.begin(), values.end());
+                    values.erase(std::unique(values.begin(), values.end()), values.end());
+
+                    auto& edges = bin_edges_[feature];
+                    if(values.size() <= max_bins) {
+                        // Midpoints between the distinct values
+                        for(int idx = 0; idx + 1 < values.size(); idx++) {
+                            edges.push_back((values[idx] + values[idx + 1]) / 2);
+                        }
+                    }
+                    else {
+                        for(int bin = 1; bin < max_bins; bin++) {
+                            double edge = values[static_cast<long>(bin) * values.size() / max_bins];
+                            if(edges.empty() || edge > edges.back()) {
+                                edges.push_back(edge);
+                            }
+                        }
+                    }
+                }
+            }
+
+            unsigned char GetBin(int feature, double value) const {
+                auto& edges = bin_edges_[feature];
+                return std::lower_bound(edges.begin(), edges.end(), value) - edges.begin();
+            }
+
+            int GrowNode(std::vector<RegressionTreeNode>& tree,
+                         const std::vector<std::vector<unsigned char>>& binned,
+                         const std::vector<double>& residuals,
+                         const std::vector<int>& samples,
+                         int depth,
+                         int num_features) {
+                int node_idx = tree.size();
+                tree.push_back(RegressionTreeNode());
+
+                double sum = 0;
+                for(auto sample : samples) {
+                    sum += residuals[sample];
+                }
+                int num_samples = samples.size();
+                tree[node_idx].value_ = params_.learning_rate_ * sum / std::max(num_samples, 1);
+
+                if(depth >= params_.max_depth_ || num_samples < 2 * params_.min_samples_leaf_) {
+                    return node_idx;
+                }
+
+                double best_gain = 1e-12;
+                int best_feature = -1;
+                int best_bin = -1;
+                double parent_score = sum * sum / num_samples;
+                for(int feature = 0; feature < num_features; feature++) {
+                    int num_bins = bin_edges_[feature].size() + 1;
+                    if(num_bins < 2) {
+                        continue;
+                    }
+                    std::vector<double> bin_sums(num_bins, 0);
+                    std::vector<int> bin_counts(num_bins, 0);
+                    for(auto sample : samples) {
+                        int bin = binned[sample][feature];
+                        bin_sums[bin] += residuals[sample];
+                        bin_counts[bin]++;
+                    }
+
+                    double left_sum = 0;
+                    int left_count = 0;
+                    for(int bin = 0; bin + 1 < num_bins; bin++) {
+                        left_sum += bin_sums[bin];
+                        left_count += bin_counts[bin];
+                        int right_count = num_samples - left_count;
+                        if(left_count < params_.min_samples_leaf_ || right_count < params_.min_samples_leaf_) {
+                            continue;
+                        }
+                        double right_sum = sum - left_sum;
+                        double gain = left_sum * left_sum / left_count + right_sum * right_sum / right_count - parent_score;
+                        if(gain > best_gain) {
+                            best_gain = gain;
+                            best_feature = feature;
+                            best_bin = bin;
+                        }
+                    }
+                }
+
+                if(best_feature < 0) {
+                    return node_idx;
+                }
+
+                std::vector<int> left_samples;
+                std::vector<int> right_samples;
+                for(auto sample : samples) {
+                    (binned[sample][best_feature] <= best_bin ? left_samples : right_samples).push_back(sample);
+                }
+
+                tree[node_idx].feature_ = best_feature;
+                tree[node_idx].threshold_ = bin_edges_[best_feature][best_bin];
+                int left = GrowNode(tree, binned, residuals, left_samples, depth + 1, num_features);
+                int right = GrowNode(tree, binned, residuals, right_samples, depth + 1, num_features);
+                tree[node_idx].left_ = left;
+                tree[node_idx].right_ = right;
+                return node_idx;
+            }
+
+            static double PredictTree(const std::vector<RegressionTreeNode>& tree, const std::vector<double>& features) {
+                int node_idx = 0;
+                while(tree[node_idx].feature_ >= 0) {
+                    auto& node = tree[node_idx];
+                    node_idx = (features[node.feature_] <= node.threshold_) ? node.left_ : node.right_;
+                }
+                return tree[node_idx].value_;
+            }
+        }; // End of class GradientBoostedTrees
+    }; // End of namespace DSE
+}; // End of namespace maestro
+
+#endif
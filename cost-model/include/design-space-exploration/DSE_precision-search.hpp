@@ -0,0 +1,347 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DSE_PRECISION_SEARCH_HPP_
+#define MAESTRO_DSE_PRECISION_SEARCH_HPP_
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_base-objects.hpp"
+#include "TL_thread-pool.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_neural-network.hpp"
+#include "DFSL_syntax_tokens.hpp"
+#include "DFSL_writer.hpp"
+
+#include "DSE_config.hpp"
+#include "DSE_design_point.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+    namespace DSE {
+
+        // Precision picked for one layer and its cost at that precision
+        class PrecisionChoice {
+        public:
+            LayerQuantizationType quantization_ = LayerQuantizationType::FP32;
+            std::shared_ptr<DesignPoint> design_point_ = nullptr;
+        }; // End of class PrecisionChoice
+
+        /*
+         * Per-layer mixed-precision search. Every layer is analyzed once at each of its allowed precisions
+         * (on a thread pool, reusing the parsed network); the assignment minimizing the total runtime (or
+         * energy) of the network is then found with a multiple-choice knapsack over the other metric, whose
+         * total must stay within the budget. The budget left over the cheapest assignment is split into
+         * num_budget_bins_per_layer_ bins per layer and the extra cost of each candidate is rounded up to whole
+         * bins, so a returned assignment never exceeds the budget.
+         *
+         * Allowed precisions are read from a file with one line per layer, "<layer name>: FP16, INT8, INT4";
+         * the line of layer "*" applies to the layers without their own line, and layers covered by neither
+         * keep the precision of their Precision block. Lines starting with "//" are comments.
+         */
+        class PrecisionSearch : public MAESTROClass {
+        public:
+            const int num_budget_bins_per_layer_ = 1024;
+
+            PrecisionSearch(std::shared_ptr<LayerEvaluator> evaluator,
+                            OptimizationTarget objective,
+                            double budget,
+                            int num_threads) :
+                    MAESTROClass("PrecisionSearch"),
+                    evaluator_(evaluator),
+                    objective_(objective),
+                    budget_(budget),
+                    num_threads_(num_threads) {
+                if(objective_ != OptimizationTarget::Runtime && objective_ != OptimizationTarget::Energy) {
+                    std::cout << "[PrecisionSearch] Only runtime and energy objectives are supported; minimizing runtime" << std::endl;
+                    objective_ = OptimizationTarget::Runtime;
+                }
+            }
+
+            static bool ParseQuantization(std::string token, LayerQuantizationType& quantization) {
+                const std::vector<std::pair<std::string, LayerQuantizationType>> quantizations = {
+                        {DFSL::layer_quant_fp32, LayerQuantizationType::FP32}, {DFSL::layer_quant_fp16, LayerQuantizationType::FP16},
+                        {DFSL::layer_quant_fp8, LayerQuantizationType::FP8}, {DFSL::layer_quant_fp4, LayerQuantizationType::FP4},
+                        {DFSL::layer_quant_fp2, LayerQuantizationType::FP2}, {DFSL::layer_quant_int32, LayerQuantizationType::INT32},
+                        {DFSL::layer_quant_int16, LayerQuantizationType::INT16}, {DFSL::layer_quant_int8, LayerQuantizationType::INT8},
+                        {DFSL::layer_quant_int4, LayerQuantizationType::INT4}, {DFSL::layer_quant_int2, LayerQuantizationType::INT2}};
+
+                for(auto& it : quantizations) {
+                    if(it.first == token) {
+                        quantization = it.second;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool ReadCandidates(std::string file_name) {
+                std::ifstream in_file(file_name);
+                if(!in_file) {
+                    std::cout << "[PrecisionSearch] Failed to open the precision candidate file " << file_name << std::endl;
+                    return false;
+                }
+
+                std::string line;
+                int line_number = 0;
+                while(std::getline(in_file, line)) {
+                    line_number++;
+                    line = line.substr(0, line.find("//"));
+                    auto colon_pos = line.find(":");
+                    if(colon_pos == std::string::npos) {
+                        if(line.find_first_not_of(" \t\r") != std::string::npos) {
+                            std::cout << "[PrecisionSearch] Line " << line_number << " of " << file_name
+                                      << ": expected \"<layer name>: <precision>, ...\"" << std::endl;
+                            return false;
+                        }
+                        continue;
+                    }
+
+                    std::string layer_name;
+                    std::istringstream(line.substr(0, colon_pos)) >> layer_name;
+
+                    std::string precision_list = line.substr(colon_pos + 1);
+                    std::replace(precision_list.begin(), precision_list.end(), ',', ' ');
+                    std::istringstream precision_stream(precision_list);
+                    std::string token;
+                    std::vector<LayerQuantizationType> candidates;
+                    while(precision_stream >> token) {
+                        LayerQuantizationType quantization;
+                        if(!ParseQuantization(token, quantization)) {
+                            std::cout << "[PrecisionSearch] Line " << line_number << " of " << file_name
+                                      << ": unknown precision " << token << std::endl;
+                            return false;
+                        }
+                        if(std::find(candidates.begin(), candidates.end(), quantization) == candidates.end()) {
+                            candidates.push_back(quantization);
+                        }
+                    }
+                    candidates_[layer_name] = candidates;
+                }
+
+                return true;
+            }
+
+            void SetCandidates(std::string layer_name, std::vector<LayerQuantizationType> candidates) {
+                candidates_[layer_name] = candidates;
+            }
+
+            std::vector<LayerQuantizationType> GetCandidates(std::shared_ptr<DFA::Layer> layer) {
+                auto it = candidates_.find(layer->GetName());
+                if(it == candidates_.end()) {
+                    it = candidates_.find("*");
+                }
+                if(it == candidates_.end() || it->second.empty()) {
+                    return std::vector<LayerQuantizationType>(1, layer->getQuantization());
+                }
+                return it->second;
+            }
+
+            // Returns a copy of the network in which every layer carries its chosen precision
+            std::shared_ptr<DFA::NeuralNetwork> SearchNetwork(std::shared_ptr<DFA::NeuralNetwork> network) {
+                EvaluateCandidates(network);
+                auto assignment = SolveAssignment();
+
+                auto ret = std::make_shared<DFA::NeuralNetwork>(network->GetName());
+                chosen_.clear();
+                for(int layer_id = 0; layer_id < network->GetNumLayers(); layer_id++) {
+                    auto layer = DFA::CloneLayer(network->at(layer_id));
+                    chosen_.push_back(layer_costs_[layer_id][assignment[layer_id]]);
+                    layer->setQuantization(chosen_.back().quantization_);
+                    ret->AddLayer(layer);
+                }
+
+                return ret;
+            }
+
+            void PrintAssignment(std::shared_ptr<DFA::NeuralNetwork> network) {
+                long runtime = 0;
+                double energy = 0;
+                std::cout << "Layer, Precision, Runtime (Cycles), Energy (nJ), Candidates" << std::endl;
+                for(int layer_id = 0; layer_id < chosen_.size(); layer_id++) {
+                    auto& choice = chosen_[layer_id];
+                    std::cout << network->at(layer_id)->GetName() << ", " << DFSL::DFSLWriter::QuantizationToString(choice.quantization_) << ", "
+                              << choice.design_point_->runtime_ << ", " << choice.design_point_->energy_ << ", "
+                              << layer_costs_[layer_id].size() << std::endl;
+                    runtime += choice.design_point_->runtime_;
+                    energy += choice.design_point_->energy_;
+                }
+
+                std::cout << "Total runtime: " << runtime << " cycles" << std::endl;
+                std::cout << "Total energy: " << energy << " nJ" << std::endl;
+                if(budget_ > 0) {
+                    std::cout << ((objective_ == OptimizationTarget::Runtime) ? "Energy budget: " : "Runtime budget: ") << budget_
+                              << (is_feasible_ ? "" : " (infeasible; the assignment minimizing the budgeted metric is reported)") << std::endl;
+                }
+            }
+
+            bool IsFeasible() {
+                return is_feasible_;
+            }
+
+            long GetNumEvaluations() {
+                return num_evaluations_;
+            }
+
+        protected:
+            std::shared_ptr<LayerEvaluator> evaluator_;
+            OptimizationTarget objective_;
+            // Limit of the total energy (nJ) when minimizing runtime, or of the total runtime (cycles) when minimizing energy; 0 for none
+            double budget_;
+            int num_threads_;
+
+            std::map<std::string, std::vector<LayerQuantizationType>> candidates_;
+
+            // [layer][candidate]
+            std::vector<std::vector<PrecisionChoice>> layer_costs_;
+            std::vector<PrecisionChoice> chosen_;
+            bool is_feasible_ = true;
+            long num_evaluations_ = 0;
+
+        private:
+            void EvaluateCandidates(std::shared_ptr<DFA::NeuralNetwork> network) {
+                std::vector<std::pair<int, int>> jobs;
+                layer_costs_.assign(network->GetNumLayers(), std::vector<PrecisionChoice>());
+                for(int layer_id = 0; layer_id < network->GetNumLayers(); layer_id++) {
+                    for(auto quantization : GetCandidates(network->at(layer_id))) {
+                        PrecisionChoice choice;
+                        choice.quantization_ = quantization;
+                        layer_costs_[layer_id].push_back(choice);
+                        jobs.push_back(std::make_pair(layer_id, layer_costs_[layer_id].size() - 1));
+                    }
+                }
+
+                TL::ThreadPool thread_pool(num_threads_);
+                thread_pool.ParallelFor(jobs.size(), [&](int job_id) {
+                    BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                    auto& choice = layer_costs_[jobs[job_id].first][jobs[job_id].second];
+                    auto layer = DFA::CloneLayer(network->at(jobs[job_id].first));
+                    layer->setQuantization(choice.quantization_);
+                    choice.design_point_ = evaluator_->Evaluate(layer);
+                });
+                num_evaluations_ += jobs.size();
+            }
+
+            double GetObjective(const PrecisionChoice& choice) {
+                return (objective_ == OptimizationTarget::Runtime) ? static_cast<double>(choice.design_point_->runtime_)
+                                                                   : choice.design_point_->energy_;
+            }
+
+            double GetBudgetedCost(const PrecisionChoice& choice) {
+                return (objective_ == OptimizationTarget::Runtime) ? choice.design_point_->energy_
+                                                                   : static_cast<double>(choice.design_point_->runtime_);
+            }
+
+            // Candidate index per layer
+            std::vector<int> SolveAssignment() {
+                int num_layers = layer_costs_.size();
+                std::vector<int> ret(num_layers, 0);
+                is_feasible_ = true;
+
+                if(budget_ <= 0) {
+                    for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                        ret[layer_id] = SelectBest(layer_id, [this](const PrecisionChoice& choice) { return GetObjective(choice); });
+                    }
+                    return ret;
+                }
+
+                // Only the cost above the cheapest candidate of each layer is spent from the budget
+                std::vector<int> cheapest(num_layers, 0);
+                std::vector<double> base_cost(num_layers, 0);
+                double spare_budget = budget_;
+                for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                    cheapest[layer_id] = SelectBest(layer_id, [this](const PrecisionChoice& choice) { return GetBudgetedCost(choice); });
+                    base_cost[layer_id] = GetBudgetedCost(layer_costs_[layer_id][cheapest[layer_id]]);
+                    spare_budget -= base_cost[layer_id];
+                }
+
+                if(spare_budget < 0) {
+                    is_feasible_ = false;
+                    return cheapest;
+                }
+
+                int num_budget_bins = num_budget_bins_per_layer_ * num_layers;
+                double bin_size = std::max(spare_budget / num_budget_bins, std::numeric_limits<double>::min());
+                const double infinity = std::numeric_limits<double>::max();
+
+                // best[bin]: lowest objective of the layers so far spending at most bin budget bins
+                std::vector<double> best(num_budget_bins + 1, 0);
+                // choice[layer][bin]: candidate of the layer in that solution
+                std::vector<std::vector<int>> choice(num_layers, std::vector<int>(num_budget_bins + 1, -1));
+                // weight[layer][candidate]: budget bins the candidate spends
+                std::vector<std::vector<int>> weight(num_layers);
+
+                for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                    std::vector<double> next(num_budget_bins + 1, infinity);
+                    for(int candidate_idx = 0; candidate_idx < layer_costs_[layer_id].size(); candidate_idx++) {
+                        auto& candidate = layer_costs_[layer_id][candidate_idx];
+                        double num_bins = std::ceil((GetBudgetedCost(candidate) - base_cost[layer_id]) / bin_size);
+                        weight[layer_id].push_back(static_cast<int>(std::min(num_bins, static_cast<double>(num_budget_bins + 1))));
+                        int candidate_weight = weight[layer_id].back();
+                        double objective = GetObjective(candidate);
+                        for(int bin = candidate_weight; bin <= num_budget_bins; bin++) {
+                            if(best[bin - candidate_weight] < infinity && best[bin - candidate_weight] + objective < next[bin]) {
+                                next[bin] = best[bin - candidate_weight] + objective;
+                                choice[layer_id][bin] = candidate_idx;
+                            }
+                        }
+                    }
+                    best = next;
+                }
+
+                int bin = num_budget_bins;
+                for(int layer_id = num_layers - 1; layer_id >= 0; layer_id--) {
+                    ret[layer_id] = choice[layer_id][bin];
+                    bin -= weight[layer_id][ret[layer_id]];
+                }
+
+                return ret;
+            }
+
+            template <typename CostFunction>
+            int SelectBest(int layer_id, CostFunction cost_function) {
+                int ret = 0;
+                for(int candidate_idx = 1; candidate_idx < layer_costs_[layer_id].size(); candidate_idx++) {
+                    if(cost_function(layer_costs_[layer_id][candidate_idx]) < cost_function(layer_costs_[layer_id][ret])) {
+                        ret = candidate_idx;
+                    }
+                }
+                return ret;
+            }
+        }; // End of class PrecisionSearch
+    }; // End of namespace DSE
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,493 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DSE_SURROGATE_MODEL_HPP_
+#define MAESTRO_DSE_SURROGATE_MODEL_HPP_
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <numeric>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_constants.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_tensor.hpp"
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+
+#include "DFSL_hw-parser.hpp"
+#include "DFSL_syntax_tokens.hpp"
+
+#include "CA_lower-bounds.hpp"
+
+#include "DSE_config.hpp"
+#include "DSE_design_point.hpp"
+#include "DSE_gradient-boosted-trees.hpp"
+
+namespace maestro {
+    namespace DSE {
+
+        class SurrogatePrediction {
+        public:
+            long runtime_ = 0;
+            double energy_ = 0;
+            long num_macs_ = 0;
+
+            // Same scalarization as DesignPoint::GetCost
+            double GetCost(OptimizationTarget target) {
+                switch (target) {
+                    case OptimizationTarget::Energy:
+                        return energy_;
+                    case OptimizationTarget::EnergyDelayProduct:
+                        return static_cast<double>(runtime_) * energy_;
+                    case OptimizationTarget::PerformancePerWatt:
+                        return (energy_ > 0) ? -static_cast<double>(num_macs_) / energy_ : 0;
+                    case OptimizationTarget::Runtime:
+                    default:
+                        return static_cast<double>(runtime_);
+                }
+            }
+        }; // End of class SurrogatePrediction
+
+        // Relative errors (|predicted - exact| / exact) of one predicted quantity over a set of samples
+        class SurrogateErrorStats {
+        public:
+            double mean_error_ = 0;
+            double median_error_ = 0;
+            double p90_error_ = 0;
+            double max_error_ = 0;
+            // Spearman correlation of the predicted and exact rankings; what screening depends on
+            double rank_correlation_ = 0;
+
+            static SurrogateErrorStats Compute(const std::vector<double>& predicted, const std::vector<double>& exact) {
+                SurrogateErrorStats ret;
+                int num_samples = predicted.size();
+                if(num_samples == 0) {
+                    return ret;
+                }
+
+                std::vector<double> errors;
+                for(int idx = 0; idx < num_samples; idx++) {
+                    errors.push_back(std::abs(predicted[idx] - exact[idx]) / std::max(std::abs(exact[idx]), 1e-12));
+                }
+                std::sort(errors.begin(), errors.end());
+                ret.mean_error_ = std::accumulate(errors.begin(), errors.end(), 0.0) / num_samples;
+                ret.median_error_ = errors[num_samples / 2];
+                ret.p90_error_ = errors[std::min(static_cast<int>(0.9 * num_samples), num_samples - 1)];
+                ret.max_error_ = errors.back();
+
+                auto predicted_ranks = GetRanks(predicted);
+                auto exact_ranks = GetRanks(exact);
+                double mean_rank = (num_samples - 1) / 2.0;
+                double covariance = 0;
+                double predicted_variance = 0;
+                double exact_variance = 0;
+                for(int idx = 0; idx < num_samples; idx++) {
+                    covariance += (predicted_ranks[idx] - mean_rank) * (exact_ranks[idx] - mean_rank);
+                    predicted_variance += (predicted_ranks[idx] - mean_rank) * (predicted_ranks[idx] - mean_rank);
+                    exact_variance += (exact_ranks[idx] - mean_rank) * (exact_ranks[idx] - mean_rank);
+                }
+                ret.rank_correlation_ = (predicted_variance > 0 && exact_variance > 0) ?
+                                        covariance / std::sqrt(predicted_variance * exact_variance) : 1.0;
+                return ret;
+            }
+
+            std::string ToString() {
+                return "mean error " + std::to_string(100 * mean_error_) + "%, median " + std::to_string(100 * median_error_)
+                       + "%, p90 " + std::to_string(100 * p90_error_) + "%, max " + std::to_string(100 * max_error_)
+                       + "%, rank correlation " + std::to_string(rank_correlation_);
+            }
+
+        private:
+            // Ties share their average rank
+            static std::vector<double> GetRanks(const std::vector<double>& values) {
+                std::vector<int> order(values.size());
+                std::iota(order.begin(), order.end(), 0);
+                std::stable_sort(order.begin(), order.end(), [&values](int lhs, int rhs) {
+                    return values[lhs] < values[rhs];
+                });
+
+                std::vector<double> ret(values.size());
+                for(int first = 0; first < order.size();) {
+                    int last = first;
+                    while(last + 1 < order.size() && values[order[last + 1]] == values[order[first]]) {
+                        last++;
+                    }
+                    for(int pos = first; pos <= last; pos++) {
+                        ret[order[pos]] = (first + last) / 2.0;
+                    }
+                    first = last + 1;
+                }
+                return ret;
+            }
+        }; // End of class SurrogateErrorStats
+
+        class SurrogateCalibration {
+        public:
+            int num_train_samples_ = 0;
+            int num_validation_samples_ = 0;
+            SurrogateErrorStats runtime_;
+            SurrogateErrorStats energy_;
+            // Average time of one prediction, including the feature extraction
+            double prediction_us_ = 0;
+
+            void Write(std::ostream& out) {
+                out << num_train_samples_ << " " << num_validation_samples_ << " " << prediction_us_ << std::endl;
+                for(auto stats : {&runtime_, &energy_}) {
+                    out << stats->mean_error_ << " " << stats->median_error_ << " " << stats->p90_error_ << " "
+                        << stats->max_error_ << " " << stats->rank_correlation_ << std::endl;
+                }
+            }
+
+            bool Read(std::istream& in) {
+                if(!(in >> num_train_samples_ >> num_validation_samples_ >> prediction_us_)) {
+                    return false;
+                }
+                for(auto stats : {&runtime_, &energy_}) {
+                    if(!(in >> stats->mean_error_ >> stats->median_error_ >> stats->p90_error_
+                            >> stats->max_error_ >> stats->rank_correlation_)) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            void Print() {
+                std::cout << "[SurrogateModel] " << num_train_samples_ << " training samples, " << num_validation_samples_
+                          << " validation samples" << std::endl;
+                std::cout << "[SurrogateModel] Runtime: " << runtime_.ToString() << std::endl;
+                std::cout << "[SurrogateModel] Energy: " << energy_.ToString() << std::endl;
+                std::cout << "[SurrogateModel] Prediction time: " << prediction_us_ << " us" << std::endl;
+            }
+        }; // End of class SurrogateCalibration
+
+        /*
+         * Learned estimate of the exact cost analysis of one layer, for screening large hardware x mapping
+         * spaces. Features describe the layer (dimensions, type, precision), its mapping (cluster levels,
+         * spatial dimensions, tile sizes) and the hardware point; the analytical lower bounds of
+         * CA::LowerBoundAnalysis anchor them. The regressors (gradient-boosted trees) predict the log of
+         * the exact runtime and energy over their lower bounds, so every prediction stays above the bounds
+         * and the models only learn the inefficiencies the bounds do not see (stalls, NoC/off-chip, buffers).
+         */
+        class SurrogateModel : public MAESTROClass {
+        public:
+            const std::string file_header_ = "MAESTRO surrogate model v1";
+
+            SurrogateModel(GradientBoostingParams params = GradientBoostingParams()) :
+                    MAESTROClass("SurrogateModel"),
+                    params_(params),
+                    runtime_model_(params),
+                    energy_model_(params) {
+            }
+
+            static std::vector<double> ExtractFeatures(std::shared_ptr<DFA::Layer> layer,
+                                                       std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                                       std::shared_ptr<DFSL::HWConfig> hw_config,
+                                                       int simd_width) {
+                if(dataflow == nullptr) {
+                    dataflow = layer->GetDataflow();
+                }
+                CA::LowerBoundAnalysis lower_bound_analysis(hw_config, simd_width);
+                auto bounds = lower_bound_analysis.AnalyzeLayer(layer, dataflow);
+
+                auto layer_type = layer->GetLayerType();
+                int bit_size = maestro::getBitSize(layer->getQuantization());
+                std::map<std::string, int> dim_sizes;
+                for(auto& dim : *layer->GetDimensions()) {
+                    dim_sizes[dim->GetName()] = dim->GetSize();
+                }
+
+                std::vector<double> ret;
+                // The lower bounds must stay the first two features (see Predict)
+                ret.push_back(Log(bounds->runtime_));
+                ret.push_back(Log(bounds->energy_));
+                ret.push_back(Log(bounds->num_macs_));
+                ret.push_back(static_cast<int>(layer_type));
+                ret.push_back(bit_size);
+                for(auto& dim : GetDimNames()) {
+                    ret.push_back(Log(dim_sizes.count(dim) ? dim_sizes[dim] : 1));
+                }
+
+                /* Hardware */
+                auto layer_hw = hw_config->GetLayerHardwareView(layer->getQuantization());
+                int bottom_noc_bw = hw_config->noc_bws_.empty() ? hw_config->noc_bw_ : hw_config->noc_bws_.front();
+                int top_noc_bw = hw_config->noc_bws_.empty() ? hw_config->noc_bw_ : hw_config->noc_bws_.back();
+                double offchip_bw = (hw_config->dram_config_ != nullptr) ?
+                                    hw_config->dram_config_->bus_bw_ * 8.0 / bit_size : hw_config->off_chip_bw_;
+                ret.push_back(Log(layer_hw.num_pes_));
+                ret.push_back(Log(simd_width));
+                ret.push_back(Log(layer_hw.l1_size_));
+                ret.push_back(Log(layer_hw.l2_size_));
+                ret.push_back(Log(bottom_noc_bw));
+                ret.push_back(Log(top_noc_bw));
+                ret.push_back(hw_config->noc_hops_);
+                ret.push_back(Log(offchip_bw));
+                ret.push_back(hw_config->dram_config_ != nullptr ? 1 : 0);
+                ret.push_back(hw_config->buffer_levels_.size());
+
+                /* Mapping: the outermost and innermost cluster levels */
+                std::vector<std::vector<std::shared_ptr<DFA::directive::Directive>>> levels(1);
+                double log_cluster_size = 0;
+                for(auto& directive : *dataflow) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        levels.push_back(std::vector<std::shared_ptr<DFA::directive::Directive>>());
+                        log_cluster_size += Log(directive->GetSize());
+                    }
+                    else {
+                        levels.back().push_back(directive);
+                    }
+                }
+                ret.push_back(levels.size() - 1);
+                ret.push_back(log_cluster_size);
+                for(auto level : {levels.front(), levels.back()}) {
+                    AddLevelFeatures(ret, level, dim_sizes);
+                }
+
+                /* Derived ratios; trees split on single features only */
+                double log_utilization = Log(bounds->num_macs_) - Log(bounds->runtime_) - Log(simd_width) - Log(layer_hw.num_pes_);
+                double log_tensor_size = Log(GetTotalTensorSize(layer, dim_sizes));
+                ret.push_back(log_utilization);
+                ret.push_back(Log(bounds->min_l1_size_) - Log(layer_hw.l1_size_));
+                ret.push_back(Log(bounds->min_l2_size_) - Log(layer_hw.l2_size_));
+                ret.push_back(log_tensor_size);
+                ret.push_back(log_tensor_size - Log(offchip_bw) - Log(bounds->runtime_));
+                ret.push_back(Log(bounds->min_l2_size_) - Log(top_noc_bw));
+                ret.push_back(Log(bounds->min_l1_size_) - Log(bottom_noc_bw));
+                return ret;
+            }
+
+            void AddSample(const std::vector<double>& features, long runtime, double energy) {
+                features_.push_back(features);
+                runtimes_.push_back(runtime);
+                energies_.push_back(energy);
+            }
+
+            int GetNumSamples() {
+                return features_.size();
+            }
+
+            bool IsTrained() {
+                return runtime_model_.GetNumTrees() > 0;
+            }
+
+            /*
+             * Trains on a random (1 - validation_fraction) share of the samples and measures the errors on the
+             * rest. The kept models are the ones trained without the validation samples.
+             */
+            SurrogateCalibration Train(double validation_fraction = 0.2) {
+                int num_samples = features_.size();
+                std::vector<int> order(num_samples);
+                std::iota(order.begin(), order.end(), 0);
+                std::mt19937 rng(params_.seed_);
+                std::shuffle(order.begin(), order.end(), rng);
+
+                int num_validation = std::min(static_cast<int>(validation_fraction * num_samples), num_samples - 1);
+                num_validation = std::max(num_validation, 0);
+
+                std::vector<std::vector<double>> train_features;
+                std::vector<double> runtime_targets;
+                std::vector<double> energy_targets;
+                for(int pos = num_validation; pos < num_samples; pos++) {
+                    int idx = order[pos];
+                    train_features.push_back(features_[idx]);
+                    num_features_ = features_[idx].size();
+                    runtime_targets.push_back(Log(runtimes_[idx]) - features_[idx][0]);
+                    energy_targets.push_back(Log(energies_[idx]) - features_[idx][1]);
+                }
+                runtime_model_.Fit(train_features, runtime_targets);
+                energy_model_.Fit(train_features, energy_targets);
+
+                std::vector<int> validation_samples(order.begin(), order.begin() + num_validation);
+                calibration_ = Calibrate(validation_samples);
+                calibration_.num_train_samples_ = train_features.size();
+                return calibration_;
+            }
+
+            // Features of another model version (see Load) fall back to the lower bounds
+            SurrogatePrediction Predict(const std::vector<double>& features) {
+                SurrogatePrediction ret;
+                if(static_cast<int>(features.size()) != num_features_) {
+                    ret.runtime_ = std::llround(std::exp(features[0]));
+                    ret.energy_ = std::exp(features[1]);
+                    ret.num_macs_ = std::llround(std::exp(features[2]));
+                    return ret;
+                }
+                // The exact costs never go below the lower bounds
+                ret.runtime_ = std::llround(std::exp(features[0] + std::max(runtime_model_.Predict(features), 0.0)));
+                ret.energy_ = std::exp(features[1] + std::max(energy_model_.Predict(features), 0.0));
+                ret.num_macs_ = std::llround(std::exp(features[2]));
+                return ret;
+            }
+
+            SurrogatePrediction Predict(std::shared_ptr<DFA::Layer> layer,
+                                        std::shared_ptr<DFA::DirectiveTable> dataflow,
+                                        std::shared_ptr<DFSL::HWConfig> hw_config,
+                                        int simd_width) {
+                return Predict(ExtractFeatures(layer, dataflow, hw_config, simd_width));
+            }
+
+            // Errors of the model on the given samples (indices of added samples)
+            SurrogateCalibration Calibrate(const std::vector<int>& samples) {
+                SurrogateCalibration ret;
+                ret.num_validation_samples_ = samples.size();
+
+                std::vector<double> predicted_runtimes;
+                std::vector<double> exact_runtimes;
+                std::vector<double> predicted_energies;
+                std::vector<double> exact_energies;
+                auto start_time = std::chrono::steady_clock::now();
+                for(auto idx : samples) {
+                    auto prediction = Predict(features_[idx]);
+                    predicted_runtimes.push_back(prediction.runtime_);
+                    predicted_energies.push_back(prediction.energy_);
+                    exact_runtimes.push_back(runtimes_[idx]);
+                    exact_energies.push_back(energies_[idx]);
+                }
+                auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time);
+
+                ret.runtime_ = SurrogateErrorStats::Compute(predicted_runtimes, exact_runtimes);
+                ret.energy_ = SurrogateErrorStats::Compute(predicted_energies, exact_energies);
+                ret.prediction_us_ = samples.empty() ? 0 : elapsed.count() / samples.size();
+                return ret;
+            }
+
+            SurrogateCalibration GetCalibration() {
+                return calibration_;
+            }
+
+            void SetCalibration(const SurrogateCalibration& calibration) {
+                calibration_ = calibration;
+            }
+
+            bool Save(std::string file_name) {
+                std::ofstream out(file_name);
+                if(!out) {
+                    std::cout << "[SurrogateModel] Failed to open the model file " << file_name << std::endl;
+                    return false;
+                }
+
+                out.precision(17);
+                out << file_header_ << std::endl;
+                out << num_features_ << std::endl;
+                calibration_.Write(out);
+                runtime_model_.Write(out);
+                energy_model_.Write(out);
+                return true;
+            }
+
+            bool Load(std::string file_name) {
+                std::ifstream in(file_name);
+                if(!in) {
+                    std::cout << "[SurrogateModel] Failed to open the model file " << file_name << std::endl;
+                    return false;
+                }
+
+                std::string header;
+                std::getline(in, header);
+                if(header != file_header_ || !(in >> num_features_) || !calibration_.Read(in) || !runtime_model_.Read(in, num_features_)
+                   || !energy_model_.Read(in, num_features_)) {
+                    std::cout << "[SurrogateModel] " << file_name << " is not a model of this version" << std::endl;
+                    return false;
+                }
+                return true;
+            }
+
+            int GetNumFeatures() {
+                return num_features_;
+            }
+
+        protected:
+            GradientBoostingParams params_;
+            GradientBoostedTrees runtime_model_;
+            GradientBoostedTrees energy_model_;
+            SurrogateCalibration calibration_;
+            int num_features_ = 0;
+
+            std::vector<std::vector<double>> features_;
+            std::vector<long> runtimes_;
+            std::vector<double> energies_;
+
+        private:
+            static double Log(double value) {
+                return std::log(std::max(value, 1e-6));
+            }
+
+            static std::vector<std::string> GetDimNames() {
+                return {DFSL::layer_dim_input_batch_, DFSL::layer_dim_group_, DFSL::layer_dim_output_channel_,
+                        DFSL::layer_dim_input_channel_, DFSL::layer_dim_weight_height_, DFSL::layer_dim_weight_width_,
+                        DFSL::layer_dim_input_height_, DFSL::layer_dim_input_width_};
+            }
+
+            // Spatial dimension (index in GetDimNames, -1 if none), its mapping size, and the tile of the level
+            static void AddLevelFeatures(std::vector<double>& features,
+                                         const std::vector<std::shared_ptr<DFA::directive::Directive>>& level,
+                                         std::map<std::string, int>& dim_sizes) {
+                auto dim_names = GetDimNames();
+                int spatial_dim = -1;
+                double log_spatial_size = 0;
+                double log_tile_volume = 0;
+                double log_num_steps = 0;
+                for(auto& directive : level) {
+                    auto var = directive->GetVariable();
+                    long dim_size = dim_sizes.count(var) ? std::max(dim_sizes[var], 1) : 1;
+                    long map_size = std::max(std::min(static_cast<long>(directive->GetSize()), dim_size), 1L);
+                    long map_ofs = std::max(directive->GetOfs(), 1);
+                    log_tile_volume += Log(map_size);
+                    log_num_steps += Log((dim_size <= map_size) ? 1 : (dim_size - map_size + map_ofs - 1) / map_ofs + 1);
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::SpatialMap && spatial_dim < 0) {
+                        spatial_dim = std::find(dim_names.begin(), dim_names.end(), var) - dim_names.begin();
+                        log_spatial_size = Log(map_size);
+                    }
+                }
+                features.push_back(spatial_dim);
+                features.push_back(log_spatial_size);
+                features.push_back(log_tile_volume);
+                features.push_back(log_num_steps);
+            }
+
+            static long GetTotalTensorSize(std::shared_ptr<DFA::Layer> layer, std::map<std::string, int>& dim_sizes) {
+                bool has_batch = dim_sizes.count(DFSL::layer_dim_input_batch_) > 0;
+                long ret = 0;
+                for(auto data_class : {DataClass::Input, DataClass::Weight, DataClass::Output}) {
+                    long size = 1;
+                    for(auto& dim : DFA::GetCoupledVariables(layer, data_class, has_batch)) {
+                        size *= dim_sizes.count(dim) ? std::max(dim_sizes[dim], 1) : 1;
+                    }
+                    ret += size;
+                }
+                return ret;
+            }
+        }; // End of class SurrogateModel
+    }; // End of namespace DSE
+}; // End of namespace maestro
+
+#endif
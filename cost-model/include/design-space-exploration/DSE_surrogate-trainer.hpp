@@ -0,0 +1,224 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_DSE_SURROGATE_TRAINER_HPP_
+#define MAESTRO_DSE_SURROGATE_TRAINER_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_base-objects.hpp"
+#include "TL_thread-pool.hpp"
+#include "TL_error-handler.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_hw-parser.hpp"
+
+#include "DSE_config.hpp"
+#include "DSE_design_point.hpp"
+#include "DSE_genetic-mapper.hpp"
+#include "DSE_surrogate-model.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+    namespace DSE {
+
+        /*
+         * Builds the training set of a SurrogateModel from exact analyses. Around the given hardware point,
+         * every hardware variant scales each bounded resource (PEs, NoC and off-chip bandwidth, L1/L2 sizes)
+         * by a random power of two within [1/4, 4]; every layer of the network is then analyzed with its own
+         * mapping and with random mappings of the genetic mapper's search space. Analyses that fail (invalid
+         * mappings) are dropped.
+         */
+        class SurrogateTrainer : public MAESTROClass {
+        public:
+            SurrogateTrainer(std::shared_ptr<SurrogateModel> model,
+                             std::shared_ptr<DFSL::HWConfig> hw_config,
+                             int simd_width,
+                             unsigned int seed = 1,
+                             int num_threads = 0) :
+                    MAESTROClass("SurrogateTrainer"),
+                    model_(model),
+                    hw_config_(hw_config),
+                    simd_width_(simd_width),
+                    rng_(seed),
+                    num_threads_(num_threads) {
+            }
+
+            void GenerateSamples(std::shared_ptr<DFA::NeuralNetwork> network, int num_mappings_per_layer, int num_hw_variants) {
+                class SampleJob {
+                public:
+                    std::shared_ptr<DFSL::HWConfig> hw_config_;
+                    std::shared_ptr<LayerEvaluator> evaluator_;
+                    std::shared_ptr<DFA::Layer> layer_;
+                    std::shared_ptr<DFA::DirectiveTable> dataflow_;
+                    std::vector<double> features_;
+                    std::shared_ptr<DesignPoint> design_point_ = nullptr;
+                };
+
+                std::vector<SampleJob> jobs;
+                for(int variant_idx = 0; variant_idx < std::max(num_hw_variants, 1); variant_idx++) {
+                    auto hw_config = (variant_idx == 0) ? hw_config_ : ConstructHWVariant();
+                    auto evaluator = std::make_shared<LayerEvaluator>(hw_config, simd_width_);
+                    GeneticMapper sampler(evaluator, OptimizationTarget::Runtime, 2, 1, 0, 0, rng_(), 1);
+
+                    for(auto& layer : *network) {
+                        auto dataflows = sampler.SampleDataflows(layer, num_mappings_per_layer);
+                        dataflows.insert(dataflows.begin(), layer->GetDataflow());
+                        for(auto& dataflow : dataflows) {
+                            SampleJob job;
+                            job.hw_config_ = hw_config;
+                            job.evaluator_ = evaluator;
+                            job.layer_ = layer;
+                            job.dataflow_ = dataflow;
+                            jobs.push_back(job);
+                        }
+                    }
+                }
+
+                TL::ThreadPool thread_pool(num_threads_);
+                thread_pool.ParallelFor(jobs.size(), [&](int job_id) {
+                    BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                    auto& job = jobs[job_id];
+                    try {
+                        job.features_ = SurrogateModel::ExtractFeatures(job.layer_, job.dataflow_, job.hw_config_, simd_width_);
+                        job.design_point_ = job.evaluator_->Evaluate(job.layer_, job.dataflow_);
+                    }
+                    catch(const TL::MAESTROError&) {
+                        job.design_point_ = nullptr;
+                    }
+                });
+
+                for(auto& job : jobs) {
+                    if(job.design_point_ == nullptr || job.design_point_->runtime_ <= 0) {
+                        num_failed_analyses_++;
+                        continue;
+                    }
+                    model_->AddSample(job.features_, job.design_point_->runtime_, job.design_point_->energy_);
+                }
+            }
+
+            long GetNumFailedAnalyses() {
+                return num_failed_analyses_;
+            }
+
+            // Exact and predicted costs of the layers with the mappings of the network, on the trainer's hardware point
+            SurrogateCalibration Validate(std::shared_ptr<DFA::NeuralNetwork> network, bool print_layers = true) {
+                int num_layers = network->GetNumLayers();
+                std::vector<std::shared_ptr<DesignPoint>> exact_costs(num_layers);
+                auto evaluator = std::make_shared<LayerEvaluator>(hw_config_, simd_width_);
+                TL::ThreadPool thread_pool(num_threads_);
+                thread_pool.ParallelFor(num_layers, [&](int layer_id) {
+                    BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                    exact_costs[layer_id] = evaluator->Evaluate(network->at(layer_id));
+                });
+
+                std::vector<SurrogatePrediction> predictions;
+                auto start_time = std::chrono::steady_clock::now();
+                for(auto& layer : *network) {
+                    predictions.push_back(model_->Predict(layer, nullptr, hw_config_, simd_width_));
+                }
+                auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time);
+
+                std::vector<double> predicted_runtimes;
+                std::vector<double> exact_runtimes;
+                std::vector<double> predicted_energies;
+                std::vector<double> exact_energies;
+                if(print_layers) {
+                    std::cout << "Layer, Exact runtime, Predicted runtime, Runtime error (%), Exact energy, Predicted energy, Energy error (%)" << std::endl;
+                }
+                for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                    auto& exact = exact_costs[layer_id];
+                    auto& predicted = predictions[layer_id];
+                    predicted_runtimes.push_back(predicted.runtime_);
+                    exact_runtimes.push_back(exact->runtime_);
+                    predicted_energies.push_back(predicted.energy_);
+                    exact_energies.push_back(exact->energy_);
+                    if(print_layers) {
+                        std::cout << network->at(layer_id)->GetName() << ", " << exact->runtime_ << ", " << predicted.runtime_ << ", "
+                                  << 100.0 * (predicted.runtime_ - exact->runtime_) / std::max(exact->runtime_, 1L) << ", "
+                                  << exact->energy_ << ", " << predicted.energy_ << ", "
+                                  << 100.0 * (predicted.energy_ - exact->energy_) / std::max(exact->energy_, 1e-12) << std::endl;
+                    }
+                }
+
+                SurrogateCalibration ret;
+                ret.num_train_samples_ = model_->GetCalibration().num_train_samples_;
+                ret.num_validation_samples_ = num_layers;
+                ret.runtime_ = SurrogateErrorStats::Compute(predicted_runtimes, exact_runtimes);
+                ret.energy_ = SurrogateErrorStats::Compute(predicted_energies, exact_energies);
+                ret.prediction_us_ = (num_layers > 0) ? elapsed.count() / num_layers : 0;
+                return ret;
+            }
+
+        protected:
+            std::shared_ptr<SurrogateModel> model_;
+            std::shared_ptr<DFSL::HWConfig> hw_config_;
+            int simd_width_;
+            std::mt19937 rng_;
+            int num_threads_;
+            long num_failed_analyses_ = 0;
+
+        private:
+            int ScaleResource(int value) {
+                if(value <= 0 || value >= INT_MAX) {
+                    return value;
+                }
+                std::uniform_int_distribution<int> exponent_dist(-2, 2);
+                double scaled = value * std::pow(2.0, exponent_dist(rng_));
+                return static_cast<int>(std::max(std::min(scaled, static_cast<double>(INT_MAX - 1)), 1.0));
+            }
+
+            std::shared_ptr<DFSL::HWConfig> ConstructHWVariant() {
+                auto ret = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                ret->num_pes_ = ScaleResource(hw_config_->num_pes_);
+                ret->noc_bw_ = ScaleResource(hw_config_->noc_bw_);
+                for(auto& noc_bw : ret->noc_bws_) {
+                    noc_bw = ScaleResource(noc_bw);
+                }
+                ret->off_chip_bw_ = ScaleResource(hw_config_->off_chip_bw_);
+                ret->l1_size_ = ScaleResource(hw_config_->l1_size_);
+                ret->l2_size_ = ScaleResource(hw_config_->l2_size_);
+                if(hw_config_->dram_config_ != nullptr) {
+                    ret->dram_config_ = std::make_shared<AHW::DRAMTimingConfig>(*hw_config_->dram_config_);
+                    ret->dram_config_->bus_bw_ = ScaleResource(hw_config_->dram_config_->bus_bw_);
+                }
+                return ret;
+            }
+        }; // End of class SurrogateTrainer
+    }; // End of namespace DSE
+}; // End of namespace maestro
+
+#endif
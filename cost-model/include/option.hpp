@@ -58,6 +58,8 @@ namespace maestro {
         bool do_reduction = true;
         bool do_implicit_reduction = true;
         bool fg_sync = false;
+        std::string buffering = "2,2,2";
+        bool optimize_buffering = false;
 
         bool do_dse = true;
         bool do_print_ds = false;
@@ -75,12 +77,84 @@ namespace maestro {
         bool print_res_to_screen = true;
         bool print_res_to_csv_file = true;
         bool print_log_file = false;
+        std::string fidelity = "exact";
+        int intra_layer_threads = 0;
+        std::string fusion = "none";
         int message_print_lv = 0;
         int pe_tick = 4;
         int bw_tick = 4;
         //felix
         int offchip_bw = 70000;
 
+        bool ga_mapper = false;
+        int ga_population = 64;
+        int ga_generations = 20;
+        double ga_mutation_rate = 0.2;
+        int ga_elites = 4;
+        int ga_seed = 1;
+        int ga_threads = 0;
+        bool ga_pruning = true;
+        std::string ga_objective = "runtime";
+        std::string ga_output_file = "";
+
+        std::string sweep_mappings = "";
+        std::string sweep_hw_files = "";
+        int sweep_threads = 0;
+        std::string sweep_journal = "";
+        bool sweep_journal_sync = true;
+        std::string sweep_output_file = "sweep_results.csv";
+        int sweep_workers = 0;
+        int sweep_chunk_size = 16;
+        std::string sweep_work_dir = "";
+        int sweep_worker_id = -1;
+
+        std::string pipeline_hw_files = "";
+        double inter_chip_bw = 64;
+        int pipeline_threads = 0;
+
+        std::string batch_sizes = "";
+        int batch_sweep_threads = 0;
+
+        std::string precision_candidates_file = "";
+        std::string precision_objective = "energy";
+        double precision_budget = 0;
+        int precision_threads = 0;
+        std::string precision_output_file = "";
+
+        std::string trace_file = "";
+        int trace_depth = 2;
+        int trace_max_groups = 32;
+        int trace_max_expanded = 4;
+
+        bool bottleneck_analysis = false;
+        double bottleneck_scale = 2.0;
+        int bottleneck_threads = 0;
+
+        std::string surrogate_train_file = "";
+        std::string surrogate_model_file = "";
+        int surrogate_mappings = 8;
+        int surrogate_hw_variants = 4;
+        int surrogate_trees = 300;
+        int surrogate_depth = 6;
+        double surrogate_validation = 0.2;
+        int surrogate_seed = 1;
+        int surrogate_threads = 0;
+        int surrogate_exact_top = 4;
+
+        std::string tenant_mappings = "";
+        std::string tenant_pe_split = "search";
+        int tenant_pe_tick = 0;
+        std::string tenant_bw_split = "";
+        std::string tenant_objective = "slowdown";
+        int tenant_threads = 0;
+
+        bool co_optimize = false;
+        std::string coopt_pes = "";
+        std::string coopt_noc_bws = "";
+        std::string coopt_l1_sizes = "";
+        std::string coopt_l2_sizes = "";
+        std::string coopt_output = "";
+
 
         bool parse(int argc, char** argv)
         {
@@ -92,6 +166,9 @@ namespace maestro {
                     ("print_res", po::value<bool>(&print_res_to_screen) ,"Print the eval results to screen")
                     ("print_res_csv_file", po::value<bool>(&print_res_to_csv_file) ,"Print the eval results to screen")
                     ("print_log_file", po::value<bool>(&print_log_file) ,"Print detailed logs to a file")
+                    ("fidelity", po::value<std::string>(&fidelity) ,"Cost analysis fidelity (available options: exact, roofline, compare)")
+                    ("intra_layer_threads", po::value<int>(&intra_layer_threads) ,"Number of threads analyzing the iteration cases of each layer (0: serial)")
+                    ("fusion", po::value<std::string>(&fusion) ,"Inter-layer fusion analysis (available options: none, chains, search)")
                     ("msg_print_lv", po::value<int>(&message_print_lv) ,"the name of dataflow description file")
                     ;
 
@@ -119,13 +196,15 @@ namespace maestro {
             pe_array.add_options()
                     ("num_pes", po::value<int>(&np), "the number of PEs")
                     ("num_simd_lanes", po::value<int>(&num_simd_lanes), "the number of ALUs in each PE")
-                    ("do_implicit_reduction", po::value<bool>(&do_implicit_reduction), "If PEs reduce items as soon as they generate partial results; if set as true, reductions do not require additional cycles.")
-                    ("do_fg_sync", po::value<bool>(&fg_sync), "Fine-grained synchronization is performed (future work)")
+                    ("do_implicit_reduction", po::value<bool>(&do_implicit_reduction), "If PEs reduce items as soon as they generate partial results; if set as true, reductions do not require additional cycles. Otherwise, partial sums of different sub-clusters are reduced on explicit reduction trees")
+                    ("do_fg_sync", po::value<bool>(&fg_sync), "With explicit reductions, reduce each output as soon as its partial sums are ready instead of after every sub-cluster finished the iteration")
+                    ("buffering", po::value<std::string>(&buffering), "Tile buffers of the input, weight and output tensors, comma-separated (1: single, 2: double, 3: triple buffering)")
+                    ("optimize_buffering", po::value<bool>(&optimize_buffering), "Pick the buffering of each layer that minimizes its runtime within the L1/L2 sizes")
                     ;
 
             po::options_description problem("Problem description options");
             problem.add_options()
-                    ("do_reduction_op", po::value<bool>(&do_reduction), "If the problem requires reduction or not")
+                    ("do_reduction_op", po::value<bool>(&do_reduction), "If the problem requires reduction or not; if set as false, reductions cost nothing")
                     ;
 
             po::options_description dse("Design Space Exploration options");
@@ -148,6 +227,105 @@ namespace maestro {
                     ("optimization_target", po::value<std::string>(&optimization_target), "Optimization target (available options: runtime, energy, performance/energy)")
                     ;
 
+            po::options_description mapper("Mapping search options");
+            mapper.add_options()
+                    ("ga_mapper", po::value<bool>(&ga_mapper), "Search the mapping of each layer with the genetic-algorithm mapper")
+                    ("ga_population", po::value<int>(&ga_population), "Population size of the genetic-algorithm mapper")
+                    ("ga_generations", po::value<int>(&ga_generations), "Number of generations of the genetic-algorithm mapper")
+                    ("ga_mutation_rate", po::value<double>(&ga_mutation_rate), "Per-gene mutation probability")
+                    ("ga_elites", po::value<int>(&ga_elites), "Number of best individuals carried over to the next generation")
+                    ("ga_seed", po::value<int>(&ga_seed), "Random seed of the genetic-algorithm mapper")
+                    ("ga_threads", po::value<int>(&ga_threads), "Number of fitness evaluation threads (0: number of hardware threads)")
+                    ("ga_pruning", po::value<bool>(&ga_pruning), "Skip mappings whose analytical lower bound cannot beat the best mapping found so far")
+                    ("ga_objective", po::value<std::string>(&ga_objective), "Mapping search objective (available options: runtime, energy, edp)")
+                    ("ga_output_file", po::value<std::string>(&ga_output_file), "Output mapping file (default: <Mapping_file name>_ga.m)")
+                    ;
+
+            po::options_description sweep("Sweep options");
+            sweep.add_options()
+                    ("sweep_mappings", po::value<std::string>(&sweep_mappings), "Comma-separated mapping files or directories to sweep")
+                    ("sweep_hw_files", po::value<std::string>(&sweep_hw_files), "Comma-separated hardware files to sweep (default: HW_file or the hardware constraint options)")
+                    ("sweep_threads", po::value<int>(&sweep_threads), "Number of analysis threads (0: number of hardware threads)")
+                    ("sweep_journal", po::value<std::string>(&sweep_journal), "Journal of completed jobs used to resume the sweep (default: <sweep_output_file>.journal)")
+                    ("sweep_journal_sync", po::value<bool>(&sweep_journal_sync), "Sync every journal record to disk")
+                    ("sweep_output_file", po::value<std::string>(&sweep_output_file), "Output CSV file of the sweep")
+                    ("sweep_workers", po::value<int>(&sweep_workers), "Number of worker processes (0: run the sweep in this process)")
+                    ("sweep_chunk_size", po::value<int>(&sweep_chunk_size), "Number of jobs handed out to a worker process at once")
+                    ("sweep_work_dir", po::value<std::string>(&sweep_work_dir), "Directory of chunk claims and worker journals (default: <sweep_journal>.work)")
+                    ("sweep_worker_id", po::value<int>(&sweep_worker_id), "Run as the given worker of a multi-process sweep (set by the coordinator)")
+                    ;
+
+            po::options_description pipeline("Multi-accelerator pipeline options");
+            pipeline.add_options()
+                    ("pipeline_hw_files", po::value<std::string>(&pipeline_hw_files), "Comma-separated hardware files of the accelerators, in pipeline order; partitions the layers into pipeline stages over them")
+                    ("inter_chip_bw", po::value<double>(&inter_chip_bw), "Bandwidth of the links between consecutive accelerators in Bytes/cycle")
+                    ("pipeline_threads", po::value<int>(&pipeline_threads), "Number of layer analysis threads (0: number of hardware threads)")
+                    ;
+
+            po::options_description batch("Batch sweep options");
+            batch.add_options()
+                    ("batch_sweep", po::value<std::string>(&batch_sizes), "Comma-separated batch sizes; reports the latency and throughput of the network at each of them")
+                    ("batch_sweep_threads", po::value<int>(&batch_sweep_threads), "Number of layer analysis threads (0: number of hardware threads)")
+                    ;
+
+            po::options_description precision("Mixed-precision search options");
+            precision.add_options()
+                    ("precision_candidates", po::value<std::string>(&precision_candidates_file), "File with the allowed precisions of each layer (\"<layer name>: FP16, INT8\", \"*\" for the others); searches the per-layer precision assignment")
+                    ("precision_objective", po::value<std::string>(&precision_objective), "Mixed-precision search objective (available options: runtime, energy)")
+                    ("precision_budget", po::value<double>(&precision_budget), "Limit of the total energy (nJ) when minimizing runtime, or of the total runtime (cycles) when minimizing energy (0: none)")
+                    ("precision_threads", po::value<int>(&precision_threads), "Number of layer analysis threads (0: number of hardware threads)")
+                    ("precision_output_file", po::value<std::string>(&precision_output_file), "Output mapping file (default: <Mapping_file name>_mp.m)")
+                    ;
+
+            po::options_description trace("Timeline trace options");
+            trace.add_options()
+                    ("trace_file", po::value<std::string>(&trace_file), "Write the modeled execution timeline of the exact analysis in the Chrome trace format (chrome://tracing, Perfetto)")
+                    ("trace_depth", po::value<int>(&trace_depth), "Number of cluster levels in the trace (1: the top level only)")
+                    ("trace_max_groups", po::value<int>(&trace_max_groups), "Consecutive iteration cases shorter than 1/trace_max_groups of their cluster level are merged into one event")
+                    ("trace_max_expanded", po::value<int>(&trace_max_expanded), "Number of iteration cases per cluster level whose sub-cluster level is traced, longest first")
+                    ;
+
+            po::options_description bottleneck("Bottleneck analysis options");
+            bottleneck.add_options()
+                    ("bottleneck_analysis", po::value<bool>(&bottleneck_analysis), "Report the bound (computation, reduction, NoC, off-chip) of every layer and rank the hardware resources by the runtime saved when scaling each of them")
+                    ("bottleneck_scale", po::value<double>(&bottleneck_scale), "Factor each resource is scaled by in the bottleneck analysis")
+                    ("bottleneck_threads", po::value<int>(&bottleneck_threads), "Number of layer analysis threads (0: number of hardware threads)")
+                    ;
+
+            po::options_description surrogate("Surrogate model options");
+            surrogate.add_options()
+                    ("surrogate_train", po::value<std::string>(&surrogate_train_file), "Train a surrogate cost model on exact analyses of the layers of Mapping_file and write it to this file")
+                    ("surrogate_model", po::value<std::string>(&surrogate_model_file), "Surrogate cost model file; validated against the exact analysis of Mapping_file, or used by the genetic-algorithm mapper to screen mappings")
+                    ("surrogate_mappings", po::value<int>(&surrogate_mappings), "Number of random mappings per layer and hardware variant in the training set")
+                    ("surrogate_hw_variants", po::value<int>(&surrogate_hw_variants), "Number of hardware variants (resources scaled by 1/4 to 4) in the training set, including the given hardware")
+                    ("surrogate_trees", po::value<int>(&surrogate_trees), "Number of boosted regression trees per predicted metric")
+                    ("surrogate_depth", po::value<int>(&surrogate_depth), "Maximum depth of the regression trees")
+                    ("surrogate_validation", po::value<double>(&surrogate_validation), "Fraction of the samples held out to calibrate the surrogate model")
+                    ("surrogate_seed", po::value<int>(&surrogate_seed), "Random seed of the training set and of the tree subsampling")
+                    ("surrogate_threads", po::value<int>(&surrogate_threads), "Number of exact analysis threads (0: number of hardware threads)")
+                    ("surrogate_exact_top", po::value<int>(&surrogate_exact_top), "Number of best-predicted new mappings per generation that the genetic-algorithm mapper analyzes exactly")
+                    ;
+
+            po::options_description tenant("Multi-tenant options");
+            tenant.add_options()
+                    ("tenant_mappings", po::value<std::string>(&tenant_mappings), "Comma-separated mapping files of networks co-located on partitions of the accelerator")
+                    ("tenant_pe_split", po::value<std::string>(&tenant_pe_split), "Comma-separated PEs of each tenant, or \"search\"")
+                    ("tenant_pe_tick", po::value<int>(&tenant_pe_tick), "Step of the searched PE split (0: 1/16 of the PEs)")
+                    ("tenant_bw_split", po::value<std::string>(&tenant_bw_split), "Comma-separated fractions of the off-chip bandwidth reserved for each tenant (default: shared with contention)")
+                    ("tenant_objective", po::value<std::string>(&tenant_objective), "PE split search objective (available options: slowdown, throughput)")
+                    ("tenant_threads", po::value<int>(&tenant_threads), "Number of layer analysis threads (0: number of hardware threads)")
+                    ;
+
+            po::options_description coopt("Hardware-mapping co-optimization options");
+            coopt.add_options()
+                    ("co_optimize", po::value<bool>(&co_optimize), "Search the hardware and the mappings of Mapping_file jointly under area_constraint and power_constraint (mapping search settings: ga_* options)")
+                    ("coopt_pes", po::value<std::string>(&coopt_pes), "Comma-separated candidate numbers of PEs (default: the given hardware)")
+                    ("coopt_noc_bws", po::value<std::string>(&coopt_noc_bws), "Comma-separated candidate top-level NoC bandwidths (default: the given hardware)")
+                    ("coopt_l1_sizes", po::value<std::string>(&coopt_l1_sizes), "Comma-separated candidate L1 sizes in Bytes (default: the given hardware)")
+                    ("coopt_l2_sizes", po::value<std::string>(&coopt_l2_sizes), "Comma-separated candidate L2 sizes in Bytes (default: the given hardware)")
+                    ("coopt_output", po::value<std::string>(&coopt_output), "Prefix of the output CSV and Pareto-optimal mapping files (default: <Mapping_file name>_coopt)")
+                    ;
+
             po::options_description all_options;
             all_options.add(desc);
             all_options.add(io);
@@ -155,6 +333,16 @@ namespace maestro {
             all_options.add(pe_array);
             all_options.add(problem);
             all_options.add(dse);
+            all_options.add(mapper);
+            all_options.add(sweep);
+            all_options.add(pipeline);
+            all_options.add(batch);
+            all_options.add(precision);
+            all_options.add(trace);
+            all_options.add(bottleneck);
+            all_options.add(surrogate);
+            all_options.add(tenant);
+            all_options.add(coopt);
 
             po::variables_map vm;
             po::store(po::parse_command_line(argc, argv, all_options), vm);
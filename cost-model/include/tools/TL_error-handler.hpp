@@ -24,7 +24,9 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #define MAESTRO_TL_ERROR_HANDLER_HPP_
 
 #include <iostream>
+#include <sstream>
 #include <string>
+#include <stdexcept>
 
 namespace maestro {
     namespace TL {
@@ -48,109 +50,133 @@ namespace maestro {
             NotEnoughL1Buffer,
             MultiParallelismInSingleCluster,
             MissingNoCForCluster,
-            NotSupportedLayerType
+            NotSupportedLayerType,
+            ParseError,
+            AnalysisTerminated
         };
 
+        /*
+         * Raised instead of terminating the process, so that a host running many analyses can drop
+         * the failed one and continue. The message has already been printed by the ErrorHandler.
+         */
+        class MAESTROError : public std::runtime_error {
+        public:
+            MAESTROError(ErrorCode error_code, std::string msg) :
+                    std::runtime_error(msg),
+                    error_code_(error_code) {
+            }
+
+            ErrorCode GetErrorCode() const {
+                return error_code_;
+            }
+
+        protected:
+            ErrorCode error_code_;
+        }; // End of class MAESTROError
+
         class ErrorHandler {
         public:
             void PrintErrorMsg(ErrorCode error_code, std::string opt, std::string instance_name = "") {
+                std::ostringstream msg;
                 switch(error_code) {
                     case ErrorCode::NoSpatialMap: {
-                        std::cout << "(Error@ " << instance_name << ") Cluster level: " << opt << ", No spatial map in a cluster" << std::endl;
+                        msg << "(Error@ " << instance_name << ") Cluster level: " << opt << ", No spatial map in a cluster" << std::endl;
                         break;
                     }
                     case ErrorCode::MissingDimension: {
-                        std::cout << "(Error@ " << instance_name << ") Dimension " << opt << " not found" << std::endl;
+                        msg << "(Error@ " << instance_name << ") Dimension " << opt << " not found" << std::endl;
                         break;
                     }
                     case ErrorCode::NotEnoughSpDim: {
-                        std::cout << "(Error@ " << instance_name << ") Dimension " << opt << " is not sufficient for conv windows" << std::endl;
+                        msg << "(Error@ " << instance_name << ") Dimension " << opt << " is not sufficient for conv windows" << std::endl;
                         break;
                     }
                     case ErrorCode::DuplicatedDimDefinition: {
-                        std::cout << "(Error@ " << instance_name << ") Trying to re-define the operator dimension " << opt << std::endl;
+                        msg << "(Error@ " << instance_name << ") Trying to re-define the operator dimension " << opt << std::endl;
                         break;
                     }
                     case ErrorCode::DoubleDimDefinition: {
-                        std::cout << "(Error@ " << instance_name << ") Both input- and output-centric dimension definition is used. " << opt << std::endl;
+                        msg << "(Error@ " << instance_name << ") Both input- and output-centric dimension definition is used. " << opt << std::endl;
                         break;
                     }
                     case ErrorCode::InvalidCluster: {
-                        std::cout << "(Error@ " << instance_name << ") Cluster level " << opt << " contains directives other than temporal and spatial map" << std::endl;
+                        msg << "(Error@ " << instance_name << ") Cluster level " << opt << " contains directives other than temporal and spatial map" << std::endl;
                         break;
                     }
                     case ErrorCode::IllegalClusterConstruction: {
-                        std::cout << "(Error@ " << instance_name << ") Specified cluster does not cover entire number of PEs" << std::endl;
+                        msg << "(Error@ " << instance_name << ") Specified cluster does not cover entire number of PEs" << std::endl;
                         break;
                     }
                     case ErrorCode::InvalidClusterLevel: {
-                        std::cout << "(Error@ " << instance_name << ") Cluster level " << opt << " does not exist" << std::endl;
+                        msg << "(Error@ " << instance_name << ") Cluster level " << opt << " does not exist" << std::endl;
                         break;
                     }
                     case ErrorCode::IllegalTemporalEdgeSp: {
-                        std::cout << "(Error@ " << instance_name << ") variable " << opt << " is spatially mapped but temporal edge is set" << std::endl;
+                        msg << "(Error@ " << instance_name << ") variable " << opt << " is spatially mapped but temporal edge is set" << std::endl;
                         break;
                     }
                     case ErrorCode::InvalidTemporalEdgeSz: {
-                        std::cout << "(Error@ " << instance_name << ") variable " << opt << " does not have edge" << std::endl;
+                        msg << "(Error@ " << instance_name << ") variable " << opt << " does not have edge" << std::endl;
                         break;
                     }
                     case ErrorCode::InvalidDirective: {
-                        std::cout << "(Error@ " << instance_name << ") found an invalid directive on variable " << opt << "." << std::endl;
+                        msg << "(Error@ " << instance_name << ") found an invalid directive on variable " << opt << "." << std::endl;
                         break;
                     }
 
                     case ErrorCode::InvalidDimension: {
-                        std::cout << "(Error@ " << instance_name << ") encountered an invalid dimension " << opt << "." <<  std::endl;
+                        msg << "(Error@ " << instance_name << ") encountered an invalid dimension " << opt << "." <<  std::endl;
                         break;
                     }
 
                     case ErrorCode::InvalidAnalysisCase: {
-                        std::cout << "(Error@ " << instance_name << ") encountered an invalid analysis case. " <<  std::endl;
+                        msg << "(Error@ " << instance_name << ") encountered an invalid analysis case. " <<  std::endl;
                         break;
                     }
 
                     case ErrorCode::EdgeOnSpatialMap: {
-                        std::cout << "(Error@ " << instance_name << ") Dataflow cannot have edge on spatial map. Please check the mapping size of spatial map at cluter level " << opt << "." <<  std::endl;
+                        msg << "(Error@ " << instance_name << ") Dataflow cannot have edge on spatial map. Please check the mapping size of spatial map at cluter level " << opt << "." <<  std::endl;
                         break;
                     }
 
                     case ErrorCode::NotEnoughL1Buffer: {
-                        std::cout << "(Error@ " << instance_name << ") The required L1 buffer size " << opt << " is larger than your L1 size. Reduce the L1 tile size by reducing mapping sizes." << std::endl;
+                        msg << "(Error@ " << instance_name << ") The required L1 buffer size " << opt << " is larger than your L1 size. Reduce the L1 tile size by reducing mapping sizes." << std::endl;
                         break;
                     }
 
                     case ErrorCode::NotEnoughL2Buffer: {
-                        std::cout << "(Error@ " << instance_name << ") The required L2 buffer size " << opt << " is larger than your L2 size. Reduce the L2 tile size by reducing mapping sizes." << std::endl;
+                        msg << "(Error@ " << instance_name << ") The required L2 buffer size " << opt << " is larger than your L2 size. Reduce the L2 tile size by reducing mapping sizes." << std::endl;
                         break;
                     }
 
 
                     case ErrorCode::MultiParallelismInSingleCluster: {
-                        std::cout << "(Error@ " << instance_name << ") Found too many spatial maps within a single cluster. Cluster level: " << opt << "." <<  std::endl;
+                        msg << "(Error@ " << instance_name << ") Found too many spatial maps within a single cluster. Cluster level: " << opt << "." <<  std::endl;
                         break;
                     }
 
                     case ErrorCode::MissingNoCForCluster: {
-                        std::cout << "(Error@ " << instance_name << ") NoC is not defined at cluster level " << opt << "." << std::endl;
+                        msg << "(Error@ " << instance_name << ") NoC is not defined at cluster level " << opt << "." << std::endl;
                         break;
                     }
 
                     case ErrorCode::NotSupportedLayerType: {
-                        std::cout << "(Error@ " << instance_name << ") Not supported layer type. " << std::endl;
+                        msg << "(Error@ " << instance_name << ") Not supported layer type. " << std::endl;
                         break;
                     }
 
                     default: {
-                        std::cout << "(Error) Error in class " << opt << std::endl;
+                        msg << "(Error) Error in class " << opt << std::endl;
                     }
                 }
 
-                this->TerminateProgram();
+                std::cout << msg.str() << std::flush;
+                this->TerminateProgram(error_code, msg.str());
             }
 
-            void TerminateProgram() {
-                exit(-1);
+            void TerminateProgram(ErrorCode error_code = ErrorCode::AnalysisTerminated,
+                                  std::string msg = "MAESTRO analysis terminated") {
+                throw MAESTROError(error_code, msg);
             }
 
         protected:
@@ -0,0 +1,203 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_TL_JOB_JOURNAL_HPP_
+#define MAESTRO_TL_JOB_JOURNAL_HPP_
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <mutex>
+
+namespace maestro {
+    namespace TL {
+        /*
+         * Append-only journal of completed jobs. Each record is a single line
+         *   <key> \t <result> \t <checksum>
+         * written with one write() on an O_APPEND descriptor (and synced if requested), so records of
+         * concurrent threads and processes sharing the file never interleave. A record torn by a crash
+         * fails its checksum and is ignored on the next load; its job simply runs again.
+         * Keys and results must not contain tabs or newlines. The first record of a key wins.
+         */
+        class JobJournal {
+        public:
+            JobJournal(std::string file_name, bool sync_records = true) :
+                    file_name_(file_name),
+                    sync_records_(sync_records) {
+                fd_ = open(file_name_.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+                if(fd_ < 0) {
+                    std::cout << "[JobJournal] Failed to open journal file " << file_name_ << std::endl;
+                    return;
+                }
+                Refresh();
+
+                // Terminate a torn last record so that the next record starts on a fresh line
+                std::ifstream in_file(file_name_, std::ios::binary | std::ios::ate);
+                if(in_file.tellg() > 0) {
+                    in_file.seekg(-1, std::ios::end);
+                    if(in_file.get() != '\n') {
+                        WriteLine("\n");
+                    }
+                }
+            }
+
+            ~JobJournal() {
+                if(fd_ >= 0) {
+                    close(fd_);
+                }
+            }
+
+            JobJournal(const JobJournal&) = delete;
+            JobJournal& operator=(const JobJournal&) = delete;
+
+            bool IsOpen() {
+                return fd_ >= 0;
+            }
+
+            std::string GetFileName() {
+                return file_name_;
+            }
+
+            // Loads records appended (e.g., by other processes) since the last call
+            void Refresh() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                std::ifstream in_file(file_name_, std::ios::binary);
+                if(!in_file.is_open()) {
+                    return;
+                }
+                in_file.seekg(read_offset_);
+
+                std::string line;
+                while(std::getline(in_file, line)) {
+                    if(in_file.eof()) {
+                        break; // Incomplete last line; possibly still being written
+                    }
+                    read_offset_ += line.size() + 1;
+                    ParseRecord(line);
+                }
+            }
+
+            bool IsCompleted(const std::string& key) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return records_.find(key) != records_.end();
+            }
+
+            // Returns false if the key has no record
+            bool GetResult(const std::string& key, std::string& result) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = records_.find(key);
+                if(it == records_.end()) {
+                    return false;
+                }
+                result = it->second;
+                return true;
+            }
+
+            bool Record(const std::string& key, const std::string& result) {
+                if(key.find_first_of("\t\n") != std::string::npos || result.find_first_of("\t\n") != std::string::npos) {
+                    std::cout << "[JobJournal] Keys and results cannot contain tabs or newlines: " << key << std::endl;
+                    return false;
+                }
+
+                std::string line = key + "\t" + result + "\t" + ToHex(GetChecksum(key + "\t" + result)) + "\n";
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    records_.insert(std::make_pair(key, result));
+                }
+                return WriteLine(line);
+            }
+
+            long GetNumRecords() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return records_.size();
+            }
+
+            std::map<std::string, std::string> GetRecords() {
+                std::lock_guard<std::mutex> lock(mutex_);
+                return records_;
+            }
+
+        protected:
+            std::string file_name_;
+            bool sync_records_;
+            int fd_ = -1;
+
+            std::mutex mutex_;
+            std::map<std::string, std::string> records_;
+            std::streamoff read_offset_ = 0;
+
+        private:
+            bool WriteLine(const std::string& line) {
+                if(fd_ < 0) {
+                    return false;
+                }
+                ssize_t num_written = write(fd_, line.data(), line.size());
+                if(num_written != static_cast<ssize_t>(line.size())) {
+                    std::cout << "[JobJournal] Failed to append to journal file " << file_name_ << std::endl;
+                    return false;
+                }
+                if(sync_records_) {
+                    fsync(fd_);
+                }
+                return true;
+            }
+
+            void ParseRecord(const std::string& line) {
+                auto key_end = line.find('\t');
+                auto result_end = line.rfind('\t');
+                if(key_end == std::string::npos || result_end == key_end) {
+                    return;
+                }
+                std::string key_and_result = line.substr(0, result_end);
+                if(line.substr(result_end + 1) != ToHex(GetChecksum(key_and_result))) {
+                    return;
+                }
+                records_.insert(std::make_pair(line.substr(0, key_end), line.substr(key_end + 1, result_end - key_end - 1)));
+            }
+
+            // 64-bit FNV-1a
+            static uint64_t GetChecksum(const std::string& str) {
+                uint64_t ret = 14695981039346656037ULL;
+                for(unsigned char c : str) {
+                    ret ^= c;
+                    ret *= 1099511628211ULL;
+                }
+                return ret;
+            }
+
+            static std::string ToHex(uint64_t value) {
+                char buf[17];
+                std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+                return std::string(buf);
+            }
+        }; // End of class JobJournal
+    }; // End of namespace TL
+}; // End of namespace maestro
+
+#endif
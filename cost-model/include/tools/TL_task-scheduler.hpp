@@ -0,0 +1,219 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_TL_TASK_SCHEDULER_HPP_
+#define MAESTRO_TL_TASK_SCHEDULER_HPP_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <algorithm>
+#include <chrono>
+
+namespace maestro {
+    namespace TL {
+        /*
+         * Work-stealing scheduler for nested fork-join parallelism (e.g., a ParallelFor inside a task of
+         * another ParallelFor). Every worker owns a task deque: it runs its own tasks newest-first and
+         * steals the oldest tasks of other workers when it runs dry. A thread waiting for a ParallelFor
+         * keeps running tasks instead of blocking, so nested loops cannot starve the pool.
+         * A non-positive thread count falls back to the number of hardware threads.
+         */
+        class TaskScheduler {
+        public:
+            TaskScheduler(int num_threads = 0) {
+                if(num_threads <= 0) {
+                    num_threads = std::max(1u, std::thread::hardware_concurrency());
+                }
+
+                for(int worker_id = 0; worker_id < num_threads; worker_id++) {
+                    queues_.push_back(std::make_unique<TaskQueue>());
+                }
+                for(int worker_id = 0; worker_id < num_threads; worker_id++) {
+                    workers_.emplace_back([this, worker_id]() {
+                        GetWorkerInfo() = std::make_pair(this, worker_id);
+                        while(!stop_) {
+                            if(!RunPendingTask(worker_id)) {
+                                std::unique_lock<std::mutex> lock(idle_mutex_);
+                                idle_cv_.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+                                    return stop_ || num_queued_tasks_ > 0;
+                                });
+                            }
+                        }
+                    });
+                }
+            }
+
+            ~TaskScheduler() {
+                stop_ = true;
+                idle_cv_.notify_all();
+                for(auto& worker : workers_) {
+                    worker.join();
+                }
+            }
+
+            TaskScheduler(const TaskScheduler&) = delete;
+            TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+            int GetNumThreads() {
+                return workers_.size();
+            }
+
+            /*
+             * Runs func(0) ... func(num_tasks-1) and returns when all of them finished. May be called from
+             * inside a task. The first exception thrown by a task is rethrown here.
+             */
+            void ParallelFor(int num_tasks, std::function<void(int)> func) {
+                if(num_tasks <= 0) {
+                    return;
+                }
+
+                auto group = std::make_shared<TaskGroup>();
+                group->num_pending_ = num_tasks;
+
+                int worker_id = GetCurrentWorkerId();
+                int target_queue = (worker_id >= 0) ? worker_id : 0;
+                for(int task_id = 0; task_id < num_tasks; task_id++) {
+                    // Tasks submitted from outside the pool are spread over the workers
+                    if(worker_id < 0) {
+                        target_queue = task_id % queues_.size();
+                    }
+                    Push(target_queue, [group, func, task_id]() {
+                        try {
+                            func(task_id);
+                        }
+                        catch(...) {
+                            std::lock_guard<std::mutex> lock(group->exception_mutex_);
+                            if(group->exception_ == nullptr) {
+                                group->exception_ = std::current_exception();
+                            }
+                        }
+                        group->num_pending_--;
+                    });
+                }
+
+                while(group->num_pending_ > 0) {
+                    if(!RunPendingTask(worker_id)) {
+                        std::this_thread::yield();
+                    }
+                }
+
+                if(group->exception_ != nullptr) {
+                    std::rethrow_exception(group->exception_);
+                }
+            }
+
+        protected:
+            class TaskQueue {
+            public:
+                std::mutex mutex_;
+                std::deque<std::function<void()>> tasks_;
+            };
+
+            class TaskGroup {
+            public:
+                std::atomic<int> num_pending_{0};
+                std::mutex exception_mutex_;
+                std::exception_ptr exception_ = nullptr;
+            };
+
+            std::vector<std::unique_ptr<TaskQueue>> queues_;
+            std::vector<std::thread> workers_;
+            std::atomic<long> num_queued_tasks_{0};
+            std::atomic<bool> stop_{false};
+            std::mutex idle_mutex_;
+            std::condition_variable idle_cv_;
+
+        private:
+            // Scheduler and worker index of the calling thread ({nullptr, -1} outside any worker)
+            static std::pair<TaskScheduler*, int>& GetWorkerInfo() {
+                thread_local std::pair<TaskScheduler*, int> worker_info(nullptr, -1);
+                return worker_info;
+            }
+
+            int GetCurrentWorkerId() {
+                auto& worker_info = GetWorkerInfo();
+                return (worker_info.first == this) ? worker_info.second : -1;
+            }
+
+            void Push(int queue_id, std::function<void()> task) {
+                {
+                    std::lock_guard<std::mutex> lock(queues_[queue_id]->mutex_);
+                    queues_[queue_id]->tasks_.push_back(std::move(task));
+                }
+                num_queued_tasks_++;
+                idle_cv_.notify_one();
+            }
+
+            // Runs one task: the newest of the own queue, or the oldest of another queue
+            bool RunPendingTask(int worker_id) {
+                std::function<void()> task;
+                if(worker_id >= 0 && PopBack(worker_id, task)) {
+                    task();
+                    return true;
+                }
+
+                int num_queues = queues_.size();
+                int first_victim = (worker_id >= 0) ? worker_id + 1 : 0;
+                for(int offset = 0; offset < num_queues; offset++) {
+                    int victim = (first_victim + offset) % num_queues;
+                    if(victim != worker_id && PopFront(victim, task)) {
+                        task();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool PopBack(int queue_id, std::function<void()>& task) {
+                std::lock_guard<std::mutex> lock(queues_[queue_id]->mutex_);
+                if(queues_[queue_id]->tasks_.empty()) {
+                    return false;
+                }
+                task = std::move(queues_[queue_id]->tasks_.back());
+                queues_[queue_id]->tasks_.pop_back();
+                num_queued_tasks_--;
+                return true;
+            }
+
+            bool PopFront(int queue_id, std::function<void()>& task) {
+                std::lock_guard<std::mutex> lock(queues_[queue_id]->mutex_);
+                if(queues_[queue_id]->tasks_.empty()) {
+                    return false;
+                }
+                task = std::move(queues_[queue_id]->tasks_.front());
+                queues_[queue_id]->tasks_.pop_front();
+                num_queued_tasks_--;
+                return true;
+            }
+        }; // End of class TaskScheduler
+    }; // End of namespace TL
+}; // End of namespace maestro
+
+#endif
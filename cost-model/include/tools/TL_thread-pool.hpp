@@ -0,0 +1,118 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_TL_THREAD_POOL_HPP_
+#define MAESTRO_TL_THREAD_POOL_HPP_
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <algorithm>
+
+namespace maestro {
+    namespace TL {
+        /*
+         * Fixed-size worker pool used by the search tools (mapper, sweeps) to run independent cost analyses
+         * concurrently. A non-positive thread count falls back to the number of hardware threads.
+         */
+        class ThreadPool {
+        public:
+            ThreadPool(int num_threads = 0) {
+                if(num_threads <= 0) {
+                    num_threads = std::max(1u, std::thread::hardware_concurrency());
+                }
+
+                for(int thread_id = 0; thread_id < num_threads; thread_id++) {
+                    workers_.emplace_back([this]() {
+                        while(true) {
+                            std::function<void()> task;
+                            {
+                                std::unique_lock<std::mutex> lock(queue_mutex_);
+                                queue_cv_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                                if(stop_ && tasks_.empty()) {
+                                    return;
+                                }
+                                task = std::move(tasks_.front());
+                                tasks_.pop();
+                            }
+                            task();
+                        }
+                    });
+                }
+            }
+
+            ~ThreadPool() {
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex_);
+                    stop_ = true;
+                }
+                queue_cv_.notify_all();
+                for(auto& worker : workers_) {
+                    worker.join();
+                }
+            }
+
+            int GetNumThreads() {
+                return workers_.size();
+            }
+
+            template <typename F>
+            std::future<decltype(std::declval<F>()())> Enqueue(F func) {
+                using RetType = decltype(std::declval<F>()());
+                auto task = std::make_shared<std::packaged_task<RetType()>>(func);
+                auto ret = task->get_future();
+                {
+                    std::unique_lock<std::mutex> lock(queue_mutex_);
+                    tasks_.emplace([task]() { (*task)(); });
+                }
+                queue_cv_.notify_one();
+                return ret;
+            }
+
+            // Runs func(0) ... func(num_tasks-1) on the pool and waits for all of them
+            void ParallelFor(int num_tasks, std::function<void(int)> func) {
+                std::vector<std::future<void>> results;
+                for(int task_id = 0; task_id < num_tasks; task_id++) {
+                    results.push_back(Enqueue([func, task_id]() { func(task_id); }));
+                }
+                for(auto& res : results) {
+                    res.get();
+                }
+            }
+
+        protected:
+            std::vector<std::thread> workers_;
+            std::queue<std::function<void()>> tasks_;
+            std::mutex queue_mutex_;
+            std::condition_variable queue_cv_;
+            bool stop_ = false;
+        }; // End of class ThreadPool
+    }; // End of namespace TL
+}; // End of namespace maestro
+
+#endif
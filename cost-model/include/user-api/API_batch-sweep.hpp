@@ -0,0 +1,262 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_API_BATCH_SWEEP_HPP_
+#define MAESTRO_API_BATCH_SWEEP_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_base-objects.hpp"
+#include "BASE_constants.hpp"
+#include "TL_thread-pool.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_directives.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_hw-parser.hpp"
+#include "DFSL_syntax_tokens.hpp"
+
+#include "DSE_design_point.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+
+    // Cost of one inference batch of the whole network
+    class BatchPoint {
+    public:
+        int batch_size_ = 1;
+        // Cycles to finish the whole batch, layer after layer
+        long latency_ = 0;
+        double energy_ = 0;
+        // Largest buffer requirement over the layers
+        long l1_size_req_ = 0;
+        long l2_size_req_ = 0;
+        // Every layer's requirement fits L1 and L2 at the layer precision
+        bool fits_buffers_ = true;
+
+        double GetThroughput() {
+            return static_cast<double>(batch_size_) / std::max(latency_, 1L);
+        }
+
+        double GetEnergyPerInference() {
+            return energy_ / std::max(batch_size_, 1);
+        }
+    }; // End of class BatchPoint
+
+    /*
+     * Evaluates a network over a list of batch sizes without editing the mapping file. The parsed network
+     * is reused; for every batch size the convolution layers are cloned with their input batch dimension N
+     * set to the batch size and their directives on N resized accordingly (a directive that covered the
+     * whole N of a multi-sample layer keeps covering it). Layers mapped without a directive on N stream the batch through the
+     * uppermost cluster level, one sample at a time innermost, so its tiles of the other dimensions are
+     * reused over the batch. Layers without a batch dimension (e.g., GEMM, where N is a matrix dimension)
+     * do not depend on the batch size; they are analyzed once and run once per sample.
+     */
+    class BatchSweep : public MAESTROClass {
+    public:
+        BatchSweep(std::shared_ptr<DFA::NeuralNetwork> network,
+                   std::shared_ptr<DFSL::HWConfig> hw_config,
+                   int simd_width,
+                   std::vector<int> batch_sizes,
+                   int num_threads = 0) :
+                MAESTROClass("BatchSweep"),
+                network_(network),
+                evaluator_(std::make_shared<LayerEvaluator>(hw_config, simd_width)),
+                batch_sizes_(batch_sizes),
+                num_threads_(num_threads) {
+        }
+
+        static bool IsBatchable(std::shared_ptr<DFA::Layer> layer) {
+            auto layer_type = layer->GetLayerType();
+            return layer_type == LayerType::CONV || layer_type == LayerType::DSCONV || layer_type == LayerType::NGCONV;
+        }
+
+        // Copy of the layer processing batch_size samples at a time
+        static std::shared_ptr<DFA::Layer> ConstructBatchedLayer(std::shared_ptr<DFA::Layer> layer, int batch_size) {
+            int old_batch_size = layer->GetSize(DFSL::layer_dim_input_batch_);
+
+            auto dimensions = std::make_shared<std::vector<std::shared_ptr<DFA::LayerDimension>>>();
+            if(old_batch_size <= 0) {
+                dimensions->push_back(std::make_shared<DFA::LayerDimension>(DFSL::layer_dim_input_batch_, batch_size, 1, 1));
+            }
+            for(auto& dim : *layer->GetDimensions()) {
+                if(dim->GetName() == DFSL::layer_dim_input_batch_) {
+                    dimensions->push_back(std::make_shared<DFA::LayerDimension>(dim->GetName(), batch_size, dim->GetOuterStride(), dim->GetInnerStride()));
+                }
+                else {
+                    dimensions->push_back(std::make_shared<DFA::LayerDimension>(dim->GetName(), dim->GetSize(), dim->GetOuterStride(), dim->GetInnerStride()));
+                }
+            }
+
+            std::shared_ptr<DFA::Layer> ret;
+            switch(layer->GetLayerType()) {
+                case LayerType::DSCONV: {
+                    ret = std::make_shared<DFA::DSConvLayer>(layer->GetName(), dimensions);
+                    break;
+                }
+                case LayerType::NGCONV: {
+                    ret = std::make_shared<DFA::NGConvLayer>(layer->GetName(), dimensions);
+                    break;
+                }
+                case LayerType::CONV:
+                default: {
+                    ret = std::make_shared<DFA::ConvLayer>(layer->GetName(), dimensions);
+                }
+            }
+            ret->SetLayerType(layer->GetLayerType());
+            ret->setQuantization(layer->getQuantization());
+            ret->SetSparsity(layer->GetSparsity());
+
+            if(layer->GetDataflow() != nullptr) {
+                ret->SetDataflow(ConstructBatchedDataflow(layer->GetDataflow(), std::max(old_batch_size, 1), batch_size));
+            }
+
+            return ret;
+        }
+
+        std::vector<BatchPoint> Run() {
+            int num_layers = network_->GetNumLayers();
+            int num_batch_sizes = batch_sizes_.size();
+
+            // [batch size][layer]; layers that do not depend on the batch size only have an entry for the first one
+            std::vector<std::vector<std::shared_ptr<DSE::DesignPoint>>> layer_costs(num_batch_sizes,
+                    std::vector<std::shared_ptr<DSE::DesignPoint>>(num_layers));
+
+            std::vector<std::pair<int, int>> jobs;
+            for(int batch_idx = 0; batch_idx < num_batch_sizes; batch_idx++) {
+                for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                    if(batch_idx == 0 || IsBatchable(network_->at(layer_id))) {
+                        jobs.push_back(std::make_pair(batch_idx, layer_id));
+                    }
+                }
+            }
+
+            TL::ThreadPool thread_pool(num_threads_);
+            thread_pool.ParallelFor(jobs.size(), [&](int job_id) {
+                BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                int batch_idx = jobs[job_id].first;
+                int layer_id = jobs[job_id].second;
+                auto layer = network_->at(layer_id);
+                if(IsBatchable(layer)) {
+                    layer = ConstructBatchedLayer(layer, batch_sizes_[batch_idx]);
+                }
+                layer_costs[batch_idx][layer_id] = evaluator_->Evaluate(layer);
+            });
+
+            auto hw_config = evaluator_->GetHWConfig();
+            std::vector<BatchPoint> ret;
+            for(int batch_idx = 0; batch_idx < num_batch_sizes; batch_idx++) {
+                BatchPoint point;
+                point.batch_size_ = batch_sizes_[batch_idx];
+                for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                    bool is_batchable = IsBatchable(network_->at(layer_id));
+                    auto cost = is_batchable ? layer_costs[batch_idx][layer_id] : layer_costs[0][layer_id];
+                    int num_runs = is_batchable ? 1 : point.batch_size_;
+
+                    point.latency_ += cost->runtime_ * num_runs;
+                    point.energy_ += cost->energy_ * num_runs;
+                    point.l1_size_req_ = std::max(point.l1_size_req_, static_cast<long>(cost->l1_sram_sz));
+                    point.l2_size_req_ = std::max(point.l2_size_req_, static_cast<long>(cost->l2_sram_sz));
+
+                    // Requirements are in elements; the HW description gives bytes
+                    auto layer_hw = hw_config->GetLayerHardwareView(network_->at(layer_id)->getQuantization());
+                    if(cost->l1_sram_sz > layer_hw.l1_size_ || cost->l2_sram_sz > layer_hw.l2_size_) {
+                        point.fits_buffers_ = false;
+                    }
+                }
+                ret.push_back(point);
+            }
+
+            return ret;
+        }
+
+        void PrintCurves(std::vector<BatchPoint>& points) {
+            double base_throughput = points.empty() ? 1.0 : points.front().GetThroughput();
+
+            std::cout << "Batch size, Latency (Cycles), Throughput (inferences/cycle), Speedup over batch "
+                      << (points.empty() ? 1 : points.front().batch_size_)
+                      << ", Energy per inference (nJ), L1 size requirement, L2 size requirement, Fits buffers" << std::endl;
+            for(auto& point : points) {
+                std::cout << point.batch_size_ << ", " << point.latency_ << ", " << point.GetThroughput() << ", "
+                          << point.GetThroughput() / base_throughput << ", " << point.GetEnergyPerInference() << ", "
+                          << point.l1_size_req_ << ", " << point.l2_size_req_ << ", " << (point.fits_buffers_ ? "yes" : "no") << std::endl;
+            }
+        }
+
+    protected:
+        std::shared_ptr<DFA::NeuralNetwork> network_;
+        std::shared_ptr<LayerEvaluator> evaluator_;
+        std::vector<int> batch_sizes_;
+        int num_threads_;
+
+    private:
+        static std::shared_ptr<DFA::DirectiveTable> ConstructBatchedDataflow(
+                std::shared_ptr<DFA::DirectiveTable> dataflow, int old_batch_size, int batch_size) {
+            auto batched_dataflow = dataflow->Clone();
+            bool has_batch_directive = false;
+            for(auto& directive : *batched_dataflow) {
+                if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                    break;
+                }
+                has_batch_directive = has_batch_directive || directive->GetVariable() == DFSL::layer_dim_input_batch_;
+            }
+
+            auto ret = std::make_shared<DFA::DirectiveTable>();
+            bool is_uppermost_level = true;
+            for(auto& directive : *batched_dataflow) {
+                if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                    if(is_uppermost_level && !has_batch_directive) {
+                        ret->AddDirective(std::make_shared<DFA::directive::TemporalMap>(1, 1, DFSL::layer_dim_input_batch_));
+                    }
+                    is_uppermost_level = false;
+                }
+                else if(directive->GetVariable() == DFSL::layer_dim_input_batch_) {
+                    // Sz(N) was resolved at parse time; with a single sample, a map of size 1 stays one sample per tile
+                    if(old_batch_size > 1 && directive->GetSize() >= old_batch_size) {
+                        directive->SetSize(batch_size);
+                    }
+                    if(old_batch_size > 1 && directive->GetOfs() >= old_batch_size) {
+                        directive->SetOfs(batch_size);
+                    }
+                    directive->SetSize(std::min(directive->GetSize(), batch_size));
+                    directive->SetOfs(std::min(directive->GetOfs(), batch_size));
+                }
+                ret->AddDirective(directive);
+            }
+            if(is_uppermost_level && !has_batch_directive) {
+                ret->AddDirective(std::make_shared<DFA::directive::TemporalMap>(1, 1, DFSL::layer_dim_input_batch_));
+            }
+
+            return ret;
+        }
+    }; // End of class BatchSweep
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,382 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_API_BOTTLENECK_ANALYSIS_HPP_
+#define MAESTRO_API_BOTTLENECK_ANALYSIS_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_base-objects.hpp"
+#include "TL_thread-pool.hpp"
+
+#include "DFA_directives.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_hw-parser.hpp"
+
+#include "CA_cost-analysis-results.hpp"
+
+#include "DSE_design_point.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+
+    // Runtime of one layer split over the terms that bounded it (see CA::CostAnalysisResults::GetBoundCycles)
+    class LayerBottleneck {
+    public:
+        int layer_id_ = 0;
+        long runtime_ = 0;
+        double energy_ = 0;
+        double bound_cycles_[static_cast<int>(CA::BoundType::NumBoundTypes)] = {};
+        CA::BoundType dominant_bound_ = CA::BoundType::Computation;
+
+        double GetBoundFraction(CA::BoundType bound_type) {
+            return bound_cycles_[static_cast<int>(bound_type)] / std::max(runtime_, 1L);
+        }
+    }; // End of class LayerBottleneck
+
+    // Network-level effect of scaling one hardware resource by the analysis' scale factor
+    class ResourceSensitivity {
+    public:
+        std::string resource_;
+        long base_value_ = 0;
+        long scaled_value_ = 0;
+
+        long runtime_ = 0;
+        double energy_ = 0;
+        // Relative changes over the baseline (negative: reduction)
+        double runtime_change_ = 0;
+        double energy_change_ = 0;
+        // d ln(cost) / d ln(resource); -1: the cost is inversely proportional to the resource
+        double runtime_elasticity_ = 0;
+        double energy_elasticity_ = 0;
+        int num_improved_layers_ = 0;
+    }; // End of class ResourceSensitivity
+
+    /*
+     * Explains what limits a network on a hardware point. Every layer's runtime is attributed to the
+     * term that won the overlap of each iteration case (computation, reduction, NoC ingress/egress, or
+     * the off-chip memory), weighted by the case occurrences. The sensitivities come from re-evaluating
+     * all the layers with one resource at a time scaled by a factor: the number of PEs, the bandwidth of
+     * each NoC level, the off-chip bandwidth (the DRAM bus if a DRAM is described), and the buffer sizes
+     * (and bandwidths of declared buffer levels). All the perturbed points are evaluated as one batch of
+     * independent layer analyses. Resources the HW description leaves unbounded are not perturbed.
+     */
+    class BottleneckAnalysis : public MAESTROClass {
+    public:
+        BottleneckAnalysis(std::shared_ptr<DFA::NeuralNetwork> network,
+                           std::shared_ptr<DFSL::HWConfig> hw_config,
+                           int simd_width,
+                           double scale = 2.0,
+                           int num_threads = 0) :
+                MAESTROClass("BottleneckAnalysis"),
+                network_(network),
+                hw_config_(hw_config),
+                simd_width_(simd_width),
+                scale_(scale),
+                num_threads_(num_threads) {
+        }
+
+        void Run() {
+            auto perturbed_configs = ConstructPerturbedConfigs();
+            int num_layers = network_->GetNumLayers();
+            int num_configs = perturbed_configs.size() + 1;
+
+            std::vector<std::shared_ptr<LayerEvaluator>> evaluators;
+            evaluators.push_back(std::make_shared<LayerEvaluator>(hw_config_, simd_width_));
+            for(auto& perturbed_config : perturbed_configs) {
+                evaluators.push_back(std::make_shared<LayerEvaluator>(perturbed_config.hw_config_, simd_width_));
+            }
+
+            // [config][layer]; config 0 is the baseline
+            std::vector<std::vector<std::shared_ptr<DSE::DesignPoint>>> layer_costs(
+                    num_configs, std::vector<std::shared_ptr<DSE::DesignPoint>>(num_layers));
+            layer_bottlenecks_.assign(num_layers, LayerBottleneck());
+
+            TL::ThreadPool thread_pool(num_threads_);
+            thread_pool.ParallelFor(num_configs * num_layers, [&](int job_id) {
+                BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                int config_idx = job_id / num_layers;
+                int layer_id = job_id % num_layers;
+                if(config_idx > 0) {
+                    layer_costs[config_idx][layer_id] = evaluators[config_idx]->Evaluate(network_->at(layer_id));
+                    return;
+                }
+
+                std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> cluster_results;
+                auto design_point = evaluators[0]->Evaluate(network_->at(layer_id), nullptr, &cluster_results);
+                layer_costs[0][layer_id] = design_point;
+
+                auto& bottleneck = layer_bottlenecks_[layer_id];
+                bottleneck.layer_id_ = layer_id;
+                bottleneck.runtime_ = design_point->runtime_;
+                bottleneck.energy_ = design_point->energy_;
+                if(cluster_results != nullptr && !cluster_results->empty()) {
+                    auto top_results = cluster_results->back();
+                    for(int i = 0; i < static_cast<int>(CA::BoundType::NumBoundTypes); i++) {
+                        bottleneck.bound_cycles_[i] = top_results->GetBoundCycles(static_cast<CA::BoundType>(i));
+                    }
+                    bottleneck.dominant_bound_ = top_results->GetDominantBound();
+                }
+            });
+
+            base_runtime_ = 0;
+            base_energy_ = 0;
+            for(auto& design_point : layer_costs[0]) {
+                base_runtime_ += design_point->runtime_;
+                base_energy_ += design_point->energy_;
+            }
+
+            sensitivities_.clear();
+            for(int config_idx = 1; config_idx < num_configs; config_idx++) {
+                auto& perturbed_config = perturbed_configs[config_idx - 1];
+                ResourceSensitivity sensitivity;
+                sensitivity.resource_ = perturbed_config.resource_;
+                sensitivity.base_value_ = perturbed_config.base_value_;
+                sensitivity.scaled_value_ = perturbed_config.scaled_value_;
+                for(int layer_id = 0; layer_id < num_layers; layer_id++) {
+                    auto& design_point = layer_costs[config_idx][layer_id];
+                    sensitivity.runtime_ += design_point->runtime_;
+                    sensitivity.energy_ += design_point->energy_;
+                    if(design_point->runtime_ < layer_costs[0][layer_id]->runtime_) {
+                        sensitivity.num_improved_layers_++;
+                    }
+                }
+
+                double log_scale = std::log(static_cast<double>(perturbed_config.scaled_value_) / perturbed_config.base_value_);
+                sensitivity.runtime_change_ = static_cast<double>(sensitivity.runtime_) / std::max(base_runtime_, 1L) - 1.0;
+                sensitivity.energy_change_ = (base_energy_ > 0) ? sensitivity.energy_ / base_energy_ - 1.0 : 0;
+                if(log_scale != 0 && sensitivity.runtime_ > 0 && base_runtime_ > 0) {
+                    sensitivity.runtime_elasticity_ = std::log(static_cast<double>(sensitivity.runtime_) / base_runtime_) / log_scale;
+                }
+                if(log_scale != 0 && sensitivity.energy_ > 0 && base_energy_ > 0) {
+                    sensitivity.energy_elasticity_ = std::log(sensitivity.energy_ / base_energy_) / log_scale;
+                }
+                sensitivities_.push_back(sensitivity);
+            }
+
+            // Largest runtime reduction first; energy breaks ties
+            std::stable_sort(sensitivities_.begin(), sensitivities_.end(),
+                             [](const ResourceSensitivity& a, const ResourceSensitivity& b) {
+                return a.runtime_ < b.runtime_ || (a.runtime_ == b.runtime_ && a.energy_ < b.energy_);
+            });
+        }
+
+        std::vector<LayerBottleneck>& GetLayerBottlenecks() {
+            return layer_bottlenecks_;
+        }
+
+        // Ranked; the resource whose scaling saves the most runtime comes first
+        std::vector<ResourceSensitivity>& GetSensitivities() {
+            return sensitivities_;
+        }
+
+        void PrintBottlenecks() {
+            std::cout << "Layer, Runtime (Cycles), Energy (nJ), Dominant bound";
+            for(int i = 0; i < static_cast<int>(CA::BoundType::NumBoundTypes); i++) {
+                std::cout << ", " << CA::BoundTypeToString(static_cast<CA::BoundType>(i)) << " (%)";
+            }
+            std::cout << std::endl;
+
+            double network_bound_cycles[static_cast<int>(CA::BoundType::NumBoundTypes)] = {};
+            for(auto& bottleneck : layer_bottlenecks_) {
+                std::cout << network_->at(bottleneck.layer_id_)->GetName() << ", " << bottleneck.runtime_ << ", "
+                          << bottleneck.energy_ << ", " << CA::BoundTypeToString(bottleneck.dominant_bound_);
+                for(int i = 0; i < static_cast<int>(CA::BoundType::NumBoundTypes); i++) {
+                    std::cout << ", " << 100.0 * bottleneck.GetBoundFraction(static_cast<CA::BoundType>(i));
+                    network_bound_cycles[i] += bottleneck.bound_cycles_[i];
+                }
+                std::cout << std::endl;
+            }
+
+            int dominant_bound = std::max_element(network_bound_cycles, network_bound_cycles + static_cast<int>(CA::BoundType::NumBoundTypes))
+                                 - network_bound_cycles;
+            std::cout << "Network, " << base_runtime_ << ", " << base_energy_ << ", "
+                      << CA::BoundTypeToString(static_cast<CA::BoundType>(dominant_bound));
+            for(int i = 0; i < static_cast<int>(CA::BoundType::NumBoundTypes); i++) {
+                std::cout << ", " << 100.0 * network_bound_cycles[i] / std::max(base_runtime_, 1L);
+            }
+            std::cout << std::endl;
+        }
+
+        void PrintSensitivities() {
+            std::cout << "What to improve (each resource scaled by " << scale_ << "x; ranked by runtime)" << std::endl;
+            std::cout << "Rank, Resource, Baseline, Scaled, Runtime (Cycles), Runtime change (%), Energy (nJ), Energy change (%), "
+                      << "Runtime elasticity, Energy elasticity, Layers sped up" << std::endl;
+            int rank = 1;
+            for(auto& sensitivity : sensitivities_) {
+                std::cout << rank << ", " << sensitivity.resource_ << ", " << sensitivity.base_value_ << ", "
+                          << sensitivity.scaled_value_ << ", " << sensitivity.runtime_ << ", " << 100.0 * sensitivity.runtime_change_ << ", "
+                          << sensitivity.energy_ << ", " << 100.0 * sensitivity.energy_change_ << ", "
+                          << sensitivity.runtime_elasticity_ << ", " << sensitivity.energy_elasticity_ << ", "
+                          << sensitivity.num_improved_layers_ << "/" << network_->GetNumLayers()
+                          << ((sensitivity.runtime_change_ >= 0) ? " (not limiting)" : "") << std::endl;
+                rank++;
+            }
+        }
+
+    protected:
+        std::shared_ptr<DFA::NeuralNetwork> network_;
+        std::shared_ptr<DFSL::HWConfig> hw_config_;
+        int simd_width_;
+        double scale_;
+        int num_threads_;
+
+        long base_runtime_ = 0;
+        double base_energy_ = 0;
+        std::vector<LayerBottleneck> layer_bottlenecks_;
+        std::vector<ResourceSensitivity> sensitivities_;
+
+    private:
+        class PerturbedConfig {
+        public:
+            std::string resource_;
+            long base_value_ = 0;
+            long scaled_value_ = 0;
+            std::shared_ptr<DFSL::HWConfig> hw_config_;
+        }; // End of class PerturbedConfig
+
+        // Scaled value of a resource; at least one unit different from the baseline, within the range of int
+        long ScaleValue(long value) {
+            long ret = static_cast<long>(std::llround(static_cast<double>(value) * scale_));
+            if(ret == value) {
+                ret += (scale_ >= 1.0) ? 1 : -1;
+            }
+            return std::max(std::min(ret, static_cast<long>(INT_MAX) - 1), 1L);
+        }
+
+        bool IsBounded(long value) {
+            return value > 0 && value < INT_MAX;
+        }
+
+        // Number of NoC levels the network uses: one more than the deepest cluster hierarchy
+        int GetNumNoCLevels() {
+            int ret = 1;
+            for(auto& layer : *network_) {
+                int num_cluster_directives = 0;
+                for(auto& directive : *layer->GetDataflow()) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        num_cluster_directives++;
+                    }
+                }
+                ret = std::max(ret, num_cluster_directives + 1);
+            }
+            return ret;
+        }
+
+        void AddPerturbedConfig(std::vector<PerturbedConfig>& perturbed_configs, std::string resource,
+                                long base_value, std::shared_ptr<DFSL::HWConfig> hw_config) {
+            PerturbedConfig perturbed_config;
+            perturbed_config.resource_ = resource;
+            perturbed_config.base_value_ = base_value;
+            perturbed_config.scaled_value_ = ScaleValue(base_value);
+            perturbed_config.hw_config_ = hw_config;
+            perturbed_configs.push_back(perturbed_config);
+        }
+
+        std::vector<PerturbedConfig> ConstructPerturbedConfigs() {
+            std::vector<PerturbedConfig> ret;
+
+            if(IsBounded(hw_config_->num_pes_)) {
+                auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                hw_config->num_pes_ = ScaleValue(hw_config_->num_pes_);
+                AddPerturbedConfig(ret, "PEs", hw_config_->num_pes_, hw_config);
+            }
+
+            // NoC levels are listed innermost (PE side) first
+            int num_noc_levels = GetNumNoCLevels();
+            for(int noc_lv = 0; noc_lv < num_noc_levels; noc_lv++) {
+                std::vector<int> noc_bws = hw_config_->noc_bws_;
+                if(noc_bws.empty()) {
+                    noc_bws.push_back(hw_config_->noc_bw_);
+                }
+                while(static_cast<int>(noc_bws.size()) < num_noc_levels) {
+                    noc_bws.push_back(noc_bws.back());
+                }
+                if(!IsBounded(noc_bws[noc_lv])) {
+                    continue;
+                }
+
+                auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                long base_value = noc_bws[noc_lv];
+                noc_bws[noc_lv] = ScaleValue(base_value);
+                hw_config->noc_bws_ = noc_bws;
+                std::string level_name = (noc_lv == 0) ? "innermost" : ((noc_lv == num_noc_levels - 1) ? "top" : "middle");
+                AddPerturbedConfig(ret, "NoC bandwidth (level " + std::to_string(noc_lv) + ", " + level_name + ")",
+                                   base_value, hw_config);
+            }
+
+            if(hw_config_->dram_config_ != nullptr) {
+                auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                hw_config->dram_config_ = std::make_shared<AHW::DRAMTimingConfig>(*hw_config_->dram_config_);
+                hw_config->dram_config_->bus_bw_ = ScaleValue(hw_config_->dram_config_->bus_bw_);
+                AddPerturbedConfig(ret, "DRAM bus bandwidth", hw_config_->dram_config_->bus_bw_, hw_config);
+            }
+            else if(IsBounded(hw_config_->off_chip_bw_)) {
+                auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                hw_config->off_chip_bw_ = ScaleValue(hw_config_->off_chip_bw_);
+                AddPerturbedConfig(ret, "Off-chip bandwidth", hw_config_->off_chip_bw_, hw_config);
+            }
+
+            if(hw_config_->buffer_levels_.empty()) {
+                if(IsBounded(hw_config_->l1_size_)) {
+                    auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                    hw_config->l1_size_ = ScaleValue(hw_config_->l1_size_);
+                    AddPerturbedConfig(ret, "L1 size", hw_config_->l1_size_, hw_config);
+                }
+                if(IsBounded(hw_config_->l2_size_)) {
+                    auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                    hw_config->l2_size_ = ScaleValue(hw_config_->l2_size_);
+                    AddPerturbedConfig(ret, "L2 size", hw_config_->l2_size_, hw_config);
+                }
+            }
+            else {
+                for(int level_idx = 0; level_idx < static_cast<int>(hw_config_->buffer_levels_.size()); level_idx++) {
+                    auto& buffer_level = hw_config_->buffer_levels_[level_idx];
+                    if(IsBounded(buffer_level.size_)) {
+                        auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                        hw_config->buffer_levels_[level_idx].size_ = ScaleValue(buffer_level.size_);
+                        AddPerturbedConfig(ret, buffer_level.name_ + " size", buffer_level.size_, hw_config);
+                    }
+                    if(IsBounded(buffer_level.bw_)) {
+                        auto hw_config = std::make_shared<DFSL::HWConfig>(*hw_config_);
+                        hw_config->buffer_levels_[level_idx].bw_ = ScaleValue(buffer_level.bw_);
+                        AddPerturbedConfig(ret, buffer_level.name_ + " bandwidth", buffer_level.bw_, hw_config);
+                    }
+                }
+            }
+
+            return ret;
+        }
+    }; // End of class BottleneckAnalysis
+}; // End of namespace maestro
+
+#endif
@@ -25,6 +25,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include <memory>
 #include <vector>
+#include <algorithm>
 #include "BASE_base-objects.hpp"
 
 #include "DFA_tensor.hpp"
@@ -34,6 +35,8 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include "DSE_hardware_modules.hpp"
 
 #include "AHW_noc-model.hpp"
+#include "AHW_offchip-memory-model.hpp"
+#include "AHW_buffer-level.hpp"
 
 
 
@@ -58,14 +61,14 @@ namespace maestro {
                 noc_multcast_(noc_multcast),
                 noc_latency_(noc_latency),
                 noc_bw_(noc_bw),
-                offchip_bw_(offchip_bw),
                 num_pes_file_(num_pes),
                 num_pes_(num_pes),
                 simd_width_(simd_width),
                 l1_byte_size_(l1_sram_byte_size),
                 l2_byte_size_(l1_sram_byte_size),
                 l1_size_(l1_sram_byte_size),
-                l2_size_(l2_sram_byte_size) {
+                l2_size_(l2_sram_byte_size),
+                offchip_bw_(offchip_bw) {
             network_= std::make_shared<DFA::NeuralNetwork>();
             tensors_ = std::make_shared<std::vector<std::shared_ptr<DFA::TensorTable>>>();
             nocs_ = std::make_shared<std::vector<std::shared_ptr<AHW::NetworkOnChipModel>>>();
@@ -75,6 +78,38 @@ namespace maestro {
                     (num_pes, simd_width, top_noc_bw, l1_sram_byte_size, l2_sram_byte_size);
         }
 
+        LayerHardwareView GetLayerHardwareView(LayerQuantizationType quantization_type) const {
+            return LayerHardwareView(num_pes_file_, l1_byte_size_, l2_byte_size_, quantization_type);
+        }
+
+        // DRAM timing model if the HW description gives one; a constant bandwidth of offchip_bw_ otherwise
+        std::shared_ptr<AHW::OffchipMemoryModel> GetOffchipMemoryModel() const {
+            if(dram_config_ != nullptr) {
+                return std::make_shared<AHW::DRAMModel>(*dram_config_);
+            }
+            return std::make_shared<AHW::ConstantBandwidthModel>(offchip_bw_);
+        }
+
+        // Topologies are listed innermost cluster level first, like the NoCs; outer levels repeat the last one
+        AHW::NoCTopology GetNoCTopology(int noc_lv) const {
+            if(noc_topologies_.empty()) {
+                return AHW::NoCTopology::Default;
+            }
+            return noc_topologies_[std::min(noc_lv, static_cast<int>(noc_topologies_.size()) - 1)];
+        }
+
+        // Cycles the buffer at a cluster boundary (see AHW::GetBufferLevelIdx) needs to move num_elements
+        long GetBufferPortDelay(int boundary, int num_cluster_lvs, long num_elements) const {
+            if(buffer_levels_.empty()) {
+                return 0;
+            }
+            auto& buffer_level = buffer_levels_[AHW::GetBufferLevelIdx(boundary, num_cluster_lvs, buffer_levels_.size())];
+            if(buffer_level.bw_ <= 0) {
+                return 0;
+            }
+            return (num_elements + buffer_level.bw_ - 1) / buffer_level.bw_;
+        }
+
         std::string dfsl_file_name_;
         std::string hw_file_name_;
 
@@ -92,14 +127,19 @@ namespace maestro {
         std::shared_ptr<std::vector<int>> noc_latency_;
         std::shared_ptr<std::vector<int>> noc_bw_;
 
-        int num_pes_;
+        // Values given by the HW description; per-layer values come from GetLayerHardwareView
         int num_pes_file_;
+        int num_pes_;
         int simd_width_;
         int l1_byte_size_;
         int l2_byte_size_;
         int l1_size_;
         int l2_size_;
         int offchip_bw_;
+        std::shared_ptr<AHW::DRAMTimingConfig> dram_config_ = nullptr;
+        std::vector<AHW::NoCTopology> noc_topologies_;
+        // Outermost level first; empty: the legacy L2/L1 pair
+        std::vector<AHW::BufferLevelConfig> buffer_levels_;
     }; // End of class Configuration
 }; // End of namespace maestro
 
@@ -0,0 +1,339 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_API_FUSION_ANALYSIS_HPP_
+#define MAESTRO_API_FUSION_ANALYSIS_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_constants.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_tensor.hpp"
+#include "DFSL_syntax_tokens.hpp"
+#include "DSE_design_point.hpp"
+
+#include "API_user-interface-v2.hpp"
+
+namespace maestro {
+
+    // Consecutive layers [first_layer_, last_layer_] whose intermediate activations stay in L2
+    class FusionGroup {
+    public:
+        int first_layer_ = 0;
+        int last_layer_ = 0;
+
+        long runtime_ = 0;
+        double energy_ = 0;
+        long unfused_runtime_ = 0;
+        double unfused_energy_ = 0;
+    }; // End of class FusionGroup
+
+    /*
+     * Fusion-aware analysis of a network whose layers run back to back on one accelerator. A layer may
+     * keep its output activation in L2 for the next layer if the next layer consumes it as is (same
+     * batch and channels; spatial sizes equal up to the zero padding of the two layers) and, for every layer of
+     * the group, the resident activations plus the layer's own L2 requirement fit in L2. Fused layers do
+     * not move those activations from/to off-chip memory, which removes the off-chip delay and the L2
+     * fill/drain accesses. The L2 requirement of a layer is the unfused one, so the check is conservative.
+     * A layer whose own working set exceeds L2 forms a group by itself.
+     */
+    class FusionAnalysis : public MAESTROClass {
+    public:
+        FusionAnalysis(std::shared_ptr<APIV2> api) :
+                MAESTROClass("FusionAnalysis"),
+                api_(api) {
+            auto configuration = api_->GetConfiguration();
+            network_ = configuration->network_;
+            l2_capacity_bits_ = static_cast<long>(configuration->l2_byte_size_) * 8;
+
+            int num_layers = network_->GetNumLayers();
+            layer_costs_.resize(num_layers);
+            for(int layer_id = 0; layer_id < num_layers - 1; layer_id++) {
+                intermediate_bits_.push_back(GetIntermediateBits(layer_id));
+            }
+        }
+
+        // Grows each group along the layer chain as long as the group stays fusible
+        std::vector<FusionGroup> FindFusionChains() {
+            std::vector<FusionGroup> ret;
+            int num_layers = network_->GetNumLayers();
+
+            int first_layer = 0;
+            while(first_layer < num_layers) {
+                int last_layer = first_layer;
+                while(last_layer + 1 < num_layers && IsFusible(first_layer, last_layer + 1)) {
+                    last_layer++;
+                }
+                ret.push_back(AnalyzeGroup(first_layer, last_layer));
+                first_layer = last_layer + 1;
+            }
+
+            return ret;
+        }
+
+        // Partitions the network into the fusible groups with the lowest end-to-end runtime (ties: lower energy)
+        std::vector<FusionGroup> SearchFusionGroups() {
+            int num_layers = network_->GetNumLayers();
+
+            // best_groups[i]: best partition of the first i layers
+            std::vector<long> best_runtime(num_layers + 1, std::numeric_limits<long>::max());
+            std::vector<double> best_energy(num_layers + 1, 0);
+            std::vector<FusionGroup> last_group(num_layers + 1);
+            best_runtime[0] = 0;
+
+            for(int last_layer = 0; last_layer < num_layers; last_layer++) {
+                for(int first_layer = last_layer; first_layer >= 0; first_layer--) {
+                    if(!IsFusible(first_layer, last_layer)) {
+                        // Longer groups contain this one
+                        break;
+                    }
+                    if(best_runtime[first_layer] == std::numeric_limits<long>::max()) {
+                        continue;
+                    }
+                    auto group = AnalyzeGroup(first_layer, last_layer);
+                    long runtime = best_runtime[first_layer] + group.runtime_;
+                    double energy = best_energy[first_layer] + group.energy_;
+                    if(runtime < best_runtime[last_layer + 1]
+                       || (runtime == best_runtime[last_layer + 1] && energy < best_energy[last_layer + 1])) {
+                        best_runtime[last_layer + 1] = runtime;
+                        best_energy[last_layer + 1] = energy;
+                        last_group[last_layer + 1] = group;
+                    }
+                }
+            }
+
+            std::vector<FusionGroup> ret;
+            for(int num_covered = num_layers; num_covered > 0; num_covered = last_group[num_covered].first_layer_) {
+                ret.push_back(last_group[num_covered]);
+            }
+            std::reverse(ret.begin(), ret.end());
+            return ret;
+        }
+
+        void PrintFusionGroups(std::vector<FusionGroup>& groups) {
+            long total_runtime = 0;
+            long total_unfused_runtime = 0;
+            double total_energy = 0;
+            double total_unfused_energy = 0;
+
+            std::cout << "Fusion group, Layers, Runtime (Cycles), Energy (nJ), Unfused runtime (Cycles), Unfused energy (nJ)" << std::endl;
+            int group_id = 0;
+            for(auto& group : groups) {
+                std::string layer_names;
+                for(int layer_id = group.first_layer_; layer_id <= group.last_layer_; layer_id++) {
+                    layer_names += (layer_id == group.first_layer_ ? "" : " -> ") + network_->at(layer_id)->GetName();
+                }
+                std::cout << group_id << ", " << layer_names << ", " << group.runtime_ << ", " << group.energy_ << ", "
+                          << group.unfused_runtime_ << ", " << group.unfused_energy_ << std::endl;
+
+                total_runtime += group.runtime_;
+                total_unfused_runtime += group.unfused_runtime_;
+                total_energy += group.energy_;
+                total_unfused_energy += group.unfused_energy_;
+                group_id++;
+            }
+
+            std::cout << "End-to-end runtime: " << total_runtime << " cycles (unfused: " << total_unfused_runtime << " cycles)" << std::endl;
+            std::cout << "End-to-end energy: " << total_energy << " nJ (unfused: " << total_unfused_energy << " nJ)" << std::endl;
+        }
+
+    protected:
+        std::shared_ptr<APIV2> api_;
+        std::shared_ptr<DFA::NeuralNetwork> network_;
+        long l2_capacity_bits_ = 0;
+
+        // Per layer, indexed by (input in L2) + 2 * (output in L2); analyzed on demand
+        std::vector<std::array<std::shared_ptr<DSE::DesignPoint>, 4>> layer_costs_;
+        // Per edge (layer_id -> layer_id + 1), the L2 footprint of the activation passed on; -1 if not fusible
+        std::vector<long> intermediate_bits_;
+
+    private:
+
+        // Activation tensor of a layer, as {batch, channels, height, width}
+        class ActivationShape {
+        public:
+            long batch_ = 1;
+            long channels_ = 1;
+            long height_ = 1;
+            long width_ = 1;
+            bool is_spatial_ = false;
+
+            long GetNumElements() {
+                return batch_ * channels_ * height_ * width_;
+            }
+        }; // End of class ActivationShape
+
+        std::shared_ptr<DSE::DesignPoint> GetLayerCost(int layer_id, bool input_in_l2, bool output_in_l2) {
+            auto& layer_cost = layer_costs_[layer_id][(input_in_l2 ? 1 : 0) + (output_in_l2 ? 2 : 0)];
+            if(layer_cost == nullptr) {
+                layer_cost = api_->AnalyzeLayer(layer_id, input_in_l2, output_in_l2);
+            }
+            return layer_cost;
+        }
+
+        // A single layer always runs unfused, even if its own working set exceeds L2
+        bool IsFusible(int first_layer, int last_layer) {
+            if(first_layer == last_layer) {
+                return true;
+            }
+
+            for(int layer_id = first_layer; layer_id <= last_layer; layer_id++) {
+                bool input_in_l2 = layer_id > first_layer;
+                bool output_in_l2 = layer_id < last_layer;
+                if(output_in_l2 && intermediate_bits_[layer_id] < 0) {
+                    return false;
+                }
+
+                auto layer = network_->at(layer_id);
+                long resident_bits = (input_in_l2 ? intermediate_bits_[layer_id - 1] : 0)
+                                     + (output_in_l2 ? intermediate_bits_[layer_id] : 0);
+                long working_bits = static_cast<long>(GetLayerCost(layer_id, false, false)->l2_sram_sz)
+                                    * static_cast<long>(getBitSize(layer->getQuantization()));
+                if(resident_bits + working_bits > l2_capacity_bits_) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        FusionGroup AnalyzeGroup(int first_layer, int last_layer) {
+            FusionGroup ret;
+            ret.first_layer_ = first_layer;
+            ret.last_layer_ = last_layer;
+
+            for(int layer_id = first_layer; layer_id <= last_layer; layer_id++) {
+                auto fused_cost = GetLayerCost(layer_id, layer_id > first_layer, layer_id < last_layer);
+                auto unfused_cost = GetLayerCost(layer_id, false, false);
+                ret.runtime_ += fused_cost->runtime_;
+                ret.energy_ += fused_cost->energy_;
+                ret.unfused_runtime_ += unfused_cost->runtime_;
+                ret.unfused_energy_ += unfused_cost->energy_;
+            }
+
+            return ret;
+        }
+
+        long GetIntermediateBits(int producer_id) {
+            auto producer = network_->at(producer_id);
+            auto consumer = network_->at(producer_id + 1);
+            auto output_shape = GetActivationShape(producer, true);
+            auto input_shape = GetActivationShape(consumer, false);
+
+            bool has_einsum = producer->GetLayerType() == LayerType::EINSUM || consumer->GetLayerType() == LayerType::EINSUM;
+            if(has_einsum || output_shape.is_spatial_ != input_shape.is_spatial_) {
+                // Flattened between a convolution and a GEMM; einsum indices do not follow either layout
+                if(output_shape.GetNumElements() != input_shape.GetNumElements()) {
+                    return -1;
+                }
+            }
+            else {
+                // Mappings often leave the zero padding of either layer out of the dimensions
+                long padding = 0;
+                if(input_shape.is_spatial_) {
+                    padding = GetDimSize(producer, DFSL::layer_dim_weight_height_) - 1
+                              + GetDimSize(consumer, DFSL::layer_dim_weight_height_) - 1;
+                }
+                if(output_shape.batch_ != input_shape.batch_ || output_shape.channels_ != input_shape.channels_
+                   || std::abs(input_shape.height_ - output_shape.height_) > padding
+                   || std::abs(input_shape.width_ - output_shape.width_) > padding) {
+                    return -1;
+                }
+            }
+
+            long bit_size = std::max(getBitSize(producer->getQuantization()), getBitSize(consumer->getQuantization()));
+            return std::max(output_shape.GetNumElements(), input_shape.GetNumElements()) * bit_size;
+        }
+
+        ActivationShape GetActivationShape(std::shared_ptr<DFA::Layer> layer, bool is_output) {
+            ActivationShape ret;
+            auto layer_type = layer->GetLayerType();
+
+            if(layer_type == LayerType::GEMM) {
+                ret.batch_ = GetDimSize(layer, "M");
+                ret.channels_ = GetDimSize(layer, is_output ? "N" : "K");
+                return ret;
+            }
+
+            if(layer_type == LayerType::EINSUM) {
+                auto sliding_windows = DFA::GetSlidingWindows(layer);
+                for(auto& dim : DFA::GetCoupledVariables(layer, is_output ? DataClass::Output : DataClass::Input)) {
+                    long size = GetDimSize(layer, dim);
+                    if(is_output && sliding_windows.count(dim)) {
+                        size = std::max(size - GetDimSize(layer, sliding_windows[dim]) + 1, 1L);
+                    }
+                    ret.batch_ *= size;
+                }
+                return ret;
+            }
+
+            ret.is_spatial_ = true;
+            ret.batch_ = GetDimSize(layer, DFSL::layer_dim_input_batch_);
+            long groups = GetDimSize(layer, DFSL::layer_dim_group_);
+            if(layer_type == LayerType::DSCONV || !is_output) {
+                ret.channels_ = groups * GetDimSize(layer, DFSL::layer_dim_input_channel_);
+            }
+            else {
+                ret.channels_ = groups * GetDimSize(layer, DFSL::layer_dim_output_channel_);
+            }
+
+            ret.height_ = GetSpatialSize(layer, DFSL::layer_dim_input_height_, DFSL::layer_dim_output_height_,
+                                         DFSL::layer_dim_weight_height_, is_output);
+            ret.width_ = GetSpatialSize(layer, DFSL::layer_dim_input_width_, DFSL::layer_dim_output_width_,
+                                        DFSL::layer_dim_weight_width_, is_output);
+            return ret;
+        }
+
+        // Input or output size along one spatial dimension; layers describe either the input or the output size
+        long GetSpatialSize(std::shared_ptr<DFA::Layer> layer, std::string input_dim, std::string output_dim,
+                            std::string filter_dim, bool is_output) {
+            long filter_size = GetDimSize(layer, filter_dim);
+            for(auto& dim : *layer->GetDimensions()) {
+                long stride = dim->GetOuterStride();
+                if(dim->GetName() == input_dim) {
+                    return is_output ? (dim->GetSize() - filter_size) / stride + 1 : dim->GetSize();
+                }
+                if(dim->GetName() == output_dim) {
+                    return is_output ? dim->GetSize() : (dim->GetSize() - 1) * stride + filter_size;
+                }
+            }
+            return 1;
+        }
+
+        // Size of a layer dimension; dimensions the layer does not describe have size 1
+        long GetDimSize(std::shared_ptr<DFA::Layer> layer, std::string dim_name) {
+            long size = layer->GetSize(dim_name);
+            return (size < 0) ? 1 : size;
+        }
+    }; // End of class FusionAnalysis
+
+}; // End of namespace maestro
+
+#endif
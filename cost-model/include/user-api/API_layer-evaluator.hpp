@@ -0,0 +1,133 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_API_LAYER_EVALUATOR_HPP_
+#define MAESTRO_API_LAYER_EVALUATOR_HPP_
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_directive-table.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_hw-parser.hpp"
+
+#include "CA_cost-analysis-results.hpp"
+
+#include "DSE_design_point.hpp"
+
+#include "API_configuration.hpp"
+#include "API_user-interface-v2.hpp"
+
+namespace maestro {
+
+    /*
+     * Analyzes single layers on a fixed hardware point without going through the DFSL/HW files.
+     * Each call works on its own configuration and its own copy of the layer, so independent
+     * evaluations can run concurrently (e.g., on a TL::ThreadPool).
+     */
+    class LayerEvaluator : public MAESTROClass {
+    public:
+        const int num_noc_levels_ = 4;
+
+        LayerEvaluator(std::shared_ptr<DFSL::HWConfig> hw_config, int simd_width = 1) :
+                MAESTROClass("LayerEvaluator"),
+                hw_config_(hw_config),
+                simd_width_(simd_width) {
+        }
+
+        std::shared_ptr<DFSL::HWConfig> GetHWConfig() {
+            return hw_config_;
+        }
+
+        int GetSIMDWidth() {
+            return simd_width_;
+        }
+
+        // Keeps the iteration cases of the exact analysis in the cluster results (CA::CostAnalysisResults::GetCaseRecords)
+        void SetTimelineRecording(bool record_timeline) {
+            record_timeline_ = record_timeline;
+        }
+
+        // Builds the same configuration APIV2 would get from a HW file with the given parameters
+        std::shared_ptr<ConfigurationV2> ConstructConfiguration() {
+            auto noc_bw = std::make_shared<std::vector<int>>(num_noc_levels_, hw_config_->noc_bw_);
+            if(!hw_config_->noc_bws_.empty()) {
+                auto& noc_bws = hw_config_->noc_bws_;
+                noc_bw->assign(std::max(static_cast<int>(noc_bws.size()), num_noc_levels_), noc_bws.back());
+                std::copy(noc_bws.begin(), noc_bws.end(), noc_bw->begin());
+            }
+            auto noc_latency = std::make_shared<std::vector<int>>(num_noc_levels_, hw_config_->noc_hops_);
+            auto noc_multcast = std::make_shared<std::vector<bool>>(num_noc_levels_, hw_config_->noc_multicast_);
+
+            auto config = std::make_shared<ConfigurationV2>(
+                    "", "", noc_bw, noc_latency, noc_multcast,
+                    hw_config_->num_pes_, simd_width_, hw_config_->noc_bw_,
+                    hw_config_->l1_size_, hw_config_->l2_size_, hw_config_->off_chip_bw_);
+            config->l2_byte_size_ = hw_config_->l2_size_;
+            config->dram_config_ = hw_config_->dram_config_;
+            config->noc_topologies_ = hw_config_->noc_topologies_;
+            config->buffer_levels_ = hw_config_->buffer_levels_;
+
+            return config;
+        }
+
+        /*
+         * Analyzes the layer with the given dataflow (or the layer's own dataflow if none is given).
+         * The per-cluster results (innermost cluster first) are stored in cluster_results if requested.
+         */
+        std::shared_ptr<DSE::DesignPoint> Evaluate(
+                std::shared_ptr<DFA::Layer> layer,
+                std::shared_ptr<DFA::DirectiveTable> dataflow = nullptr,
+                std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>>* cluster_results = nullptr) {
+            auto target_layer = DFA::CloneLayer(layer);
+            if(dataflow != nullptr) {
+                target_layer->SetDataflow(dataflow->Clone());
+            }
+
+            auto network = std::make_shared<DFA::NeuralNetwork>(layer->GetName());
+            network->AddLayer(target_layer);
+
+            auto api = std::make_shared<APIV2>(ConstructConfiguration(), network);
+            api->SetTimelineRecording(record_timeline_);
+            auto res = api->AnalyzeNeuralNetwork(false, false, false);
+
+            if(cluster_results != nullptr) {
+                *cluster_results = res->at(0);
+            }
+
+            return api->SummarizeLayer(0, res->at(0));
+        }
+
+    protected:
+        std::shared_ptr<DFSL::HWConfig> hw_config_;
+        int simd_width_;
+        bool record_timeline_ = false;
+    }; // End of class LayerEvaluator
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,531 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_API_MULTI_TENANT_HPP_
+#define MAESTRO_API_MULTI_TENANT_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_base-objects.hpp"
+#include "TL_thread-pool.hpp"
+
+#include "DFA_directives.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_hw-parser.hpp"
+
+#include "CA_cost-analysis-results.hpp"
+
+#include "DSE_design_point.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+
+    /*
+     * Slowdown: minimize the largest slowdown of a tenant over running alone on the whole accelerator
+     * Throughput: maximize the sum of the inferences per cycle of all the tenants
+     */
+    enum class TenantObjective {Slowdown, Throughput};
+
+    // One network running on its partition of a shared accelerator
+    class TenantResult {
+    public:
+        std::string name_;
+        int num_pes_ = 0;
+        int l2_size_ = 0;
+        // Fraction of the off-chip bandwidth the tenant gets; 1: not limited by the other tenants
+        double bw_share_ = 1.0;
+        // Fraction of the time the tenant keeps the off-chip channel busy alone on its partition
+        double offchip_utilization_ = 0;
+
+        // Cycles of one inference alone on the whole accelerator, alone on the partition, and co-located
+        long alone_latency_ = 0;
+        long partition_latency_ = 0;
+        long latency_ = 0;
+        double energy_ = 0;
+
+        double GetSlowdown() {
+            return static_cast<double>(latency_) / std::max(alone_latency_, 1L);
+        }
+
+        double GetThroughput() {
+            return 1.0 / std::max(latency_, 1L);
+        }
+    }; // End of class TenantResult
+
+    /*
+     * Co-locates several networks on one accelerator whose PE array is spatially partitioned among them;
+     * each tenant runs its own network back to back on its partition. The L2 capacity (the outermost
+     * buffer level, if declared) is split in proportion to the PEs, while the NoCs and L1 buffers are
+     * partitioned with the PE array. The off-chip bandwidth is either split statically or shared: the
+     * off-chip channel time of every tenant alone on its partition gives its bandwidth demand, and if
+     * the demands exceed the channel the bandwidth is divided max-min fairly and the tenants that do not
+     * get their demand are analyzed again with their share (taking at least their off-chip time divided
+     * by the share). The PE split is either given or searched in
+     * steps of pe_tick PEs, ranking the candidates with the contention estimate max(runtime, off-chip
+     * time / bandwidth share); the chosen split is then analyzed. A partition has at least the PEs the
+     * clusters of its mappings take.
+     */
+    class MultiTenantAnalysis : public MAESTROClass {
+    public:
+        MultiTenantAnalysis(std::vector<std::shared_ptr<DFA::NeuralNetwork>> networks,
+                            std::shared_ptr<DFSL::HWConfig> hw_config,
+                            int simd_width,
+                            TenantObjective objective = TenantObjective::Slowdown,
+                            int num_threads = 0) :
+                MAESTROClass("MultiTenantAnalysis"),
+                networks_(networks),
+                hw_config_(hw_config),
+                simd_width_(simd_width),
+                objective_(objective),
+                num_threads_(num_threads) {
+        }
+
+        // PEs of each tenant; empty: searched
+        void SetPESplit(std::vector<int> pe_split) {
+            pe_split_ = pe_split;
+        }
+
+        // Step of the searched PE split; 0: 1/16 of the PEs
+        void SetPETick(int pe_tick) {
+            pe_tick_ = pe_tick;
+        }
+
+        // Fraction of the off-chip bandwidth reserved for each tenant; empty: shared by all the tenants
+        void SetBandwidthSplit(std::vector<double> bw_split) {
+            bw_split_ = bw_split;
+        }
+
+        int GetNumCandidates() {
+            return num_candidates_;
+        }
+
+        std::vector<TenantResult>& GetResults() {
+            return results_;
+        }
+
+        bool Run() {
+            int num_tenants = networks_.size();
+            int num_pes = hw_config_->num_pes_;
+            results_.clear();
+            num_candidates_ = 0;
+
+            if(num_tenants == 0) {
+                std::cout << "[MultiTenantAnalysis] No tenant networks" << std::endl;
+                return false;
+            }
+            if(!bw_split_.empty() && static_cast<int>(bw_split_.size()) != num_tenants) {
+                std::cout << "[MultiTenantAnalysis] The off-chip bandwidth split has " << bw_split_.size()
+                          << " entries for " << num_tenants << " tenants" << std::endl;
+                return false;
+            }
+            if(!bw_split_.empty() && std::accumulate(bw_split_.begin(), bw_split_.end(), 0.0) > 1.0 + 1e-9) {
+                std::cout << "[MultiTenantAnalysis] The off-chip bandwidth split exceeds the whole bandwidth" << std::endl;
+                return false;
+            }
+
+            std::vector<int> min_pes;
+            for(auto& network : networks_) {
+                min_pes.push_back(GetMinNumPEs(network));
+            }
+
+            // PE counts each tenant may get
+            std::vector<std::vector<int>> pe_candidates(num_tenants);
+            if(!pe_split_.empty()) {
+                if(static_cast<int>(pe_split_.size()) != num_tenants) {
+                    std::cout << "[MultiTenantAnalysis] The PE split has " << pe_split_.size() << " entries for "
+                              << num_tenants << " tenants" << std::endl;
+                    return false;
+                }
+                if(std::accumulate(pe_split_.begin(), pe_split_.end(), 0) > num_pes) {
+                    std::cout << "[MultiTenantAnalysis] The PE split exceeds the " << num_pes << " PEs" << std::endl;
+                    return false;
+                }
+                for(int tenant = 0; tenant < num_tenants; tenant++) {
+                    if(pe_split_[tenant] < min_pes[tenant]) {
+                        std::cout << "[MultiTenantAnalysis] Tenant " << networks_[tenant]->GetName() << " needs at least "
+                                  << min_pes[tenant] << " PEs for its clusters" << std::endl;
+                        return false;
+                    }
+                    pe_candidates[tenant].push_back(pe_split_[tenant]);
+                }
+            }
+            else {
+                int pe_tick = (pe_tick_ > 0) ? pe_tick_ : std::max(num_pes / 16, 1);
+                std::vector<int> first_candidates;
+                for(int tenant = 0; tenant < num_tenants; tenant++) {
+                    first_candidates.push_back(CeilDiv(std::max(min_pes[tenant], 1), pe_tick) * pe_tick);
+                }
+                int num_reserved_pes = std::accumulate(first_candidates.begin(), first_candidates.end(), 0);
+                for(int tenant = 0; tenant < num_tenants; tenant++) {
+                    int max_pes = num_pes - (num_reserved_pes - first_candidates[tenant]);
+                    for(int tenant_pes = first_candidates[tenant]; tenant_pes <= max_pes; tenant_pes += pe_tick) {
+                        pe_candidates[tenant].push_back(tenant_pes);
+                    }
+                    if(pe_candidates[tenant].empty()) {
+                        std::cout << "[MultiTenantAnalysis] " << num_pes << " PEs in steps of " << pe_tick
+                                  << " cannot hold the clusters of all the tenants" << std::endl;
+                        return false;
+                    }
+                }
+            }
+
+            // Every tenant alone on the whole accelerator, then on each candidate partition
+            std::vector<PartitionJob> jobs;
+            for(int tenant = 0; tenant < num_tenants; tenant++) {
+                jobs.push_back(PartitionJob(tenant, num_pes, 1.0, false));
+                for(auto tenant_pes : pe_candidates[tenant]) {
+                    jobs.push_back(PartitionJob(tenant, tenant_pes, GetReservedShare(tenant), true));
+                }
+            }
+            auto costs = EvaluatePartitions(jobs);
+
+            std::vector<NetworkCost> alone_costs(num_tenants);
+            std::vector<std::vector<NetworkCost>> partition_costs(num_tenants);
+            for(int job_id = 0; job_id < jobs.size(); job_id++) {
+                if(jobs[job_id].is_partition_) {
+                    partition_costs[jobs[job_id].tenant_].push_back(costs[job_id]);
+                }
+                else {
+                    alone_costs[jobs[job_id].tenant_] = costs[job_id];
+                }
+            }
+
+            // Choose the split
+            std::vector<int> best_choice;
+            double best_cost = 0;
+            std::vector<int> choice(num_tenants, 0);
+            SearchSplit(0, 0, choice, pe_candidates, partition_costs, alone_costs, best_choice, best_cost);
+            if(best_choice.empty()) {
+                std::cout << "[MultiTenantAnalysis] No PE split fits the " << num_pes << " PEs" << std::endl;
+                return false;
+            }
+
+            std::vector<NetworkCost> chosen_costs;
+            for(int tenant = 0; tenant < num_tenants; tenant++) {
+                chosen_costs.push_back(partition_costs[tenant][best_choice[tenant]]);
+            }
+            auto bw_shares = GetBandwidthShares(chosen_costs);
+
+            // Tenants throttled by the shared bandwidth run again with their share
+            std::vector<PartitionJob> throttled_jobs;
+            for(int tenant = 0; tenant < num_tenants; tenant++) {
+                if(bw_split_.empty() && bw_shares[tenant] < 1.0) {
+                    throttled_jobs.push_back(PartitionJob(tenant, pe_candidates[tenant][best_choice[tenant]], bw_shares[tenant], true));
+                }
+            }
+            auto throttled_costs = EvaluatePartitions(throttled_jobs);
+            auto estimated_latencies = EstimateLatencies(chosen_costs);
+
+            for(int tenant = 0; tenant < num_tenants; tenant++) {
+                TenantResult result;
+                result.name_ = networks_[tenant]->GetName();
+                result.num_pes_ = pe_candidates[tenant][best_choice[tenant]];
+                result.l2_size_ = ConstructPartitionConfig(result.num_pes_, 1.0)->l2_size_;
+                result.bw_share_ = bw_shares[tenant];
+                result.offchip_utilization_ = chosen_costs[tenant].GetOffchipUtilization();
+                result.alone_latency_ = alone_costs[tenant].runtime_;
+                result.partition_latency_ = chosen_costs[tenant].runtime_;
+                result.latency_ = chosen_costs[tenant].runtime_;
+                result.energy_ = chosen_costs[tenant].energy_;
+                results_.push_back(result);
+            }
+            for(int job_id = 0; job_id < throttled_jobs.size(); job_id++) {
+                auto& result = results_[throttled_jobs[job_id].tenant_];
+                // Bandwidths are integers; a share they cannot express still bounds the tenant's channel time
+                result.latency_ = std::max(throttled_costs[job_id].runtime_, estimated_latencies[throttled_jobs[job_id].tenant_]);
+                result.energy_ = throttled_costs[job_id].energy_;
+            }
+
+            return true;
+        }
+
+        void PrintResults() {
+            std::cout << "Tenant, Network, PEs, L2 size, Off-chip bandwidth share (%), Off-chip utilization on the partition (%), "
+                      << "Latency alone on the accelerator (Cycles), Latency alone on the partition (Cycles), "
+                      << "Co-located latency (Cycles), Slowdown, Throughput (inferences/cycle), Energy per inference (nJ)" << std::endl;
+
+            double throughput = 0;
+            double max_slowdown = 0;
+            int tenant = 0;
+            for(auto& result : results_) {
+                std::cout << tenant << ", " << result.name_ << ", " << result.num_pes_ << ", " << result.l2_size_ << ", "
+                          << 100.0 * result.bw_share_ << ", " << 100.0 * result.offchip_utilization_ << ", "
+                          << result.alone_latency_ << ", " << result.partition_latency_ << ", " << result.latency_ << ", "
+                          << result.GetSlowdown() << ", " << result.GetThroughput() << ", " << result.energy_ << std::endl;
+                throughput += result.GetThroughput();
+                max_slowdown = std::max(max_slowdown, result.GetSlowdown());
+                tenant++;
+            }
+
+            if(pe_split_.empty()) {
+                std::cout << "PE split searched over " << num_candidates_ << " candidates ("
+                          << ((objective_ == TenantObjective::Slowdown) ? "minimum slowdown" : "maximum throughput") << ")" << std::endl;
+            }
+            if(bw_split_.empty()) {
+                std::cout << "Off-chip bandwidth demand: " << 100.0 * GetTotalDemand() << "% of the shared channel"
+                          << ((GetTotalDemand() > 1.0) ? " (contended)" : "") << std::endl;
+            }
+            std::cout << "Aggregate throughput: " << throughput << " inferences/cycle" << std::endl;
+            std::cout << "Largest slowdown: " << max_slowdown << std::endl;
+        }
+
+    protected:
+        std::vector<std::shared_ptr<DFA::NeuralNetwork>> networks_;
+        std::shared_ptr<DFSL::HWConfig> hw_config_;
+        int simd_width_;
+        TenantObjective objective_;
+        int num_threads_;
+
+        std::vector<int> pe_split_;
+        int pe_tick_ = 0;
+        std::vector<double> bw_split_;
+
+        int num_candidates_ = 0;
+        std::vector<TenantResult> results_;
+
+    private:
+        // Sum over the layers of a network on one partition
+        class NetworkCost {
+        public:
+            long runtime_ = 0;
+            double energy_ = 0;
+            // Cycles the off-chip channel is busy with the network's transfers
+            long offchip_cycles_ = 0;
+
+            double GetOffchipUtilization() {
+                return std::min(static_cast<double>(offchip_cycles_) / std::max(runtime_, 1L), 1.0);
+            }
+        }; // End of class NetworkCost
+
+        class PartitionJob {
+        public:
+            PartitionJob(int tenant, int num_pes, double bw_share, bool is_partition) :
+                    tenant_(tenant), num_pes_(num_pes), bw_share_(bw_share), is_partition_(is_partition) {
+            }
+
+            int tenant_;
+            int num_pes_;
+            double bw_share_;
+            bool is_partition_;
+        }; // End of class PartitionJob
+
+        static int CeilDiv(int a, int b) {
+            return (a + b - 1) / std::max(b, 1);
+        }
+
+        static int ScaleResource(int value, double fraction) {
+            if(value <= 0 || value >= INT_MAX) {
+                return value;
+            }
+            return static_cast<int>(std::max(std::round(value * fraction), 1.0));
+        }
+
+        // PEs the clusters of the network's mappings take
+        static int GetMinNumPEs(std::shared_ptr<DFA::NeuralNetwork> network) {
+            int ret = 1;
+            for(auto layer : *network) {
+                if(layer->GetDataflow() == nullptr) {
+                    continue;
+                }
+                int num_inner_pes = 1;
+                for(auto& directive : *layer->GetDataflow()) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        num_inner_pes *= std::max(directive->GetSize(), 1);
+                    }
+                }
+                ret = std::max(ret, num_inner_pes);
+            }
+            return ret;
+        }
+
+        double GetReservedShare(int tenant) {
+            return bw_split_.empty() ? 1.0 : bw_split_[tenant];
+        }
+
+        double GetTotalDemand() {
+            double ret = 0;
+            for(auto& result : results_) {
+                ret += result.offchip_utilization_;
+            }
+            return ret;
+        }
+
+        std::shared_ptr<DFSL::HWConfig> ConstructPartitionConfig(int num_pes, double bw_share) {
+            auto ret = std::make_shared<DFSL::HWConfig>(*hw_config_);
+            double pe_share = static_cast<double>(num_pes) / std::max(hw_config_->num_pes_, 1);
+            ret->num_pes_ = num_pes;
+            ret->l2_size_ = ScaleResource(hw_config_->l2_size_, pe_share);
+            if(!ret->buffer_levels_.empty() && ret->buffer_levels_.front().size_ > 0) {
+                ret->buffer_levels_.front().size_ = std::max(static_cast<long>(std::round(ret->buffer_levels_.front().size_ * pe_share)), 1L);
+            }
+
+            if(hw_config_->dram_config_ != nullptr) {
+                ret->dram_config_ = std::make_shared<AHW::DRAMTimingConfig>(*hw_config_->dram_config_);
+                ret->dram_config_->bus_bw_ = ScaleResource(hw_config_->dram_config_->bus_bw_, bw_share);
+            }
+            else {
+                ret->off_chip_bw_ = ScaleResource(hw_config_->off_chip_bw_, bw_share);
+            }
+            return ret;
+        }
+
+        // Analyzes all the layers of every job's network on the job's partition as one batch
+        std::vector<NetworkCost> EvaluatePartitions(std::vector<PartitionJob>& jobs) {
+            std::vector<std::shared_ptr<LayerEvaluator>> evaluators;
+            std::vector<std::pair<int, int>> layer_jobs;
+            for(int job_id = 0; job_id < jobs.size(); job_id++) {
+                auto evaluator = std::make_shared<LayerEvaluator>(ConstructPartitionConfig(jobs[job_id].num_pes_, jobs[job_id].bw_share_), simd_width_);
+                evaluator->SetTimelineRecording(true);
+                evaluators.push_back(evaluator);
+                for(int layer_id = 0; layer_id < networks_[jobs[job_id].tenant_]->GetNumLayers(); layer_id++) {
+                    layer_jobs.push_back(std::make_pair(job_id, layer_id));
+                }
+            }
+
+            std::vector<NetworkCost> layer_costs(layer_jobs.size());
+            TL::ThreadPool thread_pool(num_threads_);
+            thread_pool.ParallelFor(layer_jobs.size(), [&](int layer_job_id) {
+                BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                int job_id = layer_jobs[layer_job_id].first;
+                auto layer = networks_[jobs[job_id].tenant_]->at(layer_jobs[layer_job_id].second);
+
+                std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> cluster_results;
+                auto design_point = evaluators[job_id]->Evaluate(layer, nullptr, &cluster_results);
+
+                auto& cost = layer_costs[layer_job_id];
+                cost.runtime_ = design_point->runtime_;
+                cost.energy_ = design_point->energy_;
+                for(auto& case_record : cluster_results->back()->GetCaseRecords()) {
+                    cost.offchip_cycles_ += case_record.num_occurrences_
+                                            * std::max(case_record.offchip_ingress_delay_, case_record.offchip_egress_delay_);
+                }
+            });
+
+            std::vector<NetworkCost> ret(jobs.size());
+            for(int layer_job_id = 0; layer_job_id < layer_jobs.size(); layer_job_id++) {
+                auto& cost = ret[layer_jobs[layer_job_id].first];
+                cost.runtime_ += layer_costs[layer_job_id].runtime_;
+                cost.energy_ += layer_costs[layer_job_id].energy_;
+                cost.offchip_cycles_ += layer_costs[layer_job_id].offchip_cycles_;
+            }
+            return ret;
+        }
+
+        // Max-min fair division of the shared off-chip channel over the tenants' demands; 1: not limited
+        std::vector<double> GetBandwidthShares(std::vector<NetworkCost>& costs) {
+            int num_tenants = costs.size();
+            if(!bw_split_.empty()) {
+                return bw_split_;
+            }
+
+            std::vector<double> ret(num_tenants, 1.0);
+            std::vector<int> order(num_tenants);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](int a, int b) {
+                return costs[a].GetOffchipUtilization() < costs[b].GetOffchipUtilization();
+            });
+
+            double remaining = 1.0;
+            for(int idx = 0; idx < num_tenants; idx++) {
+                double fair_share = remaining / (num_tenants - idx);
+                double demand = costs[order[idx]].GetOffchipUtilization();
+                if(demand <= fair_share) {
+                    remaining -= demand;
+                    continue;
+                }
+                for(int rest = idx; rest < num_tenants; rest++) {
+                    ret[order[rest]] = fair_share;
+                }
+                break;
+            }
+            return ret;
+        }
+
+        // Co-located latency of each tenant without analyzing the throttled tenants again
+        std::vector<long> EstimateLatencies(std::vector<NetworkCost>& costs) {
+            auto bw_shares = GetBandwidthShares(costs);
+            std::vector<long> ret;
+            for(int tenant = 0; tenant < costs.size(); tenant++) {
+                long latency = costs[tenant].runtime_;
+                if(bw_split_.empty() && bw_shares[tenant] < 1.0) {
+                    latency = std::max(latency, static_cast<long>(std::ceil(costs[tenant].offchip_cycles_ / bw_shares[tenant])));
+                }
+                ret.push_back(latency);
+            }
+            return ret;
+        }
+
+        // Lower is better
+        double GetSplitCost(std::vector<NetworkCost>& costs, std::vector<NetworkCost>& alone_costs) {
+            auto latencies = EstimateLatencies(costs);
+            double max_slowdown = 0;
+            double throughput = 0;
+            for(int tenant = 0; tenant < latencies.size(); tenant++) {
+                max_slowdown = std::max(max_slowdown, static_cast<double>(latencies[tenant]) / std::max(alone_costs[tenant].runtime_, 1L));
+                throughput += 1.0 / std::max(latencies[tenant], 1L);
+            }
+            return (objective_ == TenantObjective::Slowdown) ? max_slowdown : -throughput;
+        }
+
+        void SearchSplit(int tenant, int num_used_pes, std::vector<int>& choice,
+                         std::vector<std::vector<int>>& pe_candidates,
+                         std::vector<std::vector<NetworkCost>>& partition_costs,
+                         std::vector<NetworkCost>& alone_costs,
+                         std::vector<int>& best_choice, double& best_cost) {
+            if(tenant == pe_candidates.size()) {
+                std::vector<NetworkCost> costs;
+                for(int idx = 0; idx < choice.size(); idx++) {
+                    costs.push_back(partition_costs[idx][choice[idx]]);
+                }
+                double cost = GetSplitCost(costs, alone_costs);
+                num_candidates_++;
+                if(best_choice.empty() || cost < best_cost) {
+                    best_choice = choice;
+                    best_cost = cost;
+                }
+                return;
+            }
+
+            for(int idx = 0; idx < pe_candidates[tenant].size(); idx++) {
+                if(num_used_pes + pe_candidates[tenant][idx] > hw_config_->num_pes_) {
+                    break;
+                }
+                choice[tenant] = idx;
+                SearchSplit(tenant + 1, num_used_pes + pe_candidates[tenant][idx], choice,
+                            pe_candidates, partition_costs, alone_costs, best_choice, best_cost);
+            }
+        }
+    }; // End of class MultiTenantAnalysis
+}; // End of namespace maestro
+
+#endif
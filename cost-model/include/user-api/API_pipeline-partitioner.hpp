@@ -0,0 +1,243 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_API_PIPELINE_PARTITIONER_HPP_
+#define MAESTRO_API_PIPELINE_PARTITIONER_HPP_
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+#include "BASE_maestro-class.hpp"
+#include "BASE_base-objects.hpp"
+#include "BASE_constants.hpp"
+#include "TL_thread-pool.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_tensor.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_hw-parser.hpp"
+#include "DFSL_syntax_tokens.hpp"
+
+#include "DSE_design_point.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+
+    // Consecutive layers [first_layer_, last_layer_] running on one accelerator of the pipeline
+    class PipelineStage {
+    public:
+        int accelerator_idx_ = 0;
+        int first_layer_ = 0;
+        int last_layer_ = 0;
+
+        long runtime_ = 0;
+        // Cycles to receive the input activation of the stage from the previous accelerator
+        long transfer_cycles_ = 0;
+        double energy_ = 0;
+    }; // End of class PipelineStage
+
+    /*
+     * Partitions the layers of a network into pipeline stages over several accelerators connected in a
+     * chain (in the given order) by inter-chip links. Every layer is analyzed once on every accelerator;
+     * the partitioning then minimizes the steady-state interval, i.e., the slowest stage or link transfer
+     * (min-max dynamic programming), and among those partitionings the latency of one inference.
+     * Accelerators may be left unused when that does not slow the pipeline down.
+     */
+    class PipelinePartitioner : public MAESTROClass {
+    public:
+        PipelinePartitioner(std::shared_ptr<DFA::NeuralNetwork> network,
+                            std::vector<std::shared_ptr<DFSL::HWConfig>> hw_configs,
+                            int simd_width,
+                            double link_bw,
+                            int num_threads = 0) :
+                MAESTROClass("PipelinePartitioner"),
+                network_(network),
+                hw_configs_(hw_configs),
+                simd_width_(simd_width),
+                link_bw_(link_bw),
+                num_threads_(num_threads) {
+        }
+
+        // Analyzes every (layer, accelerator) pair; results are kept for Partition()
+        void AnalyzeLayers() {
+            int num_layers = network_->GetNumLayers();
+            int num_accelerators = hw_configs_.size();
+            layer_costs_.assign(num_layers, std::vector<std::shared_ptr<DSE::DesignPoint>>(num_accelerators));
+
+            std::vector<std::shared_ptr<LayerEvaluator>> evaluators;
+            for(auto& hw_config : hw_configs_) {
+                evaluators.push_back(std::make_shared<LayerEvaluator>(hw_config, simd_width_));
+            }
+
+            TL::ThreadPool thread_pool(num_threads_);
+            thread_pool.ParallelFor(num_layers * num_accelerators, [&](int job_id) {
+                BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                int layer_id = job_id / num_accelerators;
+                int accelerator_idx = job_id % num_accelerators;
+                layer_costs_[layer_id][accelerator_idx] = evaluators[accelerator_idx]->Evaluate(network_->at(layer_id));
+            });
+        }
+
+        std::vector<PipelineStage> Partition() {
+            if(layer_costs_.empty()) {
+                AnalyzeLayers();
+            }
+
+            int num_layers = network_->GetNumLayers();
+            int num_accelerators = hw_configs_.size();
+
+            // best[acc][i]: best pipeline of the first i layers on accelerators [0, acc)
+            std::vector<std::vector<PartialPipeline>> best(num_accelerators + 1, std::vector<PartialPipeline>(num_layers + 1));
+            best[0][0].is_valid_ = true;
+
+            for(int accelerator_idx = 0; accelerator_idx < num_accelerators; accelerator_idx++) {
+                for(int first_layer = 0; first_layer <= num_layers; first_layer++) {
+                    auto& prev = best[accelerator_idx][first_layer];
+                    if(!prev.is_valid_) {
+                        continue;
+                    }
+
+                    // Leave this accelerator unused
+                    UpdateBest(best[accelerator_idx + 1][first_layer], prev.interval_, prev.latency_, first_layer);
+
+                    long transfer_cycles = GetTransferCycles(first_layer);
+                    long stage_runtime = 0;
+                    for(int last_layer = first_layer; last_layer < num_layers; last_layer++) {
+                        stage_runtime += layer_costs_[last_layer][accelerator_idx]->runtime_;
+                        long interval = std::max(prev.interval_, std::max(transfer_cycles, stage_runtime));
+                        long latency = prev.latency_ + transfer_cycles + stage_runtime;
+                        UpdateBest(best[accelerator_idx + 1][last_layer + 1], interval, latency, first_layer);
+                    }
+                }
+            }
+
+            std::vector<PipelineStage> ret;
+            int num_covered = num_layers;
+            for(int accelerator_idx = num_accelerators; accelerator_idx > 0; accelerator_idx--) {
+                int first_layer = best[accelerator_idx][num_covered].first_layer_;
+                if(first_layer == num_covered) {
+                    continue;
+                }
+
+                PipelineStage stage;
+                stage.accelerator_idx_ = accelerator_idx - 1;
+                stage.first_layer_ = first_layer;
+                stage.last_layer_ = num_covered - 1;
+                stage.transfer_cycles_ = GetTransferCycles(first_layer);
+                for(int layer_id = first_layer; layer_id < num_covered; layer_id++) {
+                    stage.runtime_ += layer_costs_[layer_id][stage.accelerator_idx_]->runtime_;
+                    stage.energy_ += layer_costs_[layer_id][stage.accelerator_idx_]->energy_;
+                }
+                ret.push_back(stage);
+                num_covered = first_layer;
+            }
+            std::reverse(ret.begin(), ret.end());
+
+            return ret;
+        }
+
+        void PrintPipeline(std::vector<PipelineStage>& stages, std::vector<std::string> accelerator_names) {
+            long interval = 0;
+            long latency = 0;
+            double energy = 0;
+            for(auto& stage : stages) {
+                interval = std::max(interval, std::max(stage.runtime_, stage.transfer_cycles_));
+                latency += stage.transfer_cycles_ + stage.runtime_;
+                energy += stage.energy_;
+            }
+
+            std::cout << "Stage, Accelerator, Layers, Stage runtime (Cycles), Inter-chip transfer (Cycles), Energy (nJ), Utilization (%)" << std::endl;
+            int stage_id = 0;
+            for(auto& stage : stages) {
+                std::string accelerator_name = (stage.accelerator_idx_ < accelerator_names.size()) ?
+                        accelerator_names[stage.accelerator_idx_] : std::to_string(stage.accelerator_idx_);
+                std::cout << stage_id << ", " << accelerator_name << ", "
+                          << network_->at(stage.first_layer_)->GetName() << " - " << network_->at(stage.last_layer_)->GetName()
+                          << " (" << stage.last_layer_ - stage.first_layer_ + 1 << " layers), "
+                          << stage.runtime_ << ", " << stage.transfer_cycles_ << ", " << stage.energy_ << ", "
+                          << 100.0 * stage.runtime_ / std::max(interval, 1L) << std::endl;
+                stage_id++;
+            }
+
+            std::cout << "Steady-state throughput: " << 1.0 / std::max(interval, 1L) << " inferences/cycle (one every "
+                      << interval << " cycles)" << std::endl;
+            std::cout << "Latency: " << latency << " cycles" << std::endl;
+            std::cout << "Energy per inference: " << energy << " nJ" << std::endl;
+        }
+
+    protected:
+        std::shared_ptr<DFA::NeuralNetwork> network_;
+        std::vector<std::shared_ptr<DFSL::HWConfig>> hw_configs_;
+        int simd_width_;
+        double link_bw_;
+        int num_threads_;
+
+        // [layer][accelerator]
+        std::vector<std::vector<std::shared_ptr<DSE::DesignPoint>>> layer_costs_;
+
+    private:
+        class PartialPipeline {
+        public:
+            bool is_valid_ = false;
+            long interval_ = 0;
+            long latency_ = 0;
+            // First layer of the last accelerator's stage; equal to the number of covered layers if it is unused
+            int first_layer_ = 0;
+        }; // End of class PartialPipeline
+
+        void UpdateBest(PartialPipeline& target, long interval, long latency, int first_layer) {
+            if(!target.is_valid_ || interval < target.interval_
+               || (interval == target.interval_ && latency < target.latency_)) {
+                target.is_valid_ = true;
+                target.interval_ = interval;
+                target.latency_ = latency;
+                target.first_layer_ = first_layer;
+            }
+        }
+
+        // Cycles to move the input activation of the layer over an inter-chip link (the first layer's input is local)
+        long GetTransferCycles(int layer_id) {
+            if(layer_id == 0 || layer_id >= network_->GetNumLayers()) {
+                return 0;
+            }
+
+            auto layer = network_->at(layer_id);
+            bool has_batch = layer->GetSize(DFSL::layer_dim_input_batch_) > 0;
+            long num_elements = 1;
+            for(auto& dim : DFA::GetCoupledVariables(layer, DataClass::Input, has_batch)) {
+                num_elements *= std::max(layer->GetSize(dim), 1);
+            }
+
+            double num_bytes = static_cast<double>(num_elements) * getBitSize(layer->getQuantization()) / 8;
+            return static_cast<long>(std::ceil(num_bytes / link_bw_));
+        }
+    }; // End of class PipelinePartitioner
+}; // End of namespace maestro
+
+#endif
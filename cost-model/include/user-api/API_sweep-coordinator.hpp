@@ -0,0 +1,213 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_API_SWEEP_COORDINATOR_HPP_
+#define MAESTRO_API_SWEEP_COORDINATOR_HPP_
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <iostream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+
+#include "BASE_maestro-class.hpp"
+#include "TL_job-journal.hpp"
+
+#include "API_sweep-driver.hpp"
+
+namespace maestro {
+
+    /*
+     * Splits the jobs of a SweepDriver into fixed-size chunks and distributes them over worker processes.
+     * Chunks are claimed through lock files (created with O_EXCL) in a work directory, which works on a
+     * single host and on shared file systems without any scheduler. Each worker starts at its own share
+     * of the chunks and then steals the chunks that other workers have not claimed yet.
+     * Workers record results in their own journals; the coordinator merges them into the sweep journal
+     * once all workers exit, and the results are written in job order, independent of the schedule.
+     */
+    class SweepCoordinator : public MAESTROClass {
+    public:
+        SweepCoordinator(std::shared_ptr<SweepDriver> sweep_driver, std::string work_dir, int chunk_size) :
+                MAESTROClass("SweepCoordinator"),
+                sweep_driver_(sweep_driver),
+                work_dir_(work_dir),
+                chunk_size_(std::max(chunk_size, 1)) {
+        }
+
+        int GetNumChunks() {
+            int num_jobs = sweep_driver_->GetJobs().size();
+            return (num_jobs + chunk_size_ - 1) / chunk_size_;
+        }
+
+        static std::string GetWorkerJournalName(std::string work_dir, int worker_id) {
+            return work_dir + "/worker_" + std::to_string(worker_id) + ".journal";
+        }
+
+        /*
+         * Starts num_workers copies of this program (argv plus --sweep_worker_id=<id>) and waits for them.
+         * Returns the number of workers that did not exit successfully.
+         */
+        int RunWorkers(int argc, char** argv, int num_workers) {
+            // Keep what the workers of an interrupted run finished; their claims are stale
+            MergeWorkerJournals();
+            boost::filesystem::create_directories(work_dir_);
+
+            std::vector<pid_t> worker_pids;
+            for(int worker_id = 0; worker_id < num_workers; worker_id++) {
+                pid_t pid = fork();
+                if(pid == 0) {
+#ifdef __linux__
+                    // Do not outlive an interrupted coordinator
+                    prctl(PR_SET_PDEATHSIG, SIGTERM);
+#endif
+                    std::vector<std::string> worker_args(argv, argv + argc);
+                    worker_args.push_back("--sweep_worker_id=" + std::to_string(worker_id));
+                    std::vector<char*> worker_argv;
+                    for(auto& arg : worker_args) {
+                        worker_argv.push_back(const_cast<char*>(arg.c_str()));
+                    }
+                    worker_argv.push_back(nullptr);
+                    execvp(worker_argv[0], worker_argv.data());
+                    std::cout << "[SweepCoordinator] Failed to start worker " << worker_id << std::endl;
+                    _exit(1);
+                }
+                else if(pid < 0) {
+                    std::cout << "[SweepCoordinator] Failed to fork worker " << worker_id << std::endl;
+                    continue;
+                }
+                worker_pids.push_back(pid);
+            }
+
+            int num_failed_workers = num_workers - worker_pids.size();
+            for(auto pid : worker_pids) {
+                int status = 0;
+                waitpid(pid, &status, 0);
+                if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                    num_failed_workers++;
+                }
+            }
+            return num_failed_workers;
+        }
+
+        // Worker side: claims and runs chunks until none is left
+        void RunWorker(int worker_id, int num_workers) {
+            int num_chunks = GetNumChunks();
+            int first_chunk = (num_workers > 0) ? static_cast<long>(worker_id % num_workers) * num_chunks / num_workers : 0;
+            auto& jobs = sweep_driver_->GetJobs();
+
+            for(int chunk_offset = 0; chunk_offset < num_chunks; chunk_offset++) {
+                int chunk_id = (first_chunk + chunk_offset) % num_chunks;
+                if(!TryClaimChunk(chunk_id)) {
+                    continue;
+                }
+
+                int first_job = chunk_id * chunk_size_;
+                int last_job = std::min(first_job + chunk_size_, static_cast<int>(jobs.size()));
+                std::vector<SweepJob> chunk_jobs(jobs.begin() + first_job, jobs.begin() + last_job);
+                sweep_driver_->Run(chunk_jobs);
+                num_claimed_chunks_++;
+
+                message_printer_->PrintMsg(1, "[SweepCoordinator] Worker " + std::to_string(worker_id)
+                                              + " finished chunk " + std::to_string(chunk_id));
+            }
+        }
+
+        /*
+         * Coordinator side: appends the worker results missing from the sweep journal (in job order) and
+         * removes the work directory. Returns the number of merged records.
+         */
+        long MergeWorkerJournals() {
+            auto journal = sweep_driver_->GetJournal();
+            journal->Refresh();
+
+            std::vector<std::string> worker_journal_names;
+            if(boost::filesystem::is_directory(work_dir_)) {
+                for(auto& dir_entry : boost::filesystem::directory_iterator(work_dir_)) {
+                    if(dir_entry.path().extension() == ".journal") {
+                        worker_journal_names.push_back(dir_entry.path().string());
+                    }
+                }
+            }
+            std::sort(worker_journal_names.begin(), worker_journal_names.end());
+
+            std::vector<std::shared_ptr<TL::JobJournal>> worker_journals;
+            for(auto& file_name : worker_journal_names) {
+                worker_journals.push_back(std::make_shared<TL::JobJournal>(file_name, false));
+            }
+
+            long num_merged = 0;
+            for(auto& job : sweep_driver_->GetJobs()) {
+                if(journal->IsCompleted(job.key_)) {
+                    continue;
+                }
+                for(auto& worker_journal : worker_journals) {
+                    std::string result;
+                    if(worker_journal->GetResult(job.key_, result)) {
+                        journal->Record(job.key_, result);
+                        num_merged++;
+                        break;
+                    }
+                }
+            }
+
+            worker_journals.clear();
+            boost::filesystem::remove_all(work_dir_);
+            return num_merged;
+        }
+
+        int GetNumClaimedChunks() {
+            return num_claimed_chunks_;
+        }
+
+    protected:
+        std::shared_ptr<SweepDriver> sweep_driver_;
+        std::string work_dir_;
+        int chunk_size_;
+        int num_claimed_chunks_ = 0;
+
+    private:
+        bool TryClaimChunk(int chunk_id) {
+            std::string claim_file_name = work_dir_ + "/chunk_" + std::to_string(chunk_id) + ".claim";
+            int fd = open(claim_file_name.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+            if(fd < 0) {
+                return false;
+            }
+            std::string owner = std::to_string(getpid()) + "\n";
+            ssize_t num_written = write(fd, owner.data(), owner.size());
+            close(fd);
+            return num_written >= 0;
+        }
+    }; // End of class SweepCoordinator
+}; // End of namespace maestro
+
+#endif
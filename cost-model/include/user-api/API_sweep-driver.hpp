@@ -0,0 +1,309 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+#ifndef MAESTRO_API_SWEEP_DRIVER_HPP_
+#define MAESTRO_API_SWEEP_DRIVER_HPP_
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+
+#include "BASE_maestro-class.hpp"
+#include "TL_thread-pool.hpp"
+#include "TL_job-journal.hpp"
+
+#include "DFA_layer.hpp"
+#include "DFA_neural-network.hpp"
+
+#include "DFSL_parser.hpp"
+#include "DFSL_hw-parser.hpp"
+
+#include "DSE_design_point.hpp"
+
+#include "API_layer-evaluator.hpp"
+
+namespace maestro {
+
+    // One (mapping, layer, hardware point) analysis of a sweep
+    class SweepJob {
+    public:
+        int mapping_idx_ = 0;
+        int layer_idx_ = 0;
+        int hw_idx_ = 0;
+        std::string key_;
+    }; // End of class SweepJob
+
+    /*
+     * Analyzes every layer of a set of mapping files on a set of hardware points using a thread pool.
+     * Completed jobs are recorded in a TL::JobJournal as soon as they finish, so an interrupted sweep
+     * resumes where it stopped, and several processes sharing the journal skip each other's work.
+     * Results are written from the journal in job order once the sweep is complete.
+     */
+    class SweepDriver : public MAESTROClass {
+    public:
+        SweepDriver(std::vector<std::string> mapping_files,
+                    std::vector<std::shared_ptr<DFSL::HWConfig>> hw_configs,
+                    int simd_width,
+                    int num_threads,
+                    std::shared_ptr<TL::JobJournal> journal) :
+                MAESTROClass("SweepDriver"),
+                mapping_files_(mapping_files),
+                hw_configs_(hw_configs),
+                simd_width_(simd_width),
+                num_threads_(num_threads),
+                journal_(journal) {
+            for(auto& mapping_file : mapping_files_) {
+                auto network = std::make_shared<DFA::NeuralNetwork>();
+                DFSL::DFSLParser dfsl_parser(mapping_file);
+                dfsl_parser.ParseDFSL(network);
+                networks_.push_back(network);
+            }
+            ConstructJobs();
+        }
+
+        // Expands directories into the mapping (.m) files they contain, in name order
+        static std::vector<std::string> ExpandMappingFiles(std::string file_list) {
+            std::vector<std::string> ret;
+            std::stringstream list_stream(file_list);
+            std::string entry;
+            while(std::getline(list_stream, entry, ',')) {
+                if(entry.empty()) {
+                    continue;
+                }
+                if(boost::filesystem::is_directory(entry)) {
+                    std::vector<std::string> dir_files;
+                    for(auto& dir_entry : boost::filesystem::directory_iterator(entry)) {
+                        if(dir_entry.path().extension() == ".m") {
+                            dir_files.push_back(dir_entry.path().string());
+                        }
+                    }
+                    std::sort(dir_files.begin(), dir_files.end());
+                    ret.insert(ret.end(), dir_files.begin(), dir_files.end());
+                }
+                else {
+                    ret.push_back(entry);
+                }
+            }
+            return ret;
+        }
+
+        std::vector<SweepJob>& GetJobs() {
+            return jobs_;
+        }
+
+        std::shared_ptr<TL::JobJournal> GetJournal() {
+            return journal_;
+        }
+
+        // Jobs recorded in a shared journal are treated as completed, but new results go to this driver's journal
+        void AddSharedJournal(std::shared_ptr<TL::JobJournal> journal) {
+            shared_journals_.push_back(journal);
+        }
+
+        long GetNumEvaluated() {
+            return num_evaluated_;
+        }
+
+        long GetNumSkipped() {
+            return num_skipped_;
+        }
+
+        // Runs the given jobs (all jobs by default) that are not in the journal yet
+        void Run(std::vector<SweepJob> jobs = {}) {
+            if(jobs.empty()) {
+                jobs = jobs_;
+            }
+
+            RefreshJournals();
+            std::vector<SweepJob> pending_jobs;
+            for(auto& job : jobs) {
+                if(IsCompleted(job.key_)) {
+                    num_skipped_++;
+                }
+                else {
+                    pending_jobs.push_back(job);
+                }
+            }
+
+            std::vector<std::shared_ptr<LayerEvaluator>> evaluators;
+            for(auto& hw_config : hw_configs_) {
+                evaluators.push_back(std::make_shared<LayerEvaluator>(hw_config, simd_width_));
+            }
+
+            TL::ThreadPool thread_pool(num_threads_);
+            thread_pool.ParallelFor(pending_jobs.size(), [&](int job_id) {
+                BaseObjectScope base_object_scope(error_handler_, message_printer_);
+                auto& job = pending_jobs[job_id];
+                // Other processes sharing the journal may have finished the job in the meantime
+                RefreshJournals();
+                if(IsCompleted(job.key_)) {
+                    num_skipped_++;
+                    return;
+                }
+
+                auto layer = networks_[job.mapping_idx_]->at(job.layer_idx_);
+                auto design_point = evaluators[job.hw_idx_]->Evaluate(layer);
+                journal_->Record(job.key_, SerializeDesignPoint(design_point));
+                num_evaluated_++;
+
+                message_printer_->PrintMsg(1, "[SweepDriver] Finished " + job.key_);
+            });
+        }
+
+        /*
+         * Writes one CSV row per job (in job order) from the journal. Returns false if some jobs have
+         * not been completed yet; those are left out.
+         */
+        bool WriteResults(std::string file_name) {
+            journal_->Refresh();
+            std::ofstream out_file(file_name);
+            out_file << "Mapping, Layer Number, Layer Name, NumPEs, L1 Size, L2 Size, NoC BW, NoC Hops, Offchip BW, Vector Width, "
+                     << "Runtime (Cycles), Activity count-based Energy (nJ), Num MACs, MACs energy, L1 energy, L2 energy, NoC energy, "
+                     << "L1 SRAM Size Req, L2 SRAM Size Req, Area, Power" << std::endl;
+
+            bool is_complete = true;
+            for(auto& job : jobs_) {
+                std::string result;
+                if(!journal_->GetResult(job.key_, result)) {
+                    is_complete = false;
+                    continue;
+                }
+                auto hw_config = hw_configs_[job.hw_idx_];
+                out_file << mapping_files_[job.mapping_idx_] << ", " << job.layer_idx_ << ", "
+                         << networks_[job.mapping_idx_]->at(job.layer_idx_)->GetName() << ", "
+                         << hw_config->num_pes_ << ", " << hw_config->l1_size_ << ", " << hw_config->l2_size_ << ", "
+                         << hw_config->noc_bw_ << ", " << hw_config->noc_hops_ << ", " << hw_config->off_chip_bw_ << ", "
+                         << simd_width_ << ", " << result << std::endl;
+            }
+            return is_complete;
+        }
+
+    protected:
+        std::vector<std::string> mapping_files_;
+        std::vector<std::shared_ptr<DFA::NeuralNetwork>> networks_;
+        std::vector<std::shared_ptr<DFSL::HWConfig>> hw_configs_;
+        int simd_width_;
+        int num_threads_;
+        std::shared_ptr<TL::JobJournal> journal_;
+        std::vector<std::shared_ptr<TL::JobJournal>> shared_journals_;
+
+        std::vector<SweepJob> jobs_;
+        std::atomic<long> num_evaluated_{0};
+        std::atomic<long> num_skipped_{0};
+
+    private:
+        void RefreshJournals() {
+            journal_->Refresh();
+            for(auto& journal : shared_journals_) {
+                journal->Refresh();
+            }
+        }
+
+        bool IsCompleted(const std::string& key) {
+            if(journal_->IsCompleted(key)) {
+                return true;
+            }
+            for(auto& journal : shared_journals_) {
+                if(journal->IsCompleted(key)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void ConstructJobs() {
+            for(int mapping_idx = 0; mapping_idx < networks_.size(); mapping_idx++) {
+                int layer_idx = 0;
+                for(auto& layer : *networks_[mapping_idx]) {
+                    for(int hw_idx = 0; hw_idx < hw_configs_.size(); hw_idx++) {
+                        SweepJob job;
+                        job.mapping_idx_ = mapping_idx;
+                        job.layer_idx_ = layer_idx;
+                        job.hw_idx_ = hw_idx;
+                        job.key_ = mapping_files_[mapping_idx] + "|" + std::to_string(layer_idx) + ":" + layer->GetName()
+                                   + "|" + GetHWKey(hw_configs_[hw_idx]);
+                        jobs_.push_back(job);
+                    }
+                    layer_idx++;
+                }
+            }
+        }
+
+        std::string GetHWKey(std::shared_ptr<DFSL::HWConfig> hw_config) {
+            std::string ret = "pes=" + std::to_string(hw_config->num_pes_)
+                   + ",l1=" + std::to_string(hw_config->l1_size_)
+                   + ",l2=" + std::to_string(hw_config->l2_size_)
+                   + ",noc_bw=" + std::to_string(hw_config->noc_bw_)
+                   + ",hops=" + std::to_string(hw_config->noc_hops_)
+                   + ",offchip_bw=" + std::to_string(hw_config->off_chip_bw_)
+                   + ",simd=" + std::to_string(simd_width_);
+
+            auto dram = hw_config->dram_config_;
+            if(dram != nullptr) {
+                ret += ",dram=" + std::to_string(dram->bus_bw_) + "/" + std::to_string(dram->burst_size_)
+                       + "/" + std::to_string(dram->row_size_) + "/" + std::to_string(dram->num_banks_)
+                       + "/" + std::to_string(dram->t_rcd_) + "/" + std::to_string(dram->t_rp_)
+                       + "/" + std::to_string(dram->t_cas_) + "/" + std::to_string(dram->t_turnaround_);
+            }
+            if(!hw_config->noc_bws_.empty()) {
+                ret += ",noc_bws=";
+                for(auto noc_bw : hw_config->noc_bws_) {
+                    ret += std::to_string(noc_bw) + "/";
+                }
+            }
+            if(!hw_config->noc_multicast_) {
+                ret += ",noc_mc=0";
+            }
+            if(!hw_config->noc_topologies_.empty()) {
+                ret += ",noc_topology=";
+                for(auto topology : hw_config->noc_topologies_) {
+                    ret += std::to_string(static_cast<int>(topology));
+                }
+            }
+            for(auto& buffer_level : hw_config->buffer_levels_) {
+                ret += "," + buffer_level.name_ + "=" + std::to_string(buffer_level.size_) + "/" + std::to_string(buffer_level.bw_)
+                       + "/" + std::to_string(buffer_level.read_energy_) + "/" + std::to_string(buffer_level.write_energy_);
+            }
+            return ret;
+        }
+
+        static std::string SerializeDesignPoint(std::shared_ptr<DSE::DesignPoint> design_point) {
+            std::ostringstream ret;
+            ret << std::setprecision(12);
+            ret << design_point->runtime_ << ", " << design_point->energy_ << ", " << design_point->num_macs_ << ", "
+                << design_point->mac_energy_ << ", " << design_point->l1_energy_ << ", " << design_point->l2_energy_ << ", "
+                << design_point->noc_energy_ << ", " << design_point->l1_sram_sz << ", " << design_point->l2_sram_sz << ", "
+                << design_point->area_ << ", " << design_point->power_;
+            return ret.str();
+        }
+    }; // End of class SweepDriver
+}; // End of namespace maestro
+
+#endif
@@ -0,0 +1,320 @@
+/******************************************************************************
+Copyright (c) 2019 Georgia Instititue of Technology
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
+*******************************************************************************/
+
+
+
+#ifndef MAESTRO_API_TIMELINE_TRACE_HPP_
+#define MAESTRO_API_TIMELINE_TRACE_HPP_
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "BASE_maestro-class.hpp"
+
+#include "DFA_neural-network.hpp"
+
+#include "CA_cost-analysis-results.hpp"
+
+namespace maestro {
+
+    /*
+     * Exports the modeled execution timeline in the Chrome trace event format (chrome://tracing, Perfetto).
+     * Layers run back to back; within a layer, each cluster level shows its iteration cases in execution
+     * order, one event per case covering all its occurrences, with the computation, ingress and egress
+     * phases of the case on separate tracks so their overlap is visible. Cases whose runtime is dominated
+     * by off-chip transfers are marked on an off-chip track. One time unit of the trace is one cycle.
+     *
+     * Traces of large networks are kept small by
+     *   max_groups: consecutive cases shorter than 1/max_groups of their cluster level are merged
+     *   max_depth: number of cluster levels shown (1: the top level only)
+     *   max_expanded: cases per cluster level whose sub-cluster level is shown, longest first; the sub-level
+     *                 shows one iteration of the case (its slowest sub-cluster) at the start of the case
+     * The cases of the exact analysis are required (APIV2::SetTimelineRecording); layers analyzed without
+     * them only show their top-level runtime.
+     */
+    class TimelineTrace : public MAESTROClass {
+    public:
+        TimelineTrace(std::string file_name, int max_depth = 2, int max_groups = 32, int max_expanded = 4) :
+                MAESTROClass("TimelineTrace"),
+                file_name_(file_name),
+                max_depth_(std::max(max_depth, 1)),
+                max_groups_(std::max(max_groups, 1)),
+                max_expanded_(std::max(max_expanded, 0)) {
+        }
+
+        bool WriteTrace(std::shared_ptr<DFA::NeuralNetwork> network,
+                        std::shared_ptr<std::vector<std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>>>> results) {
+            std::ofstream out_file(file_name_);
+            if(!out_file) {
+                std::cout << "[MAESTRO Timeline Trace] Failed to open the output file " << file_name_ << std::endl;
+                return false;
+            }
+
+            events_.clear();
+            events_.push_back("{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \""
+                              + Escape(network->GetName()) + "\"}}");
+            AddTrackName(layer_track_, "Layers");
+            AddTrackName(offchip_track_, "Off-chip memory");
+            for(int level = 0; level < max_depth_; level++) {
+                std::string level_name = "Cluster level " + std::to_string(level);
+                AddTrackName(GetTrack(level, Phase::Cases), level_name + " iteration cases");
+                AddTrackName(GetTrack(level, Phase::Computation), level_name + " computation");
+                AddTrackName(GetTrack(level, Phase::Ingress), level_name + " ingress");
+                AddTrackName(GetTrack(level, Phase::Egress), level_name + " egress");
+            }
+
+            long layer_start = 0;
+            for(int layer_id = 0; layer_id < results->size(); layer_id++) {
+                auto top_results = results->at(layer_id)->back();
+                long layer_runtime = top_results->GetRuntime();
+                std::string layer_name = (layer_id < network->GetNumLayers()) ? network->at(layer_id)->GetName()
+                                                                              : std::to_string(layer_id);
+
+                AddEvent(layer_track_, layer_name, layer_start, layer_runtime, "",
+                         "\"runtime\": " + std::to_string(layer_runtime)
+                         + ", \"num_macs\": " + std::to_string(top_results->GetTopNumComputations()));
+                AddClusterLevel(top_results, 0, layer_start);
+                layer_start += layer_runtime;
+            }
+
+            out_file << "{\"displayTimeUnit\": \"ns\", \"otherData\": {\"network\": \"" << Escape(network->GetName())
+                     << "\", \"time_unit\": \"cycles\"}, \"traceEvents\": [\n";
+            for(int event_id = 0; event_id < events_.size(); event_id++) {
+                out_file << events_[event_id] << ((event_id + 1 < events_.size()) ? ",\n" : "\n");
+            }
+            out_file << "]}\n";
+
+            return true;
+        }
+
+        long GetNumEvents() {
+            return events_.size();
+        }
+
+    protected:
+        enum class Phase {Cases, Computation, Ingress, Egress, NumPhases};
+
+        const int layer_track_ = 0;
+        const int offchip_track_ = 1;
+
+        std::string file_name_;
+        int max_depth_;
+        int max_groups_;
+        int max_expanded_;
+
+        std::vector<std::string> events_;
+
+    private:
+        // Consecutive iteration cases shown as one event
+        class CaseGroup {
+        public:
+            int first_case_ = 0;
+            int num_cases_ = 0;
+            bool is_init_ = false;
+            long num_occurrences_ = 0;
+            long start_cycle_ = 0;
+            long duration_ = 0;
+            // Over all occurrences
+            long computation_cycles_ = 0;
+            long ingress_cycles_ = 0;
+            long egress_cycles_ = 0;
+            long offchip_cycles_ = 0;
+            long offchip_stall_cycles_ = 0;
+            std::shared_ptr<CA::CostAnalysisResults> critical_sub_results_ = nullptr;
+
+            void Add(const CA::IterationCaseRecord& case_record) {
+                if(num_cases_ == 0) {
+                    first_case_ = case_record.case_id_;
+                    start_cycle_ = case_record.start_cycle_;
+                }
+                num_cases_++;
+                is_init_ = is_init_ || case_record.is_init_;
+                num_occurrences_ += case_record.num_occurrences_;
+                duration_ += case_record.duration_;
+
+                long num_occ = case_record.num_occurrences_;
+                computation_cycles_ += num_occ * (case_record.computation_delay_ + case_record.reduction_delay_);
+                ingress_cycles_ += num_occ * case_record.ingress_delay_;
+                egress_cycles_ += num_occ * case_record.egress_delay_;
+                offchip_cycles_ += num_occ * std::max(case_record.offchip_ingress_delay_, case_record.offchip_egress_delay_);
+
+                // Cycles the case takes beyond its on-chip work are off-chip stalls
+                long onchip_cycles = num_occ * std::max(case_record.stalled_delay_,
+                                                        std::max(case_record.ingress_delay_, case_record.egress_delay_));
+                if(case_record.is_init_) {
+                    onchip_cycles = num_occ * (case_record.stalled_delay_ + case_record.ingress_delay_);
+                }
+                if(case_record.offchip_ingress_delay_ > 0 || case_record.offchip_egress_delay_ > 0) {
+                    offchip_stall_cycles_ += std::max(case_record.duration_ - onchip_cycles, 0L);
+                }
+                critical_sub_results_ = (num_cases_ == 1) ? case_record.critical_sub_results_ : nullptr;
+            }
+        }; // End of class CaseGroup
+
+        int GetTrack(int level, Phase phase) {
+            return 10 + level * static_cast<int>(Phase::NumPhases) + static_cast<int>(phase);
+        }
+
+        void AddClusterLevel(std::shared_ptr<CA::CostAnalysisResults> level_results, int level, long level_start) {
+            auto& case_records = level_results->GetCaseRecords();
+            long level_runtime = level_results->GetRuntime();
+            long min_group_cycles = level_runtime / max_groups_;
+
+            std::vector<CaseGroup> groups;
+            CaseGroup group;
+            for(auto& case_record : case_records) {
+                bool is_short = case_record.duration_ < min_group_cycles;
+                if(!is_short && group.num_cases_ > 0) {
+                    groups.push_back(group);
+                    group = CaseGroup();
+                }
+                group.Add(case_record);
+                if(!is_short || group.duration_ >= min_group_cycles) {
+                    groups.push_back(group);
+                    group = CaseGroup();
+                }
+            }
+            if(group.num_cases_ > 0) {
+                groups.push_back(group);
+            }
+
+            // Sub-cluster levels of the longest cases
+            std::vector<int> expanded;
+            if(level + 1 < max_depth_) {
+                std::vector<int> order(groups.size());
+                for(int group_id = 0; group_id < groups.size(); group_id++) {
+                    order[group_id] = group_id;
+                }
+                std::stable_sort(order.begin(), order.end(), [&groups](int lhs, int rhs) {
+                    return groups[lhs].duration_ > groups[rhs].duration_;
+                });
+                for(auto group_id : order) {
+                    if(expanded.size() >= max_expanded_) {
+                        break;
+                    }
+                    if(groups[group_id].critical_sub_results_ != nullptr) {
+                        expanded.push_back(group_id);
+                    }
+                }
+            }
+
+            long end_cycle = 0;
+            for(int group_id = 0; group_id < groups.size(); group_id++) {
+                auto& case_group = groups[group_id];
+                long start = level_start + case_group.start_cycle_;
+                long duration = case_group.duration_;
+                end_cycle = case_group.start_cycle_ + duration;
+
+                std::string name = case_group.is_init_ ? "Init case" : "Case " + std::to_string(case_group.first_case_);
+                if(case_group.num_cases_ > 1) {
+                    name = std::to_string(case_group.num_cases_) + " cases from " + std::to_string(case_group.first_case_);
+                }
+
+                std::string bound = "computation";
+                std::string color = "good";
+                if(case_group.offchip_stall_cycles_ > 0) {
+                    bound = "off-chip";
+                    color = "terrible";
+                }
+                else if(std::max(case_group.ingress_cycles_, case_group.egress_cycles_) > case_group.computation_cycles_) {
+                    bound = (case_group.ingress_cycles_ >= case_group.egress_cycles_) ? "ingress" : "egress";
+                    color = "bad";
+                }
+
+                std::string args = "\"occurrences\": " + std::to_string(case_group.num_occurrences_)
+                                   + ", \"cases\": " + std::to_string(case_group.num_cases_)
+                                   + ", \"bound\": \"" + bound + "\""
+                                   + ", \"computation_cycles\": " + std::to_string(case_group.computation_cycles_)
+                                   + ", \"ingress_cycles\": " + std::to_string(case_group.ingress_cycles_)
+                                   + ", \"egress_cycles\": " + std::to_string(case_group.egress_cycles_);
+                if(level == 0) {
+                    args += ", \"offchip_cycles\": " + std::to_string(case_group.offchip_cycles_)
+                            + ", \"offchip_stall_cycles\": " + std::to_string(case_group.offchip_stall_cycles_);
+                }
+                AddEvent(GetTrack(level, Phase::Cases), name, start, duration, color, args);
+
+                AddPhase(GetTrack(level, Phase::Computation), "Computation", start, case_group.computation_cycles_, duration);
+                AddPhase(GetTrack(level, Phase::Ingress), "Ingress", start, case_group.ingress_cycles_, duration);
+                AddPhase(GetTrack(level, Phase::Egress), "Egress", start, case_group.egress_cycles_, duration);
+                if(level == 0 && case_group.offchip_cycles_ > 0) {
+                    AddEvent(offchip_track_, case_group.offchip_stall_cycles_ > 0 ? "Off-chip stall" : "Off-chip transfer",
+                             start, std::min(std::max(case_group.offchip_cycles_, case_group.offchip_stall_cycles_), duration),
+                             case_group.offchip_stall_cycles_ > 0 ? "terrible" : "",
+                             "\"stall_cycles\": " + std::to_string(case_group.offchip_stall_cycles_));
+                }
+
+                if(std::find(expanded.begin(), expanded.end(), group_id) != expanded.end()) {
+                    AddClusterLevel(case_group.critical_sub_results_, level + 1, start);
+                }
+            }
+
+            // Outputs still held in spare buffers drain after the last case
+            if(!groups.empty() && end_cycle < level_runtime) {
+                AddEvent(GetTrack(level, Phase::Egress), "Output drain", level_start + end_cycle, level_runtime - end_cycle, "", "");
+            }
+        }
+
+        void AddPhase(int track, std::string name, long start, long cycles, long group_duration) {
+            if(cycles > 0) {
+                AddEvent(track, name, start, std::min(cycles, group_duration), "", "");
+            }
+        }
+
+        void AddEvent(int track, std::string name, long start, long duration, std::string color, std::string args) {
+            std::ostringstream event;
+            event << "{\"name\": \"" << Escape(name) << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << track
+                  << ", \"ts\": " << start << ", \"dur\": " << duration;
+            if(color != "") {
+                event << ", \"cname\": \"" << color << "\"";
+            }
+            if(args != "") {
+                event << ", \"args\": {" << args << "}";
+            }
+            event << "}";
+            events_.push_back(event.str());
+        }
+
+        void AddTrackName(int track, std::string name) {
+            events_.push_back("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " + std::to_string(track)
+                              + ", \"args\": {\"name\": \"" + Escape(name) + "\"}}");
+            events_.push_back("{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 0, \"tid\": " + std::to_string(track)
+                              + ", \"args\": {\"sort_index\": " + std::to_string(track) + "}}");
+        }
+
+        static std::string Escape(std::string str) {
+            std::string ret;
+            for(auto c : str) {
+                if(c == '"' || c == '\\') {
+                    ret += '\\';
+                }
+                ret += c;
+            }
+            return ret;
+        }
+    }; // End of class TimelineTrace
+}; // End of namespace maestro
+
+#endif
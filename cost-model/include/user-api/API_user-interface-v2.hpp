@@ -26,7 +26,9 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <map>
 #include <vector>
+#include <stdexcept>
 
 #include "AHW_noc-model.hpp"
 #include "option.hpp"
@@ -40,6 +42,7 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 #include "DFA_tensor.hpp"
 
 #include "CA_cost-analysis-engine.hpp"
+#include "CA_roofline-analysis.hpp"
 #include "CA_cost-analysis-results.hpp"
 
 #include "API_configuration.hpp"
@@ -62,6 +65,19 @@ namespace maestro {
             AnalyzeClusters();
         }
 
+        // Analyzes an already constructed network (e.g., generated by a mapping search) instead of parsing the DFSL file
+        APIV2 (std::shared_ptr<ConfigurationV2> config, std::shared_ptr<DFA::NeuralNetwork> network):
+                MAESTROClass("APIV2"),
+                configuration_(config),
+                num_macs_(0) {
+            tensor_info_mapping_table_ = std::make_unique<std::map<LayerType, int>>();
+
+            configuration_->network_ = network;
+            ParseHW();
+            ConstructNoCs();
+            AnalyzeClusters();
+        }
+
 
         std::string GetNetworkName() {
             return configuration_->network_->GetName();
@@ -76,12 +92,6 @@ namespace maestro {
 
             int layer_id = 0;
             for(auto layer : *(configuration_->network_)) {
-
-                auto quantizationType = layer->getQuantization();
-                configuration_->num_pes_ = configuration_->num_pes_file_ * quantizationFactor(quantizationType);
-                configuration_->l1_size_ = (int) (configuration_->l1_byte_size_ * 8 / maestro::getBitSize(quantizationType));
-                configuration_->l2_size_ = (int) (configuration_->l2_byte_size_ * 8 / maestro::getBitSize(quantizationType));
-
                 auto layer_results = AnalyzeCostAllClusters(layer_id, print_results_to_screen, print_log_to_file);
                 long num_macs = this->GetNumPartialSums(layer_id);
                 layer_results->at(layer_results->size()-1)->UpdateTopNumComputations(num_macs);
@@ -96,10 +106,11 @@ namespace maestro {
             long min_l2_size_req = 0;
 
             if(print_results_to_screen) {
-                for(auto& layer_res : *ret) {
+                for(int res_layer_id = 0; res_layer_id < ret->size(); res_layer_id++) {
+                    auto& layer_res = ret->at(res_layer_id);
                     auto upper_most_cluster_res = layer_res->at(layer_res->size()-1);
                     auto inner_most_cluster_res = layer_res->at(0);
-                    PrintAnalysisResultsSingleCluster(upper_most_cluster_res, inner_most_cluster_res);
+                    PrintAnalysisResultsSingleCluster(upper_most_cluster_res, inner_most_cluster_res, layer_tensor_info_idx_.at(res_layer_id));
                     auto layer_wise_total_l2_size = (upper_most_cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Input) +
                                                      upper_most_cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Output) +
                                                      upper_most_cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Weight));
@@ -115,16 +126,41 @@ namespace maestro {
                         min_l2_size_req = layer_wise_total_l2_size;
                     }
                 }
+                // Buffer sizes are in entries of the last layer's precision
+                long l1_size = configuration_->l1_size_;
+                long l2_size = configuration_->l2_size_;
+                if(!ret->empty()) {
+                    auto layer_hw = configuration_->GetLayerHardwareView(configuration_->network_->at(ret->size()-1)->getQuantization());
+                    l1_size = layer_hw.l1_size_;
+                    l2_size = layer_hw.l2_size_;
+                }
+
                 bool pass=true;
                 std::cout << "Buffer Analysis:"<<std::endl;
-                if(min_l1_size_req > configuration_->l1_size_){
-                    std::cout << "[WARNING:Buffer] Per-layer L1 size requirement [" << min_l1_size_req << "] is larger than the given L1 size [" << configuration_->l1_size_ << "]"<< std::endl;
+                if(min_l1_size_req > l1_size){
+                    std::cout << "[WARNING:Buffer] Per-layer L1 size requirement [" << min_l1_size_req << "] is larger than the given L1 size [" << l1_size << "]"<< std::endl;
                     pass= false;
                 }
-                if(min_l2_size_req > configuration_->l2_size_){
-                    std::cout << "[WARNING:Buffer] Per-layer L2 size requirement [" << min_l2_size_req << "] is larger than the given L2 size [" << configuration_->l2_size_ << "]"<< std::endl;
+                if(min_l2_size_req > l2_size){
+                    std::cout << "[WARNING:Buffer] Per-layer L2 size requirement [" << min_l2_size_req << "] is larger than the given L2 size [" << l2_size << "]"<< std::endl;
                     pass= false;
                 }
+                // Declared buffer levels are checked in bytes, layer by layer
+                auto& buffer_levels = configuration_->buffer_levels_;
+                for(int layer_idx = 0; layer_idx < ret->size() && !buffer_levels.empty(); layer_idx++) {
+                    std::vector<double> level_energy;
+                    std::vector<long> level_size_req;
+                    SummarizeBufferHierarchy(ret->at(layer_idx), configuration_->network_->at(layer_idx)->getQuantization(),
+                                             level_energy, level_size_req);
+                    for(int level_idx = 0; level_idx < buffer_levels.size(); level_idx++) {
+                        if(buffer_levels[level_idx].size_ > 0 && level_size_req[level_idx] > buffer_levels[level_idx].size_) {
+                            std::cout << "[WARNING:Buffer] Layer " << configuration_->network_->at(layer_idx)->GetName() << " needs ["
+                                      << level_size_req[level_idx] << "] bytes in buffer level " << buffer_levels[level_idx].name_
+                                      << " of [" << buffer_levels[level_idx].size_ << "] bytes" << std::endl;
+                            pass = false;
+                        }
+                    }
+                }
                 if(pass) {
                     std::cout << "[PASS]" << std::endl;
                 }
@@ -174,24 +210,426 @@ namespace maestro {
             return 0;
         }
 
+        /*
+         * Energy (nJ) and required bytes of each buffer level declared in the HW description, from the
+         * accesses at every cluster boundary (see AHW::GetBufferLevelIdx). Accesses of a boundary whose data
+         * does not fit its level are served by the nearest enclosing level that holds it (the outermost one
+         * at worst). Returns false if any boundary overflows its level.
+         */
+        bool SummarizeBufferHierarchy(
+                std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> layer_res,
+                LayerQuantizationType quantizationType,
+                std::vector<double>& level_energy,
+                std::vector<long>& level_size_req) {
+            auto& buffer_levels = configuration_->buffer_levels_;
+            int num_buffer_levels = buffer_levels.size();
+            int bit_size = maestro::getBitSize(quantizationType);
+            level_energy.assign(num_buffer_levels, 0);
+            level_size_req.assign(num_buffer_levels, 0);
+
+            auto top_res = layer_res->back();
+            int num_cluster_lvs = 0;
+            for(auto& cluster_res : *layer_res) {
+                num_cluster_lvs = std::max(num_cluster_lvs, static_cast<int>(cluster_res->GetClusterLevel()) + 1);
+            }
+
+            bool fits_buffers = true;
+            for(int boundary = 0; boundary <= num_cluster_lvs; boundary++) {
+                long num_reads = 0;
+                long num_writes = 0;
+                long size_req = 0;
+                if(boundary == 0) {
+                    for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                        auto data_class = static_cast<DataClass>(i);
+                        num_reads += top_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, data_class);
+                        num_writes += top_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, data_class);
+                        size_req += top_res->GetBufferSizeReq(CA::BufferType::Upstream, data_class);
+                    }
+                }
+                else {
+                    num_reads = top_res->GetHierarchyAccessCount(boundary, CA::BufferAccessType::Read);
+                    num_writes = top_res->GetHierarchyAccessCount(boundary, CA::BufferAccessType::Write);
+                    // Requirement of the clusters reading from this boundary (the base cluster's own buffers for
+                    // the innermost one), as for the legacy L2/L1 sizes; the largest instance sets the size
+                    bool is_unit_boundary = boundary == num_cluster_lvs;
+                    for(auto& cluster_res : *layer_res) {
+                        if(cluster_res->GetClusterLevel() != (is_unit_boundary ? boundary - 1 : boundary)) {
+                            continue;
+                        }
+                        long cluster_size_req = 0;
+                        for(int i = 0; i < static_cast<int>(DataClass::NumDataClasses); i++) {
+                            cluster_size_req += cluster_res->GetBufferSizeReq(
+                                    is_unit_boundary ? CA::BufferType::Downstream : CA::BufferType::Upstream, static_cast<DataClass>(i));
+                        }
+                        size_req = std::max(size_req, cluster_size_req);
+                    }
+                }
+
+                long size_req_bytes = (size_req * bit_size + 7) / 8;
+                int level_idx = AHW::GetBufferLevelIdx(boundary, num_cluster_lvs, num_buffer_levels);
+                level_size_req[level_idx] = std::max(level_size_req[level_idx], size_req_bytes);
+
+                int serving_level_idx = level_idx;
+                while(serving_level_idx > 0 && buffer_levels[serving_level_idx].size_ > 0
+                      && size_req_bytes > buffer_levels[serving_level_idx].size_) {
+                    serving_level_idx--;
+                }
+                if(buffer_levels[level_idx].size_ > 0 && size_req_bytes > buffer_levels[level_idx].size_) {
+                    fits_buffers = false;
+                }
+
+                auto& serving_level = buffer_levels[serving_level_idx];
+                long num_level_elements = (serving_level.size_ > 0) ? serving_level.size_ * 8 / bit_size : size_req;
+                double read_energy = (serving_level.read_energy_ >= 0) ? serving_level.read_energy_ :
+                                     maestro::getMemoryEnergyMultiplier(num_level_elements, quantizationType, maestro::Operation::Read);
+                double write_energy = (serving_level.write_energy_ >= 0) ? serving_level.write_energy_ :
+                                      maestro::getMemoryEnergyMultiplier(num_level_elements, quantizationType, maestro::Operation::Write);
+                level_energy[serving_level_idx] += (num_reads / quantizationFactor(quantizationType)) * read_energy
+                                                   + (num_writes / quantizationFactor(quantizationType)) * write_energy;
+            }
+
+            return fits_buffers;
+        }
+
+        /*
+         * Rolls up the per-cluster results of a layer (layer_id starts from 0) into runtime, energy breakdown,
+         * area/power and buffer requirements. Energy is in nJ. With buffer levels declared in the HW
+         * description, the L2 energy is that of the outermost level and the L1 energy that of the others.
+         */
+        std::shared_ptr<DSE::DesignPoint> SummarizeLayer(
+                int layer_id,
+                std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> layer_res) {
+            auto quantizationType = configuration_->network_->at(layer_id)->getQuantization();
+            auto layer_hw = configuration_->GetLayerHardwareView(quantizationType);
+
+            int cluster_lv = 0;
+            long layer_runtime = 0;
+
+            double layer_energy = 0;
+            double layer_MAC_energy = 0;
+            double layer_L1_energy = 0;
+            double layer_L2_energy = 0;
+            double layer_NoC_energy = 0;
+
+            long l2_rd_input_count = 0;
+            long l2_rd_weight_count = 0;
+            long l2_rd_output_count = 0;
+
+            long l2_wr_input_count = 0;
+            long l2_wr_weight_count = 0;
+            long l2_wr_output_count = 0;
+
+            long l2_to_l1_wr_input_count = 0;
+            long l2_to_l1_wr_weight_count = 0;
+
+            long l1_rd_input_count = 0;
+            long l1_rd_weight_count = 0;
+            long l1_rd_output_count = 0;
+
+            long l1_wr_input_count = 0;
+            long l1_wr_weight_count = 0;
+            long l1_wr_output_count = 0;
+
+            int num_pes = layer_hw.num_pes_;
+            int l2_size = 0;
+            int l1_size = 0;
+            long num_psums = 0;
+            long reduction_traffic = 0;
+
+            for (auto &cluster_res: *layer_res) {
+                if (cluster_lv == layer_res->size() - 1) {
+                    l2_rd_input_count = cluster_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, DataClass::Input) / quantizationFactor(quantizationType);
+                    l2_rd_weight_count = cluster_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, DataClass::Weight) / quantizationFactor(quantizationType);
+                    l2_rd_output_count = cluster_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Read, DataClass::Output) / quantizationFactor(quantizationType);
+                    l2_wr_input_count = cluster_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, DataClass::Input) / quantizationFactor(quantizationType);
+                    l2_wr_weight_count = cluster_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, DataClass::Weight) / quantizationFactor(quantizationType);
+                    l2_wr_output_count = cluster_res->GetBufferAccessCount(CA::BufferType::Upstream, CA::BufferAccessType::Write, DataClass::Output) / quantizationFactor(quantizationType);
+
+                    l2_to_l1_wr_input_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, DataClass::Input);
+                    l2_to_l1_wr_weight_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, DataClass::Weight);
+
+                    layer_runtime = cluster_res->GetRuntime();
+
+                    l2_size += cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Input);
+                    l2_size += cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Output);
+                    l2_size += cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, DataClass::Weight);
+
+                    layer_L2_energy += (l2_rd_weight_count + l2_rd_input_count +l2_rd_output_count) * maestro::getMemoryEnergyMultiplier(l2_size, quantizationType, maestro::Operation::Read);
+                    layer_L2_energy += (l2_wr_input_count + l2_wr_weight_count + l2_wr_output_count) * maestro::getMemoryEnergyMultiplier(l2_size, quantizationType, maestro::Operation::Write);
+
+                    num_psums = cluster_res->GetNumComputations();
+                    reduction_traffic = cluster_res->GetReductionTraffic() / quantizationFactor(quantizationType);
+
+                    l1_rd_input_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, DataClass::Input) / quantizationFactor(quantizationType);
+                    l1_rd_weight_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, DataClass::Weight) / quantizationFactor(quantizationType);
+                    l1_rd_output_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Read, DataClass::Output) / quantizationFactor(quantizationType);
+                    l1_wr_input_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, DataClass::Input) / quantizationFactor(quantizationType);
+                    l1_wr_weight_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, DataClass::Weight) / quantizationFactor(quantizationType);
+                    l1_wr_output_count = cluster_res->GetBufferAccessCount(CA::BufferType::Downstream, CA::BufferAccessType::Write, DataClass::Output) / quantizationFactor(quantizationType);
+
+                    layer_L1_energy += (l1_rd_input_count + l1_rd_weight_count + l1_rd_output_count) * maestro::getMemoryEnergyMultiplier(l1_size, quantizationType, maestro::Operation::Read);
+                    layer_L1_energy += (l1_wr_input_count + l1_wr_weight_count + l1_wr_output_count) * maestro::getMemoryEnergyMultiplier(l1_size, quantizationType, maestro::Operation::Write);
+                }
+                if (cluster_lv == 0) {
+                    l1_size += cluster_res->GetBufferSizeReq(CA::BufferType::Downstream, DataClass::Input);
+                    l1_size += cluster_res->GetBufferSizeReq(CA::BufferType::Downstream, DataClass::Output);
+                    l1_size += cluster_res->GetBufferSizeReq(CA::BufferType::Downstream, DataClass::Weight);
+                }
+                cluster_lv++;
+            }
+
+            layer_MAC_energy += num_psums * maestro::DSE::cost::mac_energy_func(quantizationType);
+
+            std::vector<double> buffer_energy;
+            std::vector<long> buffer_size_req;
+            bool fits_buffers = true;
+            if(!configuration_->buffer_levels_.empty()) {
+                fits_buffers = SummarizeBufferHierarchy(layer_res, quantizationType, buffer_energy, buffer_size_req);
+                layer_L2_energy = buffer_energy.front();
+                layer_L1_energy = 0;
+                for(int level_idx = 1; level_idx < buffer_energy.size(); level_idx++) {
+                    layer_L1_energy += buffer_energy[level_idx];
+                }
+            }
+
+            //NoC energy expressed in nJ
+            layer_NoC_energy += (double)((l1_rd_input_count + l1_rd_weight_count + l1_rd_output_count) +
+                                         (l1_wr_input_count + l1_wr_weight_count + l1_wr_output_count) + reduction_traffic) *
+                                (double) maestro::getBitSize(quantizationType) *
+                                maestro::return_hop_number(quantizationType) *
+                                maestro::energy_cost_per_bit * 1e9;
+            /*
+             * NoC energy (TO BE COMPLETED)
+             * layer_NoC_energy += top_res->GetAvgBWReq() * top_res->GetRuntime() * BITWIDTH_OPERANDS * AVG_NUMBER_HOPS * ENERGY_COST_PER_BIT; // J
+             * with:
+             * - BITWIDTH_OPERANDS = depends on quantization
+             * - AVG_NUMBER_HOPS = 2 for 2 clusters, 3 for 3 clusters
+             * - ENERGY_COST_PER_BIT = 0.1143e-12; // J/bit/hop
+             */
+
+            // total energy
+            layer_energy = layer_MAC_energy + layer_L2_energy + layer_L1_energy + layer_NoC_energy;
+
+            long double layer_perf_per_energy = static_cast<long double>(num_psums) / static_cast<long double>(layer_runtime) /
+                                                static_cast<long double>(layer_energy);
+            layer_perf_per_energy *= 1000000000; //nW -> W
+
+            int noc_bw = configuration_->noc_bw_->at(0);
+            int vector_width = configuration_->simd_width_;
+
+            auto accelerator = std::make_shared<maestro::DSE::Accelerator>(
+                    num_pes, vector_width, noc_bw, l1_size, l2_size, quantizationType);
+            double area = accelerator->GetArea();
+            double power = accelerator->GetPower();
+
+            auto layer_dp = std::make_shared<maestro::DSE::DesignPoint>(
+                    maestro::DSE::OptimizationTarget::Runtime, layer_runtime, layer_energy,
+                    layer_perf_per_energy, area, power, num_pes, noc_bw, vector_width, l2_size, l1_size);
+
+            layer_dp->num_macs_ = num_psums;
+            layer_dp->mac_energy_ = layer_MAC_energy;
+            layer_dp->l1_energy_ = layer_L1_energy;
+            layer_dp->l2_energy_ = layer_L2_energy;
+            layer_dp->noc_energy_ = layer_NoC_energy;
+            layer_dp->buffer_energy_ = buffer_energy;
+            layer_dp->buffer_size_req_ = buffer_size_req;
+            layer_dp->fits_buffers_ = fits_buffers;
+
+            layer_dp->PutMulticastingFactor("input",
+                                            static_cast<double>(l2_to_l1_wr_input_count) / l2_rd_input_count);
+            layer_dp->PutMulticastingFactor("weight",
+                                            static_cast<double>(l2_to_l1_wr_weight_count) / l2_rd_weight_count);
+
+            return layer_dp;
+        }
+
+        std::shared_ptr<ConfigurationV2> GetConfiguration() {
+            return configuration_;
+        }
+
+        void SetAnalysisFidelity(CA::AnalysisFidelity fidelity) {
+            analysis_fidelity_ = fidelity;
+        }
+
+        void SetReductionMode(CA::ReductionMode reduction_mode) {
+            reduction_mode_ = reduction_mode;
+        }
+
+        // Keeps the iteration cases of the exact analysis for timeline export (see TimelineTrace)
+        void SetTimelineRecording(bool record_timeline) {
+            record_timeline_ = record_timeline;
+        }
+
+        // Tile buffers per tensor class of the layers without their own assignment
+        void SetTensorBuffering(CA::TensorBuffering buffering) {
+            buffering_ = buffering;
+        }
+
+        void SetLayerBuffering(int layer_id, CA::TensorBuffering buffering) {
+            layer_buffering_[layer_id] = buffering;
+        }
+
+        CA::TensorBuffering GetTensorBuffering(int layer_id) {
+            auto it = layer_buffering_.find(layer_id);
+            return (it == layer_buffering_.end()) ? buffering_ : it->second;
+        }
+
+        /*
+         * Picks the buffering of each tensor class of a layer (layer_id starts from 0) that minimizes its
+         * runtime while its L1 and L2 size requirements fit l1_size_ and l2_size_; ties go to the smaller
+         * footprint. If no assignment fits, the one that overflows the buffers the least is taken.
+         * The choice is kept for the layer.
+         */
+        CA::TensorBuffering OptimizeBuffering(int layer_id) {
+            auto layer_hw = configuration_->GetLayerHardwareView(configuration_->network_->at(layer_id)->getQuantization());
+
+            CA::TensorBuffering best_buffering;
+            long best_runtime = 0;
+            long best_overflow = 0;
+            long best_footprint = 0;
+            bool has_best = false;
+            for(int input_depth = 1; input_depth <= CA::max_buffering_depth; input_depth++) {
+                for(int weight_depth = 1; weight_depth <= CA::max_buffering_depth; weight_depth++) {
+                    for(int output_depth = 1; output_depth <= CA::max_buffering_depth; output_depth++) {
+                        CA::TensorBuffering buffering;
+                        buffering.SetDepth(DataClass::Input, input_depth);
+                        buffering.SetDepth(DataClass::Weight, weight_depth);
+                        buffering.SetDepth(DataClass::Output, output_depth);
+                        SetLayerBuffering(layer_id, buffering);
+
+                        auto layer_res = AnalyzeCostAllClusters(layer_id);
+                        auto upper_most_cluster_res = layer_res->at(layer_res->size() - 1);
+                        auto inner_most_cluster_res = layer_res->at(0);
+                        long l1_size_req = 0;
+                        long l2_size_req = 0;
+                        for(auto data_class : {DataClass::Input, DataClass::Weight, DataClass::Output}) {
+                            l1_size_req += inner_most_cluster_res->GetBufferSizeReq(CA::BufferType::Downstream, data_class);
+                            l2_size_req += upper_most_cluster_res->GetBufferSizeReq(CA::BufferType::Upstream, data_class);
+                        }
+
+                        long runtime = upper_most_cluster_res->GetRuntime();
+                        long overflow = std::max(l1_size_req - layer_hw.l1_size_, 0L) + std::max(l2_size_req - layer_hw.l2_size_, 0L);
+                        long footprint = l1_size_req + l2_size_req;
+                        bool is_better;
+                        if(!has_best || overflow != best_overflow) {
+                            is_better = !has_best || overflow < best_overflow;
+                        }
+                        else {
+                            is_better = runtime < best_runtime || (runtime == best_runtime && footprint < best_footprint);
+                        }
+
+                        if(is_better) {
+                            best_buffering = buffering;
+                            best_runtime = runtime;
+                            best_overflow = overflow;
+                            best_footprint = footprint;
+                            has_best = true;
+                        }
+                    }
+                }
+            }
+
+            SetLayerBuffering(layer_id, best_buffering);
+            return best_buffering;
+        }
+
+        // Analyzes the iteration cases within each layer with the given number of threads (0: serial)
+        void SetIntraLayerThreads(int num_threads) {
+            if(num_threads > 0) {
+                intra_layer_scheduler_ = std::make_shared<TL::TaskScheduler>(num_threads);
+            }
+            else {
+                intra_layer_scheduler_ = nullptr;
+            }
+        }
+
+        /*
+         * Analyzes one layer (layer_id starts from 0) and summarizes it; input_in_l2/output_in_l2 keep the
+         * input/output activations in L2 instead of moving them from/to off-chip memory (layer fusion)
+         */
+        std::shared_ptr<DSE::DesignPoint> AnalyzeLayer(int layer_id, bool input_in_l2 = false, bool output_in_l2 = false) {
+            return SummarizeLayer(layer_id, AnalyzeCostAllClusters(layer_id, false, false, input_in_l2, output_in_l2));
+        }
+
+        /*
+         * Analyzes every layer with both the exact engine and the roofline estimator and prints
+         * the relative error of the estimated runtime and energy
+         */
+        void ReportEstimationError() {
+            double sum_runtime_error = 0;
+            double sum_energy_error = 0;
+            double max_runtime_error = 0;
+            double max_energy_error = 0;
+            int num_compared_layers = 0;
+            auto original_fidelity = analysis_fidelity_;
+
+            std::cout << "Layer, Exact runtime, Roofline runtime, Runtime error (%), Exact energy, Roofline energy, Energy error (%)" << std::endl;
+            int layer_id = 0;
+            for(auto layer : *(configuration_->network_)) {
+                analysis_fidelity_ = CA::AnalysisFidelity::Exact;
+                auto exact_dp = SummarizeLayer(layer_id, AnalyzeCostAllClusters(layer_id));
+                analysis_fidelity_ = CA::AnalysisFidelity::Roofline;
+                auto roofline_dp = SummarizeLayer(layer_id, AnalyzeCostAllClusters(layer_id));
+
+                double runtime_error = GetRelativeError(roofline_dp->runtime_, exact_dp->runtime_);
+                double energy_error = GetRelativeError(roofline_dp->energy_, exact_dp->energy_);
+
+                std::cout << layer->GetName() << ", " << exact_dp->runtime_ << ", " << roofline_dp->runtime_ << ", "
+                          << 100 * runtime_error << ", " << exact_dp->energy_ << ", " << roofline_dp->energy_ << ", "
+                          << 100 * energy_error << std::endl;
+                layer_id++;
+
+                // A zero exact runtime means the exact analysis could not handle the mapping; nothing to compare against
+                if(exact_dp->runtime_ <= 0) {
+                    continue;
+                }
+                sum_runtime_error += std::abs(runtime_error);
+                sum_energy_error += std::abs(energy_error);
+                max_runtime_error = std::max(max_runtime_error, std::abs(runtime_error));
+                max_energy_error = std::max(max_energy_error, std::abs(energy_error));
+                num_compared_layers++;
+            }
+            analysis_fidelity_ = original_fidelity;
+
+            int num_layers = std::max(num_compared_layers, 1);
+            std::cout << "Roofline estimation error over " << num_compared_layers << " layers: runtime "
+                      << 100 * sum_runtime_error / num_layers << "% mean, " << 100 * max_runtime_error << "% max; energy "
+                      << 100 * sum_energy_error / num_layers << "% mean, " << 100 * max_energy_error << "% max" << std::endl;
+        }
+
 
     protected:
         std::shared_ptr<ConfigurationV2> configuration_;
         std::unique_ptr<std::map<LayerType, int>> tensor_info_mapping_table_;
+        // Tensor table (index into configuration_->tensors_) of each layer
+        std::vector<int> layer_tensor_info_idx_;
         long num_macs_;
+        CA::AnalysisFidelity analysis_fidelity_ = CA::AnalysisFidelity::Exact;
+        std::shared_ptr<TL::TaskScheduler> intra_layer_scheduler_ = nullptr;
+        CA::ReductionMode reduction_mode_ = CA::ReductionMode::Implicit;
+        CA::TensorBuffering buffering_;
+        std::map<int, CA::TensorBuffering> layer_buffering_;
+        bool record_timeline_ = false;
 
 
     private:
 
+        static double GetRelativeError(double estimate, double reference) {
+            if(reference == 0) {
+                return (estimate == 0) ? 0 : 1;
+            }
+            return (estimate - reference) / reference;
+        }
+
         void ParseDFSL(){
             DFSL::DFSLParser dfsl_parser(configuration_->dfsl_file_name_);
             dfsl_parser.ParseDFSL(configuration_->network_);
 
-            message_printer->PrintMsg(1, "Parsing finished");
-            message_printer->PrintMsg(1, "Network name:" + configuration_->network_->GetName());
+            message_printer_->PrintMsg(1, "Parsing finished");
+            message_printer_->PrintMsg(1, "Network name:" + configuration_->network_->GetName());
 
             for(auto& layer: *(configuration_->network_)) {
-                message_printer->PrintMsg(1, layer->ToString());
+                message_printer_->PrintMsg(1, layer->ToString());
             }
         }
 
@@ -206,6 +644,9 @@ namespace maestro {
                 configuration_->l2_size_ = ret->l2_size_;
                 configuration_->l2_byte_size_ = ret->l2_size_;
                 configuration_->offchip_bw_= ret->off_chip_bw_;
+                configuration_->dram_config_ = ret->dram_config_;
+                configuration_->noc_topologies_ = ret->noc_topologies_;
+                configuration_->buffer_levels_ = ret->buffer_levels_;
                 configuration_->noc_bw_->at(0) = ret->noc_bw_;
                 configuration_->noc_bw_->at(1) = ret->noc_bw_;
                 configuration_->noc_bw_->at(2) = ret->noc_bw_;
@@ -221,11 +662,11 @@ namespace maestro {
             configuration_->network_->SetName("Marvel-CONV");
             configuration_->network_->AddLayer(layer);
 
-            message_printer->PrintMsg(1, "Adding layer is finished");
-            message_printer->PrintMsg(1, "Network name:" + configuration_->network_->GetName());
+            message_printer_->PrintMsg(1, "Adding layer is finished");
+            message_printer_->PrintMsg(1, "Network name:" + configuration_->network_->GetName());
 
             for(auto& layer: *(configuration_->network_)) {
-                message_printer->PrintMsg(1, layer->ToString());
+                message_printer_->PrintMsg(1, layer->ToString());
             }
         }
 
@@ -239,6 +680,12 @@ namespace maestro {
             return ret;
         }
 
+        void ConfigEinsumOverlapDimensions(std::shared_ptr<DFA::Layer> layer, std::shared_ptr<DFA::DimensionTable> target_dim_table){
+            for(auto& it : DFA::GetSlidingWindows(layer)) {
+                target_dim_table->AddOverlapDimension(it.first, it.second);
+            }
+        }
+
         void ConfigConvOverlapDimensions(std::shared_ptr<DFA::DimensionTable> target_dim_table){
             std::shared_ptr<std::list<std::shared_ptr<std::pair<std::string, std::string>>>> overlap_dim_list = std::make_shared<std::list<std::shared_ptr<std::pair<std::string, std::string>>>>();
             auto output_column_overlap = std::make_shared<std::pair<std::string, std::string>>("X", "S");
@@ -251,60 +698,9 @@ namespace maestro {
 
         int ConfigConvTensors(LayerType layer_type, bool batch_processing = false){
             /* Construct the convolution problem */
-            std::list<std::string> input_coupled_vars;
-            std::list<std::string> weight_coupled_vars;
-            std::list<std::string> output_coupled_vars;
-
-
-            switch(layer_type) {
-                case (LayerType::DSCONV): {
-                    if(batch_processing) {
-                        input_coupled_vars =  {"N", "C", "Y", "X"};
-                        weight_coupled_vars = {"C", "R", "S"};
-                        output_coupled_vars = {"N", "C", "Y", "X"};
-                    }
-                    else {
-                        input_coupled_vars =  {"C", "Y", "X"};
-                        weight_coupled_vars = {"C", "R", "S"};
-                        output_coupled_vars = {"C", "Y", "X"};
-                    }
-                    break;
-                }
-                case (LayerType::NGCONV): {
-                    if(batch_processing) {
-                        input_coupled_vars =  {"N", "G", "C", "Y", "X"};
-                        weight_coupled_vars = {"G", "K", "C", "R", "S"};
-                        output_coupled_vars = {"N", "G", "K", "C", "Y", "X"};
-                    }
-                    else {
-                        input_coupled_vars =  {"G", "C", "Y", "X"};
-                        weight_coupled_vars = {"G", "K", "C", "R", "S"};
-                        output_coupled_vars = {"G", "K", "C", "Y", "X"};
-                    }
-                    break;
-                }
-                case (LayerType::GEMM): {
-                    input_coupled_vars =  {"M", "K"};
-                    weight_coupled_vars = {"K", "N"};
-                    output_coupled_vars = {"M", "N"};
-                    break;
-                }
-                case (LayerType::CONV):
-                default : {
-                    if(batch_processing) {
-                        input_coupled_vars =  {"N", "C", "Y", "X"};
-                        weight_coupled_vars = {"K", "C", "R", "S"};
-                        output_coupled_vars = {"N", "K", "Y", "X"};
-                    }
-                    else {
-                        input_coupled_vars =  {"C", "Y", "X"};
-                        weight_coupled_vars = {"K", "C", "R", "S"};
-                        output_coupled_vars = {"K", "Y", "X"};
-                    }
-                }
-
-            }
-
+            std::list<std::string> input_coupled_vars = DFA::GetCoupledVariables(layer_type, DataClass::Input, batch_processing);
+            std::list<std::string> weight_coupled_vars = DFA::GetCoupledVariables(layer_type, DataClass::Weight, batch_processing);
+            std::list<std::string> output_coupled_vars = DFA::GetCoupledVariables(layer_type, DataClass::Output, batch_processing);
 
             auto conv_tensor_table = std::make_shared<DFA::TensorTable>();
 
@@ -321,6 +717,19 @@ namespace maestro {
             return configuration_->tensors_->size()-1;
         }
 
+        // EINSUM layers get their own tensor table; their coupling is not determined by the layer type
+        int ConfigEinsumTensors(std::shared_ptr<DFA::Layer> layer){
+            auto einsum_tensor_table = std::make_shared<DFA::TensorTable>();
+
+            einsum_tensor_table->AddTensor(ConstructTensor("input", DFA::TensorClass::InputTensor, DataClass::Input, DFA::GetCoupledVariables(layer, DataClass::Input)));
+            einsum_tensor_table->AddTensor(ConstructTensor("filter", DFA::TensorClass::InputTensor, DataClass::Weight, DFA::GetCoupledVariables(layer, DataClass::Weight)));
+            einsum_tensor_table->AddTensor(ConstructTensor("output", DFA::TensorClass::OutputTensor, DataClass::Output, DFA::GetCoupledVariables(layer, DataClass::Output)));
+
+            configuration_->tensors_->push_back(einsum_tensor_table);
+
+            return configuration_->tensors_->size()-1;
+        }
+
         std::shared_ptr<DFA::Tensor> ConstructTensor(std::string tensor_name, DFA::TensorClass tensor_class, DataClass data_class,
                                                      std::list<std::string> coupled_var_list) {
 
@@ -419,7 +828,9 @@ namespace maestro {
                     }
                     break;
                 }
-                case (LayerType::GEMM) : {
+                case (LayerType::GEMM) :
+
+                case (LayerType::EINSUM) : {
                     for(auto dim : *dimensions) {
                         auto dimtbl_entry = std::make_shared<DFA::LayerDimension>(dim->GetName(), dim->GetSize(), dim->GetOuterStride(), dim->GetInnerStride());
                         dimension_table->AddDimension(dimtbl_entry);
@@ -446,8 +857,26 @@ namespace maestro {
             assert(noc_levels == configuration_->noc_latency_->size());
             assert(noc_levels == configuration_->noc_multcast_->size());
 
+            // Deeper cluster hierarchies than the given NoC levels reuse the outermost one
+            int num_needed_levels = noc_levels;
+            for(auto layer : *(configuration_->network_)) {
+                int num_cluster_directives = 0;
+                for(auto& directive : *layer->GetDataflow()) {
+                    if(directive->GetClass() == DFA::directive::DirectiveClass::Cluster) {
+                        num_cluster_directives++;
+                    }
+                }
+                num_needed_levels = std::max(num_needed_levels, num_cluster_directives + 1);
+            }
+            for(; noc_levels > 0 && noc_levels < num_needed_levels; noc_levels++) {
+                configuration_->noc_bw_->push_back(configuration_->noc_bw_->back());
+                configuration_->noc_latency_->push_back(configuration_->noc_latency_->back());
+                configuration_->noc_multcast_->push_back(configuration_->noc_multcast_->back());
+            }
+
             for(int noc_lv = 0; noc_lv < noc_levels; noc_lv++) {
-                auto noc = std::make_shared<maestro::AHW::NetworkOnChipModel>(
+                auto noc = AHW::CreateNoCModel(
+                        configuration_->GetNoCTopology(noc_lv),
                         configuration_->noc_bw_->at(noc_lv),
                         1,
                         configuration_->noc_latency_->at(noc_lv),
@@ -460,13 +889,10 @@ namespace maestro {
 
         void AnalyzeClusters() {
             int layer_id = -1;
+            layer_tensor_info_idx_.clear();
             for(auto layer: *(configuration_->network_)) {
 
-                auto quantizationType = layer->getQuantization();
-                configuration_->num_pes_ = configuration_->num_pes_file_ * quantizationFactor(quantizationType);
-                configuration_->l1_size_ = (int) (configuration_->l1_byte_size_ * 8 / maestro::getBitSize(quantizationType));
-                configuration_->l2_size_ = (int) (configuration_->l2_byte_size_ * 8 / maestro::getBitSize(quantizationType));
-                // configuration_->l1_size_ = configuration_->l1_size_file_ / quantizationFactor(quantizationType);
+                auto layer_hw = configuration_->GetLayerHardwareView(layer->getQuantization());
 
                 layer_id++;
                 auto dataflow = layer->GetDataflow();
@@ -511,6 +937,11 @@ namespace maestro {
                         }
                         break;
                     }
+                    case (LayerType::EINSUM): {
+                        ConfigEinsumOverlapDimensions(layer, dimension_table);
+                        tensor_info_idx = ConfigEinsumTensors(layer);
+                        break;
+                    }
                     default: {
                         //TODO: Add generic/custom dimension table construction
                         //              dimension_table->AddOverlapDimensions(overlap_dim_list);
@@ -524,8 +955,10 @@ namespace maestro {
                 message_printer_->PrintMsg(1, print_msg_0);
                 message_printer_->PrintMsg(1, print_msg_1);
 
+                layer_tensor_info_idx_.push_back(tensor_info_idx);
+
                 auto cluster_analysis = std::make_shared<DFA::ClusterAnalysis>(
-                        layer_type, configuration_->num_pes_, configuration_->tensors_->at(tensor_info_idx),
+                        layer_type, layer_hw.num_pes_, configuration_->tensors_->at(tensor_info_idx),
                         dimension_table, dataflow, configuration_->nocs_);
 
                 configuration_->cluster_analysis_->push_back(cluster_analysis);
@@ -534,14 +967,37 @@ namespace maestro {
             message_printer_->PrintMsg(1, "Cluster construction and analysis is done");
         }
 
-        std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> AnalyzeCostAllClusters(int layer_id, bool print_results = false, bool write_log_file = false) {
+        std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>> AnalyzeCostAllClusters(
+                int layer_id, bool print_results = false, bool write_log_file = false,
+                bool input_in_l2 = false, bool output_in_l2 = false) {
             auto target_cluster_analysis = configuration_->cluster_analysis_->at(layer_id);
             auto clusters = target_cluster_analysis->GetClusters();
-            auto layer_type = clusters->GetLayerType();
-            int tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
+            int tensor_info_idx = layer_tensor_info_idx_.at(layer_id);
+            auto layer = configuration_->network_->at(layer_id);
+            int element_bit_size = getBitSize(layer->getQuantization());
+
+            if(analysis_fidelity_ == CA::AnalysisFidelity::Roofline) {
+                auto roofline_analysis = std::make_unique<CA::RooflineAnalysisEngine>
+                        (configuration_, configuration_->tensors_->at(tensor_info_idx), clusters);
+                roofline_analysis->SetL2Resident(DataClass::Input, input_in_l2);
+                roofline_analysis->SetL2Resident(DataClass::Output, output_in_l2);
+                roofline_analysis->SetElementBitSize(element_bit_size);
+                roofline_analysis->SetReductionMode(reduction_mode_);
+                roofline_analysis->SetTensorBuffering(GetTensorBuffering(layer_id));
+                roofline_analysis->SetSparsity(layer->GetSparsity(), element_bit_size);
+                return roofline_analysis->AnalyzeEntireCluster(write_log_file);
+            }
 
             auto perf_analysis = std::make_unique<CA::CostAnalysisEngine>
                     (configuration_, configuration_->tensors_->at(tensor_info_idx), clusters);
+            perf_analysis->SetTaskScheduler(intra_layer_scheduler_);
+            perf_analysis->SetL2Resident(DataClass::Input, input_in_l2);
+            perf_analysis->SetL2Resident(DataClass::Output, output_in_l2);
+            perf_analysis->SetElementBitSize(element_bit_size);
+            perf_analysis->SetReductionMode(reduction_mode_);
+            perf_analysis->SetTensorBuffering(GetTensorBuffering(layer_id));
+            perf_analysis->SetSparsity(layer->GetSparsity(), element_bit_size);
+            perf_analysis->SetTimelineRecording(record_timeline_);
 
             auto results = perf_analysis->AnalyzeEntireCluster(write_log_file);
             return results;
@@ -563,254 +1019,30 @@ namespace maestro {
         void OutputResults(std::shared_ptr<std::vector<std::shared_ptr<std::vector<std::shared_ptr<CA::CostAnalysisResults>>>>> analysis_result) {
             auto csv_writer = std::make_shared<maestro::DSE::CSVWriter>(configuration_, ConstructOutputFileName());
 
-            long total_runtime = 0;
-
-            long l2_rd_input_count = 0;
-            long l2_rd_weight_count = 0;
-            long l2_rd_output_count = 0;
-
-            long l2_wr_input_count = 0;
-            long l2_wr_weight_count = 0;
-            long l2_wr_output_count = 0;
-
-            long l2_to_l1_wr_input_count = 0;
-            long l2_to_l1_wr_weight_count = 0;
-
-            long l1_rd_input_count = 0;
-            long l1_rd_weight_count = 0;
-            long l1_rd_output_count = 0;
-
-            long l1_wr_input_count = 0;
-            long l1_wr_weight_count = 0;
-            long l1_wr_output_count = 0;
-
-            int num_top_clusters = 0;
-            int num_bottom_clusters = 0;
-
             int layer_id = 1;
             long max_noc_bw_req = 0;
             long max_offchip_bw_req = 0;
             for(auto& layer_res : *analysis_result) {
-
                 auto quantizationType = configuration_->network_->at(layer_id - 1)->getQuantization();
-                configuration_->num_pes_ = configuration_->num_pes_file_ * quantizationFactor(quantizationType);
-                configuration_->l1_size_ = (int) (configuration_->l1_byte_size_ * 8 / maestro::getBitSize(quantizationType));
-                configuration_->l2_size_ = (int) (configuration_->l2_byte_size_ * 8 / maestro::getBitSize(quantizationType));
-                // configuration_->l1_size_ = configuration_->l1_size_file_ / quantizationFactor(quantizationType);
-
-                LayerType layer_type;
-                int cluster_lv = 0;
-                long layer_runtime = 0;
-
-                double layer_energy = 0;
-                double layer_MAC_energy = 0;
-                double layer_L1_energy = 0;
-                double layer_L2_energy = 0;
-                double layer_NoC_energy = 0;
-
-                long double layer_perf_per_energy;
-                double area;
-                double power;
-                int num_pes = configuration_->num_pes_;
-                int noc_bw;
-                int vector_width;
-                int l2_size = 0;
-                int l1_size = 0;
-                long num_psums = 0;
-                long num_macs_top = 0;
-
-                long num_iters = GetTempIterOverInnermostCluster(layer_id);
-                std::shared_ptr<maestro::CA::CostAnalysisResults> top_res;
                 std::string layer_name = configuration_->network_->at(layer_id - 1)->GetName();
 
-                for (auto &cluster_res: *layer_res) {
-                    layer_type = cluster_res->GetLayerType();
-                    top_res = cluster_res;
-
-                    if (cluster_lv == layer_res->size() - 1) {
-                        total_runtime += cluster_res->GetRuntime();
-                        l2_rd_input_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Upstream,
-                                                                              maestro::CA::BufferAccessType::Read,
-                                                                              maestro::DataClass::Input)/
-                                            quantizationFactor(quantizationType);
-                        l2_rd_weight_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Upstream,
-                                                                               maestro::CA::BufferAccessType::Read,
-                                                                               maestro::DataClass::Weight)/
-                                             quantizationFactor(quantizationType);
-                        l2_rd_output_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Upstream,
-                                                                               maestro::CA::BufferAccessType::Read,
-                                                                               maestro::DataClass::Output)/
-                                             quantizationFactor(quantizationType);
-                        l2_wr_input_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Upstream,
-                                                                              maestro::CA::BufferAccessType::Write,
-                                                                              maestro::DataClass::Input)/
-                                            quantizationFactor(quantizationType);
-                        l2_wr_weight_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Upstream,
-                                                                               maestro::CA::BufferAccessType::Write,
-                                                                               maestro::DataClass::Weight)/
-                                             quantizationFactor(quantizationType);
-                        l2_wr_output_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Upstream,
-                                                                               maestro::CA::BufferAccessType::Write,
-                                                                               maestro::DataClass::Output)/
-                                             quantizationFactor(quantizationType);
-
-                        long num_sub_clusters = cluster_res->GetNumSubClusters();
-                        num_top_clusters = num_sub_clusters;
-                        /*
-                        l2_to_l1_rd_input_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream, maestro::CA::BufferAccessType::Read, maestro::DataClass::Input) * num_sub_clusters - l2_rd_input_count;
-                        l2_to_l1_rd_weight_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream, maestro::CA::BufferAccessType::Read, maestro::DataClass::Weight) * num_sub_clusters - l2_rd_weight_count;
-                        */
-                        l2_to_l1_wr_input_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                                    maestro::CA::BufferAccessType::Write,
-                                                                                    maestro::DataClass::Input);
-                        l2_to_l1_wr_weight_count = cluster_res->GetBufferAccessCount(
-                                maestro::CA::BufferType::Downstream, maestro::CA::BufferAccessType::Write,
-                                maestro::DataClass::Weight);
-
-                        layer_runtime = cluster_res->GetRuntime();
-
-                        l2_size += cluster_res->GetBufferSizeReq(maestro::CA::BufferType::Upstream,
-                                                                 maestro::DataClass::Input);
-                        l2_size += cluster_res->GetBufferSizeReq(maestro::CA::BufferType::Upstream,
-                                                                 maestro::DataClass::Output);
-                        l2_size += cluster_res->GetBufferSizeReq(maestro::CA::BufferType::Upstream,
-                                                                 maestro::DataClass::Weight);
-
-                        layer_L2_energy += (l2_rd_weight_count + l2_rd_input_count +l2_rd_output_count) * maestro::getMemoryEnergyMultiplier(l2_size, quantizationType, maestro::Operation::Read);
-                        layer_L2_energy += (l2_wr_input_count + l2_wr_weight_count + l2_wr_output_count) * maestro::getMemoryEnergyMultiplier(l2_size, quantizationType, maestro::Operation::Write);
-
-                        num_psums = cluster_res->GetNumComputations();
-
-                        num_macs_top = cluster_res->GetTopNumComputations();
-
-                        l1_rd_input_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                              maestro::CA::BufferAccessType::Read,
-                                                                              maestro::DataClass::Input) /
-                                            quantizationFactor(quantizationType);
-
-                        l1_rd_weight_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                               maestro::CA::BufferAccessType::Read,
-                                                                               maestro::DataClass::Weight) /
-                                             quantizationFactor(quantizationType);
-                        l1_rd_output_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                               maestro::CA::BufferAccessType::Read,
-                                                                               maestro::DataClass::Output)/
-                                             quantizationFactor(quantizationType);
-                        l1_wr_input_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                              maestro::CA::BufferAccessType::Write,
-                                                                              maestro::DataClass::Input)/
-                                            quantizationFactor(quantizationType);
-                        l1_wr_weight_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                               maestro::CA::BufferAccessType::Write,
-                                                                               maestro::DataClass::Weight)/
-                                             quantizationFactor(quantizationType);
-                        l1_wr_output_count = cluster_res->GetBufferAccessCount(maestro::CA::BufferType::Downstream,
-                                                                               maestro::CA::BufferAccessType::Write,
-                                                                               maestro::DataClass::Output)/
-                                             quantizationFactor(quantizationType);
-
-                        layer_L1_energy += (l1_rd_input_count + l1_rd_weight_count + l1_rd_output_count) * maestro::getMemoryEnergyMultiplier(l1_size, quantizationType, maestro::Operation::Read);
-                        layer_L1_energy += (l1_wr_input_count + l1_wr_weight_count + l1_wr_output_count) * maestro::getMemoryEnergyMultiplier(l1_size, quantizationType, maestro::Operation::Write);
-                    }
-                    if (cluster_lv == 0) {
-
-                        long num_sub_clusters = cluster_res->GetNumSubClusters();
-                        long num_cur_clusters = num_pes / num_sub_clusters;
-                        num_bottom_clusters = num_cur_clusters;
-
-                        l1_size += cluster_res->GetBufferSizeReq(maestro::CA::BufferType::Downstream,
-                                                                 maestro::DataClass::Input);
-                        l1_size += cluster_res->GetBufferSizeReq(maestro::CA::BufferType::Downstream,
-                                                                 maestro::DataClass::Output);
-                        l1_size += cluster_res->GetBufferSizeReq(maestro::CA::BufferType::Downstream,
-                                                                 maestro::DataClass::Weight);
-                    }
-                    cluster_lv++;
-                }
+                auto layer_dp = SummarizeLayer(layer_id - 1, layer_res);
+                auto top_res = layer_res->at(layer_res->size() - 1);
 
-                layer_MAC_energy += num_psums * maestro::DSE::cost::mac_energy_func(quantizationType);
-
-
-                //NoC energy expressed in nJ
-                layer_NoC_energy += (double)((l1_rd_input_count + l1_rd_weight_count + l1_rd_output_count) +
-                        (l1_wr_input_count + l1_wr_weight_count + l1_wr_output_count)) *
-                                    (double) maestro::getBitSize(quantizationType) *
-                                    maestro::return_hop_number(quantizationType) *
-                                    maestro::energy_cost_per_bit * 1e9;
-                /*
-                 * NoC energy (TO BE COMPLETED)
-                 * layer_NoC_energy += top_res->GetAvgBWReq() * top_res->GetRuntime() * BITWIDTH_OPERANDS * AVG_NUMBER_HOPS * ENERGY_COST_PER_BIT; // J
-                 * with:
-                 * - BITWIDTH_OPERANDS = depends on quantization
-                 * - AVG_NUMBER_HOPS = 2 for 2 clusters, 3 for 3 clusters
-                 * - ENERGY_COST_PER_BIT = 0.1143e-12; // J/bit/hop
-                 */
-
-                // total energy
-                layer_energy = layer_MAC_energy + layer_L2_energy + layer_L1_energy + layer_NoC_energy;
-
-
-                layer_perf_per_energy = static_cast<long double>(num_psums) / static_cast<long double>(layer_runtime) /
-                                        static_cast<long double>(layer_energy);
-
-                layer_perf_per_energy *= 1000000000; //nW -> W
-
-                num_pes = configuration_->num_pes_;
-                noc_bw = configuration_->noc_bw_->at(0);
-                vector_width = configuration_->simd_width_;
-
-                int tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
+                int tensor_info_idx = layer_tensor_info_idx_.at(layer_id - 1);
 
                 long input_tensor_size = GetTensorSize(layer_id - 1, maestro::DataClass::Input, tensor_info_idx);
                 long weight_tensor_size = GetTensorSize(layer_id - 1, maestro::DataClass::Weight, tensor_info_idx);
 
-                std::shared_ptr<maestro::DSE::Accelerator> accelerator = std::make_shared<maestro::DSE::Accelerator>(
-                        num_pes, vector_width, noc_bw, l1_size, l2_size, quantizationType);
-                area = accelerator->GetArea();
-                power = accelerator->GetPower();
-
-                long double ops_per_joule = num_psums / layer_energy * 1000000000; //nJ -> J
-
-
-                auto layer_dp = std::make_shared<maestro::DSE::DesignPoint>(
-                        maestro::DSE::OptimizationTarget::Runtime, layer_runtime, layer_energy,
-                        layer_perf_per_energy, area, power, num_pes, noc_bw, vector_width, l2_size, l1_size);
-
-
-                int num_active_pes = configuration_->cluster_analysis_->at(layer_id - 1)->GetNumActivePEs();
-                int num_innermost_unit_clusters = configuration_->cluster_analysis_->at(
-                        layer_id - 1)->GetInnermostClusterSize();
-
-                int l1_mult = num_innermost_unit_clusters;
-                assert(l1_mult != 0);
-
-                layer_dp->PutMulticastingFactor("input",
-                                                static_cast<double>(l2_to_l1_wr_input_count) / l2_rd_input_count);
-                layer_dp->PutMulticastingFactor("weight",
-                                                static_cast<double>(l2_to_l1_wr_weight_count) / l2_rd_weight_count);
-
-                double pe_power = accelerator->GetPEPower();
-                double l1_power = accelerator->GetL1Power();
-                double l2_power = accelerator->GetL2Power();
-                double noc_power = accelerator->GetNoCPower();
-                /*
-                ingress_delay_[static_cast<int>(CA::ValueType::Min)] = cluster_res->GetDelay(CA::DelayType::Ingress, CA::ValueType::Min);
-                ingress_delay_[static_cast<int>(CA::ValueType::Max)] = cluster_res->GetDelay(CA::DelayType::Ingress, CA::ValueType::Max);
-
-                egress_delay_[static_cast<int>(CA::ValueType::Min)] = cluster_res->GetDelay(CA::DelayType::Egress, CA::ValueType::Min);
-                egress_delay_[static_cast<int>(CA::ValueType::Max)] = cluster_res->GetDelay(CA::DelayType::Egress, CA::ValueType::Max);
-
-                compute_delay_[static_cast<int>(CA::ValueType::Min)] = cluster_res->GetDelay(CA::DelayType::Computation, CA::ValueType::Min);
-                compute_delay_[static_cast<int>(CA::ValueType::Max)] = cluster_res->GetDelay(CA::DelayType::Computation, CA::ValueType::Max);
-                */
+                long double ops_per_joule = layer_dp->num_macs_ / layer_dp->energy_ * 1000000000; //nJ -> J
 
                 /*
                  * LF: implement a function which includes the printout of the energy components
                  */
 
                 csv_writer->WriteDesignPoint(configuration_, tensor_info_idx, layer_dp, GetNetworkName(), layer_name,
-                                             num_psums, input_tensor_size, weight_tensor_size, ops_per_joule, layer_MAC_energy,
-                                             layer_L1_energy, layer_L2_energy, layer_NoC_energy, top_res, quantizationType);
+                                             layer_dp->num_macs_, input_tensor_size, weight_tensor_size, ops_per_joule, layer_dp->mac_energy_,
+                                             layer_dp->l1_energy_, layer_dp->l2_energy_, layer_dp->noc_energy_, top_res, quantizationType);
 
                 if (top_res->GetPeakBWReq() > max_noc_bw_req) {
                     max_noc_bw_req = top_res->GetPeakBWReq();
@@ -841,7 +1073,8 @@ namespace maestro {
         }
 
 
-        void PrintAnalysisResultsSingleCluster(std::shared_ptr<CA::CostAnalysisResults> results, std::shared_ptr<CA::CostAnalysisResults> inner_results) {
+        void PrintAnalysisResultsSingleCluster(std::shared_ptr<CA::CostAnalysisResults> results, std::shared_ptr<CA::CostAnalysisResults> inner_results,
+                                               int tensor_info_idx) {
             std::cout << std::endl;
             std::cout << std::endl;
 
@@ -881,9 +1114,6 @@ namespace maestro {
             long total_l2_size = 0;
             //==========
 
-            auto layer_type = results->GetLayerType();
-            int tensor_info_idx = (*tensor_info_mapping_table_)[layer_type];
-
             for(auto tensor : *(configuration_->tensors_->at(tensor_info_idx))) {
                 auto dataclass = tensor->GetDataClass();
 
@@ -986,6 +1216,14 @@ namespace maestro {
             std::cout << "Max: " << results->GetDelay(CA::DelayType::Computation, CA::ValueType::Max) << std::endl;
             std::cout << "Avg: " << results->GetDelay(CA::DelayType::Computation, CA::ValueType::Avg) << std::endl;
 
+            if(reduction_mode_ != CA::ReductionMode::Implicit) {
+                std::cout << "Reduction Delay" << std::endl;
+                std::cout << "Min: " << results->GetDelay(CA::DelayType::Reduction, CA::ValueType::Min) << std::endl;
+                std::cout << "Max: " << results->GetDelay(CA::DelayType::Reduction, CA::ValueType::Max) << std::endl;
+                std::cout << "Avg: " << results->GetDelay(CA::DelayType::Reduction, CA::ValueType::Avg) << std::endl;
+                std::cout << "Reduction tree traffic (all cluster levels): " << results->GetReductionTraffic() << " partial sums" << std::endl;
+            }
+
             std::cout << "Average number of utilized PEs: " << results->GetNumAvgActiveClusters() << std::endl;
             std::cout << "Arithmetic intensity: " << results->GetArithmeticIntensity() << std::endl;
 
@@ -1010,8 +1248,7 @@ namespace maestro {
                 case LayerQuantizationType::INT2:
                     return 16;
                 default:
-                    std::cerr << "Unsupported quantization type" << std::endl;
-                    exit(EXIT_FAILURE);
+                    throw std::invalid_argument("Unsupported quantization type");
             }
         }
     }; // End of class API
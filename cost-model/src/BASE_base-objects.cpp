@@ -23,15 +23,42 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "TL_error-handler.hpp"
 #include "TL_message-printer.hpp"
+#include "BASE_base-objects.hpp"
 
 namespace maestro {
 
-    //Singleton objects for common functionalities
-    std::shared_ptr<TL::ErrorHandler> error_handler;
-    std::shared_ptr<TL::MessagePrinter> message_printer;
+    //Process-wide default objects for common functionalities
+    std::shared_ptr<TL::ErrorHandler> error_handler = std::make_shared<TL::ErrorHandler>();
+    std::shared_ptr<TL::MessagePrinter> message_printer = std::make_shared<TL::MessagePrinter>(0);
 
-    void InitializeBaseObjects(int print_lv = 0) {
+    //Objects of the session running on this thread (see BaseObjectScope); nullptr falls back to the defaults
+    thread_local std::shared_ptr<TL::ErrorHandler> session_error_handler = nullptr;
+    thread_local std::shared_ptr<TL::MessagePrinter> session_message_printer = nullptr;
+
+    void InitializeBaseObjects(int print_lv) {
         error_handler = std::make_shared<TL::ErrorHandler>();
         message_printer = std::make_shared<TL::MessagePrinter>(print_lv);
     }
+
+    std::shared_ptr<TL::ErrorHandler> GetErrorHandler() {
+        return (session_error_handler != nullptr) ? session_error_handler : error_handler;
+    }
+
+    std::shared_ptr<TL::MessagePrinter> GetMessagePrinter() {
+        return (session_message_printer != nullptr) ? session_message_printer : message_printer;
+    }
+
+    BaseObjectScope::BaseObjectScope(
+            std::shared_ptr<TL::ErrorHandler> session_error_handler_in,
+            std::shared_ptr<TL::MessagePrinter> session_message_printer_in) :
+            prev_error_handler_(session_error_handler),
+            prev_message_printer_(session_message_printer) {
+        session_error_handler = session_error_handler_in;
+        session_message_printer = session_message_printer_in;
+    }
+
+    BaseObjectScope::~BaseObjectScope() {
+        session_error_handler = prev_error_handler_;
+        session_message_printer = prev_message_printer_;
+    }
 };
@@ -0,0 +1,64 @@
+// One Transformer encoder attention block with the attention matmuls in their natural form (EINSUM layers),
+// instead of one CONV layer per head as in Transformer_Complete.m
+// Indices: M/N query/key positions, H heads, D head size, C model size, K projection size
+Constant Seq_Len 128;
+
+Network Transformer_Attention {
+	Layer MH_FC_VKQ {
+		Type: EINSUM
+		Einsum { MC, CK -> MK }
+		Dimensions { M: Seq_Len, C: 512, K: 1536 }
+		Dataflow {
+			SpatialMap(1,1) K;
+			TemporalMap(16,16) M;
+			TemporalMap(Sz(C),Sz(C)) C;
+			Cluster(16, P);
+			SpatialMap(1,1) M;
+			TemporalMap(Sz(C),Sz(C)) C;
+		}
+	}
+
+	Layer SD_MatMul_QK {
+		Type: EINSUM
+		Einsum { HMD, HND -> HMN }
+		Dimensions { H: 8, M: Seq_Len, N: Seq_Len, D: 64 }
+		Dataflow {
+			TemporalMap(1,1) H;
+			SpatialMap(1,1) M;
+			TemporalMap(16,16) N;
+			TemporalMap(Sz(D),Sz(D)) D;
+			Cluster(16, P);
+			SpatialMap(1,1) N;
+			TemporalMap(Sz(D),Sz(D)) D;
+		}
+	}
+
+	Layer SD_MatMul_V {
+		Type: EINSUM
+		Einsum { HMN, HND -> HMD }
+		Dimensions { H: 8, M: Seq_Len, N: Seq_Len, D: 64 }
+		Dataflow {
+			TemporalMap(1,1) H;
+			SpatialMap(1,1) M;
+			TemporalMap(16,16) D;
+			TemporalMap(Sz(N),Sz(N)) N;
+			Cluster(16, P);
+			SpatialMap(1,1) D;
+			TemporalMap(Sz(N),Sz(N)) N;
+		}
+	}
+
+	Layer MH_FC_Out {
+		Type: EINSUM
+		Einsum { MC, CK -> MK }
+		Dimensions { M: Seq_Len, C: 512, K: 512 }
+		Dataflow {
+			SpatialMap(1,1) K;
+			TemporalMap(16,16) M;
+			TemporalMap(Sz(C),Sz(C)) C;
+			Cluster(16, P);
+			SpatialMap(1,1) M;
+			TemporalMap(Sz(C),Sz(C)) C;
+		}
+	}
+}
@@ -21,7 +21,9 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 
 #include <iostream>
+#include <sstream>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "BASE_base-objects.hpp"
@@ -29,9 +31,74 @@ Author : Hyoukjun Kwon (hyoukjun@gatech.edu)
 
 #include "API_configuration.hpp"
 #include "API_user-interface-v2.hpp"
+#include "API_layer-evaluator.hpp"
+#include "API_fusion-analysis.hpp"
+#include "API_pipeline-partitioner.hpp"
+#include "API_batch-sweep.hpp"
+#include "DSE_precision-search.hpp"
+#include "API_timeline-trace.hpp"
+#include "API_bottleneck-analysis.hpp"
+#include "API_multi-tenant.hpp"
+#include "API_sweep-driver.hpp"
+#include "API_sweep-coordinator.hpp"
 
+#include "DFSL_parser.hpp"
+#include "DFSL_hw-parser.hpp"
+#include "DFSL_writer.hpp"
+#include "DSE_genetic-mapper.hpp"
+#include "DSE_surrogate-trainer.hpp"
+#include "DSE_co-optimizer.hpp"
 
-int main(int argc, char** argv)
+#include "TL_job-journal.hpp"
+
+// Hardware point from a HW file, or from the hardware constraint options if no file is given
+std::shared_ptr<maestro::DFSL::HWConfig> ConstructHWConfig(maestro::Options& option, std::string hw_file_name) {
+    if(hw_file_name != "") {
+        maestro::DFSL::HWParser hw_parser(hw_file_name);
+        auto hw_config = hw_parser.ParseHW();
+        hw_config->noc_multicast_ = option.mc;
+        return hw_config;
+    }
+
+    auto hw_config = std::make_shared<maestro::DFSL::HWConfig>();
+    hw_config->num_pes_ = option.np;
+    hw_config->l1_size_ = option.l1_size;
+    hw_config->l2_size_ = option.l2_size;
+    hw_config->noc_bw_ = option.bw;
+    hw_config->noc_hops_ = option.hop_latency * option.hops;
+    hw_config->off_chip_bw_ = option.offchip_bw;
+    hw_config->noc_multicast_ = option.mc;
+    return hw_config;
+}
+
+// Tile buffers per tensor class from "<input>,<weight>,<output>"; missing entries stay double-buffered
+maestro::CA::TensorBuffering ParseTensorBuffering(std::string buffering_list) {
+    maestro::CA::TensorBuffering ret;
+    std::istringstream list_stream(buffering_list);
+    std::string depth;
+    for(auto data_class : {maestro::DataClass::Input, maestro::DataClass::Weight, maestro::DataClass::Output}) {
+        if(!std::getline(list_stream, depth, ',')) {
+            break;
+        }
+        ret.SetDepth(data_class, std::stoi(depth));
+    }
+    return ret;
+}
+
+// Integers of a comma-separated list
+std::vector<int> ParseIntList(std::string list) {
+    std::vector<int> ret;
+    std::stringstream list_stream(list);
+    std::string value;
+    while(std::getline(list_stream, value, ',')) {
+        if(value != "") {
+            ret.push_back(std::stoi(value));
+        }
+    }
+    return ret;
+}
+
+int RunMAESTRO(int argc, char** argv)
 {
 
     maestro::Options option;
@@ -92,6 +159,345 @@ int main(int argc, char** argv)
 
         }
     }
+    else if(option.sweep_mappings != "") {
+        std::vector<std::shared_ptr<maestro::DFSL::HWConfig>> hw_configs;
+        std::stringstream hw_file_list(option.sweep_hw_files);
+        std::string hw_file_name;
+        while(std::getline(hw_file_list, hw_file_name, ',')) {
+            if(hw_file_name != "") {
+                hw_configs.push_back(ConstructHWConfig(option, hw_file_name));
+            }
+        }
+        if(hw_configs.empty()) {
+            hw_configs.push_back(ConstructHWConfig(option, option.hw_file_name));
+        }
+
+        std::string journal_file_name = option.sweep_journal;
+        if(journal_file_name == "") {
+            journal_file_name = option.sweep_output_file + ".journal";
+        }
+        std::string work_dir = option.sweep_work_dir;
+        if(work_dir == "") {
+            work_dir = journal_file_name + ".work";
+        }
+
+        auto journal = std::make_shared<maestro::TL::JobJournal>(journal_file_name, option.sweep_journal_sync);
+        if(!journal->IsOpen()) {
+            return 1;
+        }
+        auto mapping_files = maestro::SweepDriver::ExpandMappingFiles(option.sweep_mappings);
+
+        if(option.sweep_worker_id >= 0) {
+            auto worker_journal = std::make_shared<maestro::TL::JobJournal>(
+                    maestro::SweepCoordinator::GetWorkerJournalName(work_dir, option.sweep_worker_id), option.sweep_journal_sync);
+            if(!worker_journal->IsOpen()) {
+                return 1;
+            }
+            // Worker processes already run in parallel; use a single analysis thread each unless requested otherwise
+            int num_threads = (option.sweep_threads > 0) ? option.sweep_threads : 1;
+            auto sweep_driver = std::make_shared<maestro::SweepDriver>(
+                    mapping_files, hw_configs, option.num_simd_lanes, num_threads, worker_journal);
+            sweep_driver->AddSharedJournal(journal);
+
+            maestro::SweepCoordinator coordinator(sweep_driver, work_dir, option.sweep_chunk_size);
+            coordinator.RunWorker(option.sweep_worker_id, option.sweep_workers);
+            return 0;
+        }
+
+        auto sweep_driver = std::make_shared<maestro::SweepDriver>(
+                mapping_files, hw_configs, option.num_simd_lanes, option.sweep_threads, journal);
+
+        if(option.sweep_workers > 0) {
+            maestro::SweepCoordinator coordinator(sweep_driver, work_dir, option.sweep_chunk_size);
+            int num_failed_workers = coordinator.RunWorkers(argc, argv, option.sweep_workers);
+            long num_merged = coordinator.MergeWorkerJournals();
+            std::cout << "[MAESTRO] " << option.sweep_workers << " workers analyzed " << num_merged << " jobs in "
+                      << coordinator.GetNumChunks() << " chunks";
+            if(num_failed_workers > 0) {
+                std::cout << "; " << num_failed_workers << " workers failed, finishing their jobs here";
+            }
+            std::cout << std::endl;
+        }
+
+        // Runs the whole sweep in a single process, or whatever the workers left behind
+        sweep_driver->Run();
+
+        bool is_complete = sweep_driver->WriteResults(option.sweep_output_file);
+        std::cout << "[MAESTRO] Sweep of " << sweep_driver->GetJobs().size() << " jobs: " << sweep_driver->GetNumEvaluated()
+                  << " analyzed, " << sweep_driver->GetNumSkipped() << " already in " << journal_file_name << std::endl;
+        std::cout << "[MAESTRO] Results written to " << option.sweep_output_file
+                  << (is_complete ? "" : " (incomplete; re-run to finish the remaining jobs)") << std::endl;
+    }
+    else if(option.pipeline_hw_files != "") {
+        if(option.inter_chip_bw <= 0) {
+            std::cout << "[MAESTRO] Inter-chip link bandwidth must be positive (--inter_chip_bw=" << option.inter_chip_bw << ")" << std::endl;
+            return 1;
+        }
+
+        std::vector<std::shared_ptr<maestro::DFSL::HWConfig>> hw_configs;
+        std::vector<std::string> hw_file_names;
+        std::stringstream hw_file_list(option.pipeline_hw_files);
+        std::string hw_file_name;
+        while(std::getline(hw_file_list, hw_file_name, ',')) {
+            if(hw_file_name != "") {
+                hw_configs.push_back(ConstructHWConfig(option, hw_file_name));
+                hw_file_names.push_back(hw_file_name);
+            }
+        }
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        maestro::PipelinePartitioner partitioner(network, hw_configs, option.num_simd_lanes, option.inter_chip_bw,
+                                                 option.pipeline_threads);
+        auto stages = partitioner.Partition();
+        partitioner.PrintPipeline(stages, hw_file_names);
+    }
+    else if(option.batch_sizes != "") {
+        std::vector<int> batch_sizes;
+        std::stringstream batch_size_list(option.batch_sizes);
+        std::string batch_size;
+        while(std::getline(batch_size_list, batch_size, ',')) {
+            if(batch_size != "" && std::stoi(batch_size) > 0) {
+                batch_sizes.push_back(std::stoi(batch_size));
+            }
+        }
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        maestro::BatchSweep batch_sweep(network, ConstructHWConfig(option, option.hw_file_name), option.num_simd_lanes,
+                                        batch_sizes, option.batch_sweep_threads);
+        auto points = batch_sweep.Run();
+        batch_sweep.PrintCurves(points);
+    }
+    else if(option.precision_candidates_file != "") {
+        auto objective = maestro::DSE::OptimizationTarget::Energy;
+        if(option.precision_objective == "runtime") {
+            objective = maestro::DSE::OptimizationTarget::Runtime;
+        }
+        else if(option.precision_objective != "energy") {
+            std::cout << "[MAESTRO] Unknown mixed-precision search objective " << option.precision_objective << ", using energy" << std::endl;
+        }
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        auto evaluator = std::make_shared<maestro::LayerEvaluator>(ConstructHWConfig(option, option.hw_file_name), option.num_simd_lanes);
+        maestro::DSE::PrecisionSearch precision_search(evaluator, objective, option.precision_budget, option.precision_threads);
+        if(!precision_search.ReadCandidates(option.precision_candidates_file)) {
+            return 1;
+        }
+
+        auto best_network = precision_search.SearchNetwork(network);
+        precision_search.PrintAssignment(best_network);
+
+        std::string output_file_name = option.precision_output_file;
+        if(output_file_name == "") {
+            output_file_name = option.dfsl_file_name.substr(option.dfsl_file_name.find_last_of("/") + 1);
+            output_file_name = output_file_name.substr(0, output_file_name.find(".")) + "_mp.m";
+        }
+
+        maestro::DFSL::DFSLWriter dfsl_writer(output_file_name);
+        if(dfsl_writer.WriteDFSL(best_network)) {
+            std::cout << "[MAESTRO] Precision assignment (" << precision_search.GetNumEvaluations() << " layer analyses) written to "
+                      << output_file_name << std::endl;
+        }
+    }
+    else if(option.bottleneck_analysis) {
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        maestro::BottleneckAnalysis bottleneck_analysis(network, ConstructHWConfig(option, option.hw_file_name),
+                                                        option.num_simd_lanes, option.bottleneck_scale,
+                                                        option.bottleneck_threads);
+        bottleneck_analysis.Run();
+        bottleneck_analysis.PrintBottlenecks();
+        bottleneck_analysis.PrintSensitivities();
+    }
+    else if(option.tenant_mappings != "") {
+        std::vector<std::shared_ptr<maestro::DFA::NeuralNetwork>> networks;
+        std::stringstream mapping_file_list(option.tenant_mappings);
+        std::string mapping_file_name;
+        while(std::getline(mapping_file_list, mapping_file_name, ',')) {
+            if(mapping_file_name != "") {
+                auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+                maestro::DFSL::DFSLParser dfsl_parser(mapping_file_name);
+                dfsl_parser.ParseDFSL(network);
+                networks.push_back(network);
+            }
+        }
+
+        auto objective = maestro::TenantObjective::Slowdown;
+        if(option.tenant_objective == "throughput") {
+            objective = maestro::TenantObjective::Throughput;
+        }
+        else if(option.tenant_objective != "slowdown") {
+            std::cout << "[MAESTRO] Unknown multi-tenant objective " << option.tenant_objective << ", using slowdown" << std::endl;
+        }
+
+        maestro::MultiTenantAnalysis multi_tenant_analysis(networks, ConstructHWConfig(option, option.hw_file_name),
+                                                           option.num_simd_lanes, objective, option.tenant_threads);
+        multi_tenant_analysis.SetPETick(option.tenant_pe_tick);
+        if(option.tenant_pe_split != "search") {
+            multi_tenant_analysis.SetPESplit(ParseIntList(option.tenant_pe_split));
+        }
+        if(option.tenant_bw_split != "") {
+            std::vector<double> bw_split;
+            std::stringstream bw_split_list(option.tenant_bw_split);
+            std::string bw_share;
+            while(std::getline(bw_split_list, bw_share, ',')) {
+                if(bw_share != "") {
+                    bw_split.push_back(std::stod(bw_share));
+                }
+            }
+            multi_tenant_analysis.SetBandwidthSplit(bw_split);
+        }
+
+        if(!multi_tenant_analysis.Run()) {
+            return 1;
+        }
+        multi_tenant_analysis.PrintResults();
+    }
+    else if(option.co_optimize) {
+        auto objective = maestro::DSE::OptimizationTarget::Runtime;
+        if(option.ga_objective == "energy") {
+            objective = maestro::DSE::OptimizationTarget::Energy;
+        }
+        else if(option.ga_objective == "edp") {
+            objective = maestro::DSE::OptimizationTarget::EnergyDelayProduct;
+        }
+        else if(option.ga_objective != "runtime") {
+            std::cout << "[MAESTRO] Unknown mapping search objective " << option.ga_objective << ", using runtime" << std::endl;
+        }
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        maestro::DSE::CoOptimizer co_optimizer(network, ConstructHWConfig(option, option.hw_file_name), option.num_simd_lanes,
+                                               objective, option.area_cap, option.power_cap, option.ga_population,
+                                               option.ga_generations, option.ga_mutation_rate, option.ga_elites,
+                                               option.ga_seed, option.ga_threads);
+        co_optimizer.SetHardwareCandidates(ParseIntList(option.coopt_pes), ParseIntList(option.coopt_noc_bws),
+                                           ParseIntList(option.coopt_l1_sizes), ParseIntList(option.coopt_l2_sizes));
+        co_optimizer.SetPruning(option.ga_pruning);
+        if(!co_optimizer.Run()) {
+            return 1;
+        }
+
+        std::string output_prefix = option.coopt_output;
+        if(output_prefix == "") {
+            output_prefix = option.dfsl_file_name.substr(option.dfsl_file_name.find_last_of("/") + 1);
+            output_prefix = output_prefix.substr(0, output_prefix.find(".")) + "_coopt";
+        }
+        if(!co_optimizer.WriteResults(output_prefix)) {
+            return 1;
+        }
+
+        co_optimizer.PrintParetoFront();
+        std::cout << "[MAESTRO] " << co_optimizer.GetNumSearchedPoints() << " of " << co_optimizer.GetDesignPoints().size()
+                  << " hardware points within the constraints, " << co_optimizer.GetNumUniqueLayers() << " distinct layers searched on each ("
+                  << co_optimizer.GetNumEvaluations() << " evaluations, " << co_optimizer.GetNumCacheHits() << " cache hits, "
+                  << co_optimizer.GetNumSharedHits() << " analyses shared across buffer sizes); results written to "
+                  << output_prefix << ".csv" << std::endl;
+    }
+    else if(option.surrogate_train_file != "") {
+        auto hw_config = ConstructHWConfig(option, option.hw_file_name);
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        maestro::DSE::GradientBoostingParams params;
+        params.num_trees_ = option.surrogate_trees;
+        params.max_depth_ = option.surrogate_depth;
+        params.seed_ = option.surrogate_seed;
+
+        auto model = std::make_shared<maestro::DSE::SurrogateModel>(params);
+        maestro::DSE::SurrogateTrainer trainer(model, hw_config, option.num_simd_lanes, option.surrogate_seed, option.surrogate_threads);
+        trainer.GenerateSamples(network, option.surrogate_mappings, option.surrogate_hw_variants);
+        std::cout << "[MAESTRO] Surrogate training set: " << model->GetNumSamples() << " samples ("
+                  << trainer.GetNumFailedAnalyses() << " invalid mappings dropped)" << std::endl;
+
+        auto calibration = model->Train(option.surrogate_validation);
+        calibration.Print();
+
+        if(model->Save(option.surrogate_train_file)) {
+            std::cout << "[MAESTRO] Surrogate model written to " << option.surrogate_train_file << std::endl;
+        }
+    }
+    else if(option.surrogate_model_file != "" && !option.ga_mapper) {
+        auto hw_config = ConstructHWConfig(option, option.hw_file_name);
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        auto model = std::make_shared<maestro::DSE::SurrogateModel>();
+        if(!model->Load(option.surrogate_model_file)) {
+            return 1;
+        }
+
+        maestro::DSE::SurrogateTrainer trainer(model, hw_config, option.num_simd_lanes, option.surrogate_seed, option.surrogate_threads);
+        auto calibration = trainer.Validate(network);
+        std::cout << "[MAESTRO] Calibration of the model (held-out samples):" << std::endl;
+        model->GetCalibration().Print();
+        std::cout << "[MAESTRO] Error on the mappings of " << option.dfsl_file_name << ":" << std::endl;
+        calibration.Print();
+    }
+    else if(option.ga_mapper) {
+        auto hw_config = ConstructHWConfig(option, option.hw_file_name);
+
+        auto objective = maestro::DSE::OptimizationTarget::Runtime;
+        if(option.ga_objective == "energy") {
+            objective = maestro::DSE::OptimizationTarget::Energy;
+        }
+        else if(option.ga_objective == "edp") {
+            objective = maestro::DSE::OptimizationTarget::EnergyDelayProduct;
+        }
+        else if(option.ga_objective != "runtime") {
+            std::cout << "[MAESTRO] Unknown mapping search objective " << option.ga_objective << ", using runtime" << std::endl;
+        }
+
+        auto network = std::make_shared<maestro::DFA::NeuralNetwork>();
+        maestro::DFSL::DFSLParser dfsl_parser(option.dfsl_file_name);
+        dfsl_parser.ParseDFSL(network);
+
+        auto evaluator = std::make_shared<maestro::LayerEvaluator>(hw_config, option.num_simd_lanes);
+        auto mapper = std::make_shared<maestro::DSE::GeneticMapper>(
+                evaluator, objective, option.ga_population, option.ga_generations, option.ga_mutation_rate,
+                option.ga_elites, option.ga_seed, option.ga_threads);
+        mapper->SetPruning(option.ga_pruning);
+        if(option.surrogate_model_file != "") {
+            auto model = std::make_shared<maestro::DSE::SurrogateModel>();
+            if(!model->Load(option.surrogate_model_file)) {
+                return 1;
+            }
+            mapper->SetSurrogate(model, option.surrogate_exact_top);
+        }
+
+        auto best_network = mapper->SearchNetwork(network);
+
+        std::string output_file_name = option.ga_output_file;
+        if(output_file_name == "") {
+            output_file_name = option.dfsl_file_name.substr(option.dfsl_file_name.find_last_of("/") + 1);
+            output_file_name = output_file_name.substr(0, output_file_name.find(".")) + "_ga.m";
+        }
+
+        maestro::DFSL::DFSLWriter dfsl_writer(output_file_name);
+        if(dfsl_writer.WriteDFSL(best_network)) {
+            std::cout << "[MAESTRO] Best mappings (" << mapper->GetNumEvaluations() << " evaluations, "
+                      << mapper->GetNumCacheHits() << " cache hits) written to " << output_file_name << std::endl;
+            if(option.ga_pruning) {
+                std::cout << "[MAESTRO] Lower-bound pruning: " << mapper->GetPruningStats().ToString() << std::endl;
+            }
+        }
+    }
     else {
         std::shared_ptr<std::vector<bool>> noc_multcast = std::make_shared<std::vector<bool>>();
         std::shared_ptr<std::vector<int>> noc_latency = std::make_shared<std::vector<int>>();
@@ -108,10 +514,10 @@ int main(int argc, char** argv)
         noc_latency->push_back(option.hop_latency * option.hops);
         noc_latency->push_back(option.hop_latency * option.hops);
 
-        noc_multcast->push_back(true);
-        noc_multcast->push_back(true);
-        noc_multcast->push_back(true);
-        noc_multcast->push_back(true);
+        noc_multcast->push_back(option.mc);
+        noc_multcast->push_back(option.mc);
+        noc_multcast->push_back(option.mc);
+        noc_multcast->push_back(option.mc);
 
         auto config = std::make_shared<maestro::ConfigurationV2>(
                 option.dfsl_file_name,
@@ -128,8 +534,75 @@ int main(int argc, char** argv)
         );
 
         auto api = std::make_shared<maestro::APIV2>(config);
+        api->SetIntraLayerThreads(option.intra_layer_threads);
+        if(option.do_reduction && !option.do_implicit_reduction) {
+            api->SetReductionMode(option.fg_sync ? maestro::CA::ReductionMode::FineGrainedSync
+                                                 : maestro::CA::ReductionMode::CoarseGrainedSync);
+        }
+        api->SetTensorBuffering(ParseTensorBuffering(option.buffering));
+        // Only the per-layer analysis below emits a timeline trace
+        bool is_traced = option.trace_file != "" && option.fidelity != "compare"
+                         && option.fusion != "chains" && option.fusion != "search";
+        if(option.trace_file != "" && !is_traced) {
+            std::cout << "[MAESTRO] Timeline trace is not available with "
+                      << (option.fidelity == "compare" ? "--fidelity=compare" : "--fusion=" + option.fusion)
+                      << "; --trace_file ignored" << std::endl;
+        }
+        api->SetTimelineRecording(is_traced);
 
-        auto res = api->AnalyzeNeuralNetwork(option.print_res_to_screen, option.print_res_to_csv_file, option.print_log_file);
+        if(option.fidelity == "compare") {
+            api->ReportEstimationError();
+        }
+        else {
+            if(option.fidelity == "roofline") {
+                api->SetAnalysisFidelity(maestro::CA::AnalysisFidelity::Roofline);
+            }
+            else if(option.fidelity != "exact") {
+                std::cout << "[MAESTRO] Unknown analysis fidelity " << option.fidelity << ", using exact" << std::endl;
+            }
+            if(option.optimize_buffering) {
+                for(int layer_id = 0; layer_id < config->network_->GetNumLayers(); layer_id++) {
+                    auto buffering = api->OptimizeBuffering(layer_id);
+                    std::cout << "[MAESTRO] Buffering of " << config->network_->at(layer_id)->GetName() << ": "
+                              << buffering.ToString() << std::endl;
+                }
+            }
+            if(option.fusion == "chains" || option.fusion == "search") {
+                maestro::FusionAnalysis fusion_analysis(api);
+                auto groups = (option.fusion == "search") ? fusion_analysis.SearchFusionGroups()
+                                                          : fusion_analysis.FindFusionChains();
+                fusion_analysis.PrintFusionGroups(groups);
+            }
+            else {
+                if(option.fusion != "none") {
+                    std::cout << "[MAESTRO] Unknown fusion analysis " << option.fusion << ", analyzing layers separately" << std::endl;
+                }
+                auto res = api->AnalyzeNeuralNetwork(option.print_res_to_screen, option.print_res_to_csv_file, option.print_log_file);
+                if(is_traced) {
+                    maestro::TimelineTrace timeline_trace(option.trace_file, option.trace_depth, option.trace_max_groups,
+                                                          option.trace_max_expanded);
+                    if(timeline_trace.WriteTrace(config->network_, res)) {
+                        std::cout << "[MAESTRO] Timeline trace (" << timeline_trace.GetNumEvents() << " events) written to "
+                                  << option.trace_file << std::endl;
+                    }
+                }
+            }
+        }
     }
     return 0;
 }
+
+int main(int argc, char** argv)
+{
+    try {
+        return RunMAESTRO(argc, argv);
+    }
+    catch(maestro::TL::MAESTROError& e) {
+        // The error handler has already reported it
+        return -1;
+    }
+    catch(std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return -1;
+    }
+}